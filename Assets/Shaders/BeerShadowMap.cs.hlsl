@@ -0,0 +1,68 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Renders the Beer shadow map by marching the NVDF along one
+light ray per texel. CPU mirror: Muon::BuildBeerShadowMap
+----------------------------------------------*/
+#include "CloudVolume.hlsli"
+#include "BeerShadowMap.hlsli"
+
+static const int MAX_STEPS = 512;
+static const float MIN_STEP = 4.0; // World units. About half an NVDF texel
+
+Texture3D sdfNvdfTex : register(t0); // [sdf.r, model.r, model.g, model.b]
+SamplerState linearClamp : register(s3);
+RWTexture2D<float4> gBeerShadowMap : register(u0); // [front depth, mean extinction, max optical depth, unused]
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    if (any(dispatchThreadID.xy >= beerShadowResolution))
+        return;
+
+    // Texel center on the near plane. Rows run from +up to -up, same as GetBeerShadowMapCoord()
+    float2 ndc = (float2(dispatchThreadID.xy) + 0.5) / float(beerShadowResolution) * 2.0 - 1.0;
+    ndc.y = -ndc.y;
+    float3 rayOrigin = sunMapOrigin + (sunMapRight * ndc.x + sunMapUp * ndc.y) * sunMapExtent;
+
+    float4 result = float4(sunMapDepthRange, 0.0, 0.0, 0.0);
+
+    float tEnter, tExit;
+    if (RayBoxIntersect(rayOrigin, sunMapForward, VOLUME_MIN_WS, VOLUME_MAX_WS, tEnter, tExit))
+    {
+        float frontDepth = -1.0;
+        float backDepth = 0.0;
+        float opticalDepth = 0.0;
+
+        float t = max(tEnter, 0.0);
+        [loop]
+        for (int i = 0; i < MAX_STEPS && t < tExit; ++i)
+        {
+            float4 nvdfSample = sdfNvdfTex.SampleLevel(linearClamp, WorldToNvdfUV(rayOrigin + sunMapForward * t), 0.0);
+
+            // Skip empty space with the SDF, walk the inside at a fixed rate
+            float sdfDistance = DecodeSdf(nvdfSample.r) * AUTHORING_TO_WORLD_SCALE;
+            float stepSize = max(sdfDistance, MIN_STEP);
+
+            float extinction = GetCoarseCloudExtinction(nvdfSample);
+            if (extinction > 0.0)
+            {
+                float segment = min(stepSize, tExit - t);
+                if (frontDepth < 0.0)
+                    frontDepth = t;
+                backDepth = t + segment;
+                opticalDepth += extinction * segment;
+            }
+
+            t += stepSize;
+        }
+
+        if (frontDepth >= 0.0)
+        {
+            float thickness = max(backDepth - frontDepth, MIN_STEP);
+            result = float4(frontDepth, opticalDepth / thickness, opticalDepth, 0.0);
+        }
+    }
+
+    gBeerShadowMap[dispatchThreadID.xy] = result;
+}
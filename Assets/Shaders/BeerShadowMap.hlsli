@@ -0,0 +1,53 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Beer shadow map of the clouds, seen from the sun.
+Each texel stores [front depth, mean extinction, max optical depth] along one
+light ray, so transmittance anywhere along it is a single fetch.
+Matches Muon::cbBeerShadowParams, CPU mirror in Utils/CloudLightingUtils.h
+----------------------------------------------*/
+#ifndef BEERSHADOWMAP_HLSLI
+#define BEERSHADOWMAP_HLSLI
+
+cbuffer BeerShadowParams : register(b7)
+{
+    float3 sunMapOrigin;    // Center of the map's near plane
+    float sunMapExtent;     // Half the width of the map in world units
+    float3 sunMapRight;
+    float sunMapDepthRange; // Near to far plane distance
+    float3 sunMapUp;
+    uint beerShadowValid;   // The map has been rendered at least once
+    float3 sunMapForward;   // Direction light travels, away from the sun
+    uint beerShadowResolution;
+};
+
+// World position -> [uv, depth from the near plane]
+float3 GetBeerShadowMapCoord(float3 positionWS)
+{
+    float3 d = positionWS - sunMapOrigin;
+    float2 ndc = float2(dot(d, sunMapRight), dot(d, sunMapUp)) / sunMapExtent;
+    return float3(ndc.x * 0.5 + 0.5, 0.5 - ndc.y * 0.5, dot(d, sunMapForward));
+}
+
+// Optical depth of the clouds between the sun and positionWS
+float SampleBeerShadowOpticalDepth(Texture2D<float4> beerShadowMap, SamplerState linearClampSampler, float3 positionWS)
+{
+    if (beerShadowValid == 0)
+        return 0.0;
+
+    float3 coord = GetBeerShadowMapCoord(positionWS);
+    if (any(coord.xy < 0.0) || any(coord.xy > 1.0))
+        return 0.0;
+
+    float3 bsm = beerShadowMap.SampleLevel(linearClampSampler, coord.xy, 0.0).xyz;
+    return min(bsm.y * max(coord.z - bsm.x, 0.0), bsm.z);
+}
+
+// Fraction of sunlight that makes it through the clouds to positionWS.
+// CPU mirror: Muon::EvaluateBeerShadowTransmittance
+float SampleBeerShadowTransmittance(Texture2D<float4> beerShadowMap, SamplerState linearClampSampler, float3 positionWS)
+{
+    return exp(-SampleBeerShadowOpticalDepth(beerShadowMap, linearClampSampler, positionWS));
+}
+
+#endif
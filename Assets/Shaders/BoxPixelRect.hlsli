@@ -0,0 +1,91 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Conservative screen rectangle of a world space box, shared by
+the brick splat in CloudRayIntervals.cs and the hull binning in HullBinning.cs
+CPU mirror: Muon::GetBrickPixelRect in RayIntervalUtils.h
+----------------------------------------------*/
+#ifndef BOXPIXELRECT_HLSLI
+#define BOXPIXELRECT_HLSLI
+
+#include "VS_Common.hlsli"
+#include "CloudParamsBuffer.hlsli"
+
+// Boxes are clipped here in view space before projecting, matches RayIntervalUtils.cpp
+static const float CLOUD_BRICK_NEAR_PLANE = 0.1;
+
+// Inclusive rectangle of full resolution pixels whose rays may hit the box. False if it is behind the camera.
+// CPU mirror: Muon::GetBrickPixelRect
+bool GetBrickPixelRect(float3 boxMin, float3 boxMax, float3 eyePos, out uint2 rectMin, out uint2 rectMax)
+{
+    rectMin = uint2(0, 0);
+    rectMax = fullResolution - 1;
+
+    float tanHalfFovX = 1.0 / proj[0][0];
+    float tanHalfFovY = 1.0 / proj[1][1];
+
+    float3 cornersVS[8];
+    float maxZ = -1e30;
+    [unroll]
+    for (uint i = 0; i < 8; ++i)
+    {
+        float3 corner = float3((i & 1) ? boxMax.x : boxMin.x, (i & 2) ? boxMax.y : boxMin.y, (i & 4) ? boxMax.z : boxMin.z);
+        cornersVS[i] = mul(view, float4(corner, 1.0)).xyz;
+        maxZ = max(maxZ, cornersVS[i].z);
+    }
+
+    if (maxZ < CLOUD_BRICK_NEAR_PLANE)
+        return false;
+
+    // Anything in the frustum closer than the near plane is this close to the eye
+    float3 eyeOffset = max(max(boxMin - eyePos, eyePos - boxMax), 0.0);
+    if (length(eyeOffset) <= CLOUD_BRICK_NEAR_PLANE * sqrt(1.0 + tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY))
+        return true;
+
+    // Project the corners in front of the near plane, and where the edges cross it
+    float2 pixelMin = 1e30;
+    float2 pixelMax = -1e30;
+    [unroll]
+    for (uint a = 0; a < 8; ++a)
+    {
+        float3 points[4];
+        bool valid[4];
+        points[0] = cornersVS[a];
+        valid[0] = cornersVS[a].z >= CLOUD_BRICK_NEAR_PLANE;
+
+        [unroll]
+        for (uint axis = 0; axis < 3; ++axis)
+        {
+            uint axisBit = 1u << axis;
+            float3 b = cornersVS[a | axisBit];
+            valid[axis + 1] = !(a & axisBit) && ((cornersVS[a].z < CLOUD_BRICK_NEAR_PLANE) != (b.z < CLOUD_BRICK_NEAR_PLANE));
+
+            float s = (CLOUD_BRICK_NEAR_PLANE - cornersVS[a].z) / (b.z - cornersVS[a].z);
+            points[axis + 1] = float3(lerp(cornersVS[a].xy, b.xy, valid[axis + 1] ? s : 0.0), CLOUD_BRICK_NEAR_PLANE);
+        }
+
+        [unroll]
+        for (uint p = 0; p < 4; ++p)
+        {
+            if (!valid[p])
+                continue;
+
+            float2 ndc = points[p].xy / (points[p].z * float2(tanHalfFovX, tanHalfFovY));
+            float2 pixel = float2(ndc.x + 1.0, 1.0 - ndc.y) * 0.5 * float2(fullResolution) - 0.5;
+            pixelMin = min(pixelMin, pixel);
+            pixelMax = max(pixelMax, pixel);
+        }
+    }
+
+    // Pixel centers inside the projected hull, widened a pixel to absorb rounding
+    pixelMin = floor(pixelMin) - 1.0;
+    pixelMax = ceil(pixelMax) + 1.0;
+    if (any(pixelMax < 0.0) || any(pixelMin > float2(fullResolution - 1)))
+        return false;
+
+    rectMin = uint2(max(pixelMin, 0.0));
+    rectMax = uint2(min(pixelMax, float2(fullResolution - 1)));
+    return true;
+}
+
+#endif
@@ -0,0 +1,23 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Constants of the per-tile adaptive step budget shared by
+Raymarch.cs, CloudTileStats.cs and CloudTileBudget.cs
+CPU mirror: Utils/CloudBudgetUtils.h
+----------------------------------------------*/
+#ifndef CLOUDBUDGET_HLSLI
+#define CLOUDBUDGET_HLSLI
+
+static const uint CLOUD_BUDGET_TILE_SIZE = 8; // In march texels
+static const float CLOUD_BUDGET_MIN_STEP_SCALE = 0.5;
+static const float CLOUD_BUDGET_MAX_STEP_SCALE = 3.0;
+static const float CLOUD_BUDGET_IMPORTANCE_FLOOR = 1e-3;
+static const float CLOUD_BUDGET_RESPONSE = 0.25;
+static const uint CLOUD_BUDGET_SOLVER_ITERATIONS = 32;
+
+uint2 GetBudgetTileCount(uint2 marchSize)
+{
+    return (marchSize + CLOUD_BUDGET_TILE_SIZE - 1) / CLOUD_BUDGET_TILE_SIZE;
+}
+
+#endif
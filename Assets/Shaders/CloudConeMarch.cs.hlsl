@@ -0,0 +1,63 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Cone march prepass for the cloud raymarch.
+One thread per 8x8 pixel tile marches a cone holding all of the tile's rays
+and writes how far they can skip before reaching a cloud.
+CPU mirror: Muon::BuildConeStartTiles
+----------------------------------------------*/
+#include "VS_Common.hlsli"
+#include "CloudParamsBuffer.hlsli"
+#include "DepthUtils.hlsli"
+#include "CloudConeMarch.hlsli"
+
+static const float MAX_DIST = 1000.0; // Matches Raymarch.cs
+
+Texture3D<float> cloudEmptyDistanceTex : register(t0); // Lower bound on the distance to the nearest cloud, per coarse cell
+RWTexture2D<float> gConeStart : register(u0); // Distance along the tile's rays the raymarch can start at
+
+// Axis and half angle of the cone holding every pixel center ray of a tile, in view space.
+// CPU mirror: Muon::GetTileCone
+float3 GetTileCone(uint2 tile, out float tanHalfAngle)
+{
+    // Every ray the raymarch traces from this tile passes through a pixel center, so the corner pixels bound them all
+    int2 cornerMin = int2(tile * CLOUD_CONE_TILE_SIZE);
+    int2 cornerMax = min(cornerMin + int(CLOUD_CONE_TILE_SIZE), int2(fullResolution)) - 1;
+
+    float3 corners[4] =
+    {
+        GetViewRayDirection(cornerMin, fullResolution, proj),
+        GetViewRayDirection(int2(cornerMax.x, cornerMin.y), fullResolution, proj),
+        GetViewRayDirection(int2(cornerMin.x, cornerMax.y), fullResolution, proj),
+        GetViewRayDirection(cornerMax, fullResolution, proj),
+    };
+
+    float3 axis = normalize(corners[0] + corners[1] + corners[2] + corners[3]);
+
+    float minCos = 1.0;
+    [unroll]
+    for (uint i = 0; i < 4; ++i)
+        minCos = min(minCos, dot(axis, corners[i]));
+
+    // A hair wider to absorb rounding
+    minCos = clamp(minCos - 1e-5, 1e-3, 1.0);
+    tanHalfAngle = sqrt(1.0 - minCos * minCos) / minCos;
+    return axis;
+}
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 tile = dispatchThreadID.xy;
+    uint2 tileCount = (fullResolution + CLOUD_CONE_TILE_SIZE - 1) / CLOUD_CONE_TILE_SIZE;
+    if (any(tile >= tileCount))
+        return;
+
+    float tanHalfAngle;
+    float3 axisVS = GetTileCone(tile, tanHalfAngle);
+
+    float3 axisWS = normalize(mul(invView, float4(axisVS, 0.0)).xyz);
+    float3 eyePos = float3(invView[0][3], invView[1][3], invView[2][3]);
+
+    gConeStart[tile] = ConeMarchFirstHit(cloudEmptyDistanceTex, eyePos, axisWS, tanHalfAngle, MAX_DIST);
+}
@@ -0,0 +1,52 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Cone marching through the conservative cloud distance grid.
+The grid holds, per coarse cell, a lower bound on the distance to the nearest
+cloud. Built by Muon::BuildCloudDensityGrid, CPU mirrors in ConeMarchUtils.h
+----------------------------------------------*/
+#ifndef CLOUDCONEMARCH_HLSLI
+#define CLOUDCONEMARCH_HLSLI
+
+#include "CloudVolume.hlsli"
+
+static const uint CLOUD_CONE_TILE_SIZE = 8; // Full resolution pixels per side of a cone tile
+static const uint CLOUD_CONE_MAX_STEPS = 64;
+
+// Lower bound on the distance from positionWS to the nearest cloud.
+// CPU mirror: Muon::GetCloudEmptyDistance
+float GetCloudEmptyDistance(Texture3D<float> emptyDistanceTex, float3 positionWS)
+{
+    float3 clamped = clamp(positionWS, VOLUME_MIN_WS, VOLUME_MAX_WS);
+    float outside = length(positionWS - clamped);
+
+    uint3 dims;
+    emptyDistanceTex.GetDimensions(dims.x, dims.y, dims.z);
+    uint3 cell = min(uint3(WorldToNvdfUV(clamped) * float3(dims)), dims - 1);
+
+    // Clouds only live inside the volume, and the closest point of it is outside away from the cell's bound
+    return max(outside, emptyDistanceTex.Load(int4(cell, 0)) - outside);
+}
+
+// Distance along axis before which nothing inside the cone can touch a cloud, at most maxDistance.
+// CPU mirror: Muon::ConeMarchFirstHit
+float ConeMarchFirstHit(Texture3D<float> emptyDistanceTex, float3 origin, float3 axis, float tanHalfAngle, float maxDistance)
+{
+    float t = 0.0;
+
+    [loop]
+    for (uint i = 0; i < CLOUD_CONE_MAX_STEPS && t < maxDistance; ++i)
+    {
+        float emptyDistance = GetCloudEmptyDistance(emptyDistanceTex, origin + axis * t);
+        float coneRadius = t * tanHalfAngle;
+        if (emptyDistance <= coneRadius)
+            return t;
+
+        // The empty ball covers the cone section at t + step as long as step + (t + step) * tan <= emptyDistance
+        t += (emptyDistance - coneRadius) / (1.0 + tanHalfAngle);
+    }
+
+    return min(t, maxDistance);
+}
+
+#endif
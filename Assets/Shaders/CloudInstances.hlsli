@@ -0,0 +1,125 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Placed cloud instances and the BVH over their bounds, rebuilt
+on the CPU every frame. Each instance maps the world into the NVDF volume
+space the single cloud used to be authored in.
+CPU mirror: Utils/CloudInstanceUtils.h
+----------------------------------------------*/
+#ifndef CLOUDINSTANCES_HLSLI
+#define CLOUDINSTANCES_HLSLI
+
+#include "CloudVolume.hlsli"
+
+// Match Muon::MAX_CLOUD_INSTANCES, MAX_CLOUD_BVH_NODES and MAX_RAY_CLOUD_INSTANCES
+#define MAX_CLOUD_INSTANCES 256
+#define MAX_CLOUD_BVH_NODES (2 * MAX_CLOUD_INSTANCES - 1)
+#define MAX_RAY_CLOUD_INSTANCES 8
+#define CLOUD_BVH_STACK_SIZE 32
+
+// Matches Muon::cbCloudInstances. Instances are stored in BVH leaf order.
+cbuffer CloudInstances : register(b14)
+{
+    float4 instanceToLocal[MAX_CLOUD_INSTANCES * 3]; // Rows of the world -> NVDF volume space transform
+    float4 instanceParams[MAX_CLOUD_INSTANCES];      // x: world units per volume unit, y: density multiplier, z: NVDF slot
+    float4 bvhNodeMin[MAX_CLOUD_BVH_NODES];          // xyz: bounds, w: asuint first child (inner) or first instance (leaf)
+    float4 bvhNodeMax[MAX_CLOUD_BVH_NODES];          // xyz: bounds, w: asuint instance count, 0 for inner nodes
+    uint cloudInstanceCount;
+};
+
+struct CloudRayHit
+{
+    uint instance;
+    float tEnter;
+    float tExit;
+};
+
+float3 CloudInstanceToLocal(uint instance, float3 positionWS)
+{
+    float4 p = float4(positionWS, 1.0);
+    return float3(dot(instanceToLocal[instance * 3 + 0], p), dot(instanceToLocal[instance * 3 + 1], p), dot(instanceToLocal[instance * 3 + 2], p));
+}
+
+float3 CloudInstanceDirToLocal(uint instance, float3 dirWS)
+{
+    return float3(dot(instanceToLocal[instance * 3 + 0].xyz, dirWS), dot(instanceToLocal[instance * 3 + 1].xyz, dirWS), dot(instanceToLocal[instance * 3 + 2].xyz, dirWS));
+}
+
+// Instances the ray overlaps within [tMin, tMax], nearest entry first. Overlaps past MAX_RAY_CLOUD_INSTANCES are dropped.
+// CPU mirror: Muon::CollectCloudRayHits
+uint CollectCloudRayHits(float3 origin, float3 dir, float tMin, float tMax, out CloudRayHit hits[MAX_RAY_CLOUD_INSTANCES])
+{
+    [unroll]
+    for (uint h = 0; h < MAX_RAY_CLOUD_INSTANCES; ++h)
+    {
+        hits[h].instance = 0;
+        hits[h].tEnter = tMax;
+        hits[h].tExit = tMax;
+    }
+
+    if (cloudInstanceCount == 0)
+        return 0;
+
+    uint hitCount = 0;
+    uint stack[CLOUD_BVH_STACK_SIZE];
+    uint stackSize = 0;
+    stack[stackSize++] = 0;
+
+    [loop]
+    while (stackSize > 0)
+    {
+        uint nodeIdx = stack[--stackSize];
+        float4 nodeMin = bvhNodeMin[nodeIdx];
+        float4 nodeMax = bvhNodeMax[nodeIdx];
+
+        float tEnter, tExit;
+        if (!RayBoxIntersect(origin, dir, nodeMin.xyz, nodeMax.xyz, tEnter, tExit) || tEnter > tMax || tExit < tMin)
+            continue;
+
+        uint first = asuint(nodeMin.w);
+        uint count = asuint(nodeMax.w);
+        if (count == 0)
+        {
+            if (stackSize + 2 <= CLOUD_BVH_STACK_SIZE)
+            {
+                stack[stackSize++] = first + 1;
+                stack[stackSize++] = first;
+            }
+            continue;
+        }
+
+        for (uint instance = first; instance < first + count; ++instance)
+        {
+            // Similarity transform, so the unnormalized local ray keeps world distances as its parameter
+            float3 localOrigin = CloudInstanceToLocal(instance, origin);
+            float3 localDir = CloudInstanceDirToLocal(instance, dir);
+            if (!RayBoxIntersect(localOrigin, localDir, VOLUME_MIN_WS, VOLUME_MAX_WS, tEnter, tExit))
+                continue;
+
+            tEnter = max(tEnter, tMin);
+            tExit = min(tExit, tMax);
+            if (tExit <= tEnter)
+                continue;
+
+            // Insert by entry, dropping the furthest once full
+            uint insertAt = hitCount;
+            while (insertAt > 0 && hits[insertAt - 1].tEnter > tEnter)
+                --insertAt;
+
+            if (insertAt >= MAX_RAY_CLOUD_INSTANCES)
+                continue;
+
+            for (uint i = min(hitCount, MAX_RAY_CLOUD_INSTANCES - 1); i > insertAt; --i)
+                hits[i] = hits[i - 1];
+
+            hits[insertAt].instance = instance;
+            hits[insertAt].tEnter = tEnter;
+            hits[insertAt].tExit = tExit;
+            hitCount = min(hitCount + 1, MAX_RAY_CLOUD_INSTANCES);
+        }
+    }
+
+    return hitCount;
+}
+
+#endif
@@ -0,0 +1,36 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Bakes a band of rows of the far-field cloud panorama.
+Each texel marches the same NVDF march as Raymarch.cs, from the sweep origin
+and only past the far-field distance. Driven by Muon::CloudPanorama
+----------------------------------------------*/
+#define CLOUD_PANORAMA_BAKE 1
+#include "Raymarch.cs.hlsl"
+
+cbuffer CloudPanoramaParams : register(b12)
+{
+    float3 sweepOrigin;          // World space point this sweep is baked from
+    float sweepFarFieldDistance; // Marching starts here, Raymarch.cs covers everything closer
+    uint panoramaResolution;
+    uint rowBegin;               // Rows [rowBegin, rowEnd) are baked this dispatch
+    uint rowEnd;
+};
+
+RWTexture2D<float4> gCloudPanorama : register(u0); // [in-scattered radiance.rgb, transmittance]
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    uint2 texel = uint2(dispatchThreadID.x, rowBegin + dispatchThreadID.y);
+    if (texel.x >= panoramaResolution || texel.y >= rowEnd)
+        return;
+
+    float3 dir = OctahedralDecode((float2(texel) + 0.5) / float(panoramaResolution));
+    float texelAngle = PANORAMA_TEXEL_ANGLE_SCALE / float(panoramaResolution);
+
+    float cloudDistance;
+    uint stepCount;
+    gCloudPanorama[texel] = VolumeRaymarchNvdf(sweepOrigin, dir, SKY_DISTANCE, float2(sweepFarFieldDistance, MAX_DIST), stepSizeScale, int2(texel), texelAngle, HULL_TILE_NONE,
+                                               cloudDistance, stepCount);
+}
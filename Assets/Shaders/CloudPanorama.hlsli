@@ -0,0 +1,44 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Octahedral addressing for the far-field cloud panorama.
+The panorama stores [in-scattered radiance.rgb, transmittance] of the clouds
+past the far-field distance, seen from one origin. Baked by CloudPanorama.cs
+and read by Raymarch.cs in place of marching the far end of sky rays.
+----------------------------------------------*/
+#ifndef CLOUDPANORAMA_HLSLI
+#define CLOUDPANORAMA_HLSLI
+
+// Solid angle of the whole sphere is 4pi, spread evenly enough over res^2 texels that sqrt(4pi)/res is a fair texel footprint
+static const float PANORAMA_TEXEL_ANGLE_SCALE = 3.5449077;
+
+float2 SignNotZero(float2 v)
+{
+    return float2(v.x >= 0.0 ? 1.0 : -1.0, v.y >= 0.0 ? 1.0 : -1.0);
+}
+
+// World space direction (y up) to [0,1] UV. The upper hemisphere fills the center diamond, the lower one the corners.
+// CPU mirror: Muon::OctahedralEncode in RaymarchUtils.h
+float2 OctahedralEncode(float3 dir)
+{
+    dir /= abs(dir.x) + abs(dir.y) + abs(dir.z);
+
+    float2 p = dir.xz;
+    if (dir.y < 0.0)
+        p = (1.0 - abs(p.yx)) * SignNotZero(p);
+
+    return p * 0.5 + 0.5;
+}
+
+// CPU mirror: Muon::OctahedralDecode in RaymarchUtils.h
+float3 OctahedralDecode(float2 uv)
+{
+    float2 p = uv * 2.0 - 1.0;
+    float3 dir = float3(p.x, 1.0 - abs(p.x) - abs(p.y), p.y);
+
+    float fold = saturate(-dir.y);
+    dir.xz -= fold * SignNotZero(dir.xz);
+    return normalize(dir);
+}
+
+#endif
@@ -0,0 +1,43 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Per-frame settings shared by the cloud compute passes
+Matches Muon::cbCloudParams
+----------------------------------------------*/
+#ifndef CLOUDPARAMSBUFFER_HLSLI
+#define CLOUDPARAMSBUFFER_HLSLI
+
+cbuffer CloudParams : register(b6)
+{
+    float4x4 prevViewProj;  // Last frame's view-projection, for reprojecting history
+    uint2 fullResolution;   // Size of the scene color/depth targets
+    uint2 marchResolution;  // Size of the region of the cloud targets written by the raymarch
+    int2 marchPixelOffset;  // Pixel within each divisor x divisor block that gets marched this frame
+    uint resolutionDivisor; // 1 = full, 2 = half, 4 = quarter res marching
+    uint temporalEnabled;   // Marching 1 of every 4x4 pixels per frame and reprojecting the rest
+    uint historyValid;      // 0 on the first temporal frame, or after the history was invalidated
+    uint frameIndex;
+    float stepSizeScale;    // Multiplier on the adaptive march step
+    uint sunShadowValid;    // sunShadowTex holds a finished bake
+    float3 sunDirection;    // World space, toward the sun
+    uint scatteringLutValid; // cloudScatteringLut has been built
+    float3 panoramaOrigin;  // World space point cloudPanoramaTex was baked from
+    float farFieldDistance; // Distance past which sky rays read the panorama instead of marching
+    uint panoramaValid;     // cloudPanoramaTex holds a finished bake near the camera
+    uint coneStartValid;    // coneStartTex was written by this frame's cone march prepass
+    uint rayIntervalValid;  // rayEnterTex/rayExitTex were written by this frame's brick splat
+    uint tileBudgetEnabled; // The raymarch counts its steps per tile for CloudTileStats.cs
+    uint tileBudgetValid;   // tileStepScaleTex and the tile stats hold last frame's allocation for this march resolution
+    uint hullTilesValid;    // hullTilesTex was written by this frame's HullBinning.cs
+    uint meshSdfValid;      // meshSdfAtlas was uploaded, hull instances with a meshSdfSlots entry can be sampled
+};
+
+// Full resolution pixel that a low resolution march texel stands in for.
+// CPU mirror: Muon::GetMarchPixelCoord in RaymarchUtils.h
+int2 GetMarchPixelCoord(int2 marchCoord)
+{
+    int2 pixel = marchCoord * int(resolutionDivisor) + marchPixelOffset;
+    return min(pixel, int2(fullResolution) - 1);
+}
+
+#endif
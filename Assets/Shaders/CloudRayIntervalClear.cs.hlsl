@@ -0,0 +1,21 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Resets the cloud ray intervals to empty before CloudRayIntervals.cs
+splats the bricks into them.
+----------------------------------------------*/
+#include "CloudParamsBuffer.hlsli"
+#include "CloudRayIntervals.hlsli"
+
+RWTexture2D<uint> gRayEnter : register(u0);
+RWTexture2D<uint> gRayExit : register(u1);
+
+[numthreads(8, 8, 1)]
+void main(uint3 dispatchThreadID : SV_DispatchThreadID)
+{
+    if (any(dispatchThreadID.xy >= marchResolution))
+        return;
+
+    gRayEnter[dispatchThreadID.xy] = CLOUD_RAY_NO_ENTER_BITS;
+    gRayExit[dispatchThreadID.xy] = CLOUD_RAY_NO_EXIT_BITS;
+}
@@ -0,0 +1,73 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Splats the occupied cloud bricks into the per march texel ray
+intervals. One group per brick walks the march texels under the brick's
+projected rectangle, intersects each texel's ray with the brick, and keeps
+the nearest entry and furthest exit with atomics.
+Stands in for rasterizing the bricks' front and back faces with min/max blending.
+CPU mirror: Muon::BuildCloudRayIntervals
+----------------------------------------------*/
+#include "VS_Common.hlsli"
+#include "CloudParamsBuffer.hlsli"
+#include "DepthUtils.hlsli"
+#include "CloudVolume.hlsli"
+#include "CloudRayIntervals.hlsli"
+#include "BoxPixelRect.hlsli"
+
+// Matches Muon::MAX_CLOUD_BRICKS
+#define MAX_CLOUD_BRICKS 1024
+
+// Matches Muon::cbCloudBricks
+cbuffer CloudBricks : register(b13)
+{
+    float4 brickMin[MAX_CLOUD_BRICKS]; // xyz: world space bounds of the brick's occupied cells
+    float4 brickMax[MAX_CLOUD_BRICKS];
+    uint brickCount;
+};
+
+RWTexture2D<uint> gRayEnter : register(u0);
+RWTexture2D<uint> gRayExit : register(u1);
+
+[numthreads(16, 16, 1)]
+void main(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID)
+{
+    uint brick = groupID.x;
+    if (brick >= brickCount)
+        return;
+
+    float3 boxMin = brickMin[brick].xyz;
+    float3 boxMax = brickMax[brick].xyz;
+    float3 eyePos = float3(invView[0][3], invView[1][3], invView[2][3]);
+
+    uint2 pixelMin, pixelMax;
+    if (!GetBrickPixelRect(boxMin, boxMax, eyePos, pixelMin, pixelMax))
+        return;
+
+    // March texels whose pixel lands in the rectangle. The last row/column may be clamped onto the edge pixel.
+    int divisor = int(resolutionDivisor);
+    int2 marchMin = max((int2(pixelMin) - marchPixelOffset + divisor - 1) / divisor, 0);
+    int2 marchMax = (int2(pixelMax) - marchPixelOffset) / divisor;
+    if (pixelMax.x >= fullResolution.x - 1)
+        marchMax.x = int(marchResolution.x) - 1;
+    if (pixelMax.y >= fullResolution.y - 1)
+        marchMax.y = int(marchResolution.y) - 1;
+    marchMax = min(marchMax, int2(marchResolution) - 1);
+
+    for (int y = marchMin.y + int(groupThreadID.y); y <= marchMax.y; y += 16)
+    {
+        for (int x = marchMin.x + int(groupThreadID.x); x <= marchMax.x; x += 16)
+        {
+            int2 marchCoord = int2(x, y);
+            float3 viewDir = GetViewRayDirection(GetMarchPixelCoord(marchCoord), fullResolution, proj);
+            float3 dir = normalize(mul(invView, float4(viewDir, 0.0)).xyz); // Same ray as Raymarch.cs
+
+            float tEnter, tExit;
+            if (!RayBoxIntersect(eyePos, dir, boxMin, boxMax, tEnter, tExit))
+                continue;
+
+            InterlockedMin(gRayEnter[marchCoord], asuint(max(tEnter, 0.0)));
+            InterlockedMax(gRayExit[marchCoord], asuint(tExit));
+        }
+    }
+}
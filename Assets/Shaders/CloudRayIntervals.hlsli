@@ -0,0 +1,22 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Per march texel [enter, exit] distances of the occupied cloud
+bricks, written by CloudRayIntervals.cs and read by Raymarch.cs.
+Distances are stored as float bits in R32_UINT so the splat can use atomics;
+non-negative floats order the same as their bits.
+CPU mirror: Utils/RayIntervalUtils.h
+----------------------------------------------*/
+#ifndef CLOUDRAYINTERVALS_HLSLI
+#define CLOUDRAYINTERVALS_HLSLI
+
+// Interval of a ray that touches no brick, matches Muon::CLOUD_RAY_NO_ENTER/EXIT
+static const uint CLOUD_RAY_NO_ENTER_BITS = 0x7F7FFFFF; // FLT_MAX
+static const uint CLOUD_RAY_NO_EXIT_BITS = 0;
+
+float2 DecodeRayInterval(uint enterBits, uint exitBits)
+{
+    return float2(asfloat(enterBits), asfloat(exitBits));
+}
+
+#endif
@@ -0,0 +1,21 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Addressing for the cloud phase function / multiple scattering LUT.
+Layout matches Muon::BuildCloudScatteringLut in CloudLightingUtils.h
+----------------------------------------------*/
+#ifndef CLOUDSCATTERINGLUT_HLSLI
+#define CLOUDSCATTERINGLUT_HLSLI
+
+static const float2 CLOUD_SCATTERING_LUT_SIZE = float2(256.0, 128.0);
+static const float CLOUD_SCATTERING_LUT_MAX_OPTICAL_DEPTH = 64.0;
+
+// u = cos theta, v = sqrt of the normalized optical depth, remapped onto the first and last texel centers.
+// CPU mirror: Muon::GetCloudScatteringLutCoord
+float2 GetCloudScatteringLutCoord(float cosTheta, float opticalDepth)
+{
+    float2 unit = float2(saturate(cosTheta * 0.5 + 0.5), sqrt(saturate(opticalDepth / CLOUD_SCATTERING_LUT_MAX_OPTICAL_DEPTH)));
+    return (0.5 + unit * (CLOUD_SCATTERING_LUT_SIZE - 1.0)) / CLOUD_SCATTERING_LUT_SIZE;
+}
+
+#endif
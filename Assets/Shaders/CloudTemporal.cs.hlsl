@@ -0,0 +1,135 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Temporal reconstruction of the clouds when only one pixel of 
+every 4x4 block is marched per frame.
+Freshly marched pixels are taken as is. Every other pixel is reprojected into 
+last frame's resolved clouds using the previous view-projection, and falls back
+to a spatial upsample of this frame's samples when the history is off screen or 
+disoccluded.
+CPU mirror: Muon::ResolveTemporalCloudPixel in RaymarchUtils.h
+----------------------------------------------*/
+#include "CameraBuffer.hlsli"
+#include "CloudParamsBuffer.hlsli"
+#include "CloudUpsampleCommon.hlsli"
+#include "DepthUtils.hlsli"
+
+// Relative view depth difference past which the history belongs to a different surface
+static const float DISOCCLUSION_THRESHOLD = 0.05;
+
+Texture2D cloudTex : register(t0); // This frame's samples at march resolution
+Texture2D<float2> cloudDepthTex : register(t1); // [linear view Z, cloud distance] of this frame's samples
+Texture2D historyTex : register(t2); // Last frame's resolved clouds
+Texture2D<float2> historyDepthTex : register(t3); // [linear view Z, cloud distance] of last frame's resolved clouds
+Texture2D depthStencilBuffer : register(t4);
+SamplerState linearClamp : register(s3);
+RWTexture2D<float4> gCloudResolved : register(u0);
+RWTexture2D<float2> gCloudResolvedDepth : register(u1);
+
+// Row-vector CPU matrix seen transposed, same convention as viewProj in Phong.vs
+float4 ToPrevClip(float3 positionWS)
+{
+    return mul(prevViewProj, float4(positionWS, 1.0));
+}
+
+// Returns false if the point was behind the previous camera or off screen
+bool ReprojectToPrevious(float3 positionWS, out float2 prevUV, out float prevViewZ)
+{
+    float4 prevClip = ToPrevClip(positionWS);
+    prevViewZ = prevClip.w;
+    prevUV = 0.0;
+
+    if (prevClip.w <= 0.0)
+        return false;
+
+    float2 ndc = prevClip.xy / prevClip.w;
+    prevUV = float2(ndc.x * 0.5 + 0.5, 0.5 - ndc.y * 0.5);
+    return all(prevUV >= 0.0) && all(prevUV <= 1.0);
+}
+
+bool IsDisoccluded(float expectedPrevDepth, float historyDepth)
+{
+    // Both at the sky, nothing to compare
+    if (expectedPrevDepth >= SKY_DISTANCE && historyDepth >= SKY_DISTANCE)
+        return false;
+
+    float relativeDiff = abs(expectedPrevDepth - historyDepth) / max(min(expectedPrevDepth, historyDepth), 1e-4);
+    return relativeDiff > DISOCCLUSION_THRESHOLD;
+}
+
+[numthreads(16, 16, 1)]
+void main(int3 dispatchThreadID : SV_DispatchThreadID)
+{
+    int2 pixelCoord = dispatchThreadID.xy;
+    if (any(pixelCoord >= int2(fullResolution)))
+        return;
+
+    int2 marchCoord = min(pixelCoord / int(resolutionDivisor), int2(marchResolution) - 1);
+    float2 marchDepth = cloudDepthTex[marchCoord];
+
+    float deviceDepth = depthStencilBuffer[pixelCoord].r;
+    float sceneDepth = LinearizeDepth(deviceDepth, proj);
+
+    // This pixel was marched this frame
+    if (all(GetMarchPixelCoord(marchCoord) == pixelCoord))
+    {
+        gCloudResolved[pixelCoord] = cloudTex[marchCoord];
+        gCloudResolvedDepth[pixelCoord] = marchDepth;
+        return;
+    }
+
+    float4 spatial = BilateralUpsampleCloud(cloudTex, cloudDepthTex, pixelCoord, sceneDepth);
+    float cloudDistance = marchDepth.y;
+
+    float4 resolved = spatial;
+    if (historyValid)
+    {
+        float3 viewDir = GetViewRayDirection(pixelCoord, fullResolution, proj);
+        float3 worldDir = normalize(mul(invView, float4(viewDir, 0.0)).xyz);
+        float3 eyePos = float3(invView[0][3], invView[1][3], invView[2][3]);
+
+        // Reproject the cloud itself, approximated by the nearest sample's cloud distance
+        float2 prevUV;
+        float prevCloudZ;
+        bool onScreen = ReprojectToPrevious(eyePos + worldDir * cloudDistance, prevUV, prevCloudZ);
+
+        if (onScreen)
+        {
+            int2 prevPixel = min(int2(prevUV * float2(fullResolution)), int2(fullResolution) - 1);
+
+            // Where the opaque surface behind this pixel should have been last frame
+            float expectedPrevDepth = SKY_DISTANCE;
+            if (sceneDepth < SKY_DISTANCE)
+            {
+                float2 unusedUV;
+                ReprojectToPrevious(eyePos + worldDir * (sceneDepth / viewDir.z), unusedUV, expectedPrevDepth);
+            }
+
+            if (!IsDisoccluded(expectedPrevDepth, historyDepthTex[prevPixel].x))
+            {
+                float4 history = historyTex.SampleLevel(linearClamp, prevUV, 0.0);
+
+                // Keep the history within the range of this frame's nearby samples to limit ghosting
+                float4 neighborMin = 1e30;
+                float4 neighborMax = -1e30;
+                [unroll]
+                for (int y = -1; y <= 1; ++y)
+                {
+                    [unroll]
+                    for (int x = -1; x <= 1; ++x)
+                    {
+                        int2 tap = clamp(marchCoord + int2(x, y), int2(0, 0), int2(marchResolution) - 1);
+                        float4 tapCloud = cloudTex[tap];
+                        neighborMin = min(neighborMin, tapCloud);
+                        neighborMax = max(neighborMax, tapCloud);
+                    }
+                }
+
+                resolved = clamp(history, neighborMin, neighborMax);
+            }
+        }
+    }
+
+    gCloudResolved[pixelCoord] = resolved;
+    gCloudResolvedDepth[pixelCoord] = float2(sceneDepth, cloudDistance);
+}
@@ -0,0 +1,81 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Hands out next frame's per-tile step size multipliers.
+A single group bisects for the lambda where tiles stepping at 1 / (lambda * importance)
+spend as many steps as a uniform multiplier of 1 would have.
+CPU mirror: Muon::SolveCloudTileBudget
+----------------------------------------------*/
+#include "CloudParamsBuffer.hlsli"
+#include "CloudBudget.hlsli"
+
+#define BUDGET_THREADS 1024
+
+Texture2D<float4> tileStatsTex : register(t0); // [mean luminance, mean transmittance, importance, base steps], from CloudTileStats.cs
+RWTexture2D<float> gTileStepScale : register(u0);
+
+groupshared float gsSum[BUDGET_THREADS];
+
+float GroupSum(uint threadIndex, float value)
+{
+    gsSum[threadIndex] = value;
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for (uint stride = BUDGET_THREADS / 2; stride > 0; stride >>= 1)
+    {
+        if (threadIndex < stride)
+            gsSum[threadIndex] += gsSum[threadIndex + stride];
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    float sum = gsSum[0];
+    GroupMemoryBarrierWithGroupSync();
+    return sum;
+}
+
+// Relative step count of a tile at lambda, the inverse of its step size multiplier
+float GetTileStepFraction(float importance, float log2Lambda)
+{
+    return clamp(exp2(log2Lambda) * importance, 1.0 / CLOUD_BUDGET_MAX_STEP_SCALE, 1.0 / CLOUD_BUDGET_MIN_STEP_SCALE);
+}
+
+[numthreads(BUDGET_THREADS, 1, 1)]
+void main(uint threadIndex : SV_GroupIndex)
+{
+    uint2 tileCount = GetBudgetTileCount(marchResolution);
+    uint totalTiles = tileCount.x * tileCount.y;
+
+    float budget = 0.0;
+    for (uint i = threadIndex; i < totalTiles; i += BUDGET_THREADS)
+        budget += tileStatsTex[uint2(i % tileCount.x, i / tileCount.x)].w;
+    budget = GroupSum(threadIndex, budget);
+
+    // Spent steps only grow with lambda, so bisect it in log space
+    float log2Low = -32.0;
+    float log2High = 32.0;
+    for (uint iteration = 0; iteration < CLOUD_BUDGET_SOLVER_ITERATIONS; ++iteration)
+    {
+        float log2Mid = 0.5 * (log2Low + log2High);
+
+        float spent = 0.0;
+        for (uint i = threadIndex; i < totalTiles; i += BUDGET_THREADS)
+        {
+            float2 tile = tileStatsTex[uint2(i % tileCount.x, i / tileCount.x)].zw;
+            spent += tile.y * GetTileStepFraction(tile.x, log2Mid);
+        }
+        spent = GroupSum(threadIndex, spent);
+
+        if (spent > budget)
+            log2High = log2Mid;
+        else
+            log2Low = log2Mid;
+    }
+
+    float log2Lambda = 0.5 * (log2Low + log2High);
+    for (uint i = threadIndex; i < totalTiles; i += BUDGET_THREADS)
+    {
+        uint2 tile = uint2(i % tileCount.x, i / tileCount.x);
+        gTileStepScale[tile] = budget > 0.0 ? 1.0 / GetTileStepFraction(tileStatsTex[tile].z, log2Lambda) : 1.0;
+    }
+}
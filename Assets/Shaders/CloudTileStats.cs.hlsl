@@ -0,0 +1,82 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Measures every budget tile of this frame's raymarch output.
+One group per tile reduces the luminance and transmittance spread of its
+march texels, compares the means to last frame's, and folds in the steps
+the raymarch counted for the tile.
+CPU mirror: Muon::MeasureCloudTile
+----------------------------------------------*/
+#include "CloudParamsBuffer.hlsli"
+#include "CloudBudget.hlsli"
+
+Texture2D<float4> cloudTex : register(t0); // Raymarch output, [in-scattered radiance.rgb, transmittance]
+Texture2D<float> tileStepScaleTex : register(t1); // Multiplier the tile was marched with this frame
+
+RWTexture2D<float4> gTileStats : register(u0); // [mean luminance, mean transmittance, importance, base steps]
+RWTexture2D<uint> gTileSteps : register(u1); // Steps the raymarch took per tile, reset here for next frame
+
+static const uint TILE_TEXELS = CLOUD_BUDGET_TILE_SIZE * CLOUD_BUDGET_TILE_SIZE;
+
+groupshared float4 gsSums[TILE_TEXELS]; // [luminance, luminance^2, transmittance, transmittance^2]
+groupshared float gsCount[TILE_TEXELS];
+
+[numthreads(CLOUD_BUDGET_TILE_SIZE, CLOUD_BUDGET_TILE_SIZE, 1)]
+void main(uint3 groupID : SV_GroupID, uint3 groupThreadID : SV_GroupThreadID, uint groupIndex : SV_GroupIndex)
+{
+    uint2 tile = groupID.xy;
+    uint2 marchCoord = tile * CLOUD_BUDGET_TILE_SIZE + groupThreadID.xy;
+
+    float4 sums = 0.0;
+    float count = 0.0;
+    if (all(marchCoord < marchResolution))
+    {
+        float4 texel = cloudTex[marchCoord];
+        float luminance = dot(texel.rgb, float3(0.2126, 0.7152, 0.0722));
+        sums = float4(luminance, luminance * luminance, texel.a, texel.a * texel.a);
+        count = 1.0;
+    }
+
+    gsSums[groupIndex] = sums;
+    gsCount[groupIndex] = count;
+    GroupMemoryBarrierWithGroupSync();
+
+    [unroll]
+    for (uint stride = TILE_TEXELS / 2; stride > 0; stride >>= 1)
+    {
+        if (groupIndex < stride)
+        {
+            gsSums[groupIndex] += gsSums[groupIndex + stride];
+            gsCount[groupIndex] += gsCount[groupIndex + stride];
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (groupIndex != 0 || gsCount[0] == 0.0)
+        return;
+
+    float invCount = 1.0 / gsCount[0];
+    float4 moments = gsSums[0] * invCount;
+    float meanLuminance = moments.x;
+    float meanTransmittance = moments.z;
+
+    // Spread within the tile is mostly step noise, which shrinks with the step size
+    float importance = sqrt(max(moments.y - meanLuminance * meanLuminance, 0.0)) +
+                       sqrt(max(moments.w - meanTransmittance * meanTransmittance, 0.0));
+
+    // Tiles that changed since last frame haven't converged yet
+    float stepScale = 1.0;
+    if (tileBudgetValid != 0)
+    {
+        float4 previous = gTileStats[tile];
+        importance += abs(meanLuminance - previous.x) + abs(meanTransmittance - previous.y);
+        importance = lerp(previous.z, importance, CLOUD_BUDGET_RESPONSE);
+        stepScale = tileStepScaleTex[tile];
+    }
+
+    uint steps;
+    InterlockedExchange(gTileSteps[tile], 0, steps);
+
+    // Step count goes roughly as the inverse of the step size
+    gTileStats[tile] = float4(meanLuminance, meanTransmittance, max(importance, CLOUD_BUDGET_IMPORTANCE_FLOOR), float(steps) * stepScale);
+}
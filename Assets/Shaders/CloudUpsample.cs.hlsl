@@ -0,0 +1,44 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Upsamples the (possibly reduced resolution) cloud march output to 
+full resolution and composites it over the scene.
+Uses a joint bilateral filter guided by the full resolution depth buffer so clouds 
+don't bleed across opaque silhouettes.
+When temporal mode is on, cloudTex is the already resolved full resolution history.
+Game clears temporalEnabled for frames where the resolve didn't run.
+----------------------------------------------*/
+#include "CameraBuffer.hlsli"
+#include "CloudParamsBuffer.hlsli"
+#include "CloudUpsampleCommon.hlsli"
+#include "DepthUtils.hlsli"
+
+Texture2D gInput : register(t0); // Scene color
+Texture2D cloudTex : register(t1); // [in-scattered radiance.rgb, transmittance]
+Texture2D<float2> cloudDepthTex : register(t2); // [linear view Z, cloud distance] of each march texel
+Texture2D depthStencilBuffer : register(t3);
+RWTexture2D<float4> gOutput : register(u0);
+
+[numthreads(16, 16, 1)]
+void main(int3 dispatchThreadID : SV_DispatchThreadID)
+{
+    int2 pixelCoord = dispatchThreadID.xy;
+    if (any(pixelCoord >= int2(fullResolution)))
+        return;
+
+    float4 cloud;
+    if (temporalEnabled)
+    {
+        cloud = cloudTex[pixelCoord];
+    }
+    else
+    {
+        float fullResDepth = LinearizeDepth(depthStencilBuffer[pixelCoord].r, proj);
+        cloud = BilateralUpsampleCloud(cloudTex, cloudDepthTex, pixelCoord, fullResDepth);
+    }
+
+    float3 bgColor = gInput[pixelCoord].rgb;
+    float3 finalColor = cloud.rgb + bgColor * cloud.a;
+
+    gOutput[pixelCoord] = float4(finalColor, 1.0);
+}
@@ -0,0 +1,70 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Depth aware reconstruction of full resolution clouds from the
+reduced resolution raymarch output. Shared by CloudUpsample.cs and CloudTemporal.cs
+CPU mirror: Muon::BilateralUpsampleCloud in RaymarchUtils.h
+----------------------------------------------*/
+#ifndef CLOUDUPSAMPLECOMMON_HLSLI
+#define CLOUDUPSAMPLECOMMON_HLSLI
+
+#include "CloudParamsBuffer.hlsli"
+
+// How quickly a low res sample loses weight as its depth diverges from the full res pixel's
+static const float DEPTH_SHARPNESS = 32.0;
+
+// Below this total weight none of the taps belong to the pixel's surface, fall back to the closest depth
+static const float MIN_TOTAL_WEIGHT = 1e-4;
+
+// Relative difference, so the same sharpness works near and far (and against the sky)
+float DepthWeight(float lowResDepth, float fullResDepth)
+{
+    float relativeDiff = abs(lowResDepth - fullResDepth) / max(min(lowResDepth, fullResDepth), 1e-4);
+    return exp(-relativeDiff * DEPTH_SHARPNESS);
+}
+
+// cloudTex: [in-scattered radiance.rgb, transmittance] at march resolution
+// cloudDepthTex: .x = linear view Z of each march texel
+float4 BilateralUpsampleCloud(Texture2D cloudTex, Texture2D<float2> cloudDepthTex, int2 pixelCoord, float fullResDepth)
+{
+    if (resolutionDivisor <= 1)
+        return cloudTex[pixelCoord];
+
+    // Position in march texels, relative to the pixels the march texels were traced from
+    float2 marchPos = (float2(pixelCoord) - float2(marchPixelOffset)) / float(resolutionDivisor);
+    int2 base = int2(floor(marchPos));
+    float2 f = marchPos - float2(base);
+
+    int2 maxCoord = int2(marchResolution) - 1;
+
+    float4 sum = 0.0;
+    float totalWeight = 0.0;
+    float4 closest = float4(0.0, 0.0, 0.0, 1.0);
+    float closestDiff = 1e30;
+
+    [unroll]
+    for (int i = 0; i < 4; ++i)
+    {
+        int2 offset = int2(i & 1, i >> 1);
+        int2 tap = clamp(base + offset, int2(0, 0), maxCoord);
+
+        float bilinear = (offset.x ? f.x : 1.0 - f.x) * (offset.y ? f.y : 1.0 - f.y);
+        float tapDepth = cloudDepthTex[tap].x;
+        float4 tapCloud = cloudTex[tap];
+
+        float weight = bilinear * DepthWeight(tapDepth, fullResDepth);
+        sum += tapCloud * weight;
+        totalWeight += weight;
+
+        float diff = abs(tapDepth - fullResDepth);
+        if (diff < closestDiff)
+        {
+            closestDiff = diff;
+            closest = tapCloud;
+        }
+    }
+
+    return totalWeight > MIN_TOTAL_WEIGHT ? sum / totalWeight : closest;
+}
+
+#endif
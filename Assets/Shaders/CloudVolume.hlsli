@@ -0,0 +1,79 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Cloud volume bounds and NVDF helpers shared by the cloud passes
+CPU mirrors live in Utils/CloudLightingUtils.h
+----------------------------------------------*/
+#ifndef CLOUDVOLUME_HLSLI
+#define CLOUDVOLUME_HLSLI
+
+// Volume bounds in world space
+static const float SIDE_LENGTH = 4000.0; 
+static const float3 VOLUME_MIN_WS = float3(-SIDE_LENGTH / 2, 0.0, -SIDE_LENGTH / 2);
+static const float3 VOLUME_MAX_WS = float3(SIDE_LENGTH / 2, SIDE_LENGTH / 8, SIDE_LENGTH / 2);
+
+// Mapping from NVDF authoring space to world 
+static const float NVDF_DOMAIN_SIDE_LENGTH = 4000.0; // NVDF authoring domain: 4km x 4km x 0.5km (matches the world volume).
+static const float NOISE_DOMAIN_SIDE_LENGTH = 100.0; // Noise domain: 3D noise pattern repeats every 100m in X/Y/Z.
+static const float AUTHORING_TO_WORLD_SCALE = SIDE_LENGTH / NVDF_DOMAIN_SIDE_LENGTH;
+
+// Density -> extinction scaling
+static const float DENSITY_SCALE = .035; // To be tuned / driven by NVDF
+
+float3 WorldToNvdfUV(float3 worldPos)
+{
+    float3 local = (worldPos - VOLUME_MIN_WS) / (VOLUME_MAX_WS - VOLUME_MIN_WS);
+
+    // local: (X, Y, Z) normalized into [0,1]
+
+    float u = local.x; // world X -> texture X
+    float v = local.z; // world Z -> texture Y (so each slice is an XZ plane)
+    float w = local.y; // world Y -> texture Z (stacking along Y)
+
+    return float3(u, v, w);
+}
+
+bool RayBoxIntersect(
+    float3 origin,
+    float3 dir,
+    float3 boxMin,
+    float3 boxMax,
+    out float tEnter,
+    out float tExit)
+{
+    float3 invDir = 1.0 / dir;
+
+    float3 t0s = (boxMin - origin) * invDir;
+    float3 t1s = (boxMax - origin) * invDir;
+
+    float3 tMin = min(t0s, t1s);
+    float3 tMax = max(t0s, t1s);
+
+    tEnter = max(max(tMin.x, tMin.y), tMin.z);
+    tExit = min(min(tMax.x, tMax.y), tMax.z);
+
+    // Need a positive interval where enter < exit
+    return tExit > max(tEnter, 0.0);
+}
+
+// Encoded value in [0, 1]  ->  real SDF in [-256, 4096]
+float DecodeSdf(float encodedSdf)
+{
+    const float sdfMin = -256.0;
+    const float sdfMax = 4096.0;
+    return lerp(sdfMin, sdfMax, encodedSdf);
+}
+
+// Density without the detail noise erosion, for lighting passes that can't afford the noise fetch.
+// Same as GetUprezzedVoxelCloudDensity() with zero erosion, CPU mirror: GetNvdfTexelExtinction() in CloudLightingUtils.cpp
+float GetCoarseCloudExtinction(float4 nvdfSample)
+{
+    if (DecodeSdf(nvdfSample.r) >= 0.0)
+        return 0.0;
+
+    float poweredDensityScale = pow(saturate(nvdfSample.a), 4.0);
+    float density = pow(saturate(nvdfSample.g) * poweredDensityScale, lerp(0.3, 0.6, max(0.001, poweredDensityScale)));
+    return density * DENSITY_SCALE;
+}
+
+#endif
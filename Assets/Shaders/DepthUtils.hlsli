@@ -0,0 +1,45 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Screen ray and scene depth helpers shared by the compute passes
+CPU mirrors live in Utils/RaymarchUtils.h
+----------------------------------------------*/
+#ifndef DEPTHUTILS_HLSLI
+#define DEPTHUTILS_HLSLI
+
+static const float SKY_DISTANCE = 1e20; // Distance for pixels with no opaque geometry
+
+// Device depth [0,1] -> positive view space Z. Undoes XMMatrixPerspectiveFovLH.
+// projMatrix is seen transposed here, so projMatrix[2][3] is the CPU's _43.
+float LinearizeDepth(float deviceDepth, float4x4 projMatrix)
+{
+    if (deviceDepth >= 1.0)
+        return SKY_DISTANCE;
+
+    return projMatrix[2][3] / (deviceDepth - projMatrix[2][2]);
+}
+
+// Device depth -> distance along the normalized view space ray. Cleared depth is treated as the sky.
+float DepthToRayDistance(float deviceDepth, float3 viewDir, float4x4 projMatrix)
+{
+    if (deviceDepth >= 1.0 || viewDir.z <= 0.0)
+        return SKY_DISTANCE;
+
+    return LinearizeDepth(deviceDepth, projMatrix) / viewDir.z;
+}
+
+// Normalized view space ray through the center of a pixel.
+// CPU mirror: Muon::GetViewRayDirection in RaymarchUtils.h
+float3 GetViewRayDirection(int2 pixelCoord, uint2 resolution, float4x4 projMatrix)
+{
+    float2 uv = (float2(pixelCoord) + 0.5) / float2(resolution);
+    uv = uv * 2.0 - 1.0;
+    uv.y = -uv.y;
+
+    float tanHalfFovY = 1.0 / projMatrix[1][1];
+    float tanHalfFovX = 1.0 / projMatrix[0][0];
+
+    return normalize(float3(uv.x * tanHalfFovX, uv.y * tanHalfFovY, 1.0));
+}
+
+#endif
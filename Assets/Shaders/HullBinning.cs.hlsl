@@ -0,0 +1,63 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Bins the registered hulls into 16x16 tiles of march texels.
+One group per tile tests every hull's projected box against the pixels the
+tile's texels trace, and appends the overlapping ones to the tile's list,
+like tiled light culling. Raymarch.cs then only intersects its tile's hulls.
+CPU mirror: Muon::BinHullsToTiles
+----------------------------------------------*/
+#include "VS_Common.hlsli"
+#include "CloudParamsBuffer.hlsli"
+#include "Raymarch_Common.hlsli"
+#include "BoxPixelRect.hlsli"
+#include "HullTiles.hlsli"
+
+#define BINNING_THREADS 64
+
+RWTexture2D<uint> gHullTiles : register(u0); // Per tile [count, hull indices...], see HullTiles.hlsli
+
+groupshared uint sTileCount;
+groupshared uint sTileHulls[MAX_HULLS_PER_TILE];
+
+[numthreads(BINNING_THREADS, 1, 1)]
+void main(uint3 groupID : SV_GroupID, uint groupIndex : SV_GroupIndex)
+{
+    uint2 tile = groupID.xy;
+    if (groupIndex == 0)
+        sTileCount = 0;
+    GroupMemoryBarrierWithGroupSync();
+
+    // Pixels grow with march texels, so the tile's corner texels bound all of them
+    int2 firstTexel = int2(tile * HULL_TILE_SIZE);
+    int2 lastTexel = min(firstTexel + int(HULL_TILE_SIZE) - 1, int2(marchResolution) - 1);
+    uint2 tileMin = uint2(GetMarchPixelCoord(firstTexel));
+    uint2 tileMax = uint2(GetMarchPixelCoord(lastTexel));
+
+    float3 eyePos = float3(invView[0][3], invView[1][3], invView[2][3]);
+    for (uint i = groupIndex; i < hullBoundsCount; i += BINNING_THREADS)
+    {
+        HullBounds bounds = hullBounds[i];
+
+        uint2 rectMin, rectMax;
+        if (!GetBrickPixelRect(bounds.minBounds, bounds.maxBounds, eyePos, rectMin, rectMax))
+            continue;
+
+        if (any(rectMin > tileMax) || any(rectMax < tileMin))
+            continue;
+
+        uint slot;
+        InterlockedAdd(sTileCount, 1, slot);
+        if (slot < MAX_HULLS_PER_TILE)
+            sTileHulls[slot] = i;
+    }
+    GroupMemoryBarrierWithGroupSync();
+
+    uint2 texel = GetHullTileTexel(tile);
+    uint count = sTileCount;
+    if (groupIndex == 0)
+        gHullTiles[texel] = count > MAX_HULLS_PER_TILE ? HULL_TILE_OVERFLOW : count;
+
+    for (uint s = groupIndex; s < min(count, MAX_HULLS_PER_TILE); s += BINNING_THREADS)
+        gHullTiles[texel + uint2(1 + s, 0)] = sTileHulls[s];
+}
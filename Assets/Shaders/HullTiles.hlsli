@@ -0,0 +1,33 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Layout of the per-tile hull lists written by HullBinning.cs
+and read by Raymarch.cs. Each 16x16 tile of march texels is a run of
+HULL_TILE_SLOTS texels: the hull count, then indices into hullBounds.
+CPU mirror: Utils/HullBinningUtils.h
+----------------------------------------------*/
+#ifndef HULLTILES_HLSLI
+#define HULLTILES_HLSLI
+
+static const uint HULL_TILE_SIZE = 16; // In march texels, one raymarch thread group
+static const uint MAX_HULLS_PER_TILE = 31;
+static const uint HULL_TILE_SLOTS = MAX_HULLS_PER_TILE + 1;
+
+// Count of a tile with more hulls than fit, its rays test every hull
+static const uint HULL_TILE_OVERFLOW = 0xFFFFFFFF;
+
+// Passed for rays that aren't traced from a screen tile, they test every hull too
+static const uint2 HULL_TILE_NONE = uint2(0xFFFFFFFF, 0xFFFFFFFF);
+
+uint2 GetHullTileCount(uint2 marchSize)
+{
+    return (marchSize + HULL_TILE_SIZE - 1) / HULL_TILE_SIZE;
+}
+
+// First texel of a tile's run in the CloudHullTiles texture
+uint2 GetHullTileTexel(uint2 tile)
+{
+    return uint2(tile.x * HULL_TILE_SLOTS, tile.y);
+}
+
+#endif
@@ -0,0 +1,52 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Sampling the baked mesh SDF volumes, packed into one atlas
+(MeshSdfAtlas), so clouds can be pushed away from objects for the cost of one
+fetch per object.
+CPU mirror: Muon::SampleMeshSdfAtlas in MeshSdf.h
+----------------------------------------------*/
+#ifndef MESHSDF_HLSLI
+#define MESHSDF_HLSLI
+
+static const uint MESH_SDF_SLOT_NONE = 0xFFFFFFFF;
+
+// Mirrors Muon::sbMeshSdfSlot, where one mesh's SDF sits in the atlas and the box of the mesh's local space it covers
+struct MeshSdfSlot
+{
+    float3 boundsMin;
+    float falloff;      // Distance from the surface over which clouds thin out, in the mesh's local units
+    float3 boundsSize;
+    uint zOffset;       // First slice of the atlas the SDF fills
+    uint3 dimensions;
+    uint pad;
+};
+
+// Distance from a position in the mesh's local space outside the slot's box, 0 within it
+float GetMeshSdfSlotOutsideDistance(MeshSdfSlot slot, float3 localPos)
+{
+    return length(localPos - clamp(localPos, slot.boundsMin, slot.boundsMin + slot.boundsSize));
+}
+
+// Distance from a position in the mesh's local space, negative inside. Outside the slot's box, the distance at the closest
+// point on it plus the way there. Texels are clamped half a texel inside the slot, so filtering never reads the next one.
+// CPU mirror: Muon::SampleMeshSdfAtlas
+float SampleMeshSdfAtlas(Texture3D<float> atlasTex, SamplerState linearClamp, MeshSdfSlot slot, float3 localPos)
+{
+    float3 atlasSize;
+    atlasTex.GetDimensions(atlasSize.x, atlasSize.y, atlasSize.z);
+
+    float3 closest = clamp(localPos, slot.boundsMin, slot.boundsMin + slot.boundsSize);
+    float3 texel = clamp((closest - slot.boundsMin) / slot.boundsSize * float3(slot.dimensions), 0.5f, float3(slot.dimensions) - 0.5f);
+    float3 uvw = (texel + float3(0.0f, 0.0f, slot.zOffset)) / atlasSize;
+    return atlasTex.SampleLevel(linearClamp, uvw, 0.0f) + length(localPos - closest);
+}
+
+// Cloud density near an object, thinned out to nothing at its surface over falloff units.
+// CPU mirror: Muon::BlendMeshSdfDensity
+float BlendMeshSdfDensity(float density, float distance, float falloff)
+{
+    return density * smoothstep(0.0f, max(falloff, 1e-4f), distance);
+}
+
+#endif
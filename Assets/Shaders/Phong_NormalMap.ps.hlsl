@@ -1,5 +1,6 @@
 #include "PhongCommon.hlsli"
 #include "TimeBuffer.hlsli"
+#include "BeerShadowMap.hlsli"
 
 struct VertexOut
 {
@@ -29,7 +30,9 @@ cbuffer PSPerMaterial : register(b11)
 Texture2D diffuseTexture    : register(t0);
 Texture2D normalMap         : register(t1);
 Texture3D test3d : register(t2);
+Texture2D<float4> beerShadowMap : register(t3); // Cloud shadows, see BeerShadowMap.hlsli
 SamplerState samplerOptions : register(s0);
+SamplerState linearClamp : register(s3);
 float4 main(VertexOut input) : SV_TARGET
 {
     // Sample diffuse texture, normal map(unpacked)
@@ -75,6 +78,10 @@ float4 main(VertexOut input) : SV_TARGET
     float3 specularLighting = lightColor *
         SpecularPhong(input.normal, toLight, toCamera, matSpecularity) * any(diffuseLighting);
 
+    // Clouds shadow the direct light
+    float cloudShadow = SampleBeerShadowTransmittance(beerShadowMap, linearClamp, input.worldPos);
+    diffuseLighting *= cloudShadow;
+
     // Add to totallight
     totalLight += diffuseLighting;
 
@@ -1,11 +1,38 @@
 #include "VS_Common.hlsli"
 #include "Raymarch_Common.hlsli"
+#include "CloudParamsBuffer.hlsli"
+#include "DepthUtils.hlsli"
+#include "CloudVolume.hlsli"
+#include "BeerShadowMap.hlsli"
+#include "SkyAmbientBuffer.hlsli"
+#include "CloudScatteringLut.hlsli"
+#include "CloudPanorama.hlsli"
+#include "CloudConeMarch.hlsli"
+#include "CloudRayIntervals.hlsli"
+#include "CloudBudget.hlsli"
+#include "CloudInstances.hlsli"
+#include "HullTiles.hlsli"
+#include "MeshSdf.hlsli"
 
 // Toggle features
 #define USE_ADAPTIVE_STEP 1 // Shows some artifact ATM. Will debug again after uprez. 
 #define USE_JITTERED_STEP 1
+#define USE_BLUE_NOISE_JITTER 1 // Spatiotemporal blue noise instead of white noise for the step jitter
 #define USE_HIGH_HIGH_FREQUENCY 1
 #define DEBUG_AABB_INTERSECT 1
+#define USE_DEPTH_CLIP 1 // Stop marching at opaque scene geometry
+#define USE_NOISE_MIPS 1 // Pick the detail noise mip from ray distance
+#define USE_SUN_SHADOW 1 // Light samples with the precomputed sun optical depth volume
+#define USE_BEER_SHADOW_MAP 1 // Fall back to the Beer shadow map when the sun shadow volume is off or not baked yet
+#define USE_SKY_AMBIENT 1 // Add sky light from the SH projected on the CPU
+#define USE_SCATTERING_LUT 1 // Phase function and multiple scattering from the precomputed LUT instead of plain Beer-Lambert
+#define USE_FAR_FIELD_PANORAMA 1 // Sky rays stop marching at the far-field distance and read the rest from the cached panorama
+#define USE_CONE_MARCH_START 1 // Skip the empty space the cone march prepass found in front of each tile
+#define USE_RAY_INTERVALS 1 // Only march the span of the ray between the first and last occupied brick it crosses
+#define USE_TILE_BUDGET 1 // Scale the step size per tile by the multiplier CloudTileBudget.cs handed out last frame
+#define USE_CLOUD_INSTANCES 1 // March the placed cloud instances the ray overlaps instead of the single world volume
+#define USE_HULL_TILES 1 // Only intersect the hulls HullBinning.cs found in the ray's tile
+#define USE_MESH_SDF 1 // Thin the clouds out around the hull instances the ray passes near, using the baked SDF of each one's mesh
 
 // Raymarch settings
 static const int MAX_STEPS = 1024; // Max steps per ray
@@ -14,26 +41,36 @@ static const float MAX_DIST = 1000.0; // Global far distance
 static const float EPSILON = 0.001; // Small epsilon for safety
 static const float MIN_TRANSMITTANCE = 0.01; // Early-out when mostly opaque
 
-// Volume bounds in world space
-static const float SIDE_LENGTH = 4000.0; 
-static const float3 VOLUME_MIN_WS = float3(-SIDE_LENGTH / 2, 0.0, -SIDE_LENGTH / 2);
-static const float3 VOLUME_MAX_WS = float3(SIDE_LENGTH / 2, SIDE_LENGTH / 8, SIDE_LENGTH / 2);
+// Instances with a mesh SDF gathered per ray. Rays passing near more than this sample every instance instead.
+#define MAX_RAY_SDF_INSTANCES 4
+static const uint RAY_SDF_INSTANCES_ALL = 0xFFFFFFFF;
 
-// Mapping from NVDF authoring space to world 
-static const float NVDF_DOMAIN_SIDE_LENGTH = 4000.0; // NVDF authoring domain: 4km x 4km x 0.5km (matches the world volume).
-static const float NOISE_DOMAIN_SIDE_LENGTH = 100.0; // Noise domain: 3D noise pattern repeats every 100m in X/Y/Z.
-static const float AUTHORING_TO_WORLD_SCALE = SIDE_LENGTH / NVDF_DOMAIN_SIDE_LENGTH;
+// Fraction of the light that still reaches fully shadowed samples, when there is no sky ambient
+static const float SHADOW_AMBIENT_FLOOR = 0.2;
 
-// Density -> extinction scaling
-static const float DENSITY_SCALE = .035; // To be tuned / driven by NVDF
-
-Texture2D gInput : register(t0);
 Texture3D sdfNvdfTex : register(t1); // Sdf and model textures combined [sdf.r, model.r, model.g, model.b] 
 Texture3D noiseTex : register(t2); // Low frequency, high frequency noises for wispy and billowy clouds 
 Texture2D depthStencilBuffer : register(t3); // The scene's depth-stencil buffer, bound here post-graphics passes
+Texture3D<float> blueNoiseTex : register(t4); // Void-and-cluster blue noise. xy tiles over the march texels, z cycles over frames
+Texture3D<float> sunShadowTex : register(t5); // Optical depth toward the sun, same layout as sdfNvdfTex. Baked by Muon::SunShadowVolume
+Texture2D<float4> beerShadowMap : register(t6); // [front depth, mean extinction, max optical depth] from the sun, see BeerShadowMap.hlsli
+Texture2D<float> cloudScatteringLut : register(t7); // Scattered sunlight by [cos theta, sun optical depth], built by Muon::CloudScatteringLut
+Texture2D<float4> cloudPanoramaTex : register(t8); // Far-field clouds around panoramaOrigin, octahedral. Baked by CloudPanorama.cs
+Texture2D<float> coneStartTex : register(t9); // Per 8x8 tile distance before which no ray can touch a cloud. Written by CloudConeMarch.cs
+Texture2D<uint> rayEnterTex : register(t10); // Per march texel distance to the first occupied brick, float bits. Written by CloudRayIntervals.cs
+Texture2D<uint> rayExitTex : register(t11); // Per march texel distance out of the last occupied brick, float bits
+Texture2D<float> tileStepScaleTex : register(t12); // Per budget tile step size multiplier. Written by CloudTileBudget.cs
+Texture2D<uint> hullTilesTex : register(t17); // Per 16x16 tile [count, hullBounds indices...] of the hulls that can be hit there. Written by HullBinning.cs
+Texture3D<float> meshSdfAtlas : register(t18); // Every shape's mesh SDF stacked along z, see meshSdfSlots. Built by Muon::BuildMeshSdfAtlas
 SamplerState linearWrap : register(s2);
 SamplerState linearClamp : register(s3); 
-RWTexture2D<float4> gOutput : register(u0);
+
+// CloudPanorama.cs reuses everything up to main() with its own output and entry point
+#ifndef CLOUD_PANORAMA_BAKE
+RWTexture2D<float4> gCloudOutput : register(u0); // [in-scattered radiance.rgb, transmittance], composited by CloudUpsample.cs
+RWTexture2D<float2> gCloudDepth : register(u1); // [linear view Z the march was clipped against, cloud distance along the ray]
+RWTexture2D<uint> gTileSteps : register(u2); // Steps taken per budget tile, measured by CloudTileStats.cs
+#endif
 
 struct NoiseSample
 {
@@ -66,6 +103,9 @@ struct RayMarchInfo
     // Optical state
     float transmittance; // remaining light (1 = fully transparent, 0 = fully opaque)
     float3 accumColor; // accumulated in-scattered radiance / cloud color
+    float weightedDistance; // sum of sample distances weighted by their contribution
+    float distanceWeight; // sum of contributions, normalizes weightedDistance
+    float noiseMipScale; // noise texels covered by one pixel per unit of distance
 
     // Bookkeeping
     uint stepIndex; // current step index in the loop (for jitter, etc.)
@@ -79,50 +119,16 @@ void InitRayMarchInfo(out RayMarchInfo info, float tEnter, float tExit)
     info.stepSize = 0.0f;
     info.transmittance = 1.0f;
     info.accumColor = float3(0.0f, 0.0f, 0.0f);
+    info.weightedDistance = 0.0f;
+    info.distanceWeight = 0.0f;
+    info.noiseMipScale = 0.0f;
     info.stepIndex = 0;
 }
 
-
-float3 WorldToNvdfUV(float3 worldPos)
-{
-    float3 local = (worldPos - VOLUME_MIN_WS) / (VOLUME_MAX_WS - VOLUME_MIN_WS);
-
-    // local: (X, Y, Z) normalized into [0,1]
-
-    float u = local.x; // world X -> texture X
-    float v = local.z; // world Z -> texture Y (so each slice is an XZ plane)
-    float w = local.y; // world Y -> texture Z (stacking along Y)
-
-    return float3(u, v, w);
-}
-
-bool RayBoxIntersect(
-    float3 origin,
-    float3 dir,
-    float3 boxMin,
-    float3 boxMax,
-    out float tEnter,
-    out float tExit)
-{
-    float3 invDir = 1.0 / dir;
-
-    float3 t0s = (boxMin - origin) * invDir;
-    float3 t1s = (boxMax - origin) * invDir;
-
-    float3 tMin = min(t0s, t1s);
-    float3 tMax = max(t0s, t1s);
-
-    tEnter = max(max(tMin.x, tMin.y), tMin.z);
-    tExit = min(min(tMax.x, tMax.y), tMax.z);
-
-    // Need a positive interval where enter < exit
-    return tExit > max(tEnter, 0.0);
-}
-
 bool RayConvexHullIntersect(
-    float3 origin,
-    float3 dir,
-    ConvexHull hull,
+    float3 localOrigin,
+    float3 localDir,
+    HullRange hull,
     out float tEnter,
     out float tExit)
 {
@@ -130,16 +136,12 @@ bool RayConvexHullIntersect(
     tEnter = -1e20;
     tExit  =  1e20;
 
-    uint faceStart = hull.faceOffset;
-    uint faceEnd   = hull.faceOffset + hull.faceCount;
-
-    float3 localOrigin = mul(hull.invWorld, float4(origin, 1.0)).xyz;
-    float3 localDir    = mul(hull.invWorld, float4(dir, 0.0)).xyz;
-
+    uint faceStart = hull.planeOffset;
+    uint faceEnd   = hull.planeOffset + hull.planeCount;
 
     for (uint fi = faceStart; fi < faceEnd; ++fi)
     {
-        float4 face = hullFaces[fi];
+        float4 face = hullPlanes[fi];
         float distance = face.w;
         float4 normal = float4(face.xyz, 0.0);
 
@@ -176,12 +178,112 @@ bool RayConvexHullIntersect(
     return tExit > max(tEnter, 0.0);
 }
 
-// Encoded value in [0, 1]  ->  real SDF in [-256, 4096]
-float DecodeSdf(float encodedSdf)
+// Whether the ray enters any registered hull. Rays from a screen tile only test the hulls binned into it.
+bool RayHitsAnyHull(float3 eyePos, float3 dir, uint2 hullTile)
 {
-    const float sdfMin = -256.0;
-    const float sdfMax = 4096.0;
-    return lerp(sdfMin, sdfMax, encodedSdf);
+    uint count = hullBoundsCount;
+    uint2 tileTexel = GetHullTileTexel(hullTile);
+    bool useTile = false;
+#if USE_HULL_TILES
+    if (hullTilesValid != 0 && hullTile.x != HULL_TILE_NONE.x)
+    {
+        uint tileCount = hullTilesTex[tileTexel];
+        useTile = tileCount != HULL_TILE_OVERFLOW;
+        if (useTile)
+            count = tileCount;
+    }
+#endif
+
+    for (uint i = 0; i < count; ++i)
+    {
+        HullBounds bounds = hullBounds[useTile ? hullTilesTex[tileTexel + uint2(1 + i, 0)] : i];
+        HullInstance instance = hullInstances[bounds.instance];
+
+        float3 localOrigin = mul(instance.invWorld, float4(eyePos, 1.0)).xyz;
+        float3 localDir    = mul(instance.invWorld, float4(dir, 0.0)).xyz;
+
+        float hullEnter, hullExit;
+        if (RayConvexHullIntersect(localOrigin, localDir, hullRanges[bounds.range], hullEnter, hullExit))
+            return true;
+    }
+
+    return false;
+}
+
+// The instances with a mesh SDF whose hull boxes, grown by the SDF's falloff, the ray crosses within [tMin, tMax].
+// None without the atlas. Taken from the ray's tile, or all the bounds without one. Decomposed shapes bin a box per hull, so instances are only added once.
+// Returns how many were found, or RAY_SDF_INSTANCES_ALL if they didn't fit and every instance has to be sampled.
+uint CollectRaySdfInstances(float3 eyePos, float3 dir, float tMin, float tMax, uint2 hullTile, out uint instances[MAX_RAY_SDF_INSTANCES])
+{
+    [unroll]
+    for (uint k = 0; k < MAX_RAY_SDF_INSTANCES; ++k)
+        instances[k] = 0;
+
+    if (meshSdfValid == 0)
+        return 0;
+
+    uint count = hullBoundsCount;
+    uint2 tileTexel = GetHullTileTexel(hullTile);
+    bool useTile = false;
+#if USE_HULL_TILES
+    if (hullTilesValid != 0 && hullTile.x != HULL_TILE_NONE.x)
+    {
+        uint tileCount = hullTilesTex[tileTexel];
+        useTile = tileCount != HULL_TILE_OVERFLOW;
+        if (useTile)
+            count = tileCount;
+    }
+#endif
+
+    uint instanceCount = 0;
+    for (uint i = 0; i < count; ++i)
+    {
+        HullBounds bounds = hullBounds[useTile ? hullTilesTex[tileTexel + uint2(1 + i, 0)] : i];
+        if (hullInstances[bounds.instance].sdfSlot == MESH_SDF_SLOT_NONE)
+            continue;
+
+        float boxEnter, boxExit;
+        if (!RayBoxIntersect(eyePos, dir, bounds.minBounds, bounds.maxBounds, boxEnter, boxExit) || boxEnter > tMax || boxExit < tMin)
+            continue;
+
+        bool known = false;
+        for (uint j = 0; j < instanceCount; ++j)
+            known = known || instances[j] == bounds.instance;
+        if (known)
+            continue;
+
+        if (instanceCount == MAX_RAY_SDF_INSTANCES)
+            return RAY_SDF_INSTANCES_ALL;
+        instances[instanceCount++] = bounds.instance;
+    }
+
+    return instanceCount;
+}
+
+// How much of the cloud density survives at a world position, thinned toward the surface of each instance's mesh over its SDF's falloff.
+// Only samples the instances CollectRaySdfInstances() found, or every instance if it returned RAY_SDF_INSTANCES_ALL.
+float GetMeshSdfDensityScale(float3 worldPos, uint instances[MAX_RAY_SDF_INSTANCES], uint instanceCount)
+{
+    const bool sampleAll = instanceCount == RAY_SDF_INSTANCES_ALL;
+    const uint count = sampleAll ? hullInstanceCount : instanceCount;
+
+    float scale = 1.0;
+    for (uint i = 0; i < count && scale > 0.0; ++i)
+    {
+        HullInstance instance = hullInstances[sampleAll ? i : instances[i]];
+        if (instance.sdfSlot == MESH_SDF_SLOT_NONE)
+            continue;
+
+        MeshSdfSlot slot = meshSdfSlots[instance.sdfSlot];
+        float3 localPos = mul(instance.invWorld, float4(worldPos, 1.0)).xyz;
+
+        // Past the falloff from the SDF's box, it can't be any closer to the mesh
+        if (GetMeshSdfSlotOutsideDistance(slot, localPos) >= slot.falloff)
+            continue;
+
+        scale = BlendMeshSdfDensity(scale, SampleMeshSdfAtlas(meshSdfAtlas, linearClamp, slot, localPos), slot.falloff);
+    }
+    return scale;
 }
 
 // Take smaller steps near the camera
@@ -218,6 +320,22 @@ float StaticStepJitter(uint2 pixelCoord, uint stepIndex)
     return Hash231(pixelCoord, stepIndex) - 0.5f;
 }
 
+// Blue noise offset for this march texel and frame, advanced by the golden ratio each step so consecutive steps stay well distributed.
+// Indexed by the march texel, since the full resolution pixels of a reduced march skip over the noise and lose its spectrum.
+// A temporal march revisits each pixel once every divisor^2 frames, so the slice only advances once per visit.
+// Returns [-0.5, 0.5]. CPU mirror: Muon::BlueNoiseStepJitter in BlueNoise.h
+float BlueNoiseStepJitter(uint2 marchCoord, uint stepIndex)
+{
+    static const float GOLDEN_RATIO_FRACT = 0.61803398875;
+
+    uint3 dims;
+    blueNoiseTex.GetDimensions(dims.x, dims.y, dims.z);
+
+    uint slice = temporalEnabled ? frameIndex / (resolutionDivisor * resolutionDivisor) : frameIndex;
+    float noise = blueNoiseTex[uint3(marchCoord % dims.xy, slice % dims.z)];
+    return frac(noise + stepIndex * GOLDEN_RATIO_FRACT) - 0.5;
+}
+
 // Erode normalized base value by erosionValue (noise), re-normalizing remaining range into [0,1].
 float ValueErosion(float baseValue, float erosionValue)
 {
@@ -290,6 +408,62 @@ float GetFractionFromValue(float x, float minVal, float maxVal)
     return saturate(t);
 }
 
+// Cloud optical depth between a sample and the sun. One fetch from the baked volume, or from the Beer shadow map without it.
+float GetSunOpticalDepth(float3 samplePositionWS)
+{
+#if USE_SUN_SHADOW
+    if (sunShadowValid != 0)
+        return sunShadowTex.SampleLevel(linearClamp, WorldToNvdfUV(samplePositionWS), 0.0f);
+#endif
+
+#if USE_BEER_SHADOW_MAP
+    return SampleBeerShadowOpticalDepth(beerShadowMap, linearClamp, samplePositionWS);
+#else
+    return 0.0f;
+#endif
+}
+
+// Sunlight scattered toward the eye by a sample. Plain transmittance without the LUT.
+// opticalDepthScale converts the baked optical depth to the sample's instance.
+float GetSunLight(float3 samplePositionWS, float cosTheta, float opticalDepthScale)
+{
+    float opticalDepth = GetSunOpticalDepth(samplePositionWS) * opticalDepthScale;
+
+#if USE_SCATTERING_LUT
+    if (scatteringLutValid != 0)
+        return cloudScatteringLut.SampleLevel(linearClamp, GetCloudScatteringLutCoord(cosTheta, opticalDepth), 0.0f);
+#endif
+
+    return exp(-opticalDepth);
+}
+
+// Angle subtended by one marched pixel on screen
+float GetMarchPixelAngle()
+{
+    return 2.0f / (proj[1][1] * (float)fullResolution.y) * (float)resolutionDivisor;
+}
+
+// Ratio of the angle a marched pixel subtends to the size of one noise texel in world units.
+// Multiplied by distance this gives the number of noise texels a pixel footprint covers.
+float GetNoiseMipScale(float pixelAngle)
+{
+    uint noiseWidth, noiseHeight, noiseDepth;
+    noiseTex.GetDimensions(noiseWidth, noiseHeight, noiseDepth);
+
+    float texelSizeWS = NOISE_DOMAIN_SIDE_LENGTH * AUTHORING_TO_WORLD_SCALE / (float)noiseWidth;
+    return pixelAngle / texelSizeWS;
+}
+
+// Same shape as GetVoxelCloudMipLevel() in Nubis' VoxelCloudSampler: mip grows with the log of the pixel footprint
+float GetVoxelCloudMipLevel(RayMarchInfo rayMarchInfo, float baseMip)
+{
+#if USE_NOISE_MIPS
+    return log2(1.0f + abs(rayMarchInfo.distance * rayMarchInfo.noiseMipScale)) + baseMip;
+#else
+    return baseMip;
+#endif
+}
+
 // Compute uprezzed voxel cloud density from dimensional profile, type and density scale.
 float GetUprezzedVoxelCloudDensity(
     RayMarchInfo rayMarchInfo,
@@ -309,7 +483,7 @@ float GetUprezzedVoxelCloudDensity(
     NoiseSample noiseSample = MakeNoiseSample(noiseTex.SampleLevel(
         linearWrap,
         noiseUVW,
-        0.0f // TODO: plug in distance-based mip
+        GetVoxelCloudMipLevel(rayMarchInfo, 0.0f)
     ));
     
     // Define wispy noise
@@ -348,80 +522,148 @@ float GetUprezzedVoxelCloudDensity(
     return uprezzed_density;
 }
 
-float3 VolumeRaymarchNvdf(float3 eyePos, float3 dir, float3 bgColor, int3 dispatchThreadID)
+#if USE_CLOUD_INSTANCES
+// NVDF sample of the instance the point is deepest inside, among the hits whose span covers t.
+// sdfDistance is in world units, and also never steps past the entry of a hit further along the ray.
+float4 SampleCloudInstances(CloudRayHit hits[MAX_RAY_CLOUD_INSTANCES], uint hitCount, float3 positionWS, float t,
+                            out uint instance, out float sdfDistance)
 {
-    float tEnter, tExit;
-    if (!RayBoxIntersect(eyePos, dir, VOLUME_MIN_WS, VOLUME_MAX_WS, tEnter, tExit))
-    {
-        // Ray misses the volume entirely
-        //return float3(1, 1, 1);
-        return bgColor;
-    }
+    float4 nearestSample = float4(1.0, 0.0, 0.0, 0.0); // Encoded SDF of 1 is far outside any cloud
+    instance = hits[0].instance;
+    sdfDistance = SKY_DISTANCE;
 
-    float minBoxEnter = tEnter;
-    float maxBoxExit = tExit;
-    for (uint i = 0; i < aabbCount; ++i)
+    for (uint h = 0; h < hitCount; ++h)
     {
-        float aabbEnter, aabbExit;
-        if (RayBoxIntersect(eyePos, dir, aabbs[i].minBounds, aabbs[i].maxBounds, aabbEnter, aabbExit))
+        if (t < hits[h].tEnter)
         {
-            minBoxEnter = min(minBoxEnter, aabbEnter);
-            maxBoxExit = max(maxBoxExit, aabbExit);
-#if DEBUG_AABB_INTERSECT
-           // return float3(1, 0, 0) * bgColor; // Visualize AABB intersection
-#endif
+            sdfDistance = min(sdfDistance, hits[h].tEnter - t);
+            continue;
+        }
+
+        if (t > hits[h].tExit)
+            continue;
+
+        float3 volumePos = CloudInstanceToLocal(hits[h].instance, positionWS);
+        float4 nvdfSample = sdfNvdfTex.SampleLevel(linearClamp, WorldToNvdfUV(volumePos), 0.0f);
+        float distance = DecodeSdf(nvdfSample.r) * AUTHORING_TO_WORLD_SCALE * instanceParams[hits[h].instance].x;
+        if (distance < sdfDistance)
+        {
+            sdfDistance = distance;
+            nearestSample = nvdfSample;
+            instance = hits[h].instance;
         }
     }
 
+    return nearestSample;
+}
+#endif
+
+// Returns [in-scattered radiance.rgb, transmittance]. The caller composites it over the scene.
+// Only the part of the ray within marchRange is marched. pixelAngle is the angular footprint of the ray, for noise mip selection.
+// jitterCoord is the texel of the target being marched, which the step jitter is tiled over.
+// hullTile is the ray's HullBinning.cs tile, or HULL_TILE_NONE.
+// stepScale multiplies the adaptive step size. stepCount is how many steps were taken.
+// cloudDistance is the contribution weighted distance of the cloud along the ray, used for temporal reprojection.
+float4 VolumeRaymarchNvdf(float3 eyePos, float3 dir, float sceneDistance, float2 marchRange, float stepScale, int2 jitterCoord, float pixelAngle, uint2 hullTile,
+                          out float cloudDistance, out uint stepCount)
+{
+    const float4 emptyCloud = float4(0.0, 0.0, 0.0, 1.0);
+    stepCount = 0;
+
+    // Empty rays reproject as if they hit the far end of the march
+    cloudDistance = min(sceneDistance, MAX_DIST);
 
-    for(uint i = 0; i < hullCount; ++i)
+    float tEnter, tExit;
+#if USE_CLOUD_INSTANCES
+    // Only the instances the ray overlaps are marched, over the span from the first entry to the last exit
+    CloudRayHit hits[MAX_RAY_CLOUD_INSTANCES];
+    uint hitCount = CollectCloudRayHits(eyePos, dir, marchRange.x, marchRange.y, hits);
+    if (hitCount == 0)
+        return emptyCloud;
+
+    tEnter = hits[0].tEnter;
+    tExit = hits[0].tExit;
+    for (uint h = 1; h < hitCount; ++h)
+        tExit = max(tExit, hits[h].tExit);
+#else
+    if (!RayBoxIntersect(eyePos, dir, VOLUME_MIN_WS, VOLUME_MAX_WS, tEnter, tExit))
     {
-        float hullEnter, hullExit;
-        ConvexHull ch = hulls[i];
+        // Ray misses the volume entirely
+        return emptyCloud;
+    }
+#endif
+
+#if USE_DEPTH_CLIP
+    // Opaque geometry is in front of the volume, nothing to march.
+    if (sceneDistance <= max(tEnter, marchRange.x))
+        return emptyCloud;
+
+    tExit = min(tExit, sceneDistance);
+#endif
 
-        if (RayConvexHullIntersect(eyePos, dir, ch, hullEnter, hullExit))
-        {
-            // minBoxEnter = min(minBoxEnter, hullEnter);
-            // maxBoxExit = max(maxBoxExit, hullExit);
 #if DEBUG_AABB_INTERSECT
-            return float3(1, 0, 0) * bgColor; // Visualize hull intersection
+    if (RayHitsAnyHull(eyePos, dir, hullTile))
+        return float4(0.5, 0, 0, 0.5); // Visualize hull intersection
 #endif
-        }
-    }
 
-    // Clamp to your global near/far
-    tEnter = max(tEnter, MIN_DIST);
-    tExit = min(tExit, MAX_DIST);
+    // Clamp to the requested part of the ray
+    tEnter = max(tEnter, marchRange.x);
+    tExit = min(tExit, marchRange.y);
 
     if (tExit <= tEnter)
-        return bgColor;
+        return emptyCloud;
 
     const float3 cloudColor = float3(1.0, 1.0, 1.0);
+    const float cosTheta = dot(dir, sunDirection);
+
+#if USE_SKY_AMBIENT
+    // Cloud tops mostly see the sky above, bottoms see the horizon and ground. Blended by height in the loop.
+    const float3 skyAmbientTop = EvaluateSkyAmbient(float3(0.0, 1.0, 0.0));
+    const float3 skyAmbientBottom = EvaluateSkyAmbient(float3(0.0, -1.0, 0.0));
+#endif
 
     RayMarchInfo march;
     InitRayMarchInfo(march, tEnter, tExit);
+    march.noiseMipScale = GetNoiseMipScale(pixelAngle);
+
+#if USE_MESH_SDF
+    uint sdfInstances[MAX_RAY_SDF_INSTANCES];
+    uint sdfInstanceCount = CollectRaySdfInstances(eyePos, dir, tEnter, tExit, hullTile, sdfInstances);
+#endif
 
     // Ray march until the ray exits the volume or max steps are reached
     [loop]
     for (int i = 0; i < MAX_STEPS && march.distance < march.tExit; ++i)
     {
         march.stepIndex = i;
+        stepCount = i + 1;
 
         float3 samplePos = eyePos + march.distance * dir;
 
+#if USE_CLOUD_INSTANCES
+        // The instance the sample is deepest inside. Its NVDF drives the step, and the density is sampled in its space.
+        uint instance;
+        float sdfDistance;
+        float4 sdfSample = SampleCloudInstances(hits, hitCount, samplePos, march.distance, instance, sdfDistance);
+#else
         // Sample NVDF volume: .r = encoded SDF, .g = density (dimensional profile)
         float4 sdfSample = sdfNvdfTex.SampleLevel(linearClamp, WorldToNvdfUV(samplePos), 0.0f);
         float sdfDistance = DecodeSdf(sdfSample.r) * AUTHORING_TO_WORLD_SCALE;
+#endif
 
 #if USE_ADAPTIVE_STEP
-        float adaptive = ComputeAdaptiveStepSize(march.distance);
+        float adaptive = ComputeAdaptiveStepSize(march.distance) * stepScale;
         march.stepSize = ComputeBaseStepSize(sdfDistance, adaptive);
 #else
-        march.stepSize = max(sdfDistance, AUTHORING_TO_WORLD_SCALE);
+        march.stepSize = max(sdfDistance, AUTHORING_TO_WORLD_SCALE * stepScale);
 #endif
 
 #if USE_JITTERED_STEP
-        float jitter = StaticStepJitter(dispatchThreadID.xy, march.stepIndex); // [-0.5, 0.5]
+#if USE_BLUE_NOISE_JITTER
+        float jitter = BlueNoiseStepJitter(jitterCoord, march.stepIndex); // [-0.5, 0.5]
+#else
+        float jitter = StaticStepJitter(jitterCoord, march.stepIndex); // [-0.5, 0.5]
+#endif
         float jitterDistance = jitter * march.stepSize;
         samplePos += dir * jitterDistance;
 #endif
@@ -431,20 +673,56 @@ float3 VolumeRaymarchNvdf(float3 eyePos, float3 dir, float3 bgColor, int3 dispat
             float dimensionalProfile = sdfSample.g;
             float detailType = sdfSample.b;
             float densityScale = sdfSample.a;
+
+#if USE_CLOUD_INSTANCES
+            // Noise, lighting and height all live in the instance's volume space
+            float3 volumePos = CloudInstanceToLocal(instance, samplePos);
+            float instanceScale = instanceParams[instance].x;
+            float instanceDensity = instanceParams[instance].y;
+
+            RayMarchInfo instanceMarch = march;
+            instanceMarch.noiseMipScale *= 1.0 / instanceScale;
+#else
+            float3 volumePos = samplePos;
+            float instanceScale = 1.0;
+            float instanceDensity = 1.0;
+            RayMarchInfo instanceMarch = march;
+#endif
             
             float density = GetUprezzedVoxelCloudDensity(
-                march,
-                samplePos,
+                instanceMarch,
+                volumePos,
                 dimensionalProfile,
                 detailType,
                 densityScale
-            );
+            ) * instanceDensity;
+
+#if USE_MESH_SDF
+            if (sdfInstanceCount != 0)
+                density *= GetMeshSdfDensityScale(samplePos, sdfInstances, sdfInstanceCount);
+#endif
             
+            // Don't integrate past the exit point (the opaque surface when depth clipped)
+            float segmentLength = min(march.stepSize, march.tExit - march.distance);
+
             float sigma = density * DENSITY_SCALE;
-            float alpha = 1.0 - exp(-sigma * march.stepSize);
+            float alpha = 1.0 - exp(-sigma * segmentLength);
+
+            float sunLight = GetSunLight(volumePos, cosTheta, instanceScale * instanceDensity);
+            float3 lighting = cloudColor * lerp(SHADOW_AMBIENT_FLOOR, 1.0, sunLight);
+#if USE_SKY_AMBIENT
+            if (skyAmbientValid)
+            {
+                float heightFraction = saturate((volumePos.y - VOLUME_MIN_WS.y) / (VOLUME_MAX_WS.y - VOLUME_MIN_WS.y));
+                lighting = cloudColor * (sunLight + lerp(skyAmbientBottom, skyAmbientTop, heightFraction));
+            }
+#endif
 
-            float3 contrib = cloudColor * alpha * march.transmittance;
+            float3 contrib = lighting * alpha * march.transmittance;
             march.accumColor += contrib;
+
+            march.weightedDistance += march.distance * alpha * march.transmittance;
+            march.distanceWeight += alpha * march.transmittance;
         
             march.transmittance *= (1.0 - alpha);
             if (march.transmittance < MIN_TRANSMITTANCE)
@@ -454,44 +732,86 @@ float3 VolumeRaymarchNvdf(float3 eyePos, float3 dir, float3 bgColor, int3 dispat
         march.distance += march.stepSize;
     }
 
-    float3 finalColor = march.accumColor + bgColor * march.transmittance;
-    return finalColor;
+    if (march.distanceWeight > 0.0)
+        cloudDistance = march.weightedDistance / march.distanceWeight;
+
+    return float4(march.accumColor, march.transmittance);
 }
 
 
+#ifndef CLOUD_PANORAMA_BAKE
 [numthreads(16, 16, 1)]
 void main(int3 dispatchThreadID : SV_DispatchThreadID)
 {
-    int2 pixelCoord = dispatchThreadID.xy;
+    int2 marchCoord = dispatchThreadID.xy;
+    if (any(marchCoord >= int2(marchResolution)))
+        return;
 
-    uint width, height;
-    gOutput.GetDimensions(width, height);
+    // At reduced resolution each thread marches on behalf of a divisor x divisor block of pixels
+    int2 pixelCoord = GetMarchPixelCoord(marchCoord);
     
-    // NDC
-    float2 uv = (float2(pixelCoord) + 0.5) / float2(width, height);
-    uv = uv * 2.0 - 1.0;
-    uv.y = -uv.y;
-    
-    float tanHalfFovY = 1.0 / proj[1][1];
-    float tanHalfFovX = 1.0 / proj[0][0];
-    
-    float3 viewDir = normalize(float3(uv.x * tanHalfFovX,
-                                       uv.y * tanHalfFovY,
-                                       1.0));
+    float3 viewDir = GetViewRayDirection(pixelCoord, fullResolution, proj);
     
     // Transform to world space
     float3 worldDir = normalize(mul(invView, float4(viewDir, 0.0)).xyz);
     float3 eyePos = float3(invView[0][3], invView[1][3], invView[2][3]); // from the 4th column instead of row..
-    
-    float3 bgColor = gInput[pixelCoord].rgb;
 
-    // Volume composite against NVDF dimensional profile (green channel)
-    float3 finalColor = VolumeRaymarchNvdf(eyePos, worldDir, bgColor, dispatchThreadID);
+    float depth = depthStencilBuffer[pixelCoord].r;
+    float sceneDistance = DepthToRayDistance(depth, viewDir, proj);
 
-    float depth = depthStencilBuffer[dispatchThreadID.xy].r;
-    
-    // Example: Visulize depth
-    // finalColor = depth.rrr;
+    float2 marchRange = float2(MIN_DIST, MAX_DIST);
+#if USE_CONE_MARCH_START
+    // The tile's cone is empty up to here
+    if (coneStartValid != 0)
+        marchRange.x = max(MIN_DIST, coneStartTex[pixelCoord / CLOUD_CONE_TILE_SIZE]);
+#endif
+
+#if USE_RAY_INTERVALS
+    // No cloud outside the occupied bricks the ray crosses. Rays missing them all end up with an empty range.
+    if (rayIntervalValid != 0)
+    {
+        float2 interval = DecodeRayInterval(rayEnterTex[marchCoord], rayExitTex[marchCoord]);
+        marchRange = float2(max(marchRange.x, interval.x), min(marchRange.y, interval.y));
+    }
+#endif
+
+#if USE_FAR_FIELD_PANORAMA
+    // Sky rays only march up to the far-field distance when the panorama holds the rest.
+    // Rays that hit geometry march all the way, the panorama knows nothing about the scene.
+    const bool useFarField = panoramaValid != 0 && sceneDistance >= MAX_DIST;
+    if (useFarField)
+        marchRange.y = min(marchRange.y, farFieldDistance);
+#endif
+
+    float stepScale = stepSizeScale;
+#if USE_TILE_BUDGET
+    uint2 budgetTile = uint2(marchCoord) / CLOUD_BUDGET_TILE_SIZE;
+    if (tileBudgetValid != 0)
+        stepScale *= tileStepScaleTex[budgetTile];
+#endif
+
+    // Volume march against NVDF dimensional profile (green channel)
+    float cloudDistance;
+    uint stepCount;
+    float4 cloud = VolumeRaymarchNvdf(eyePos, worldDir, sceneDistance, marchRange, stepScale, marchCoord, GetMarchPixelAngle(), uint2(marchCoord) / HULL_TILE_SIZE, cloudDistance, stepCount);
+
+#if USE_TILE_BUDGET
+    // Feeds next frame's allocation
+    if (tileBudgetEnabled != 0 && stepCount > 0)
+        InterlockedAdd(gTileSteps[budgetTile], stepCount);
+#endif
+
+#if USE_FAR_FIELD_PANORAMA
+    // Composite the cached far field behind whatever the near march left visible
+    if (useFarField && cloud.a >= MIN_TRANSMITTANCE)
+    {
+        float4 farField = cloudPanoramaTex.SampleLevel(linearClamp, OctahedralEncode(worldDir), 0.0f);
+        cloud.rgb += cloud.a * farField.rgb;
+        cloud.a *= farField.a;
+    }
+#endif
     
-    gOutput[dispatchThreadID.xy] = float4(finalColor, 1.0);
-}
\ No newline at end of file
+    gCloudOutput[marchCoord] = cloud;
+    gCloudDepth[marchCoord] = float2(LinearizeDepth(depth, proj), cloudDistance);
+}
+#endif
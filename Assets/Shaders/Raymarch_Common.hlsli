@@ -6,6 +6,8 @@ Description : Common Raymarching Structures for Collision
 #ifndef RAYMARCH_COMMON_HLSLI
 #define RAYMARCH_COMMON_HLSLI
 
+#include "MeshSdf.hlsli"
+
 struct AABB
 {
 	float3 minBounds;
@@ -18,27 +20,44 @@ cbuffer AABBBuffer : register(b3)
 	AABB aabbs[1];
 };
 
-struct ConvexHull
+// Mirrors Muon::sbHullRange, one convex hull's planes in hullPlanes
+struct HullRange
 {
-    uint buffer1;   // offset into HullPoints
-    uint buffer2;
+    uint planeOffset;
+    uint planeCount;
+};
 
-    uint faceOffset;    // offset into HullFaces
-    uint faceCount;
+// Mirrors Muon::sbHullInstance, a placed shape whose hulls are a run of hullRanges
+struct HullInstance
+{
+    uint rangeOffset;
+    uint rangeCount;
+    uint sdfSlot;   // Into meshSdfSlots, or MESH_SDF_SLOT_NONE
+    uint pad;
 
-    float4x4 world;
-	float4x4 invWorld;
+    float4x4 invWorld;
 };
 
-cbuffer HullsBuffer : register(b4)
+// Mirrors Muon::sbHullBounds, the world space box of one hull of one instance
+struct HullBounds
 {
-	uint hullCount;
-	ConvexHull hulls[1];
+    float3 minBounds;
+    uint instance;  // Into hullInstances
+    float3 maxBounds;
+    uint range;     // Into hullRanges
 };
 
-cbuffer HullFacesBuffer : register(b5)
+cbuffer HullRegistryParams : register(b4)
 {
-	float4 hullFaces[1024];
+	uint hullInstanceCount;
+	uint hullBoundsCount;
 };
 
+// Every registered hull, filled by Muon::HullRegistry
+StructuredBuffer<float4> hullPlanes : register(t13);          // Outward normal in xyz, n.p + w > 0 outside
+StructuredBuffer<HullRange> hullRanges : register(t14);
+StructuredBuffer<HullInstance> hullInstances : register(t15);
+StructuredBuffer<HullBounds> hullBounds : register(t16);        // One per hull of every instance, what HullBinning.cs bins
+StructuredBuffer<MeshSdfSlot> meshSdfSlots : register(t19);     // Where each shape's mesh SDF sits in the MeshSdfAtlas
+
 #endif
\ No newline at end of file
@@ -0,0 +1,33 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Sky light around the cloud layer as L2 spherical harmonics,
+projected on the CPU from the atmosphere tables every frame.
+Matches Muon::cbSkyAmbient
+----------------------------------------------*/
+#ifndef SKYAMBIENTBUFFER_HLSLI
+#define SKYAMBIENTBUFFER_HLSLI
+
+cbuffer SkyAmbient : register(b8)
+{
+    float4 skySH[9];      // Pre-convolved with a clamped cosine and divided by pi, world space
+    uint skyAmbientValid; // 0 when the atmosphere tables weren't available on the CPU
+};
+
+// Radiance reflected by a white diffuse surface facing n.
+// CPU mirror: Muon::EvaluateSkyAmbientSH
+float3 EvaluateSkyAmbient(float3 n)
+{
+    float3 result = skySH[0].rgb * 0.282095;
+    result += skySH[1].rgb * (0.488603 * n.y);
+    result += skySH[2].rgb * (0.488603 * n.z);
+    result += skySH[3].rgb * (0.488603 * n.x);
+    result += skySH[4].rgb * (1.092548 * n.x * n.y);
+    result += skySH[5].rgb * (1.092548 * n.y * n.z);
+    result += skySH[6].rgb * (0.315392 * (3.0 * n.z * n.z - 1.0));
+    result += skySH[7].rgb * (1.092548 * n.x * n.z);
+    result += skySH[8].rgb * (0.546274 * (n.x * n.x - n.y * n.y));
+    return max(result, 0.0);
+}
+
+#endif
@@ -0,0 +1,331 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of BlueNoise.h
+Follows Ulichney's void-and-cluster method: relax a random initial pattern,
+then rank every texel by repeatedly removing the tightest cluster or filling
+the largest void.
+----------------------------------------------*/
+#include "BlueNoise.h"
+
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <random>
+
+namespace Muon
+{
+
+namespace
+{
+    static const uint32_t BLUE_NOISE_CACHE_VERSION = 1;
+    static const char BLUE_NOISE_CACHE_MAGIC[4] = { 'B', 'N', 'V', 'C' };
+
+    struct BlueNoiseCacheHeader
+    {
+        char magic[4];
+        uint32_t version;
+        BlueNoiseDesc desc;
+    };
+
+    struct KernelTap
+    {
+        int dx, dy, dz;
+        float weight;
+    };
+
+    // Tracks the gaussian energy of the current binary pattern.
+    // Extremes are cached per row so finding the tightest cluster/largest void doesn't rescan the whole volume every step.
+    class VoidAndCluster
+    {
+    public:
+        VoidAndCluster(const BlueNoiseDesc& desc) :
+            mWidth((int)desc.width),
+            mHeight((int)desc.height),
+            mDepth((int)desc.depth),
+            mRowCount((size_t)desc.height * desc.depth)
+        {
+            // Truncate the gaussian at 3 sigma, and never wrap the window onto itself
+            int radiusXY = std::min((int)ceilf(3.0f * desc.spatialSigma), (std::min(mWidth, mHeight) - 1) / 2);
+            int radiusZ = mDepth > 1 ? std::min((int)ceilf(3.0f * desc.depthSigma), (mDepth - 1) / 2) : 0;
+
+            float invSpatial = 1.0f / (2.0f * desc.spatialSigma * desc.spatialSigma);
+            float invDepth = 1.0f / (2.0f * desc.depthSigma * desc.depthSigma);
+
+            for (int dz = -radiusZ; dz <= radiusZ; ++dz)
+                for (int dy = -radiusXY; dy <= radiusXY; ++dy)
+                    for (int dx = -radiusXY; dx <= radiusXY; ++dx)
+                    {
+                        float weight = expf(-(float)(dx * dx + dy * dy) * invSpatial - (float)(dz * dz) * invDepth);
+                        mKernel.push_back({ dx, dy, dz, weight });
+                    }
+
+            mRadiusY = radiusXY;
+            mRadiusZ = radiusZ;
+
+            size_t count = (size_t)mWidth * mHeight * mDepth;
+            mEnergy.assign(count, 0.0f);
+            mBinary.assign(count, 0);
+            mRowMaxOne.assign(mRowCount, -1);
+            mRowMinZero.assign(mRowCount, -1);
+            mRowDirty.assign(mRowCount, 1);
+        }
+
+        size_t Size() const { return mEnergy.size(); }
+        bool IsSet(size_t idx) const { return mBinary[idx] != 0; }
+
+        void Set(size_t idx, bool value)
+        {
+            if (IsSet(idx) == value)
+                return;
+
+            mBinary[idx] = value ? 1 : 0;
+            Splat(idx, value ? 1.0f : -1.0f);
+        }
+
+        // Highest energy texel that is set
+        size_t TightestCluster()
+        {
+            RefreshRows();
+
+            int best = -1;
+            for (size_t r = 0; r < mRowCount; ++r)
+            {
+                int candidate = mRowMaxOne[r];
+                if (candidate >= 0 && (best < 0 || mEnergy[candidate] > mEnergy[best]))
+                    best = candidate;
+            }
+            return (size_t)best;
+        }
+
+        // Lowest energy texel that is not set
+        size_t LargestVoid()
+        {
+            RefreshRows();
+
+            int best = -1;
+            for (size_t r = 0; r < mRowCount; ++r)
+            {
+                int candidate = mRowMinZero[r];
+                if (candidate >= 0 && (best < 0 || mEnergy[candidate] < mEnergy[best]))
+                    best = candidate;
+            }
+            return (size_t)best;
+        }
+
+    private:
+        void Splat(size_t idx, float sign)
+        {
+            int x = (int)(idx % mWidth);
+            int y = (int)((idx / mWidth) % mHeight);
+            int z = (int)(idx / ((size_t)mWidth * mHeight));
+
+            for (const KernelTap& tap : mKernel)
+            {
+                int tx = Wrap(x + tap.dx, mWidth);
+                int ty = Wrap(y + tap.dy, mHeight);
+                int tz = Wrap(z + tap.dz, mDepth);
+                mEnergy[((size_t)tz * mHeight + ty) * mWidth + tx] += sign * tap.weight;
+            }
+
+            for (int dz = -mRadiusZ; dz <= mRadiusZ; ++dz)
+                for (int dy = -mRadiusY; dy <= mRadiusY; ++dy)
+                    mRowDirty[(size_t)Wrap(z + dz, mDepth) * mHeight + Wrap(y + dy, mHeight)] = 1;
+        }
+
+        void RefreshRows()
+        {
+            for (size_t r = 0; r < mRowCount; ++r)
+            {
+                if (!mRowDirty[r])
+                    continue;
+
+                int maxOne = -1;
+                int minZero = -1;
+                size_t rowStart = r * mWidth;
+                for (int x = 0; x < mWidth; ++x)
+                {
+                    int idx = (int)(rowStart + x);
+                    if (mBinary[idx])
+                    {
+                        if (maxOne < 0 || mEnergy[idx] > mEnergy[maxOne])
+                            maxOne = idx;
+                    }
+                    else if (minZero < 0 || mEnergy[idx] < mEnergy[minZero])
+                    {
+                        minZero = idx;
+                    }
+                }
+
+                mRowMaxOne[r] = maxOne;
+                mRowMinZero[r] = minZero;
+                mRowDirty[r] = 0;
+            }
+        }
+
+        static int Wrap(int v, int size)
+        {
+            v %= size;
+            return v < 0 ? v + size : v;
+        }
+
+        int mWidth, mHeight, mDepth;
+        int mRadiusY = 0, mRadiusZ = 0;
+        size_t mRowCount;
+
+        std::vector<KernelTap> mKernel;
+        std::vector<float> mEnergy;
+        std::vector<uint8_t> mBinary;
+
+        std::vector<int> mRowMaxOne;
+        std::vector<int> mRowMinZero;
+        std::vector<uint8_t> mRowDirty;
+    };
+}
+
+bool GenerateBlueNoise(const BlueNoiseDesc& desc, std::vector<float>& out_values)
+{
+    if (desc.width < 4 || desc.height < 4 || desc.depth < 1 || desc.spatialSigma <= 0.0f || desc.depthSigma <= 0.0f)
+    {
+        Printf(L"Error: Invalid blue noise dimensions %ux%ux%u!\n", desc.width, desc.height, desc.depth);
+        return false;
+    }
+
+    VoidAndCluster pattern(desc);
+    const size_t count = pattern.Size();
+
+    // Random initial pattern, roughly 10% of the texels set
+    const size_t initialOnes = std::max<size_t>(1, count / 10);
+    {
+        std::mt19937 rng(desc.seed);
+        std::uniform_int_distribution<size_t> dist(0, count - 1);
+
+        size_t placed = 0;
+        while (placed < initialOnes)
+        {
+            size_t idx = dist(rng);
+            if (pattern.IsSet(idx))
+                continue;
+
+            pattern.Set(idx, true);
+            ++placed;
+        }
+    }
+
+    // Relax into the initial binary pattern: move the tightest cluster into the largest void until they coincide
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t cluster = pattern.TightestCluster();
+        pattern.Set(cluster, false);
+
+        size_t largestVoid = pattern.LargestVoid();
+        pattern.Set(largestVoid, true);
+
+        if (largestVoid == cluster)
+            break;
+    }
+
+    std::vector<uint32_t> ranks(count, 0);
+
+    // Phase 1: rank the initial pattern's texels by removing tightest clusters
+    {
+        VoidAndCluster shrinking = pattern;
+        for (size_t ones = initialOnes; ones > 0; --ones)
+        {
+            size_t cluster = shrinking.TightestCluster();
+            shrinking.Set(cluster, false);
+            ranks[cluster] = (uint32_t)(ones - 1);
+        }
+    }
+
+    // Phase 2 and 3: fill the largest voids until every texel is ranked.
+    // Past the half way point Ulichney swaps to the tightest cluster of zeros, but since the kernel sums to a constant,
+    // the zeros' energy is that constant minus the ones' energy, so it picks the same texel as the largest void.
+    for (size_t rank = initialOnes; rank < count; ++rank)
+    {
+        size_t largestVoid = pattern.LargestVoid();
+        pattern.Set(largestVoid, true);
+        ranks[largestVoid] = (uint32_t)rank;
+    }
+
+    out_values.resize(count);
+    for (size_t i = 0; i < count; ++i)
+        out_values[i] = ((float)ranks[i] + 0.5f) / (float)count;
+
+    return true;
+}
+
+static bool DescMatches(const BlueNoiseDesc& a, const BlueNoiseDesc& b)
+{
+    return a.width == b.width && a.height == b.height && a.depth == b.depth &&
+           a.spatialSigma == b.spatialSigma && a.depthSigma == b.depthSigma && a.seed == b.seed;
+}
+
+bool LoadOrGenerateBlueNoise(const BlueNoiseDesc& desc, const std::filesystem::path& cachePath, std::vector<float>& out_values)
+{
+    const size_t count = (size_t)desc.width * desc.height * desc.depth;
+
+    std::ifstream inFile(cachePath, std::ios::binary);
+    if (inFile)
+    {
+        BlueNoiseCacheHeader header = {};
+        inFile.read(reinterpret_cast<char*>(&header), sizeof(header));
+
+        bool valid = inFile &&
+            std::equal(std::begin(header.magic), std::end(header.magic), std::begin(BLUE_NOISE_CACHE_MAGIC)) &&
+            header.version == BLUE_NOISE_CACHE_VERSION &&
+            DescMatches(header.desc, desc);
+
+        if (valid)
+        {
+            out_values.resize(count);
+            inFile.read(reinterpret_cast<char*>(out_values.data()), count * sizeof(float));
+            if (inFile)
+                return true;
+        }
+
+        Printf(L"Warning: Blue noise cache %s is stale, regenerating.\n", cachePath.c_str());
+    }
+    inFile.close();
+
+    if (!GenerateBlueNoise(desc, out_values))
+        return false;
+
+    std::error_code ec;
+    std::filesystem::create_directories(cachePath.parent_path(), ec);
+
+    std::ofstream outFile(cachePath, std::ios::binary | std::ios::trunc);
+    if (!outFile)
+    {
+        // Not fatal, it just gets generated again next launch.
+        Printf(L"Warning: Failed to write blue noise cache %s\n", cachePath.c_str());
+        return true;
+    }
+
+    BlueNoiseCacheHeader header = {};
+    std::copy(std::begin(BLUE_NOISE_CACHE_MAGIC), std::end(BLUE_NOISE_CACHE_MAGIC), header.magic);
+    header.version = BLUE_NOISE_CACHE_VERSION;
+    header.desc = desc;
+
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(out_values.data()), count * sizeof(float));
+    return true;
+}
+
+float BlueNoiseStepJitter(const std::vector<float>& noise, const BlueNoiseDesc& desc, uint32_t marchX, uint32_t marchY, uint32_t frameIndex,
+                          bool temporalEnabled, uint32_t resolutionDivisor, uint32_t stepIndex)
+{
+    static const float GOLDEN_RATIO_FRACT = 0.61803398875f;
+
+    uint32_t slice = temporalEnabled ? frameIndex / (resolutionDivisor * resolutionDivisor) : frameIndex;
+    size_t idx = ((size_t)(slice % desc.depth) * desc.height + (marchY % desc.height)) * desc.width + (marchX % desc.width);
+    if (idx >= noise.size())
+        return 0.0f;
+
+    float value = noise[idx] + (float)stepIndex * GOLDEN_RATIO_FRACT;
+    return (value - floorf(value)) - 0.5f;
+}
+
+}
@@ -0,0 +1,43 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Void-and-cluster blue noise generation for tileable 2D/3D textures.
+3D volumes can be treated as spatiotemporal noise (xy = screen, z = frame) by
+giving the z axis its own sigma. Results are cached to disk since generation is slow.
+----------------------------------------------*/
+#ifndef MUON_BLUENOISE_H
+#define MUON_BLUENOISE_H
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Muon
+{
+    struct BlueNoiseDesc
+    {
+        uint32_t width = 64;
+        uint32_t height = 64;
+        uint32_t depth = 1;         // 1 = plain 2D noise
+
+        float spatialSigma = 1.9f;  // Gaussian energy filter width along x/y (Ulichney recommends ~1.5)
+        float depthSigma = 1.9f;    // ...and along z. Equal to spatialSigma for isotropic 3D noise.
+
+        uint32_t seed = 0x6d756f6e; // Seeds the initial binary pattern, so results are reproducible
+    };
+
+    // Generates width*height*depth ranks mapped to [0,1), laid out x fastest, then y, then z.
+    // The pattern wraps on every axis so it can be tiled.
+    bool GenerateBlueNoise(const BlueNoiseDesc& desc, std::vector<float>& out_values);
+
+    // Reads the noise from cachePath if it was generated with the same desc, otherwise generates and writes it.
+    bool LoadOrGenerateBlueNoise(const BlueNoiseDesc& desc, const std::filesystem::path& cachePath, std::vector<float>& out_values);
+
+    // Per-step ray jitter in [-0.5, 0.5]. Each step is offset by the golden ratio so consecutive steps stay well distributed.
+    // Tiled over march texels. A temporal march only advances z once every resolutionDivisor^2 frames, when the texel's pixel comes around again.
+    // Mirrors BlueNoiseStepJitter() in Raymarch.cs.hlsl.
+    float BlueNoiseStepJitter(const std::vector<float>& noise, const BlueNoiseDesc& desc, uint32_t marchX, uint32_t marchY, uint32_t frameIndex,
+                              bool temporalEnabled, uint32_t resolutionDivisor, uint32_t stepIndex);
+}
+
+#endif
@@ -14,6 +14,9 @@ Description : Implementation of GPU Buffers
 
 #include <DirectXTex.h>
 
+#include <algorithm>
+#include <vector>
+
 namespace Muon
 {
 
@@ -159,7 +162,7 @@ bool UploadBuffer::Allocate(UINT desiredSize, UINT alignment, void*& out_mappedP
     return true;
 }
 
-bool UploadBuffer::UploadToTexture(Texture& dstTexture, void* data, ID3D12GraphicsCommandList* pCommandList)
+bool UploadBuffer::UploadToTexture(Texture& dstTexture, const void* data, ID3D12GraphicsCommandList* pCommandList)
 {
     if (!dstTexture.GetResource())
         return false; // There is nowhere to copy to.
@@ -186,7 +189,106 @@ bool UploadBuffer::UploadToTexture(Texture& dstTexture, void* data, ID3D12Graphi
     return true;
 }
 
-bool UploadBuffer::UploadToMesh(ID3D12GraphicsCommandList* pCommandList, Mesh& dstMesh, void* vtxData, UINT vtxDataSize, void* idxData, UINT idxDataSize)
+// Same as UploadToTexture, but fills every mip level. mipData[i] holds mip i, tightly packed.
+bool UploadBuffer::UploadMipsToTexture(Texture& dstTexture, const void* const* mipData, UINT mipCount, ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!dstTexture.GetResource() || !mipData || mipCount == 0 || mipCount > dstTexture.GetMipLevels())
+        return false;
+
+    const size_t bitsPerPixel = DirectX::BitsPerPixel(dstTexture.GetFormat());
+    const size_t bytesPerPixel = bitsPerPixel / 8;
+
+    std::vector<D3D12_SUBRESOURCE_DATA> subresourceData(mipCount);
+    for (UINT mip = 0; mip < mipCount; ++mip)
+    {
+        size_t mipWidth = std::max<size_t>(1, dstTexture.GetWidth() >> mip);
+        size_t mipHeight = std::max<size_t>(1, dstTexture.GetHeight() >> mip);
+
+        subresourceData[mip].pData = mipData[mip];
+        subresourceData[mip].RowPitch = mipWidth * bytesPerPixel;
+        subresourceData[mip].SlicePitch = mipWidth * mipHeight * bytesPerPixel;
+    }
+
+    UINT64 requiredSize = GetRequiredIntermediateSize(dstTexture.GetResource(), 0, mipCount);
+    if (requiredSize > GetBufferSize())
+    {
+        Muon::Printf("Error: Upload Buffer is too small for a %u mip texture (%llu bytes needed).\n", mipCount, requiredSize);
+        return false;
+    }
+
+    UpdateSubresources(pCommandList, dstTexture.GetResource(), this->GetResource(), 0, 0, mipCount, subresourceData.data());
+
+    CD3DX12_RESOURCE_BARRIER barrier = CD3DX12_RESOURCE_BARRIER::Transition(
+        dstTexture.GetResource(),
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE
+    );
+    pCommandList->ResourceBarrier(1, &barrier);
+
+    return true;
+}
+
+// Copies depth slices [firstSlice, firstSlice + sliceCount) of a 3D texture. volumeData is the whole volume, tightly packed.
+// Each slice is staged at its own offset so the buffer can be rewritten every frame for different slices.
+// The texture must already be in COPY_DEST; the caller owns the transitions.
+bool UploadBuffer::UploadSlicesToTexture(Texture& dstTexture, const void* volumeData, UINT firstSlice, UINT sliceCount, ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!dstTexture.GetResource() || !volumeData || !mMappedPtr || sliceCount == 0 || firstSlice + sliceCount > dstTexture.GetDepth())
+        return false;
+
+    const size_t bytesPerPixel = DirectX::BitsPerPixel(dstTexture.GetFormat()) / 8;
+    const size_t rowSize = dstTexture.GetWidth() * bytesPerPixel;
+    const size_t rowPitch = Muon::AlignToBoundary((UINT)rowSize, D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    const size_t slicePitch = Muon::AlignToBoundary((UINT)(rowPitch * dstTexture.GetHeight()), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+
+    if ((firstSlice + sliceCount) * slicePitch > GetBufferSize())
+    {
+        Muon::Printf("Error: Upload Buffer is too small to stage slices %u-%u.\n", firstSlice, firstSlice + sliceCount - 1);
+        return false;
+    }
+
+    const UINT8* pSrc = static_cast<const UINT8*>(volumeData);
+    for (UINT slice = firstSlice; slice < firstSlice + sliceCount; ++slice)
+    {
+        for (UINT row = 0; row < dstTexture.GetHeight(); ++row)
+        {
+            memcpy(mMappedPtr + slice * slicePitch + row * rowPitch,
+                   pSrc + ((size_t)slice * dstTexture.GetHeight() + row) * rowSize,
+                   rowSize);
+        }
+    }
+
+    D3D12_PLACED_SUBRESOURCE_FOOTPRINT footprint = {};
+    footprint.Offset = firstSlice * slicePitch;
+    footprint.Footprint.Format = dstTexture.GetFormat();
+    footprint.Footprint.Width = dstTexture.GetWidth();
+    footprint.Footprint.Height = dstTexture.GetHeight();
+    footprint.Footprint.Depth = sliceCount;
+    footprint.Footprint.RowPitch = (UINT)rowPitch;
+
+    // Slices are slicePitch apart in the buffer, but a placed footprint assumes rowPitch * height. Copy one slice at a time unless they match.
+    if (slicePitch == rowPitch * dstTexture.GetHeight())
+    {
+        CD3DX12_TEXTURE_COPY_LOCATION dst(dstTexture.GetResource(), 0);
+        CD3DX12_TEXTURE_COPY_LOCATION src(this->GetResource(), footprint);
+        pCommandList->CopyTextureRegion(&dst, 0, 0, firstSlice, &src, nullptr);
+    }
+    else
+    {
+        footprint.Footprint.Depth = 1;
+        for (UINT slice = firstSlice; slice < firstSlice + sliceCount; ++slice)
+        {
+            footprint.Offset = slice * slicePitch;
+            CD3DX12_TEXTURE_COPY_LOCATION dst(dstTexture.GetResource(), 0);
+            CD3DX12_TEXTURE_COPY_LOCATION src(this->GetResource(), footprint);
+            pCommandList->CopyTextureRegion(&dst, 0, 0, slice, &src, nullptr);
+        }
+    }
+
+    return true;
+}
+
+bool UploadBuffer::UploadToMesh(ID3D12GraphicsCommandList* pCommandList, Mesh& dstMesh, const void* vtxData, UINT vtxDataSize, const void* idxData, UINT idxDataSize)
 {
     // DX12 needs 512-byte aligned insertions
     const UINT necessaryAlignment = D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT;
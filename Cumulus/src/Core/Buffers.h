@@ -58,8 +58,10 @@ struct UploadBuffer : Buffer
     bool CanAllocate(UINT desiredSize, UINT alignment);
     bool Allocate(UINT desiredSize, UINT alignment, void*& out_mappedPtr, D3D12_GPU_VIRTUAL_ADDRESS& out_gpuAddr, UINT& out_offset);
 
-    bool UploadToTexture(Texture& dstTexture, void* data, ID3D12GraphicsCommandList* pCommandList);
-    bool UploadToMesh(ID3D12GraphicsCommandList* pCommandList, Mesh& dstMesh, void* vtxData, UINT vtxDataSize, void* idxData = nullptr, UINT idxDataSize = 0);
+    bool UploadToTexture(Texture& dstTexture, const void* data, ID3D12GraphicsCommandList* pCommandList);
+    bool UploadMipsToTexture(Texture& dstTexture, const void* const* mipData, UINT mipCount, ID3D12GraphicsCommandList* pCommandList);
+    bool UploadSlicesToTexture(Texture& dstTexture, const void* volumeData, UINT firstSlice, UINT sliceCount, ID3D12GraphicsCommandList* pCommandList);
+    bool UploadToMesh(ID3D12GraphicsCommandList* pCommandList, Mesh& dstMesh, const void* vtxData, UINT vtxDataSize, const void* idxData = nullptr, UINT idxDataSize = 0);
 
 private:
     UINT8* mMappedPtr = nullptr;
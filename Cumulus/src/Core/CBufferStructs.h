@@ -59,28 +59,11 @@ struct alignas(256) cbIntersections
     AABB aabbs[1];
 };
 
-struct alignas(16) cbConvexHull
+// Counts for the hull registry's structured buffers, see Muon::HullRegistry
+struct alignas(16) cbHullRegistryParams
 {
-    uint32_t buffer1;
-    uint32_t buffer2;
-
-    uint32_t faceOffset;
-    uint32_t faceCount;
-
-    DirectX::XMFLOAT4X4 world;
-    DirectX::XMFLOAT4X4 invWorld;
-};
-
-struct alignas(16) cbHulls
-{
-    uint32_t hullCount;
-    cbConvexHull hulls[1];
-};
-
-
-struct alignas(16) cbHullFaces
-{
-    DirectX::XMFLOAT4 faces[1024];
+    uint32_t hullInstanceCount;
+    uint32_t hullBoundsCount;
 };
 
 struct alignas(16) cbHullPoints
@@ -110,6 +93,76 @@ struct alignas(16) cbAtmosphere
     float pad3;
 };
 
+struct alignas(16) cbCloudParams
+{
+    DirectX::XMFLOAT4X4 prevViewProj;
+    DirectX::XMUINT2 fullResolution;
+    DirectX::XMUINT2 marchResolution;
+    DirectX::XMINT2 marchPixelOffset;
+    uint32_t resolutionDivisor;
+    uint32_t temporalEnabled;
+    uint32_t historyValid;
+    uint32_t frameIndex;
+    float stepSizeScale;
+    uint32_t sunShadowValid;
+    DirectX::XMFLOAT3 sunDirection;
+    uint32_t scatteringLutValid;
+    DirectX::XMFLOAT3 panoramaOrigin;
+    float farFieldDistance;
+    uint32_t panoramaValid;
+    uint32_t coneStartValid;
+    uint32_t rayIntervalValid;
+    uint32_t tileBudgetEnabled;
+    uint32_t tileBudgetValid;
+    uint32_t hullTilesValid;
+    uint32_t meshSdfValid;
+};
+
+struct alignas(16) cbBeerShadowParams
+{
+    DirectX::XMFLOAT3 sunMapOrigin;
+    float sunMapExtent;
+    DirectX::XMFLOAT3 sunMapRight;
+    float sunMapDepthRange;
+    DirectX::XMFLOAT3 sunMapUp;
+    uint32_t beerShadowValid;
+    DirectX::XMFLOAT3 sunMapForward;
+    uint32_t beerShadowResolution;
+};
+
+// Sized for Muon::MAX_CLOUD_BRICKS
+struct alignas(16) cbCloudBricks
+{
+    DirectX::XMFLOAT4 brickMin[1024];
+    DirectX::XMFLOAT4 brickMax[1024];
+    uint32_t brickCount;
+};
+
+// Sized for Muon::MAX_CLOUD_INSTANCES. Instances are stored in BVH leaf order.
+struct alignas(16) cbCloudInstances
+{
+    DirectX::XMFLOAT4 instanceToLocal[256 * 3]; // Rows of the world to NVDF volume transform
+    DirectX::XMFLOAT4 instanceParams[256];      // x: scale, y: density multiplier, z: NVDF slot
+    DirectX::XMFLOAT4 bvhNodeMin[511];          // w: first instance or left child, as uint
+    DirectX::XMFLOAT4 bvhNodeMax[511];          // w: instance count, 0 for inner nodes, as uint
+    uint32_t cloudInstanceCount;
+};
+
+struct alignas(16) cbCloudPanoramaParams
+{
+    DirectX::XMFLOAT3 sweepOrigin;
+    float sweepFarFieldDistance;
+    uint32_t panoramaResolution;
+    uint32_t rowBegin;
+    uint32_t rowEnd;
+};
+
+struct alignas(16) cbSkyAmbient
+{
+    DirectX::XMFLOAT4 skySH[9]; // rgb = L2 SH coefficient, see Muon::ProjectSkyAmbientSH
+    uint32_t skyAmbientValid;
+};
+
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,75 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CloudDistanceBounds.h
+----------------------------------------------*/
+#include "CloudDistanceBounds.h"
+
+#include <Core/DescriptorHeap.h>
+#include <Utils/Utils.h>
+
+namespace Muon
+{
+
+bool CloudDistanceBounds::Init(ID3D12Device* pDevice, const CloudDensityGrid* pDensityGrid)
+{
+    if (!pDensityGrid || pDensityGrid->emptyDistance.empty())
+    {
+        Printf(L"Error: CloudDistanceBounds needs a cloud density grid with empty distances!\n");
+        return false;
+    }
+
+    mpDensityGrid = pDensityGrid;
+
+    const UINT width = pDensityGrid->width;
+    const UINT height = pDensityGrid->height;
+    const UINT depth = pDensityGrid->depth;
+
+    if (!mTexture.Create(L"CloudDistanceBounds", pDevice, width, height, depth, DXGI_FORMAT_R32_FLOAT, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST))
+    {
+        Printf(L"Error: Failed to create the cloud distance bounds texture!\n");
+        return false;
+    }
+    mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+    if (!mTexture.InitSRV(pDevice, GetSRVHeap()))
+    {
+        Printf(L"Error: Failed to create the cloud distance bounds SRV!\n");
+        return false;
+    }
+
+    // Room for every slice at its own offset, see UploadBuffer::UploadSlicesToTexture
+    const size_t rowPitch = AlignToBoundary(width * (UINT)sizeof(float), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    const size_t slicePitch = AlignToBoundary((UINT)(rowPitch * height), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    mStagingBuffer.Create(L"Cloud Distance Bounds Staging Buffer", slicePitch * depth);
+
+    mHasUploaded = false;
+    return true;
+}
+
+void CloudDistanceBounds::Destroy()
+{
+    mTexture.Destroy();
+    mStagingBuffer.Destroy();
+    mpDensityGrid = nullptr;
+    mHasUploaded = false;
+}
+
+void CloudDistanceBounds::RecordUpload(ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!mTexture.GetResource() || !mpDensityGrid || mHasUploaded)
+        return;
+
+    if (!mStagingBuffer.UploadSlicesToTexture(mTexture, mpDensityGrid->emptyDistance.data(), 0, mpDensityGrid->depth, pCommandList))
+    {
+        Printf(L"Warning: Failed to upload the cloud distance bounds\n");
+        return;
+    }
+
+    pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mTexture.GetResource(),
+        mTextureState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+    mTextureState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    mHasUploaded = true;
+}
+
+}
@@ -0,0 +1,42 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Lower bound on the distance to the nearest cloud, per coarse
+cell of the density grid. Uploaded once and traced by the cone march prepass
+(CloudConeMarch.cs) to find where each screen tile's rays can start.
+----------------------------------------------*/
+#ifndef MUON_CLOUDDISTANCEBOUNDS_H
+#define MUON_CLOUDDISTANCEBOUNDS_H
+
+#include <Core/Buffers.h>
+#include <Core/Texture.h>
+#include <Utils/CloudLightingUtils.h>
+
+namespace Muon
+{
+
+class CloudDistanceBounds
+{
+public:
+    // The volume matches the density grid's resolution and layout
+    bool Init(ID3D12Device* pDevice, const CloudDensityGrid* pDensityGrid);
+    void Destroy();
+
+    // Records the one time copy of the grid. The texture is left in NON_PIXEL_SHADER_RESOURCE.
+    void RecordUpload(ID3D12GraphicsCommandList* pCommandList);
+
+    bool IsValid() const { return mHasUploaded; }
+    const Texture& GetTexture() const { return mTexture; }
+
+private:
+    const CloudDensityGrid* mpDensityGrid = nullptr;
+
+    Texture mTexture;
+    UploadBuffer mStagingBuffer;
+    D3D12_RESOURCE_STATES mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+    bool mHasUploaded = false;
+};
+
+}
+
+#endif
@@ -0,0 +1,161 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CloudPanorama.h
+----------------------------------------------*/
+#include "CloudPanorama.h"
+
+#include <Core/DescriptorHeap.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+
+namespace
+{
+    // Same as the sun shadow volume, smaller sun movements don't visibly change the lighting
+    static const float SUN_DIRECTION_TOLERANCE_COS = 0.99999f;
+
+    // While a new sweep is in flight the old bake is still used, until the camera is this many tolerances away from it
+    static const float FRONT_RANGE_TOLERANCE_SCALE = 4.0f;
+
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    float Distance(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        DirectX::XMFLOAT3 d(a.x - b.x, a.y - b.y, a.z - b.z);
+        return sqrtf(Dot(d, d));
+    }
+}
+
+bool CloudPanorama::Init(ID3D12Device* pDevice)
+{
+    const wchar_t* TEXTURE_NAMES[2] = { L"CloudPanorama0", L"CloudPanorama1" };
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        bool success = mTextures[i].Create(TEXTURE_NAMES[i], pDevice, CLOUD_PANORAMA_RESOLUTION, CLOUD_PANORAMA_RESOLUTION, 1,
+            DXGI_FORMAT_R16G16B16A16_FLOAT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+        if (success)
+            success &= mTextures[i].InitSRV(pDevice, GetSRVHeap());
+        if (success)
+            success &= mTextures[i].InitUAV(pDevice, GetSRVHeap());
+
+        if (!success)
+        {
+            Printf(L"Error: Failed to create %s!\n", TEXTURE_NAMES[i]);
+            return false;
+        }
+    }
+
+    mParamsBuffer.Create(L"Cloud Panorama Params", sizeof(cbCloudPanoramaParams));
+
+    mFrontIndex = 0;
+    mHasBaked = false;
+    mFrontInRange = false;
+    mSweepActive = false;
+    mNextRow = 0;
+    mBakeRowBegin = mBakeRowEnd = 0;
+    return true;
+}
+
+void CloudPanorama::Destroy()
+{
+    mTextures[0].Destroy();
+    mTextures[1].Destroy();
+    mParamsBuffer.Destroy();
+    mHasBaked = false;
+    mSweepActive = false;
+}
+
+void CloudPanorama::Update(const DirectX::XMFLOAT3& cameraPosWS, const DirectX::XMFLOAT3& sunDirWS, float farFieldDistance, float moveTolerance, uint32_t rowBudget)
+{
+    mBakeRowBegin = mBakeRowEnd = 0;
+    if (!mTextures[0].GetResource() || !mTextures[1].GetResource())
+        return;
+
+    const bool isStale = !mHasBaked ||
+        Distance(cameraPosWS, mFrontOrigin) > moveTolerance ||
+        Dot(sunDirWS, mSweepSunDir) < SUN_DIRECTION_TOLERANCE_COS ||
+        farFieldDistance != mFrontFarFieldDistance;
+
+    // Like the sun shadow volume, a sweep in flight always finishes against what it started with
+    if (!mSweepActive && isStale)
+    {
+        mSweep.sweepOrigin = cameraPosWS;
+        mSweep.sweepFarFieldDistance = farFieldDistance;
+        mSweep.panoramaResolution = CLOUD_PANORAMA_RESOLUTION;
+        mSweepSunDir = sunDirWS;
+        mNextRow = 0;
+        mSweepActive = true;
+    }
+
+    mFrontInRange = mFrontFarFieldDistance == farFieldDistance &&
+        Distance(cameraPosWS, mFrontOrigin) <= moveTolerance * FRONT_RANGE_TOLERANCE_SCALE;
+
+    if (!mSweepActive)
+        return;
+
+    mBakeRowBegin = mNextRow;
+    mBakeRowEnd = std::min(mNextRow + std::max(rowBudget, 1u), CLOUD_PANORAMA_RESOLUTION);
+}
+
+void CloudPanorama::RecordBake(const ComputePass& pass, ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!IsBakeDue())
+        return;
+
+    const uint32_t backIndex = 1 - mFrontIndex;
+    Texture& backTexture = mTextures[backIndex];
+
+    mSweep.rowBegin = mBakeRowBegin;
+    mSweep.rowEnd = mBakeRowEnd;
+
+    UINT8* mapped = mParamsBuffer.GetMappedPtr();
+    if (mapped)
+        memcpy(mapped, &mSweep, sizeof(cbCloudPanoramaParams));
+
+    int32_t paramsIdx = pass.GetResourceRootIndex("CloudPanoramaParams");
+    if (paramsIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(paramsIdx, mParamsBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t outputIdx = pass.GetResourceRootIndex("gCloudPanorama");
+    if (outputIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(outputIdx, backTexture.GetUAVHandleGPU());
+    }
+
+    pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(backTexture.GetResource(),
+        D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+    UINT numGroupsX = (UINT)ceilf(CLOUD_PANORAMA_RESOLUTION / 8.0f);
+    UINT numGroupsY = (UINT)ceilf((mBakeRowEnd - mBakeRowBegin) / 8.0f);
+    pCommandList->Dispatch(numGroupsX, numGroupsY, 1);
+
+    pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(backTexture.GetResource(),
+        D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ));
+
+    mNextRow = mBakeRowEnd;
+    mBakeRowBegin = mBakeRowEnd = 0;
+
+    // The last band is recorded before this frame's raymarch, so the new bake can be read right away
+    if (mNextRow >= CLOUD_PANORAMA_RESOLUTION)
+    {
+        mFrontIndex = backIndex;
+        mFrontOrigin = mSweep.sweepOrigin;
+        mFrontFarFieldDistance = mSweep.sweepFarFieldDistance;
+        mHasBaked = true;
+        mFrontInRange = true;
+        mSweepActive = false;
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Far-field cloud panorama around the camera.
+An octahedral map of the clouds past the far-field distance, so sky rays can
+stop marching there. Re-baked a band of rows per frame into a back buffer once
+the camera has moved away from where the current one was baked, then swapped.
+----------------------------------------------*/
+#ifndef MUON_CLOUDPANORAMA_H
+#define MUON_CLOUDPANORAMA_H
+
+#include <Core/Buffers.h>
+#include <Core/CBufferStructs.h>
+#include <Core/Pass.h>
+#include <Core/Texture.h>
+
+namespace Muon
+{
+
+static const uint32_t CLOUD_PANORAMA_RESOLUTION = 512;
+
+class CloudPanorama
+{
+public:
+    bool Init(ID3D12Device* pDevice);
+    void Destroy();
+
+    // Call once per frame. Starts a new sweep once the camera is further than moveTolerance from the current bake,
+    // or the sun or far-field distance changed, then schedules up to rowBudget rows of it for RecordBake.
+    void Update(const DirectX::XMFLOAT3& cameraPosWS, const DirectX::XMFLOAT3& sunDirWS, float farFieldDistance, float moveTolerance, uint32_t rowBudget);
+
+    bool IsBakeDue() const { return mBakeRowEnd > mBakeRowBegin; }
+
+    // Records this frame's rows with CloudPanorama.cs. The pass must be bound with the cloud volume resources already.
+    // Swaps the buffers when the sweep completes, so query the accessors below afterwards.
+    void RecordBake(const ComputePass& pass, ID3D12GraphicsCommandList* pCommandList);
+
+    // A finished bake exists and the camera is still close enough to its origin for it to line up
+    bool IsValid() const { return mHasBaked && mFrontInRange; }
+    const Texture& GetTexture() const { return mTextures[mFrontIndex]; }
+    const DirectX::XMFLOAT3& GetOrigin() const { return mFrontOrigin; }
+    float GetFarFieldDistance() const { return mFrontFarFieldDistance; }
+
+private:
+    Texture mTextures[2];
+    UploadBuffer mParamsBuffer;
+    uint32_t mFrontIndex = 0;
+
+    DirectX::XMFLOAT3 mFrontOrigin = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+    float mFrontFarFieldDistance = 0.0f;
+    bool mHasBaked = false;
+    bool mFrontInRange = false;
+
+    // Sweep being baked into the back buffer
+    cbCloudPanoramaParams mSweep = {};
+    DirectX::XMFLOAT3 mSweepSunDir = DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+    uint32_t mNextRow = 0;
+    bool mSweepActive = false;
+
+    // Rows scheduled for this frame's dispatch
+    uint32_t mBakeRowBegin = 0;
+    uint32_t mBakeRowEnd = 0;
+};
+
+}
+
+#endif
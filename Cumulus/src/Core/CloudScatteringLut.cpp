@@ -0,0 +1,92 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CloudScatteringLut.h
+----------------------------------------------*/
+#include "CloudScatteringLut.h"
+
+#include <Core/DescriptorHeap.h>
+#include <Utils/Utils.h>
+
+namespace Muon
+{
+
+bool CloudScatteringLut::Init(ID3D12Device* pDevice)
+{
+    const UINT width = CLOUD_SCATTERING_LUT_WIDTH;
+    const UINT height = CLOUD_SCATTERING_LUT_HEIGHT;
+
+    if (!mTexture.Create(L"CloudScatteringLut", pDevice, width, height, 1, DXGI_FORMAT_R32_FLOAT, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST))
+    {
+        Printf(L"Error: Failed to create the cloud scattering LUT texture!\n");
+        return false;
+    }
+    mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+    if (!mTexture.InitSRV(pDevice, GetSRVHeap()))
+    {
+        Printf(L"Error: Failed to create the cloud scattering LUT SRV!\n");
+        return false;
+    }
+
+    const size_t rowPitch = AlignToBoundary(width * (UINT)sizeof(float), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    mStagingBuffer.Create(L"Cloud Scattering LUT Staging Buffer", rowPitch * height);
+
+    mHasBuilt = false;
+    mUploadPending = false;
+    return true;
+}
+
+void CloudScatteringLut::Destroy()
+{
+    mTexture.Destroy();
+    mStagingBuffer.Destroy();
+    mTexels.clear();
+    mHasBuilt = false;
+    mUploadPending = false;
+}
+
+void CloudScatteringLut::Update(const CloudScatteringParams& params)
+{
+    if (!mTexture.GetResource())
+        return;
+
+    if (mHasBuilt && CloudScatteringParamsMatch(params, mParams))
+        return;
+
+    mParams = params;
+    BuildCloudScatteringLut(mParams, mTexels);
+    mHasBuilt = true;
+    mUploadPending = true;
+}
+
+void CloudScatteringLut::RecordUpload(ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!mTexture.GetResource())
+        return;
+
+    if (mUploadPending)
+    {
+        if (mTextureState != D3D12_RESOURCE_STATE_COPY_DEST)
+        {
+            pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mTexture.GetResource(),
+                mTextureState, D3D12_RESOURCE_STATE_COPY_DEST));
+            mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+        }
+
+        // A 2D texture is a volume with a single slice
+        if (!mStagingBuffer.UploadSlicesToTexture(mTexture, mTexels.data(), 0, 1, pCommandList))
+            Printf(L"Warning: Failed to upload the cloud scattering LUT\n");
+
+        mUploadPending = false;
+    }
+
+    if (mTextureState != D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE)
+    {
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mTexture.GetResource(),
+            mTextureState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+        mTextureState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    }
+}
+
+}
@@ -0,0 +1,48 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Phase function and multiple scattering lookup table for the
+cloud raymarch, indexed by cos theta and sun optical depth.
+Built on the CPU and only rebuilt when the scattering parameters change.
+----------------------------------------------*/
+#ifndef MUON_CLOUDSCATTERINGLUT_H
+#define MUON_CLOUDSCATTERINGLUT_H
+
+#include <Core/Buffers.h>
+#include <Core/Texture.h>
+#include <Utils/CloudLightingUtils.h>
+
+#include <vector>
+
+namespace Muon
+{
+
+class CloudScatteringLut
+{
+public:
+    bool Init(ID3D12Device* pDevice);
+    void Destroy();
+
+    // Call once per frame, rebuilds the table if the params differ from the ones it was last built with
+    void Update(const CloudScatteringParams& params);
+
+    // Records the copy of a rebuilt table. The texture is left in NON_PIXEL_SHADER_RESOURCE.
+    void RecordUpload(ID3D12GraphicsCommandList* pCommandList);
+
+    bool IsValid() const { return mHasBuilt; }
+    const Texture& GetTexture() const { return mTexture; }
+
+private:
+    Texture mTexture;
+    UploadBuffer mStagingBuffer;
+    D3D12_RESOURCE_STATES mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+    std::vector<float> mTexels;
+    CloudScatteringParams mParams;
+    bool mHasBuilt = false;
+    bool mUploadPending = false;
+};
+
+}
+
+#endif
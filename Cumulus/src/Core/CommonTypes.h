@@ -31,20 +31,6 @@ namespace Muon
         float distance;
         DirectX::XMFLOAT3A normal;
     };
-
-    struct Edge {
-        int v0, v1;
-
-        bool operator==(Edge const& other) const {
-            return v0 == other.v0 && v1 == other.v1;
-        }
-    };
-
-    struct EdgeHash {
-        size_t operator()(Edge const& e) const noexcept {
-            return (size_t(e.v0) << 32) ^ size_t(e.v1);
-        }
-    };
 }
 
 #endif
\ No newline at end of file
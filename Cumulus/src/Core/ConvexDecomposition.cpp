@@ -0,0 +1,588 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of ConvexDecomposition.h
+----------------------------------------------*/
+#include <Core/ConvexDecomposition.h>
+
+#include <Utils/ParallelUtils.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    static const uint8_t VOXEL_INTERIOR = 0; // Anything the flood fill from the border didn't reach
+    static const uint8_t VOXEL_SURFACE = 1;
+    static const uint8_t VOXEL_OUTSIDE = 2;
+    static const uint32_t VOXEL_BORDER = 2;
+
+    struct Vec3d
+    {
+        double v[3];
+    };
+
+    // Voxels around the mesh bounds, x fastest then y then z. The border is two voxels deep since surface lying
+    // exactly on the bounds marks the first, and the outside has to stay connected around it.
+    struct VoxelGrid
+    {
+        uint32_t dims[3] = { 0, 0, 0 };
+        float origin[3] = { 0.0f, 0.0f, 0.0f };
+        float cellSize = 0.0f;
+        std::vector<uint8_t> voxels;
+
+        size_t Index(uint32_t x, uint32_t y, uint32_t z) const { return ((size_t)z * dims[1] + y) * dims[0] + x; }
+        bool IsSolid(uint32_t x, uint32_t y, uint32_t z) const { return voxels[Index(x, y, z)] != VOXEL_OUTSIDE; }
+    };
+
+    // Voxel ranges [lo, hi) on each axis
+    struct VoxelBox
+    {
+        uint32_t lo[3];
+        uint32_t hi[3];
+    };
+
+    struct Piece
+    {
+        VoxelBox box;
+        float hullVolume = 0.0f;
+        float emptyVolume = 0.0f; // Hull volume the voxels don't fill
+        bool splittable = true;
+    };
+
+    struct Cut
+    {
+        uint32_t piece;
+        int axis;
+        uint32_t position;
+        bool valid = false;
+        Piece halves[2];
+    };
+
+    // Separating axis test between a triangle and an axis aligned box (Akenine-Moller)
+    bool TriangleOverlapsBox(const double center[3], double halfSize, const aiVector3D& a, const aiVector3D& b, const aiVector3D& c)
+    {
+        double v[3][3];
+        for (int i = 0; i < 3; ++i)
+        {
+            v[0][i] = (double)a[i] - center[i];
+            v[1][i] = (double)b[i] - center[i];
+            v[2][i] = (double)c[i] - center[i];
+        }
+
+        double e[3][3];
+        for (int i = 0; i < 3; ++i)
+        {
+            e[0][i] = v[1][i] - v[0][i];
+            e[1][i] = v[2][i] - v[1][i];
+            e[2][i] = v[0][i] - v[2][i];
+        }
+
+        // Cross products of the triangle edges with the box axes
+        for (int edge = 0; edge < 3; ++edge)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                double dir[3] = { 0.0, 0.0, 0.0 };
+                const int u = (axis + 1) % 3;
+                const int w = (axis + 2) % 3;
+                dir[u] = -e[edge][w];
+                dir[w] = e[edge][u];
+
+                double minP = DBL_MAX, maxP = -DBL_MAX;
+                for (int i = 0; i < 3; ++i)
+                {
+                    double p = dir[0] * v[i][0] + dir[1] * v[i][1] + dir[2] * v[i][2];
+                    minP = std::min(minP, p);
+                    maxP = std::max(maxP, p);
+                }
+
+                double radius = halfSize * (fabs(dir[0]) + fabs(dir[1]) + fabs(dir[2]));
+                if (minP > radius || maxP < -radius)
+                    return false;
+            }
+        }
+
+        // Box faces
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            double minP = std::min(v[0][axis], std::min(v[1][axis], v[2][axis]));
+            double maxP = std::max(v[0][axis], std::max(v[1][axis], v[2][axis]));
+            if (minP > halfSize || maxP < -halfSize)
+                return false;
+        }
+
+        // Triangle plane
+        double n[3] = {
+            e[0][1] * e[1][2] - e[0][2] * e[1][1],
+            e[0][2] * e[1][0] - e[0][0] * e[1][2],
+            e[0][0] * e[1][1] - e[0][1] * e[1][0]
+        };
+        double d = n[0] * v[0][0] + n[1] * v[0][1] + n[2] * v[0][2];
+        double radius = halfSize * (fabs(n[0]) + fabs(n[1]) + fabs(n[2]));
+        return fabs(d) <= radius;
+    }
+
+    bool Voxelize(const aiVector3D* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, uint32_t resolution, VoxelGrid& out_grid)
+    {
+        float minP[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+        float maxP[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+        for (uint32_t i = 0; i < vertexCount; ++i)
+        {
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                minP[axis] = std::min(minP[axis], vertices[i][axis]);
+                maxP[axis] = std::max(maxP[axis], vertices[i][axis]);
+            }
+        }
+
+        float longest = std::max(maxP[0] - minP[0], std::max(maxP[1] - minP[1], maxP[2] - minP[2]));
+        if (!(longest > 0.0f) || resolution == 0)
+            return false;
+
+        out_grid.cellSize = longest / (float)resolution;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            uint32_t cells = std::max(1u, (uint32_t)ceilf((maxP[axis] - minP[axis]) / out_grid.cellSize));
+            out_grid.dims[axis] = cells + 2 * VOXEL_BORDER;
+            out_grid.origin[axis] = minP[axis] - VOXEL_BORDER * out_grid.cellSize;
+        }
+        out_grid.voxels.assign((size_t)out_grid.dims[0] * out_grid.dims[1] * out_grid.dims[2], VOXEL_INTERIOR);
+
+        // Slightly grown so triangles lying exactly on a voxel face mark both sides
+        const double halfSize = 0.5 * (double)out_grid.cellSize * (1.0 + 1e-4);
+        for (uint32_t t = 0; t + 2 < indexCount; t += 3)
+        {
+            const aiVector3D& a = vertices[indices[t]];
+            const aiVector3D& b = vertices[indices[t + 1]];
+            const aiVector3D& c = vertices[indices[t + 2]];
+
+            uint32_t lo[3], hi[3];
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                float triMin = std::min(a[axis], std::min(b[axis], c[axis]));
+                float triMax = std::max(a[axis], std::max(b[axis], c[axis]));
+                lo[axis] = (uint32_t)std::max(0.0f, floorf((triMin - out_grid.origin[axis]) / out_grid.cellSize) - 1.0f);
+                hi[axis] = std::min(out_grid.dims[axis] - 1, (uint32_t)((triMax - out_grid.origin[axis]) / out_grid.cellSize) + 1);
+            }
+
+            for (uint32_t z = lo[2]; z <= hi[2]; ++z)
+            {
+                for (uint32_t y = lo[1]; y <= hi[1]; ++y)
+                {
+                    for (uint32_t x = lo[0]; x <= hi[0]; ++x)
+                    {
+                        uint8_t& voxel = out_grid.voxels[out_grid.Index(x, y, z)];
+                        if (voxel == VOXEL_SURFACE)
+                            continue;
+
+                        const double center[3] = {
+                            out_grid.origin[0] + (x + 0.5) * out_grid.cellSize,
+                            out_grid.origin[1] + (y + 0.5) * out_grid.cellSize,
+                            out_grid.origin[2] + (z + 0.5) * out_grid.cellSize
+                        };
+                        if (TriangleOverlapsBox(center, halfSize, a, b, c))
+                            voxel = VOXEL_SURFACE;
+                    }
+                }
+            }
+        }
+
+        // Flood the outside in from the border, whatever it can't reach is inside the mesh
+        std::vector<size_t> stack;
+        stack.push_back(0);
+        out_grid.voxels[0] = VOXEL_OUTSIDE;
+        const uint32_t* dims = out_grid.dims;
+        while (!stack.empty())
+        {
+            size_t index = stack.back();
+            stack.pop_back();
+
+            uint32_t x = (uint32_t)(index % dims[0]);
+            uint32_t y = (uint32_t)((index / dims[0]) % dims[1]);
+            uint32_t z = (uint32_t)(index / ((size_t)dims[0] * dims[1]));
+
+            auto Visit = [&](uint32_t nx, uint32_t ny, uint32_t nz)
+            {
+                uint8_t& voxel = out_grid.voxels[out_grid.Index(nx, ny, nz)];
+                if (voxel == VOXEL_INTERIOR)
+                {
+                    voxel = VOXEL_OUTSIDE;
+                    stack.push_back(out_grid.Index(nx, ny, nz));
+                }
+            };
+
+            if (x > 0) Visit(x - 1, y, z);
+            if (x + 1 < dims[0]) Visit(x + 1, y, z);
+            if (y > 0) Visit(x, y - 1, z);
+            if (y + 1 < dims[1]) Visit(x, y + 1, z);
+            if (z > 0) Visit(x, y, z - 1);
+            if (z + 1 < dims[2]) Visit(x, y, z + 1);
+        }
+
+        return true;
+    }
+
+    // Voxels in the box whose centers are inside the hull, found a row at a time from where each row crosses it
+    uint32_t CountVoxelsInHull(const VoxelGrid& grid, const VoxelBox& box, const Hull& hull)
+    {
+        uint32_t count = 0;
+        for (uint32_t z = box.lo[2]; z < box.hi[2]; ++z)
+        {
+            const float centerZ = grid.origin[2] + (z + 0.5f) * grid.cellSize;
+            for (uint32_t y = box.lo[1]; y < box.hi[1]; ++y)
+            {
+                const float centerY = grid.origin[1] + (y + 0.5f) * grid.cellSize;
+
+                // n.x * x + rest <= 0 for every face
+                float enter = -FLT_MAX, exit = FLT_MAX;
+                for (const HullFace& face : hull.faces)
+                {
+                    const float rest = face.normal.y * centerY + face.normal.z * centerZ + face.distance;
+                    if (face.normal.x > 1e-6f)
+                        exit = std::min(exit, -rest / face.normal.x);
+                    else if (face.normal.x < -1e-6f)
+                        enter = std::max(enter, -rest / face.normal.x);
+                    else if (rest > 1e-6f * grid.cellSize)
+                        enter = FLT_MAX;
+                }
+
+                // Centers sit at origin + (x + 0.5) * cellSize, allow a sliver for centers exactly on a face
+                const float slack = 1e-3f;
+                const float first = std::max((float)box.lo[0], ceilf((enter - grid.origin[0]) / grid.cellSize - 0.5f - slack));
+                const float last = std::min((float)box.hi[0] - 1.0f, floorf((exit - grid.origin[0]) / grid.cellSize - 0.5f + slack));
+                if (last >= first)
+                    count += (uint32_t)(last - first) + 1;
+            }
+        }
+        return count;
+    }
+
+    // Whether the points span a volume, found like the hull's initial simplex: the furthest point from the first, then
+    // from their line, then from that plane. Voxel centers off a plane through other centers are a good fraction of a
+    // cell away from it, so the tolerance can be loose.
+    bool SpansVolume(const std::vector<aiVector3D>& points, double tolerance)
+    {
+        if (points.size() < 4)
+            return false;
+
+        // Index of the point furthest from the first by the given measure, and that point relative to the first
+        auto FindFurthest = [&](const auto& Measure, Vec3d& out_offset)
+        {
+            double furthest = -1.0;
+            for (const aiVector3D& point : points)
+            {
+                const Vec3d offset = { { (double)point.x - points[0].x, (double)point.y - points[0].y, (double)point.z - points[0].z } };
+                const double measure = Measure(offset);
+                if (measure > furthest)
+                {
+                    furthest = measure;
+                    out_offset = offset;
+                }
+            }
+            return furthest;
+        };
+
+        auto Dot = [](const Vec3d& a, const Vec3d& b) { return a.v[0] * b.v[0] + a.v[1] * b.v[1] + a.v[2] * b.v[2]; };
+        auto Cross = [](const Vec3d& a, const Vec3d& b)
+        {
+            return Vec3d{ { a.v[1] * b.v[2] - a.v[2] * b.v[1], a.v[2] * b.v[0] - a.v[0] * b.v[2], a.v[0] * b.v[1] - a.v[1] * b.v[0] } };
+        };
+
+        Vec3d ab = {}, ac = {}, ad = {};
+        const double abLength = sqrt(FindFurthest([&](const Vec3d& p) { return Dot(p, p); }, ab));
+        if (abLength <= tolerance)
+            return false;
+
+        const Vec3d axis = { { ab.v[0] / abLength, ab.v[1] / abLength, ab.v[2] / abLength } };
+        if (sqrt(FindFurthest([&](const Vec3d& p) { const Vec3d c = Cross(p, axis); return Dot(c, c); }, ac)) <= tolerance)
+            return false;
+
+        Vec3d normal = Cross(axis, ac);
+        const double normalLength = sqrt(Dot(normal, normal));
+        normal = { { normal.v[0] / normalLength, normal.v[1] / normalLength, normal.v[2] / normalLength } };
+        return FindFurthest([&](const Vec3d& p) { return fabs(Dot(p, normal)); }, ad) > tolerance;
+    }
+
+    // Shrinks the box to the solid voxels inside it and measures how much empty space their hull takes in.
+    // Hulls voxel centers and counts the voxels centered inside, so neither side has the staircase and a convex
+    // mesh's voxels come out with almost no empty space. False if there are no solid voxels.
+    bool BuildPiece(const VoxelGrid& grid, const VoxelBox& box, Piece& out_piece)
+    {
+        std::vector<aiVector3D> centers;
+        uint32_t solidCount = 0;
+        VoxelBox tight = { { UINT32_MAX, UINT32_MAX, UINT32_MAX }, { 0, 0, 0 } };
+
+        // A row of voxels is inside the hull of its first and last voxel
+        for (uint32_t z = box.lo[2]; z < box.hi[2]; ++z)
+        {
+            for (uint32_t y = box.lo[1]; y < box.hi[1]; ++y)
+            {
+                uint32_t first = UINT32_MAX, last = 0;
+                for (uint32_t x = box.lo[0]; x < box.hi[0]; ++x)
+                {
+                    if (!grid.IsSolid(x, y, z))
+                        continue;
+
+                    first = std::min(first, x);
+                    last = x;
+                    ++solidCount;
+                }
+
+                if (first == UINT32_MAX)
+                    continue;
+
+                const float centerY = grid.origin[1] + (y + 0.5f) * grid.cellSize;
+                const float centerZ = grid.origin[2] + (z + 0.5f) * grid.cellSize;
+                centers.emplace_back(grid.origin[0] + (first + 0.5f) * grid.cellSize, centerY, centerZ);
+                centers.emplace_back(grid.origin[0] + (last + 0.5f) * grid.cellSize, centerY, centerZ);
+
+                const uint32_t rowLo[3] = { first, y, z };
+                const uint32_t rowHi[3] = { last + 1, y + 1, z + 1 };
+                for (int axis = 0; axis < 3; ++axis)
+                {
+                    tight.lo[axis] = std::min(tight.lo[axis], rowLo[axis]);
+                    tight.hi[axis] = std::max(tight.hi[axis], rowHi[axis]);
+                }
+            }
+        }
+
+        if (solidCount == 0)
+            return false;
+
+        out_piece.box = tight;
+        out_piece.splittable = (tight.hi[0] - tight.lo[0] > 1) || (tight.hi[1] - tight.lo[1] > 1) || (tight.hi[2] - tight.lo[2] > 1);
+
+        // Centers in a single row or plane have no hull, so count the whole box like an unbounded hull would. Checked up
+        // front since Hull reports flat input as an error, and every worker building cuts would hit it.
+        uint32_t hullCount = (tight.hi[0] - tight.lo[0]) * (tight.hi[1] - tight.lo[1]) * (tight.hi[2] - tight.lo[2]);
+        if (SpansVolume(centers, 1e-3 * grid.cellSize))
+        {
+            const Hull centerHull(centers.data(), (int)centers.size());
+            hullCount = std::max(solidCount, CountVoxelsInHull(grid, tight, centerHull));
+        }
+        const float voxelVolume = grid.cellSize * grid.cellSize * grid.cellSize;
+        out_piece.hullVolume = hullCount * voxelVolume;
+        out_piece.emptyVolume = (hullCount - solidCount) * voxelVolume;
+        return true;
+    }
+
+    // Clips a convex polygon to lo <= p[axis] (sign 1) or p[axis] <= hi (sign -1)
+    void ClipPolygon(std::vector<Vec3d>& polygon, std::vector<Vec3d>& scratch, int axis, double bound, double sign)
+    {
+        scratch.clear();
+        for (size_t i = 0; i < polygon.size(); ++i)
+        {
+            const Vec3d& a = polygon[i];
+            const Vec3d& b = polygon[(i + 1) % polygon.size()];
+            const double da = sign * (a.v[axis] - bound);
+            const double db = sign * (b.v[axis] - bound);
+
+            if (da >= 0.0)
+                scratch.push_back(a);
+
+            if ((da >= 0.0) != (db >= 0.0))
+            {
+                const double t = da / (da - db);
+                scratch.push_back({ { a.v[0] + (b.v[0] - a.v[0]) * t, a.v[1] + (b.v[1] - a.v[1]) * t, a.v[2] + (b.v[2] - a.v[2]) * t } });
+            }
+        }
+        polygon.swap(scratch);
+    }
+
+    // The hull handed out for a piece: the mesh's triangles clipped to the piece's box, plus the corners of its voxels
+    // that are entirely inside the mesh. Every bit of surface in a solid voxel ends up in the hull of that voxel's piece.
+    Hull BuildCoveringHull(const VoxelGrid& grid, const aiVector3D* vertices, const uint32_t* indices, uint32_t indexCount, const VoxelBox& box)
+    {
+        // Grown like the voxelization's boxes so surface exactly on a cut still lands on both sides
+        const double margin = 1e-4 * grid.cellSize;
+        double boxMin[3], boxMax[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            boxMin[axis] = grid.origin[axis] + (double)box.lo[axis] * grid.cellSize - margin;
+            boxMax[axis] = grid.origin[axis] + (double)box.hi[axis] * grid.cellSize + margin;
+        }
+
+        std::vector<aiVector3D> points;
+        std::vector<Vec3d> polygon, scratch;
+        for (uint32_t t = 0; t + 2 < indexCount; t += 3)
+        {
+            const aiVector3D* tri[3] = { &vertices[indices[t]], &vertices[indices[t + 1]], &vertices[indices[t + 2]] };
+
+            bool outside = false;
+            for (int axis = 0; axis < 3 && !outside; ++axis)
+            {
+                const double triMin = std::min((*tri[0])[axis], std::min((*tri[1])[axis], (*tri[2])[axis]));
+                const double triMax = std::max((*tri[0])[axis], std::max((*tri[1])[axis], (*tri[2])[axis]));
+                outside = triMax < boxMin[axis] || triMin > boxMax[axis];
+            }
+            if (outside)
+                continue;
+
+            polygon.clear();
+            for (const aiVector3D* v : tri)
+                polygon.push_back({ { (*v)[0], (*v)[1], (*v)[2] } });
+
+            for (int axis = 0; axis < 3 && !polygon.empty(); ++axis)
+            {
+                ClipPolygon(polygon, scratch, axis, boxMin[axis], 1.0);
+                ClipPolygon(polygon, scratch, axis, boxMax[axis], -1.0);
+            }
+
+            for (const Vec3d& p : polygon)
+                points.emplace_back((float)p.v[0], (float)p.v[1], (float)p.v[2]);
+        }
+
+        // Interior voxels, a row at a time like BuildPiece
+        auto AddCornerFace = [&](uint32_t x, uint32_t y, uint32_t z)
+        {
+            for (uint32_t dz = 0; dz < 2; ++dz)
+            {
+                for (uint32_t dy = 0; dy < 2; ++dy)
+                {
+                    points.emplace_back(grid.origin[0] + x * grid.cellSize,
+                                        grid.origin[1] + (y + dy) * grid.cellSize,
+                                        grid.origin[2] + (z + dz) * grid.cellSize);
+                }
+            }
+        };
+
+        for (uint32_t z = box.lo[2]; z < box.hi[2]; ++z)
+        {
+            for (uint32_t y = box.lo[1]; y < box.hi[1]; ++y)
+            {
+                uint32_t first = UINT32_MAX, last = 0;
+                for (uint32_t x = box.lo[0]; x < box.hi[0]; ++x)
+                {
+                    if (grid.voxels[grid.Index(x, y, z)] != VOXEL_INTERIOR)
+                        continue;
+
+                    first = std::min(first, x);
+                    last = x;
+                }
+
+                if (first == UINT32_MAX)
+                    continue;
+
+                AddCornerFace(first, y, z);
+                AddCornerFace(last + 1, y, z);
+            }
+        }
+
+        return Hull(points.data(), (int)points.size());
+    }
+}
+
+bool DecomposeConvex(const aiVector3D* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                     const ConvexDecompositionParams& params, std::vector<Hull>& out_hulls)
+{
+    out_hulls.clear();
+    if (!vertices || !indices || vertexCount == 0 || indexCount < 3)
+        return false;
+
+    VoxelGrid grid;
+    if (!Voxelize(vertices, vertexCount, indices, indexCount, params.voxelResolution, grid))
+    {
+        Printf(L"Error: Mesh has no extent to decompose!\n");
+        return false;
+    }
+
+    std::vector<Piece> pieces(1);
+    const VoxelBox all = { { 0, 0, 0 }, { grid.dims[0], grid.dims[1], grid.dims[2] } };
+    if (!BuildPiece(grid, all, pieces[0]))
+    {
+        Printf(L"Error: Mesh voxelized to nothing!\n");
+        return false;
+    }
+
+    const float maxEmptyVolume = params.concavityTolerance * pieces[0].hullVolume;
+    const uint32_t maxHulls = std::max(1u, params.maxHulls);
+
+    std::vector<uint32_t> toSplit;
+    std::vector<Cut> cuts;
+    while (pieces.size() < maxHulls)
+    {
+        // The emptiest pieces first, as many as the hull budget allows
+        toSplit.clear();
+        for (uint32_t i = 0; i < (uint32_t)pieces.size(); ++i)
+        {
+            if (pieces[i].splittable && pieces[i].emptyVolume > maxEmptyVolume)
+                toSplit.push_back(i);
+        }
+
+        if (toSplit.empty())
+            break;
+
+        std::sort(toSplit.begin(), toSplit.end(), [&](uint32_t a, uint32_t b) { return pieces[a].emptyVolume > pieces[b].emptyVolume; });
+        toSplit.resize(std::min(toSplit.size(), (size_t)(maxHulls - pieces.size())));
+
+        // Evenly spaced cuts across each axis of every piece, all evaluated at once
+        cuts.clear();
+        for (uint32_t p : toSplit)
+        {
+            const VoxelBox& box = pieces[p].box;
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const uint32_t extent = box.hi[axis] - box.lo[axis];
+                if (extent < 2)
+                    continue;
+
+                const uint32_t cutCount = std::min(std::max(1u, params.planesPerAxis), extent - 1);
+                for (uint32_t k = 0; k < cutCount; ++k)
+                {
+                    Cut& cut = cuts.emplace_back();
+                    cut.piece = p;
+                    cut.axis = axis;
+                    cut.position = box.lo[axis] + (k + 1) * extent / (cutCount + 1);
+                }
+            }
+        }
+
+        ParallelFor((uint32_t)cuts.size(), params.threadCount, [&](uint32_t i)
+        {
+            Cut& cut = cuts[i];
+            VoxelBox below = pieces[cut.piece].box;
+            VoxelBox above = below;
+            below.hi[cut.axis] = cut.position;
+            above.lo[cut.axis] = cut.position;
+            cut.valid = BuildPiece(grid, below, cut.halves[0]) && BuildPiece(grid, above, cut.halves[1]);
+        });
+
+        // Keep each piece's cut that leaves the least empty space in the two halves
+        for (uint32_t p : toSplit)
+        {
+            Cut* best = nullptr;
+            for (Cut& cut : cuts)
+            {
+                if (cut.piece != p || !cut.valid)
+                    continue;
+
+                if (!best || cut.halves[0].emptyVolume + cut.halves[1].emptyVolume < best->halves[0].emptyVolume + best->halves[1].emptyVolume)
+                    best = &cut;
+            }
+
+            if (!best)
+            {
+                pieces[p].splittable = false;
+                continue;
+            }
+
+            pieces[p] = std::move(best->halves[0]);
+            pieces.push_back(std::move(best->halves[1]));
+        }
+    }
+
+    out_hulls.resize(pieces.size());
+    ParallelFor((uint32_t)pieces.size(), params.threadCount, [&](uint32_t i)
+    {
+        out_hulls[i] = BuildCoveringHull(grid, vertices, indices, indexCount, pieces[i].box);
+    });
+
+    // Pieces too thin to hull on their own are already covered by the grown boxes of their neighbors
+    out_hulls.erase(std::remove_if(out_hulls.begin(), out_hulls.end(), [](const Hull& hull) { return hull.faces.empty(); }), out_hulls.end());
+    return !out_hulls.empty();
+}
+}
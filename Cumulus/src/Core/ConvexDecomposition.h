@@ -0,0 +1,35 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Approximate convex decomposition of triangle meshes, in the
+spirit of V-HACD. The mesh is voxelized, then the solid is cut by axis aligned
+planes until every piece is close enough to its own convex hull. Each piece's
+hull is built from the triangles clipped to the piece plus its voxels that are
+entirely inside, so the hulls together always cover the mesh's surface.
+----------------------------------------------*/
+#ifndef MUON_CONVEXDECOMPOSITION_H
+#define MUON_CONVEXDECOMPOSITION_H
+
+#include <Core/Hull.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    struct ConvexDecompositionParams
+    {
+        uint32_t voxelResolution = 48;      // Voxels along the mesh's longest axis
+        float concavityTolerance = 0.02f;   // Empty space a piece's hull may add, as a fraction of the whole mesh's hull volume
+        uint32_t maxHulls = 16;
+        uint32_t planesPerAxis = 8;         // Candidate cuts tried along each axis of a piece
+        uint32_t threadCount = 0;           // 0 uses every hardware thread
+    };
+
+    // Meshes that aren't closed still decompose, the voxels inside them just don't count as solid.
+    // Returns false and leaves out_hulls empty if the mesh has no volume to voxelize.
+    bool DecomposeConvex(const aiVector3D* vertices, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                         const ConvexDecompositionParams& params, std::vector<Hull>& out_hulls);
+}
+
+#endif
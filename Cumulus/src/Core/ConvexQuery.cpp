@@ -0,0 +1,843 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of ConvexQuery.h
+----------------------------------------------*/
+#include <Core/ConvexQuery.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    static const uint32_t SUPPORT_SCAN_MAX_VERTICES = 32;   // Past this the support hill climbs instead of scanning
+    static const uint32_t GJK_MAX_ITERATIONS = 64;
+    static const float GJK_TOLERANCE = 1e-5f;               // Relative improvement of the squared distance that counts as converged
+    static const float GJK_TOUCH_TOLERANCE = 1e-10f;        // Squared distance relative to the shapes' size that counts as touching
+    static const float FLAT_TOLERANCE = 1e-5f;              // Tetrahedron volume relative to its longest edge cubed that counts as flat
+    static const uint32_t EPA_MAX_ITERATIONS = 64;
+    static const uint32_t EPA_MAX_VERTICES = EPA_MAX_ITERATIONS + 4;
+    static const uint32_t EPA_MAX_FACES = 256;
+    static const uint32_t EPA_MAX_HORIZON = 64;
+    static const float EPA_TOLERANCE = 1e-3f;               // Relative to the depth
+    static const float EPA_MIN_TOLERANCE = 1e-5f;           // Relative to the shapes' size, for contacts barely touching
+
+    struct Vec3
+    {
+        float x, y, z;
+    };
+
+    static Vec3 Add(const Vec3& a, const Vec3& b) { return { a.x + b.x, a.y + b.y, a.z + b.z }; }
+    static Vec3 Sub(const Vec3& a, const Vec3& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    static Vec3 Mul(const Vec3& a, float s) { return { a.x * s, a.y * s, a.z * s }; }
+    static Vec3 Neg(const Vec3& a) { return { -a.x, -a.y, -a.z }; }
+    static float Dot(const Vec3& a, const Vec3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    static Vec3 Cross(const Vec3& a, const Vec3& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
+    static Vec3 ToVec3(const DirectX::XMFLOAT3& v) { return { v.x, v.y, v.z }; }
+    static DirectX::XMFLOAT3 ToFloat3(const Vec3& v) { return DirectX::XMFLOAT3(v.x, v.y, v.z); }
+
+    // An object's transform split for support queries: world = p * linear + translation
+    struct Placement
+    {
+        float linear[3][3];
+        Vec3 translation;
+        float scale;        // Frobenius norm of linear, at least as much as any local length can grow
+    };
+
+    Placement MakePlacement(const DirectX::XMFLOAT4X4& world)
+    {
+        Placement placement;
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                placement.linear[r][c] = world.m[r][c];
+        placement.translation = { world._41, world._42, world._43 };
+
+        // The longest row only bounds the growth when the rows are orthogonal, shears stretch some directions further
+        placement.scale = 0.0f;
+        for (int r = 0; r < 3; ++r)
+        {
+            Vec3 row = { world.m[r][0], world.m[r][1], world.m[r][2] };
+            placement.scale += Dot(row, row);
+        }
+        placement.scale = sqrtf(placement.scale);
+        return placement;
+    }
+
+    Vec3 ToWorld(const Placement& placement, const DirectX::XMFLOAT3& p)
+    {
+        const float (&m)[3][3] = placement.linear;
+        return { p.x * m[0][0] + p.y * m[1][0] + p.z * m[2][0] + placement.translation.x,
+                 p.x * m[0][1] + p.y * m[1][1] + p.z * m[2][1] + placement.translation.y,
+                 p.x * m[0][2] + p.y * m[1][2] + p.z * m[2][2] + placement.translation.z };
+    }
+
+    // d.(p * M) = p.(M d), so a world direction maps back through the rows of the linear part
+    Vec3 ToLocalDirection(const Placement& placement, const Vec3& d)
+    {
+        const float (&m)[3][3] = placement.linear;
+        return { m[0][0] * d.x + m[0][1] * d.y + m[0][2] * d.z,
+                 m[1][0] * d.x + m[1][1] * d.y + m[1][2] * d.z,
+                 m[2][0] * d.x + m[2][1] * d.y + m[2][2] * d.z };
+    }
+
+    // Walks to neighbors further along dir until none is. On a convex hull the first local maximum is the support point.
+    uint32_t ClimbToSupport(const ConvexShape& shape, const Vec3& dir, uint32_t start)
+    {
+        const uint32_t vertexCount = (uint32_t)shape.vertices.size();
+        uint32_t current = start < vertexCount ? start : 0;
+        float best = Dot(ToVec3(shape.vertices[current]), dir);
+
+        for (uint32_t step = 0; step < vertexCount; ++step)
+        {
+            uint32_t next = current;
+            for (uint32_t n = shape.neighborOffsets[current]; n < shape.neighborOffsets[current + 1]; ++n)
+            {
+                float d = Dot(ToVec3(shape.vertices[shape.neighbors[n]]), dir);
+                if (d > best)
+                {
+                    best = d;
+                    next = shape.neighbors[n];
+                }
+            }
+
+            if (next == current)
+                break;
+            current = next;
+        }
+
+        return current;
+    }
+
+    // One side of the pair, remembering its last support vertex for the next climb
+    struct SupportState
+    {
+        const ConvexShape* pShape;
+        const Placement* pPlacement;
+        uint32_t last;
+    };
+
+    Vec3 Support(SupportState& state, const Vec3& dir)
+    {
+        const ConvexShape& shape = *state.pShape;
+        Vec3 local = ToLocalDirection(*state.pPlacement, dir);
+
+        if (shape.vertices.size() <= SUPPORT_SCAN_MAX_VERTICES || shape.neighbors.empty())
+        {
+            float unused;
+            state.last = FindSupportPoint(shape.points, ToFloat3(local), unused);
+        }
+        else
+        {
+            state.last = ClimbToSupport(shape, local, state.last);
+        }
+
+        return ToWorld(*state.pPlacement, shape.vertices[state.last]);
+    }
+
+    // Point of the Minkowski difference A - B, with the points of A and B it came from for the witnesses
+    struct SimplexVertex
+    {
+        Vec3 w;
+        Vec3 a;
+        Vec3 b;
+        uint32_t indexA;    // Shape vertices a and b are
+        uint32_t indexB;
+    };
+
+    SimplexVertex SupportDifference(SupportState& stateA, SupportState& stateB, const Vec3& dir)
+    {
+        SimplexVertex v;
+        v.a = Support(stateA, dir);
+        v.b = Support(stateB, Neg(dir));
+        v.w = Sub(v.a, v.b);
+        v.indexA = stateA.last;
+        v.indexB = stateB.last;
+        return v;
+    }
+
+    // Starts the next climbs from the known support points furthest along dir, usually a step or two from the answer
+    void WarmStart(SupportState& stateA, SupportState& stateB, const SimplexVertex* const* vertices, uint32_t count, const Vec3& dir)
+    {
+        float bestA = -FLT_MAX, bestB = -FLT_MAX;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float da = Dot(vertices[i]->a, dir);
+            if (da > bestA)
+            {
+                bestA = da;
+                stateA.last = vertices[i]->indexA;
+            }
+
+            float db = -Dot(vertices[i]->b, dir);
+            if (db > bestB)
+            {
+                bestB = db;
+                stateB.last = vertices[i]->indexB;
+            }
+        }
+    }
+
+    struct Simplex
+    {
+        SimplexVertex v[4];
+        float lambda[4];
+        uint32_t count = 0;
+    };
+
+    Vec3 Combine(const Simplex& s, Vec3 SimplexVertex::* member)
+    {
+        Vec3 p = { 0.0f, 0.0f, 0.0f };
+        for (uint32_t i = 0; i < s.count; ++i)
+            p = Add(p, Mul(s.v[i].*member, s.lambda[i]));
+        return p;
+    }
+
+    void SetVertex(Simplex& s, const SimplexVertex& a)
+    {
+        s.v[0] = a;
+        s.lambda[0] = 1.0f;
+        s.count = 1;
+    }
+
+    void SetSegment(Simplex& s, const SimplexVertex& a, const SimplexVertex& b, float t)
+    {
+        s.v[0] = a;
+        s.v[1] = b;
+        s.lambda[0] = 1.0f - t;
+        s.lambda[1] = t;
+        s.count = 2;
+    }
+
+    // Closest point of a segment to the origin, as the sub-simplex it lies on
+    void SolveSegment(const SimplexVertex& a, const SimplexVertex& b, Simplex& out)
+    {
+        Vec3 ab = Sub(b.w, a.w);
+        float t = -Dot(a.w, ab);
+        float denom = Dot(ab, ab);
+        if (t <= 0.0f || denom <= 0.0f)
+            SetVertex(out, a);
+        else if (t >= denom)
+            SetVertex(out, b);
+        else
+            SetSegment(out, a, b, t / denom);
+    }
+
+    // Closest point of a triangle to the origin by its Voronoi regions (Ericson, Real-Time Collision Detection 5.1.5)
+    void SolveTriangle(const SimplexVertex& a, const SimplexVertex& b, const SimplexVertex& c, Simplex& out)
+    {
+        Vec3 ab = Sub(b.w, a.w);
+        Vec3 ac = Sub(c.w, a.w);
+
+        Vec3 ap = Neg(a.w);
+        float d1 = Dot(ab, ap);
+        float d2 = Dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f)
+            return SetVertex(out, a);
+
+        Vec3 bp = Neg(b.w);
+        float d3 = Dot(ab, bp);
+        float d4 = Dot(ac, bp);
+        if (d3 >= 0.0f && d4 <= d3)
+            return SetVertex(out, b);
+
+        float vc = d1 * d4 - d3 * d2;
+        if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+            return SetSegment(out, a, b, d1 / (d1 - d3));
+
+        Vec3 cp = Neg(c.w);
+        float d5 = Dot(ab, cp);
+        float d6 = Dot(ac, cp);
+        if (d6 >= 0.0f && d5 <= d6)
+            return SetVertex(out, c);
+
+        float vb = d5 * d2 - d1 * d6;
+        if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+            return SetSegment(out, a, c, d2 / (d2 - d6));
+
+        float va = d3 * d6 - d5 * d4;
+        if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+            return SetSegment(out, b, c, (d4 - d3) / ((d4 - d3) + (d5 - d6)));
+
+        float denom = va + vb + vc;
+        if (denom <= 0.0f)
+            return SolveSegment(a, b, out); // Degenerate, the triangle is a line
+
+        float v = vb / denom;
+        float w = vc / denom;
+        out.v[0] = a;
+        out.v[1] = b;
+        out.v[2] = c;
+        out.lambda[0] = 1.0f - v - w;
+        out.lambda[1] = v;
+        out.lambda[2] = w;
+        out.count = 3;
+    }
+
+    // Whether abcd is too thin for the side of its faces the origin is on to mean anything. The sign of a near zero
+    // volume is rounding noise, so a flat tetrahedron can look like it holds a point well off its plane.
+    bool IsFlatTetrahedron(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d)
+    {
+        Vec3 edges[6] = { Sub(b, a), Sub(c, a), Sub(d, a), Sub(c, b), Sub(d, b), Sub(d, c) };
+        float longestSq = 0.0f;
+        for (const Vec3& edge : edges)
+            longestSq = std::max(longestSq, Dot(edge, edge));
+
+        float volume = Dot(Cross(edges[0], edges[1]), edges[2]);
+        return fabsf(volume) <= FLAT_TOLERANCE * longestSq * sqrtf(longestSq);
+    }
+
+    // Whether the origin and d are on opposite sides of the plane through abc
+    bool OriginOutsideFace(const Vec3& a, const Vec3& b, const Vec3& c, const Vec3& d)
+    {
+        Vec3 n = Cross(Sub(b, a), Sub(c, a));
+        float signOrigin = -Dot(a, n);
+        float signD = Dot(Sub(d, a), n);
+        return signD == 0.0f || signOrigin * signD < 0.0f;
+    }
+
+    // Returns true if the tetrahedron holds the origin, otherwise reduces it to its face closest to the origin.
+    // Flat tetrahedra hold nothing, so they test every face.
+    bool SolveTetrahedron(const Simplex& s, Simplex& out)
+    {
+        const SimplexVertex& a = s.v[0];
+        const SimplexVertex& b = s.v[1];
+        const SimplexVertex& c = s.v[2];
+        const SimplexVertex& d = s.v[3];
+        const SimplexVertex* faces[4][4] = { { &a, &b, &c, &d }, { &a, &c, &d, &b }, { &a, &d, &b, &c }, { &b, &d, &c, &a } };
+        const bool flat = IsFlatTetrahedron(a.w, b.w, c.w, d.w);
+
+        bool inside = true;
+        float bestDistanceSq = FLT_MAX;
+        for (const auto& face : faces)
+        {
+            if (!flat && !OriginOutsideFace(face[0]->w, face[1]->w, face[2]->w, face[3]->w))
+                continue;
+
+            inside = false;
+            Simplex candidate;
+            SolveTriangle(*face[0], *face[1], *face[2], candidate);
+
+            Vec3 p = Combine(candidate, &SimplexVertex::w);
+            float distanceSq = Dot(p, p);
+            if (distanceSq < bestDistanceSq)
+            {
+                bestDistanceSq = distanceSq;
+                out = candidate;
+            }
+        }
+
+        return inside;
+    }
+
+    // Runs GJK on A - B from axis, a guess of the direction from B to A. Returns true if the shapes overlap.
+    // Otherwise out_v is the closest point of A - B to the origin, or just a separating axis if overlapOnly stopped early.
+    bool RunGjk(SupportState& stateA, SupportState& stateB, Vec3 axis, bool overlapOnly, Simplex& s, Vec3& out_v)
+    {
+        if (Dot(axis, axis) <= 0.0f)
+            axis = { 1.0f, 0.0f, 0.0f };
+
+        s.count = 0;
+        Vec3 v = axis;
+        float maxWSq = 0.0f;
+        float previousDistanceSq = FLT_MAX;
+
+        for (uint32_t iteration = 0; iteration < GJK_MAX_ITERATIONS; ++iteration)
+        {
+            const SimplexVertex* known[4] = { &s.v[0], &s.v[1], &s.v[2], &s.v[3] };
+            WarmStart(stateA, stateB, known, s.count, Neg(v));
+
+            SimplexVertex w = SupportDifference(stateA, stateB, Neg(v));
+            float vw = Dot(v, w.w);
+            maxWSq = std::max(maxWSq, Dot(w.w, w.w));
+
+            if (overlapOnly && vw > 0.0f)
+                break; // v separates them
+
+            float distanceSq = Dot(v, v);
+            if (s.count > 0 && distanceSq - vw <= GJK_TOLERANCE * distanceSq)
+                break; // No support point gets meaningfully closer
+
+            bool duplicate = false;
+            for (uint32_t i = 0; i < s.count; ++i)
+                duplicate |= s.v[i].w.x == w.w.x && s.v[i].w.y == w.w.y && s.v[i].w.z == w.w.z;
+            if (duplicate)
+                break;
+
+            s.v[s.count++] = w;
+
+            Simplex reduced;
+            switch (s.count)
+            {
+            case 1: SetVertex(reduced, s.v[0]); break;
+            case 2: SolveSegment(s.v[0], s.v[1], reduced); break;
+            case 3: SolveTriangle(s.v[0], s.v[1], s.v[2], reduced); break;
+            default:
+                if (SolveTetrahedron(s, reduced))
+                {
+                    out_v = { 0.0f, 0.0f, 0.0f };
+                    return true;
+                }
+                break;
+            }
+
+            s = reduced;
+            v = Combine(s, &SimplexVertex::w);
+            distanceSq = Dot(v, v);
+
+            if (distanceSq <= GJK_TOUCH_TOLERANCE * maxWSq)
+            {
+                out_v = v;
+                return true;
+            }
+
+            if (distanceSq >= previousDistanceSq)
+                break; // Rounding stalled it
+            previousDistanceSq = distanceSq;
+        }
+
+        out_v = v;
+        return false;
+    }
+
+    struct EpaFace
+    {
+        uint32_t v[3];
+        Vec3 normal;
+        float distance;
+        bool alive;
+    };
+
+    bool MakeEpaFace(const SimplexVertex* vertices, uint32_t a, uint32_t b, uint32_t c, EpaFace& out_face)
+    {
+        Vec3 n = Cross(Sub(vertices[b].w, vertices[a].w), Sub(vertices[c].w, vertices[a].w));
+        float lengthSq = Dot(n, n);
+        if (lengthSq <= 0.0f)
+            return false;
+
+        out_face.v[0] = a;
+        out_face.v[1] = b;
+        out_face.v[2] = c;
+        out_face.normal = Mul(n, 1.0f / sqrtf(lengthSq));
+        out_face.distance = Dot(out_face.normal, vertices[a].w);
+        out_face.alive = true;
+        return true;
+    }
+
+    // Grows GJK's final simplex into a tetrahedron. Fails if A - B is flat, in which case they only touch.
+    bool FillTetrahedron(SupportState& stateA, SupportState& stateB, Simplex& s, float tolerance)
+    {
+        static const Vec3 AXES[6] = { { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } };
+
+        if (s.count == 1)
+        {
+            for (const Vec3& axis : AXES)
+            {
+                SimplexVertex w = SupportDifference(stateA, stateB, axis);
+                Vec3 offset = Sub(w.w, s.v[0].w);
+                if (Dot(offset, offset) > tolerance * tolerance)
+                {
+                    s.v[s.count++] = w;
+                    break;
+                }
+            }
+        }
+
+        if (s.count == 2)
+        {
+            Vec3 line = Sub(s.v[1].w, s.v[0].w);
+            Vec3 least = fabsf(line.x) < fabsf(line.y) ? (fabsf(line.x) < fabsf(line.z) ? AXES[0] : AXES[4]) : (fabsf(line.y) < fabsf(line.z) ? AXES[2] : AXES[4]);
+            Vec3 side = Cross(line, least);
+            Vec3 dirs[4] = { side, Neg(side), Cross(line, side), Neg(Cross(line, side)) };
+
+            float lineLengthSq = Dot(line, line);
+            for (const Vec3& dir : dirs)
+            {
+                SimplexVertex w = SupportDifference(stateA, stateB, dir);
+                Vec3 offLine = Cross(Sub(w.w, s.v[0].w), line);
+                if (Dot(offLine, offLine) > tolerance * tolerance * lineLengthSq)
+                {
+                    s.v[s.count++] = w;
+                    break;
+                }
+            }
+        }
+
+        if (s.count == 3)
+        {
+            Vec3 n = Cross(Sub(s.v[1].w, s.v[0].w), Sub(s.v[2].w, s.v[0].w));
+            float nLength = sqrtf(Dot(n, n));
+            Vec3 dirs[2] = { n, Neg(n) };
+            for (const Vec3& dir : dirs)
+            {
+                SimplexVertex w = SupportDifference(stateA, stateB, dir);
+                if (fabsf(Dot(Sub(w.w, s.v[0].w), n)) > tolerance * nLength && !IsFlatTetrahedron(s.v[0].w, s.v[1].w, s.v[2].w, w.w))
+                {
+                    s.v[s.count++] = w;
+                    break;
+                }
+            }
+        }
+
+        return s.count == 4;
+    }
+
+    // Drops the vertex of a flat tetrahedron that adds the least area, so FillTetrahedron can grow it again off the plane
+    void DropToLargestFace(Simplex& s)
+    {
+        uint32_t dropped = 0;
+        float bestAreaSq = -1.0f;
+        for (uint32_t i = 0; i < 4; ++i)
+        {
+            const Vec3& a = s.v[(i + 1) % 4].w;
+            Vec3 n = Cross(Sub(s.v[(i + 2) % 4].w, a), Sub(s.v[(i + 3) % 4].w, a));
+            float areaSq = Dot(n, n);
+            if (areaSq > bestAreaSq)
+            {
+                bestAreaSq = areaSq;
+                dropped = i;
+            }
+        }
+
+        s.v[dropped] = s.v[3];
+        s.count = 3;
+    }
+
+    // Penetration of overlapping shapes from GJK's final simplex. out_normal points from A towards B.
+    bool RunEpa(SupportState& stateA, SupportState& stateB, Simplex s, float size,
+                Vec3& out_normal, float& out_depth, Vec3& out_pointA, Vec3& out_pointB)
+    {
+        const float minTolerance = EPA_MIN_TOLERANCE * size;
+        if (s.count == 4 && IsFlatTetrahedron(s.v[0].w, s.v[1].w, s.v[2].w, s.v[3].w))
+            DropToLargestFace(s);
+        if (!FillTetrahedron(stateA, stateB, s, minTolerance))
+            return false;
+
+        SimplexVertex vertices[EPA_MAX_VERTICES];
+        EpaFace faces[EPA_MAX_FACES];
+        uint32_t vertexCount = 4;
+        uint32_t faceCount = 0;
+
+        for (uint32_t i = 0; i < 4; ++i)
+            vertices[i] = s.v[i];
+
+        // Not flat, so winding the first face away from the fourth vertex makes every face face out.
+        // When GJK stopped on the touch tolerance the origin can be just outside the start. Faces it is outside of have
+        // a negative distance, so they are the closest and get expanded first, growing the polytope over the origin.
+        if (Dot(Cross(Sub(vertices[1].w, vertices[0].w), Sub(vertices[2].w, vertices[0].w)), Sub(vertices[3].w, vertices[0].w)) > 0.0f)
+            std::swap(vertices[1], vertices[2]);
+
+        const uint32_t TETRAHEDRON[4][3] = { { 0, 1, 2 }, { 0, 3, 1 }, { 0, 2, 3 }, { 1, 3, 2 } };
+        for (const auto& tri : TETRAHEDRON)
+        {
+            if (!MakeEpaFace(vertices, tri[0], tri[1], tri[2], faces[faceCount]))
+                return false;
+            ++faceCount;
+        }
+
+        uint32_t closest = 0;
+        for (uint32_t iteration = 0; iteration < EPA_MAX_ITERATIONS; ++iteration)
+        {
+            closest = UINT32_MAX;
+            for (uint32_t f = 0; f < faceCount; ++f)
+            {
+                if (faces[f].alive && (closest == UINT32_MAX || faces[f].distance < faces[closest].distance))
+                    closest = f;
+            }
+            if (closest == UINT32_MAX)
+                return false;
+
+            const EpaFace& face = faces[closest];
+            const SimplexVertex* known[3] = { &vertices[face.v[0]], &vertices[face.v[1]], &vertices[face.v[2]] };
+            WarmStart(stateA, stateB, known, 3, face.normal);
+
+            SimplexVertex w = SupportDifference(stateA, stateB, face.normal);
+            if (Dot(w.w, face.normal) - face.distance <= std::max(EPA_TOLERANCE * face.distance, minTolerance) || vertexCount == EPA_MAX_VERTICES)
+                break;
+
+            // Faces w can see are replaced by a fan from w to the edges around them. So are faces w lies in the plane of,
+            // a fan edge along one of those would leave a sliver facing back in.
+            uint32_t visible[EPA_MAX_FACES];
+            uint32_t visibleCount = 0;
+            uint32_t horizon[EPA_MAX_HORIZON][2];
+            uint32_t horizonCount = 0;
+            bool overflow = false;
+            for (uint32_t f = 0; f < faceCount; ++f)
+            {
+                if (!faces[f].alive || Dot(faces[f].normal, Sub(w.w, vertices[faces[f].v[0]].w)) <= -minTolerance)
+                    continue;
+
+                visible[visibleCount++] = f;
+                for (uint32_t e = 0; e < 3; ++e)
+                {
+                    uint32_t from = faces[f].v[e];
+                    uint32_t to = faces[f].v[(e + 1) % 3];
+
+                    // An edge shared with another visible face is interior, its twin was added the other way around
+                    uint32_t twin = 0;
+                    while (twin < horizonCount && !(horizon[twin][0] == to && horizon[twin][1] == from))
+                        ++twin;
+
+                    if (twin < horizonCount)
+                    {
+                        horizon[twin][0] = horizon[horizonCount - 1][0];
+                        horizon[twin][1] = horizon[horizonCount - 1][1];
+                        --horizonCount;
+                    }
+                    else if (horizonCount < EPA_MAX_HORIZON)
+                    {
+                        horizon[horizonCount][0] = from;
+                        horizon[horizonCount][1] = to;
+                        ++horizonCount;
+                    }
+                    else
+                    {
+                        overflow = true;
+                    }
+                }
+            }
+
+            if (overflow || faceCount + horizonCount > EPA_MAX_FACES)
+                break; // Keep the best face found so far
+
+            // The polytope only grows, so while it holds the origin no new face can be closer than the closest one.
+            // One that is has been flipped by w landing just past the plane of a face it can't see, so stop on the last good polytope.
+            const float minDistance = face.distance - std::max(EPA_TOLERANCE * face.distance, minTolerance);
+            bool valid = true;
+            vertices[vertexCount] = w;
+            for (uint32_t e = 0; valid && e < horizonCount; ++e)
+            {
+                EpaFace& newFace = faces[faceCount + e];
+                valid = MakeEpaFace(vertices, horizon[e][0], horizon[e][1], vertexCount, newFace) &&
+                        (face.distance <= 0.0f || newFace.distance >= minDistance);
+            }
+            if (!valid)
+                break;
+
+            for (uint32_t i = 0; i < visibleCount; ++i)
+                faces[visible[i]].alive = false;
+            faceCount += horizonCount;
+            ++vertexCount;
+        }
+
+        // Still outside after running out of room, there's no depth to report
+        const EpaFace& face = faces[closest];
+        if (face.distance < -minTolerance)
+            return false;
+
+        const Vec3& a = vertices[face.v[0]].w;
+        const Vec3& b = vertices[face.v[1]].w;
+        const Vec3& c = vertices[face.v[2]].w;
+
+        // Barycentric coordinates of the origin's projection, to carry the face's point back to A and B
+        Vec3 p = Mul(face.normal, face.distance);
+        Vec3 v0 = Sub(b, a), v1 = Sub(c, a), v2 = Sub(p, a);
+        float d00 = Dot(v0, v0), d01 = Dot(v0, v1), d11 = Dot(v1, v1), d20 = Dot(v2, v0), d21 = Dot(v2, v1);
+        float denom = d00 * d11 - d01 * d01;
+        float bv = denom != 0.0f ? (d11 * d20 - d01 * d21) / denom : 0.0f;
+        float bw = denom != 0.0f ? (d00 * d21 - d01 * d20) / denom : 0.0f;
+        float bu = 1.0f - bv - bw;
+
+        out_normal = face.normal;
+        out_depth = std::max(face.distance, 0.0f);
+        out_pointA = Add(Add(Mul(vertices[face.v[0]].a, bu), Mul(vertices[face.v[1]].a, bv)), Mul(vertices[face.v[2]].a, bw));
+        out_pointB = Add(Add(Mul(vertices[face.v[0]].b, bu), Mul(vertices[face.v[1]].b, bv)), Mul(vertices[face.v[2]].b, bw));
+        return true;
+    }
+
+    ConvexQueryResult QueryPlaced(const ConvexShape& shapeA, const Placement& placementA, const ConvexShape& shapeB, const Placement& placementB,
+                                  ConvexQueryType type, ConvexQueryCache* io_cache)
+    {
+        ConvexQueryResult result;
+        if (shapeA.vertices.empty() || shapeB.vertices.empty())
+            return result;
+
+        if (type == CONVEX_QUERY_OVERLAP)
+        {
+            Vec3 between = Sub(placementA.translation, placementB.translation);
+            float reach = shapeA.boundingRadius * placementA.scale + shapeB.boundingRadius * placementB.scale + shapeA.radius + shapeB.radius;
+            if (Dot(between, between) > reach * reach)
+                return result;
+        }
+
+        SupportState stateA = { &shapeA, &placementA, io_cache ? io_cache->supportA : 0 };
+        SupportState stateB = { &shapeB, &placementB, io_cache ? io_cache->supportB : 0 };
+
+        Vec3 axis = io_cache ? ToVec3(io_cache->axis) : Vec3{ 0.0f, 0.0f, 0.0f };
+        if (Dot(axis, axis) <= 0.0f)
+            axis = Sub(placementA.translation, placementB.translation);
+
+        // Rounded shapes need the real distance, their cores can be apart while they touch
+        const float margin = shapeA.radius + shapeB.radius;
+        const bool overlapOnly = type == CONVEX_QUERY_OVERLAP && margin <= 0.0f;
+
+        Simplex s;
+        Vec3 v;
+        bool coresOverlap = RunGjk(stateA, stateB, axis, overlapOnly, s, v);
+
+        if (io_cache)
+        {
+            if (!coresOverlap)
+                io_cache->axis = ToFloat3(v);
+            io_cache->supportA = stateA.last;
+            io_cache->supportB = stateB.last;
+        }
+
+        if (!coresOverlap)
+        {
+            if (overlapOnly)
+                return result;
+
+            float coreDistance = sqrtf(Dot(v, v));
+            Vec3 normal = Mul(v, -1.0f / coreDistance);
+
+            result.overlap = coreDistance <= margin;
+            result.distance = std::max(coreDistance - margin, 0.0f);
+            if (type == CONVEX_QUERY_OVERLAP)
+                return result;
+
+            if (result.overlap && type == CONVEX_QUERY_PENETRATION)
+                result.penetration = margin - coreDistance;
+
+            result.normal = ToFloat3(normal);
+            result.pointA = ToFloat3(Add(Combine(s, &SimplexVertex::a), Mul(normal, shapeA.radius)));
+            result.pointB = ToFloat3(Sub(Combine(s, &SimplexVertex::b), Mul(normal, shapeB.radius)));
+            return result;
+        }
+
+        result.overlap = true;
+        if (type != CONVEX_QUERY_PENETRATION)
+            return result;
+
+        float size = 0.0f;
+        for (uint32_t i = 0; i < s.count; ++i)
+            size = std::max(size, sqrtf(Dot(s.v[i].w, s.v[i].w)));
+        size = std::max(size, sqrtf(Dot(Sub(placementA.translation, placementB.translation), Sub(placementA.translation, placementB.translation))));
+        size = std::max(size, FLT_MIN);
+
+        Vec3 normal, pointA, pointB;
+        float depth;
+        if (!RunEpa(stateA, stateB, s, size, normal, depth, pointA, pointB))
+        {
+            // A - B is flat, so the cores only touch. Any direction off the contact is as good as another.
+            pointA = Combine(s, &SimplexVertex::a);
+            pointB = Combine(s, &SimplexVertex::b);
+            normal = Sub(placementB.translation, placementA.translation);
+            float lengthSq = Dot(normal, normal);
+            normal = lengthSq > 0.0f ? Mul(normal, 1.0f / sqrtf(lengthSq)) : Vec3{ 1.0f, 0.0f, 0.0f };
+            depth = 0.0f;
+        }
+
+        if (io_cache)
+            io_cache->axis = ToFloat3(Neg(normal));
+
+        result.penetration = depth + margin;
+        result.normal = ToFloat3(normal);
+        result.pointA = ToFloat3(Add(pointA, Mul(normal, shapeA.radius)));
+        result.pointB = ToFloat3(Sub(pointB, Mul(normal, shapeB.radius)));
+        return result;
+    }
+}
+
+bool BuildConvexShape(const Hull& hull, ConvexShape& out_shape)
+{
+    out_shape = ConvexShape();
+    if (hull.vertices.empty())
+        return false;
+
+    const uint32_t vertexCount = (uint32_t)hull.vertices.size();
+    out_shape.vertices = hull.vertices;
+    BuildPointCloudSoA(out_shape.vertices.data(), vertexCount, out_shape.points);
+
+    for (const DirectX::XMFLOAT3& v : out_shape.vertices)
+        out_shape.boundingRadius = std::max(out_shape.boundingRadius, sqrtf(v.x * v.x + v.y * v.y + v.z * v.z));
+
+    // Every face edge, both ways, grouped by vertex
+    std::vector<uint64_t> edges;
+    edges.reserve(hull.faces.size() * 6);
+    for (const HullFace& face : hull.faces)
+    {
+        for (int e = 0; e < 3; ++e)
+        {
+            uint64_t from = (uint32_t)face.indices[e];
+            uint64_t to = (uint32_t)face.indices[(e + 1) % 3];
+            edges.push_back(from << 32 | to);
+            edges.push_back(to << 32 | from);
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    edges.erase(std::unique(edges.begin(), edges.end()), edges.end());
+
+    out_shape.neighborOffsets.assign(vertexCount + 1, 0);
+    out_shape.neighbors.reserve(edges.size());
+    for (uint64_t edge : edges)
+    {
+        ++out_shape.neighborOffsets[(edge >> 32) + 1];
+        out_shape.neighbors.push_back((uint32_t)edge);
+    }
+    for (uint32_t i = 0; i < vertexCount; ++i)
+        out_shape.neighborOffsets[i + 1] += out_shape.neighborOffsets[i];
+
+    return true;
+}
+
+void BuildSphereShape(float radius, ConvexShape& out_shape)
+{
+    out_shape = ConvexShape();
+    out_shape.vertices.assign(1, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f));
+    BuildPointCloudSoA(out_shape.vertices.data(), 1, out_shape.points);
+    out_shape.radius = radius;
+}
+
+AABB GetConvexBounds(const ConvexShape& shape, const DirectX::XMFLOAT4X4& world)
+{
+    AABB bounds;
+    Placement placement = MakePlacement(world);
+    if (shape.vertices.empty())
+    {
+        bounds.min = bounds.max = DirectX::XMFLOAT3A(placement.translation.x, placement.translation.y, placement.translation.z);
+        return bounds;
+    }
+
+    SupportState state = { &shape, &placement, 0 };
+    float lo[3], hi[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        Vec3 dir = { axis == 0 ? 1.0f : 0.0f, axis == 1 ? 1.0f : 0.0f, axis == 2 ? 1.0f : 0.0f };
+        Vec3 maxPoint = Support(state, dir);
+        Vec3 minPoint = Support(state, Neg(dir));
+        hi[axis] = Dot(maxPoint, dir) + shape.radius;
+        lo[axis] = Dot(minPoint, dir) - shape.radius;
+    }
+
+    bounds.min = DirectX::XMFLOAT3A(lo[0], lo[1], lo[2]);
+    bounds.max = DirectX::XMFLOAT3A(hi[0], hi[1], hi[2]);
+    return bounds;
+}
+
+ConvexQueryResult QueryConvex(const ConvexShape& shapeA, const DirectX::XMFLOAT4X4& worldA,
+                              const ConvexShape& shapeB, const DirectX::XMFLOAT4X4& worldB,
+                              ConvexQueryType type, ConvexQueryCache* io_cache)
+{
+    return QueryPlaced(shapeA, MakePlacement(worldA), shapeB, MakePlacement(worldB), type, io_cache);
+}
+
+void QueryConvexPairs(const std::vector<ConvexShape>& shapes, const std::vector<ConvexObject>& objects,
+                      const ConvexQueryPair* pairs, uint32_t pairCount, ConvexQueryType type,
+                      ConvexQueryResult* out_results, ConvexQueryCache* io_caches)
+{
+    std::vector<Placement> placements(objects.size());
+    for (size_t i = 0; i < objects.size(); ++i)
+        placements[i] = MakePlacement(objects[i].world);
+
+    for (uint32_t i = 0; i < pairCount; ++i)
+    {
+        const ConvexObject& a = objects[pairs[i].objectA];
+        const ConvexObject& b = objects[pairs[i].objectB];
+        out_results[i] = QueryPlaced(shapes[a.shape], placements[pairs[i].objectA], shapes[b.shape], placements[pairs[i].objectB],
+                                     type, io_caches ? &io_caches[i] : nullptr);
+    }
+}
+}
@@ -0,0 +1,94 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Distance, overlap and penetration queries between placed
+convex shapes, with GJK for the first two and EPA for the depth. A shape
+caches its hull's vertices once, as a structure of arrays for the 8-wide
+support scan, plus vertex adjacency so bigger hulls hill climb from their
+last support point instead. Batches keep a separating axis per pair between
+frames, so pairs that barely moved finish in a couple of iterations.
+----------------------------------------------*/
+#ifndef MUON_CONVEXQUERY_H
+#define MUON_CONVEXQUERY_H
+
+#include <Core/CommonTypes.h>
+#include <Core/Hull.h>
+#include <Utils/PointCloudUtils.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Query data for one hull, built once and shared by every object using it
+    struct ConvexShape
+    {
+        PointCloudSoA points;
+        std::vector<DirectX::XMFLOAT3> vertices;
+        std::vector<uint32_t> neighborOffsets;  // vertices.size() + 1 entries into neighbors
+        std::vector<uint32_t> neighbors;
+        float radius = 0.0f;                    // Rounds the shape in world units, a single vertex with a radius is a sphere
+        float boundingRadius = 0.0f;            // Of the vertices around the local origin. Lets overlap queries skip far apart pairs.
+    };
+
+    // Returns false and leaves out_shape empty if the hull has no vertices
+    bool BuildConvexShape(const Hull& hull, ConvexShape& out_shape);
+
+    // For the camera and other round proxies
+    void BuildSphereShape(float radius, ConvexShape& out_shape);
+
+    // Tight world space box of a placed shape, from its support points along the axes. What the broadphase sorts.
+    AABB GetConvexBounds(const ConvexShape& shape, const DirectX::XMFLOAT4X4& world);
+
+    enum ConvexQueryType : uint8_t
+    {
+        CONVEX_QUERY_OVERLAP,       // Only whether they touch, stops as soon as that's known
+        CONVEX_QUERY_DISTANCE,      // Closest points while apart, just the overlap flag once the hulls touch
+        CONVEX_QUERY_PENETRATION,   // Distance, plus the depth and normal from EPA while overlapping
+    };
+
+    // A shape placed in the world
+    struct ConvexObject
+    {
+        uint32_t shape;
+        DirectX::XMFLOAT4X4 world;  // Any affine transform, row vector like the rest of the engine
+    };
+
+    struct ConvexQueryPair
+    {
+        uint32_t objectA;
+        uint32_t objectB;
+    };
+
+    struct ConvexQueryResult
+    {
+        bool overlap = false;
+        float distance = 0.0f;      // Gap between the shapes, 0 while overlapping
+        float penetration = 0.0f;   // How far B has to move along normal to separate, PENETRATION queries only
+        DirectX::XMFLOAT3 normal = { 0.0f, 0.0f, 0.0f };    // Unit, from A towards B
+        DirectX::XMFLOAT3 pointA = { 0.0f, 0.0f, 0.0f };    // Closest points while apart, deepest points while overlapping
+        DirectX::XMFLOAT3 pointB = { 0.0f, 0.0f, 0.0f };
+    };
+
+    // Per pair state carried between frames. Zero initialized is a valid cold start.
+    struct ConvexQueryCache
+    {
+        DirectX::XMFLOAT3 axis = { 0.0f, 0.0f, 0.0f };  // Last separating direction, B to A
+        uint32_t supportA = 0;                          // Where the hill climbs start
+        uint32_t supportB = 0;
+    };
+
+    // Normal and points are only filled in when the query type produces them.
+    ConvexQueryResult QueryConvex(const ConvexShape& shapeA, const DirectX::XMFLOAT4X4& worldA,
+                                  const ConvexShape& shapeB, const DirectX::XMFLOAT4X4& worldB,
+                                  ConvexQueryType type, ConvexQueryCache* io_cache = nullptr);
+
+    // Each object's transform is split up once for all of its pairs. io_caches is optional, one per pair.
+    void QueryConvexPairs(const std::vector<ConvexShape>& shapes, const std::vector<ConvexObject>& objects,
+                          const ConvexQueryPair* pairs, uint32_t pairCount, ConvexQueryType type,
+                          ConvexQueryResult* out_results, ConvexQueryCache* io_caches = nullptr);
+}
+
+#endif
@@ -0,0 +1,410 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CookedMesh.h
+Every section starts on a 16 byte boundary so the streams can be read in
+place. The hulls are written field by field rather than as raw HullFaces,
+which carry XMFLOAT3A padding.
+----------------------------------------------*/
+#include <Core/CookedMesh.h>
+
+#include <Core/WinApp.h>
+#include <Utils/HashUtils.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+namespace Muon
+{
+namespace
+{
+    // Bump whenever the layout below or the way LoadMesh builds what goes in it changes (e.g. its Assimp flags)
+    static const uint32_t COOKED_MESH_VERSION = 1;
+    static const char COOKED_MESH_MAGIC[4] = { 'M', 'E', 'S', 'H' };
+    static const uint64_t COOKED_MESH_SECTION_ALIGNMENT = 16;
+
+    struct CookedMeshHeader
+    {
+        char magic[4];
+        uint32_t version;
+        uint32_t sourceHash;
+        uint32_t vertexLayout;
+        uint32_t vertexStride;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t hullCount;     // The mesh's hull, then its convex decomposition
+        uint32_t hullBytes;
+        DirectX::XMFLOAT3 aabbMin;
+        DirectX::XMFLOAT3 aabbMax;
+        uint32_t sdfWidth;
+        uint32_t sdfHeight;
+        uint32_t sdfDepth;
+        DirectX::XMFLOAT3 sdfBoundsMin;
+        float sdfVoxelSize;
+        uint64_t fileSize;      // Catches files cut short by a crash mid write
+    };
+
+    // Each hull is one of these, then its vertices as XMFLOAT3s, then its faces
+    struct CookedHullHeader
+    {
+        uint32_t vertexCount;
+        uint32_t faceCount;
+        float volume;
+    };
+
+    struct CookedHullFace
+    {
+        int32_t indices[3];
+        float distance;
+        DirectX::XMFLOAT3 normal;
+    };
+
+    struct CookedMeshSections
+    {
+        uint64_t vertexOffset;
+        uint64_t indexOffset;
+        uint64_t hullOffset;
+        uint64_t sdfOffset;
+        uint64_t fileSize;
+    };
+
+    uint64_t AlignSection(uint64_t offset)
+    {
+        return (offset + COOKED_MESH_SECTION_ALIGNMENT - 1) & ~(COOKED_MESH_SECTION_ALIGNMENT - 1);
+    }
+
+    // 64 bit so that a corrupt header can't wrap around and pass the size check
+    CookedMeshSections GetSections(const CookedMeshHeader& header)
+    {
+        CookedMeshSections sections;
+        sections.vertexOffset = AlignSection(sizeof(CookedMeshHeader));
+        sections.indexOffset = AlignSection(sections.vertexOffset + (uint64_t)header.vertexStride * header.vertexCount);
+        sections.hullOffset = AlignSection(sections.indexOffset + (uint64_t)header.indexCount * sizeof(uint32_t));
+        sections.sdfOffset = AlignSection(sections.hullOffset + header.hullBytes);
+        sections.fileSize = sections.sdfOffset + (uint64_t)header.sdfWidth * header.sdfHeight * header.sdfDepth * sizeof(float);
+        return sections;
+    }
+
+    uint64_t GetCookedHullSize(const Hull& hull)
+    {
+        return sizeof(CookedHullHeader) + hull.vertices.size() * sizeof(DirectX::XMFLOAT3) + hull.faces.size() * sizeof(CookedHullFace);
+    }
+
+    // Read only view of a whole file. Empty files can't be mapped, so they fail too.
+    bool MapFile(const std::filesystem::path& path, HANDLE& out_file, HANDLE& out_mapping, const uint8_t*& out_view, uint64_t& out_size)
+    {
+        out_file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+        if (out_file == INVALID_HANDLE_VALUE)
+        {
+            out_file = nullptr;
+            return false;
+        }
+
+        LARGE_INTEGER size = {};
+        if (!GetFileSizeEx(out_file, &size) || size.QuadPart <= 0)
+            return false;
+        out_size = (uint64_t)size.QuadPart;
+
+        out_mapping = CreateFileMappingW(out_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        if (!out_mapping)
+            return false;
+
+        out_view = static_cast<const uint8_t*>(MapViewOfFile(out_mapping, FILE_MAP_READ, 0, 0, 0));
+        return out_view != nullptr;
+    }
+
+    void UnmapFile(HANDLE& file, HANDLE& mapping, const uint8_t*& view)
+    {
+        if (view)
+            UnmapViewOfFile(view);
+        if (mapping)
+            CloseHandle(mapping);
+        if (file)
+            CloseHandle(file);
+
+        view = nullptr;
+        mapping = nullptr;
+        file = nullptr;
+    }
+
+    void WritePadding(std::ofstream& outFile, uint64_t offset)
+    {
+        static const char zeroes[COOKED_MESH_SECTION_ALIGNMENT] = {};
+        outFile.write(zeroes, AlignSection(offset) - offset);
+    }
+}
+
+uint32_t GetCookedVertexStride(uint32_t vertexLayout)
+{
+    uint32_t stride = 0;
+    if (vertexLayout & COOKED_VERTEX_POSITION) stride += sizeof(float) * 3;
+    if (vertexLayout & COOKED_VERTEX_NORMAL) stride += sizeof(float) * 3;
+    if (vertexLayout & COOKED_VERTEX_TEXCOORD) stride += sizeof(float) * 2;
+    if (vertexLayout & COOKED_VERTEX_TANGENTS) stride += sizeof(float) * 6;
+    if (vertexLayout & COOKED_VERTEX_COLOR) stride += sizeof(float) * 4;
+    return stride;
+}
+
+bool HashModelSource(const std::filesystem::path& sourcePath, const ConvexDecompositionParams& decompositionParams,
+                     const MeshSdfDesc& sdfDesc, uint32_t& out_hash)
+{
+    HANDLE file = nullptr;
+    HANDLE mapping = nullptr;
+    const uint8_t* view = nullptr;
+    uint64_t size = 0;
+    if (!MapFile(sourcePath, file, mapping, view, size))
+    {
+        UnmapFile(file, mapping, view);
+        return false;
+    }
+
+    uint32_t hash = fnv1a(view, (size_t)size);
+    UnmapFile(file, mapping, view);
+
+    // Field by field, threadCount doesn't change the result and the structs may hold padding
+    hash = fnv1a(&decompositionParams.voxelResolution, sizeof(uint32_t), hash);
+    hash = fnv1a(&decompositionParams.concavityTolerance, sizeof(float), hash);
+    hash = fnv1a(&decompositionParams.maxHulls, sizeof(uint32_t), hash);
+    hash = fnv1a(&decompositionParams.planesPerAxis, sizeof(uint32_t), hash);
+    hash = fnv1a(&sdfDesc.resolution, sizeof(uint32_t), hash);
+    hash = fnv1a(&sdfDesc.padding, sizeof(float), hash);
+
+    out_hash = hash;
+    return true;
+}
+
+bool WriteCookedMesh(const std::filesystem::path& path, uint32_t sourceHash, uint32_t vertexLayout,
+                     const void* vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices,
+                     const AABB& aabb, const Hull& hull, const std::vector<Hull>& convexDecomposition, const MeshSdf& sdf)
+{
+    CookedMeshHeader header = {};
+    std::copy(std::begin(COOKED_MESH_MAGIC), std::end(COOKED_MESH_MAGIC), header.magic);
+    header.version = COOKED_MESH_VERSION;
+    header.sourceHash = sourceHash;
+    header.vertexLayout = vertexLayout;
+    header.vertexStride = GetCookedVertexStride(vertexLayout);
+    header.vertexCount = vertexCount;
+    header.indexCount = (uint32_t)indices.size();
+    header.hullCount = 1 + (uint32_t)convexDecomposition.size();
+    header.aabbMin = DirectX::XMFLOAT3(aabb.min.x, aabb.min.y, aabb.min.z);
+    header.aabbMax = DirectX::XMFLOAT3(aabb.max.x, aabb.max.y, aabb.max.z);
+    header.sdfWidth = sdf.width;
+    header.sdfHeight = sdf.height;
+    header.sdfDepth = sdf.depth;
+    header.sdfBoundsMin = sdf.boundsMin;
+    header.sdfVoxelSize = sdf.voxelSize;
+
+    if ((uint64_t)sdf.width * sdf.height * sdf.depth != sdf.distances.size())
+        return false;
+
+    uint64_t hullBytes = GetCookedHullSize(hull);
+    for (const Hull& piece : convexDecomposition)
+        hullBytes += GetCookedHullSize(piece);
+    if (hullBytes > UINT32_MAX)
+        return false;
+    header.hullBytes = (uint32_t)hullBytes;
+
+    const CookedMeshSections sections = GetSections(header);
+    header.fileSize = sections.fileSize;
+
+    std::error_code ec;
+    std::filesystem::create_directories(path.parent_path(), ec);
+
+    std::ofstream outFile(path, std::ios::binary | std::ios::trunc);
+    if (!outFile)
+        return false;
+
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    WritePadding(outFile, sizeof(header));
+
+    outFile.write(static_cast<const char*>(vertexData), (std::streamsize)header.vertexStride * vertexCount);
+    WritePadding(outFile, sections.vertexOffset + (uint64_t)header.vertexStride * vertexCount);
+
+    outFile.write(reinterpret_cast<const char*>(indices.data()), indices.size() * sizeof(uint32_t));
+    WritePadding(outFile, sections.indexOffset + indices.size() * sizeof(uint32_t));
+
+    auto WriteHull = [&outFile](const Hull& piece)
+    {
+        CookedHullHeader hullHeader = { (uint32_t)piece.vertices.size(), (uint32_t)piece.faces.size(), piece.volume };
+        outFile.write(reinterpret_cast<const char*>(&hullHeader), sizeof(hullHeader));
+        outFile.write(reinterpret_cast<const char*>(piece.vertices.data()), piece.vertices.size() * sizeof(DirectX::XMFLOAT3));
+
+        for (const HullFace& face : piece.faces)
+        {
+            CookedHullFace cookedFace = { { face.indices[0], face.indices[1], face.indices[2] }, face.distance, DirectX::XMFLOAT3(face.normal.x, face.normal.y, face.normal.z) };
+            outFile.write(reinterpret_cast<const char*>(&cookedFace), sizeof(cookedFace));
+        }
+    };
+
+    WriteHull(hull);
+    for (const Hull& piece : convexDecomposition)
+        WriteHull(piece);
+    WritePadding(outFile, sections.hullOffset + hullBytes);
+
+    outFile.write(reinterpret_cast<const char*>(sdf.distances.data()), sdf.distances.size() * sizeof(float));
+    return (bool)outFile;
+}
+
+CookedMesh::~CookedMesh()
+{
+    Close();
+}
+
+bool CookedMesh::Open(const std::filesystem::path& path, uint32_t sourceHash)
+{
+    Close();
+
+    HANDLE file = nullptr;
+    HANDLE mapping = nullptr;
+    uint64_t size = 0;
+    bool mapped = MapFile(path, file, mapping, mView, size);
+    mFile = file;
+    mMapping = mapping;
+    if (!mapped)
+    {
+        // No file yet is the usual first launch, nothing to warn about
+        const bool exists = mFile != nullptr;
+        Close();
+        if (exists)
+            Printf(L"Warning: Failed to map cooked mesh %s\n", path.c_str());
+        return false;
+    }
+
+    CookedMeshHeader header = {};
+    bool valid = size >= sizeof(header);
+    if (valid)
+    {
+        memcpy(&header, mView, sizeof(header));
+        valid = std::equal(std::begin(header.magic), std::end(header.magic), std::begin(COOKED_MESH_MAGIC)) &&
+            header.version == COOKED_MESH_VERSION &&
+            header.sourceHash == sourceHash &&
+            header.vertexStride == GetCookedVertexStride(header.vertexLayout) &&
+            header.hullCount > 0 &&
+            header.fileSize == size &&
+            GetSections(header).fileSize == size;
+    }
+
+    // Walk the hulls once here, so ReadHulls can trust their counts and face indices
+    const CookedMeshSections sections = GetSections(header);
+    for (uint32_t i = 0, offset = 0; valid && i != header.hullCount; ++i)
+    {
+        CookedHullHeader hullHeader = {};
+        valid = (uint64_t)offset + sizeof(hullHeader) <= header.hullBytes;
+        if (!valid)
+            break;
+        memcpy(&hullHeader, mView + sections.hullOffset + offset, sizeof(hullHeader));
+
+        const uint64_t hullSize = sizeof(hullHeader) + (uint64_t)hullHeader.vertexCount * sizeof(DirectX::XMFLOAT3) + (uint64_t)hullHeader.faceCount * sizeof(CookedHullFace);
+        valid = offset + hullSize <= header.hullBytes;
+        if (!valid)
+            break;
+
+        const uint8_t* faceHead = mView + sections.hullOffset + offset + sizeof(hullHeader) + (uint64_t)hullHeader.vertexCount * sizeof(DirectX::XMFLOAT3);
+        for (uint32_t f = 0; valid && f != hullHeader.faceCount; ++f)
+        {
+            CookedHullFace cookedFace;
+            memcpy(&cookedFace, faceHead + (uint64_t)f * sizeof(cookedFace), sizeof(cookedFace));
+            for (int32_t index : cookedFace.indices)
+                valid &= index >= 0 && (uint32_t)index < hullHeader.vertexCount;
+        }
+        offset += (uint32_t)hullSize;
+    }
+
+    if (!valid)
+    {
+        Close();
+        Printf(L"Warning: Cooked mesh %s is stale, recooking.\n", path.c_str());
+        return false;
+    }
+
+    mVertexData = mView + sections.vertexOffset;
+    mVertexStride = header.vertexStride;
+    mVertexCount = header.vertexCount;
+    mVertexLayout = header.vertexLayout;
+    mIndices = reinterpret_cast<const uint32_t*>(mView + sections.indexOffset);
+    mIndexCount = header.indexCount;
+    mAABB.min = DirectX::XMFLOAT3A(header.aabbMin.x, header.aabbMin.y, header.aabbMin.z);
+    mAABB.max = DirectX::XMFLOAT3A(header.aabbMax.x, header.aabbMax.y, header.aabbMax.z);
+
+    mHulls = mView + sections.hullOffset;
+    mHullCount = header.hullCount;
+
+    mSdfLayout.width = header.sdfWidth;
+    mSdfLayout.height = header.sdfHeight;
+    mSdfLayout.depth = header.sdfDepth;
+    mSdfLayout.boundsMin = header.sdfBoundsMin;
+    mSdfLayout.voxelSize = header.sdfVoxelSize;
+    mSdfDistances = reinterpret_cast<const float*>(mView + sections.sdfOffset);
+    return true;
+}
+
+void CookedMesh::Close()
+{
+    HANDLE file = mFile;
+    HANDLE mapping = mMapping;
+    UnmapFile(file, mapping, mView);
+    mFile = nullptr;
+    mMapping = nullptr;
+
+    mVertexData = nullptr;
+    mVertexStride = 0;
+    mVertexCount = 0;
+    mVertexLayout = 0;
+    mIndices = nullptr;
+    mIndexCount = 0;
+    mAABB = {};
+    mHulls = nullptr;
+    mHullCount = 0;
+    mSdfLayout = MeshSdf();
+    mSdfDistances = nullptr;
+}
+
+void CookedMesh::ReadHulls(Hull& out_hull, std::vector<Hull>& out_convexDecomposition) const
+{
+    out_hull = Hull();
+    out_convexDecomposition.clear();
+    if (!mHulls)
+        return;
+
+    out_convexDecomposition.resize(mHullCount - 1);
+
+    const uint8_t* readHead = mHulls;
+    for (uint32_t i = 0; i != mHullCount; ++i)
+    {
+        Hull& hull = i == 0 ? out_hull : out_convexDecomposition[i - 1];
+
+        CookedHullHeader hullHeader;
+        memcpy(&hullHeader, readHead, sizeof(hullHeader));
+        readHead += sizeof(hullHeader);
+        hull.volume = hullHeader.volume;
+
+        hull.vertices.assign(reinterpret_cast<const DirectX::XMFLOAT3*>(readHead), reinterpret_cast<const DirectX::XMFLOAT3*>(readHead) + hullHeader.vertexCount);
+        readHead += hullHeader.vertexCount * sizeof(DirectX::XMFLOAT3);
+
+        hull.faces.resize(hullHeader.faceCount);
+        for (HullFace& face : hull.faces)
+        {
+            CookedHullFace cookedFace;
+            memcpy(&cookedFace, readHead, sizeof(cookedFace));
+            readHead += sizeof(cookedFace);
+
+            face.indices[0] = cookedFace.indices[0];
+            face.indices[1] = cookedFace.indices[1];
+            face.indices[2] = cookedFace.indices[2];
+            face.distance = cookedFace.distance;
+            face.normal = DirectX::XMFLOAT3A(cookedFace.normal.x, cookedFace.normal.y, cookedFace.normal.z);
+        }
+    }
+}
+
+void CookedMesh::ReadSdf(MeshSdf& out_sdf) const
+{
+    out_sdf = mSdfLayout;
+    if (!mSdfDistances)
+        return;
+
+    out_sdf.distances.assign(mSdfDistances, mSdfDistances + (size_t)mSdfLayout.width * mSdfLayout.height * mSdfLayout.depth);
+}
+}
@@ -0,0 +1,92 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Cooked meshes, everything MeshFactory::LoadMesh derives from a
+model file flattened into one binary file: the interleaved vertex stream,
+the indices, the AABB, the hull and convex decomposition, and the SDF.
+Loading one maps the file and hands the streams straight to the staging
+buffer, so Assimp and every bake only run when the model or the settings
+they were built with change.
+----------------------------------------------*/
+#ifndef MUON_COOKEDMESH_H
+#define MUON_COOKEDMESH_H
+
+#include <Core/CommonTypes.h>
+#include <Core/ConvexDecomposition.h>
+#include <Core/Hull.h>
+#include <Core/MeshSdf.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace Muon
+{
+    // Attributes present in the interleaved vertex stream, which holds them in this order
+    enum CookedVertexAttribute : uint32_t
+    {
+        COOKED_VERTEX_POSITION  = 1 << 0,   // float3
+        COOKED_VERTEX_NORMAL    = 1 << 1,   // float3
+        COOKED_VERTEX_TEXCOORD  = 1 << 2,   // float2
+        COOKED_VERTEX_TANGENTS  = 1 << 3,   // float3 tangent, float3 bitangent
+        COOKED_VERTEX_COLOR     = 1 << 4,   // float4
+    };
+
+    uint32_t GetCookedVertexStride(uint32_t vertexLayout);
+
+    // Of the model file's bytes and the settings the hulls and SDF are built with, so changing either recooks the mesh
+    bool HashModelSource(const std::filesystem::path& sourcePath, const ConvexDecompositionParams& decompositionParams,
+                         const MeshSdfDesc& sdfDesc, uint32_t& out_hash);
+
+    // Not fatal if it fails, the mesh just gets cooked again next launch
+    bool WriteCookedMesh(const std::filesystem::path& path, uint32_t sourceHash, uint32_t vertexLayout,
+                         const void* vertexData, uint32_t vertexCount, const std::vector<uint32_t>& indices,
+                         const AABB& aabb, const Hull& hull, const std::vector<Hull>& convexDecomposition, const MeshSdf& sdf);
+
+    // A cooked mesh file mapped into memory. The vertex and index streams point into the mapping, so they live as long as this does.
+    class CookedMesh
+    {
+    public:
+        CookedMesh() = default;
+        ~CookedMesh();
+        CookedMesh(const CookedMesh&) = delete;
+        CookedMesh& operator=(const CookedMesh&) = delete;
+
+        // Fails if there is no file, or it was cooked from a different source or by an older version
+        bool Open(const std::filesystem::path& path, uint32_t sourceHash);
+        void Close();
+
+        const void* GetVertexData() const { return mVertexData; }
+        uint32_t GetVertexDataSize() const { return mVertexStride * mVertexCount; }
+        uint32_t GetVertexStride() const { return mVertexStride; }
+        uint32_t GetVertexCount() const { return mVertexCount; }
+        uint32_t GetVertexLayout() const { return mVertexLayout; }
+        const uint32_t* GetIndices() const { return mIndices; }
+        uint32_t GetIndexCount() const { return mIndexCount; }
+        AABB GetAABB() const { return mAABB; }
+
+        // These are small, so they are copied out rather than pointed at
+        void ReadHulls(Hull& out_hull, std::vector<Hull>& out_convexDecomposition) const;
+        void ReadSdf(MeshSdf& out_sdf) const;
+
+    private:
+        void* mFile = nullptr;      // Win32 HANDLEs
+        void* mMapping = nullptr;
+        const uint8_t* mView = nullptr;
+
+        const void* mVertexData = nullptr;
+        uint32_t mVertexStride = 0;
+        uint32_t mVertexCount = 0;
+        uint32_t mVertexLayout = 0;
+        const uint32_t* mIndices = nullptr;
+        uint32_t mIndexCount = 0;
+        AABB mAABB = {};
+
+        const uint8_t* mHulls = nullptr;    // The mesh's hull, then its convex decomposition
+        uint32_t mHullCount = 0;
+        MeshSdf mSdfLayout;                 // Everything but the distances
+        const float* mSdfDistances = nullptr;
+    };
+}
+
+#endif
@@ -15,31 +15,106 @@
 #include <filesystem>
 #include <DirectXTex.h>
 
+#include <Core/BlueNoise.h>
+#include <Core/CookedMesh.h>
 #include <Core/DXCore.h>
+#include <Core/MeshSdf.h>
+#include <Core/PathMacros.h>
+#include <Utils/CloudLightingUtils.h>
+#include <Utils/CloudBudgetUtils.h>
+#include <Utils/ConeMarchUtils.h>
+#include <Utils/HullBinningUtils.h>
+#include <Utils/TextureUtils.h>
 #include <Utils/Utils.h>
+#include <chrono>
 #include <unordered_map>
 #include "Hull.h"
+#include "ConvexDecomposition.h"
 
 namespace Muon
 {
 
-static unsigned int GetVertexSize(const aiMesh& mesh)
+// Which attributes of the mesh end up in its interleaved vertex stream, see GetCookedVertexStride for their sizes
+static uint32_t GetVertexLayout(const aiMesh& mesh)
 {
-    unsigned int sz = 0;
-    if (mesh.HasPositions()) sz += sizeof(float) * 3;
-    if (mesh.HasNormals()) sz += sizeof(float) * 3;
-    if (mesh.HasTextureCoords(0)) sz += sizeof(float) * 2;  // vec2
-    if (mesh.HasTangentsAndBitangents())  sz += sizeof(float) * 6;  // vec3 tangent + vec3 bitangent
-    if (mesh.HasVertexColors(0)) sz += sizeof(float) * 4;  // vec4
-    return sz;
+    uint32_t layout = 0;
+    if (mesh.HasPositions()) layout |= COOKED_VERTEX_POSITION;
+    if (mesh.HasNormals()) layout |= COOKED_VERTEX_NORMAL;
+    if (mesh.HasTextureCoords(0)) layout |= COOKED_VERTEX_TEXCOORD;
+    if (mesh.HasTangentsAndBitangents()) layout |= COOKED_VERTEX_TANGENTS;
+    if (mesh.HasVertexColors(0)) layout |= COOKED_VERTEX_COLOR;
+    return layout;
+}
+
+static bool CreateAndUploadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer, Mesh& outMesh, const void* vertexData, UINT vertexStride, UINT vertexCount,
+                                const uint32_t* indices, UINT indexCount, const AABB& boundingBox, const Hull& hull, const std::vector<Hull>& convexDecomposition, const MeshSdf& sdf)
+{
+    const UINT vertexDataSize = vertexStride * vertexCount;
+    const UINT indexDataSize = indexCount * sizeof(uint32_t);
+
+    bool success = outMesh.Create(fileName, vertexDataSize, vertexStride, vertexCount, indexDataSize, indexCount, DXGI_FORMAT_R32_UINT, boundingBox, hull, convexDecomposition, sdf);
+    if (!success)
+    {
+        Muon::Printf(L"Error: Failed to create mesh: %s\n", fileName);
+        outMesh.Destroy();
+        return false;
+    }
+    
+    success = stagingBuffer.UploadToMesh(Muon::GetCommandList(), outMesh, vertexData, vertexDataSize, indices, indexDataSize);
+    if (!success)
+    {
+        Muon::Printf(L"Error: Failed to upload mesh: %s\n", fileName);
+        outMesh.Destroy();
+        return false;
+    }
+
+    return true;
 }
 
 bool MeshFactory::LoadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer, Mesh& outMesh)
 {
     using namespace DirectX;
+
+    std::wstring modelPath = GetModelPathFromFile_W(fileName);
+    std::string pathStr = Muon::FromWideStr(modelPath);
+
+    std::wstring cookedPath = CACHEPATHW;
+    cookedPath += std::wstring(fileName) + L".mesh";
+
+    ConvexDecompositionParams decompositionParams;
+    MeshSdfDesc sdfDesc;
+
+    // Once cooked, loading is a straight copy from the mapped file into the staging buffer
+    uint32_t sourceHash = 0;
+    const bool hashedSource = HashModelSource(modelPath, decompositionParams, sdfDesc, sourceHash);
+    if (hashedSource)
+    {
+        auto cookedStart = std::chrono::steady_clock::now();
+
+        CookedMesh cooked;
+        if (cooked.Open(cookedPath, sourceHash))
+        {
+            Hull hull;
+            std::vector<Hull> convexDecomposition;
+            MeshSdf sdf;
+            cooked.ReadHulls(hull, convexDecomposition);
+            cooked.ReadSdf(sdf);
+
+            bool success = CreateAndUploadMesh(fileName, stagingBuffer, outMesh, cooked.GetVertexData(), cooked.GetVertexStride(), cooked.GetVertexCount(),
+                                               cooked.GetIndices(), cooked.GetIndexCount(), cooked.GetAABB(), hull, convexDecomposition, sdf);
+
+            #if defined(MN_DEBUG)
+                double cookedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cookedStart).count();
+                Muon::Printf("Cooked mesh '%s': %u vertices, %u indices in %.3f ms\n", pathStr.c_str(), cooked.GetVertexCount(), cooked.GetIndexCount(), cookedMs);
+            #else
+                (void)cookedStart;
+            #endif
+
+            return success;
+        }
+    }
+
     Assimp::Importer Importer;
-   
-    std::string pathStr = Muon::FromWideStr(GetModelPathFromFile_W(fileName));
 
     // Load assimpScene with proper flags
     const aiScene* pScene = Importer.ReadFile(
@@ -60,10 +135,13 @@ bool MeshFactory::LoadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer,
     {
         std::vector<uint8_t> vertexData;
         std::vector<uint32_t> indices;
+        uint32_t vertexLayout = 0;
         uint32_t vertexCount = 0;
         DirectX::XMFLOAT3A min;
         DirectX::XMFLOAT3A max;
         Hull hull;
+        std::vector<Hull> convexDecomposition;
+        MeshSdf sdf;
     };
     std::vector<MeshData> meshesData;
     meshesData.reserve(pScene->mNumMeshes);
@@ -100,11 +178,13 @@ bool MeshFactory::LoadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer,
             continue;
         }
 
-        const unsigned int vertexSize = GetVertexSize(*pMesh);
+        const uint32_t vertexLayout = GetVertexLayout(*pMesh);
+        const unsigned int vertexSize = GetCookedVertexStride(vertexLayout);
         const unsigned int numVertices = pMesh->mNumVertices;
         const unsigned int totalVBOSize = numVertices * vertexSize;
         MeshData& meshData = meshesData.emplace_back();
         meshData.vertexData.resize(totalVBOSize);
+        meshData.vertexLayout = vertexLayout;
         meshData.vertexCount = numVertices;
 
         uint8_t* bufferStart = meshData.vertexData.data();
@@ -135,8 +215,17 @@ bool MeshFactory::LoadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer,
 
         //convex hull calc:
         if (pMesh->HasPositions()) {
+            auto hullStart = std::chrono::steady_clock::now();
             Hull hull(pMesh->mVertices, pMesh->mNumVertices);
             meshData.hull = hull;
+
+            #if defined(MN_DEBUG)
+                // Every shipped model goes through here at startup, so this doubles as the hull benchmark
+                double hullMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - hullStart).count();
+                Muon::Printf("Hull '%s': %u points -> %u faces in %.3f ms\n", pathStr.c_str(), numVertices, (uint32_t)hull.faces.size(), hullMs);
+            #else
+                (void)hullStart;
+            #endif
         }
 
         // Process Indices next
@@ -152,6 +241,33 @@ bool MeshFactory::LoadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer,
             meshData.indices.push_back(face.mIndices[1]);
             meshData.indices.push_back(face.mIndices[2]);
         }
+
+        // Concave meshes get a set of tighter hulls as well
+        if (pMesh->HasPositions()) {
+            auto decompositionStart = std::chrono::steady_clock::now();
+            DecomposeConvex(pMesh->mVertices, pMesh->mNumVertices, meshData.indices.data(), (uint32_t)meshData.indices.size(), decompositionParams, meshData.convexDecomposition);
+
+            #if defined(MN_DEBUG)
+                double decompositionMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decompositionStart).count();
+                Muon::Printf("Convex decomposition '%s': %u hulls in %.3f ms\n", pathStr.c_str(), (uint32_t)meshData.convexDecomposition.size(), decompositionMs);
+            #else
+                (void)decompositionStart;
+            #endif
+        }
+
+        // Signed distance volume for the clouds to flow around, kept in the cooked mesh since it's slow to bake
+        if (pMesh->HasPositions()) {
+            auto sdfStart = std::chrono::steady_clock::now();
+            if (!BakeMeshSdf(reinterpret_cast<const XMFLOAT3*>(pMesh->mVertices), pMesh->mNumVertices, meshData.indices.data(), (uint32_t)meshData.indices.size(), sdfDesc, meshData.sdf))
+                Muon::Printf("Warning: Failed to bake SDF for '%s'\n", pathStr.c_str());
+
+            #if defined(MN_DEBUG)
+                double sdfMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - sdfStart).count();
+                Muon::Printf("Mesh SDF '%s': %ux%ux%u in %.3f ms\n", pathStr.c_str(), meshData.sdf.width, meshData.sdf.height, meshData.sdf.depth, sdfMs);
+            #else
+                (void)sdfStart;
+            #endif
+        }
     }
 
     // TODO: Support scenes with multiple meshes. These meshData's need to be merged.
@@ -161,21 +277,13 @@ bool MeshFactory::LoadMesh(const wchar_t* fileName, UploadBuffer& stagingBuffer,
     boundingBox.min = data.min;
     boundingBox.max = data.max;
 
-    bool success = outMesh.Create(fileName, (UINT)data.vertexData.size(), (UINT)data.vertexData.size() / data.vertexCount, (UINT)data.vertexCount, (UINT)data.indices.size() * sizeof(uint32_t), (UINT)data.indices.size(), DXGI_FORMAT_R32_UINT, boundingBox, data.hull);
-    if (!success)
-    {
-        Muon::Printf(L"Error: Failed to create mesh: %s\n", fileName);
-        outMesh.Destroy();
+    if (!CreateAndUploadMesh(fileName, stagingBuffer, outMesh, data.vertexData.data(), GetCookedVertexStride(data.vertexLayout), (UINT)data.vertexCount,
+                             data.indices.data(), (UINT)data.indices.size(), boundingBox, data.hull, data.convexDecomposition, data.sdf))
         return false;
-    }
-    
-    success = stagingBuffer.UploadToMesh(Muon::GetCommandList(), outMesh, data.vertexData.data(), (UINT)data.vertexData.size(), data.indices.data(), (UINT)data.indices.size() * sizeof(uint32_t));
-    if (!success)
-    {
-        Muon::Printf(L"Error: Failed to upload mesh: %s\n", fileName);
-        outMesh.Destroy();
-        return false;
-    }
+
+    // Not fatal, it just gets cooked again next launch
+    if (hashedSource && !WriteCookedMesh(cookedPath, sourceHash, data.vertexLayout, data.vertexData.data(), data.vertexCount, data.indices, boundingBox, data.hull, data.convexDecomposition, data.sdf))
+        Muon::Printf(L"Warning: Failed to write cooked mesh %s\n", cookedPath.c_str());
 
     return true;
 }
@@ -247,7 +355,7 @@ void ShaderFactory::LoadAllShaders(ResourceCodex& codex)
     }
 }
 
-bool TextureFactory::Upload3DTextureFromData(const wchar_t* textureName, void* data, size_t width, size_t height, size_t depth, DXGI_FORMAT fmt, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex)
+bool TextureFactory::Upload3DTextureFromData(const wchar_t* textureName, const void* data, size_t width, size_t height, size_t depth, DXGI_FORMAT fmt, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex, bool generateWrappedMips)
 {
     const size_t bitsPerPixel = DirectX::BitsPerPixel(fmt);
     const size_t bytesPerPixel = bitsPerPixel / 8;
@@ -256,15 +364,43 @@ bool TextureFactory::Upload3DTextureFromData(const wchar_t* textureName, void* d
     UploadBuffer& stagingBuffer = codex.Get3DTextureStagingBuffer();
     assert(dataSize <= stagingBuffer.GetBufferSize());
 
+    // The mip builder works on float texels only
+    const size_t channelCount = bytesPerPixel / sizeof(float);
+    if (generateWrappedMips && (DirectX::FormatDataType(fmt) != DirectX::FORMAT_TYPE_FLOAT || bitsPerPixel != channelCount * 32))
+    {
+        Muon::Printf(L"Warning: Can't build mips for 3d texture %s, format is not 32-bit float.\n", textureName);
+        generateWrappedMips = false;
+    }
+
+    std::vector<std::vector<float>> mips;
+    if (generateWrappedMips)
+        Build3DMipChainWrapped(static_cast<const float*>(data), (uint32_t)width, (uint32_t)height, (uint32_t)depth, (uint32_t)channelCount, mips);
+
+    const UINT16 mipLevels = mips.empty() ? 1 : (UINT16)mips.size();
+
     Texture& tex = codex.InsertTexture(GetResourceID(textureName));
 
-    if (!tex.Create(textureName, pDevice, (UINT)width, (UINT)height, (UINT)depth, fmt, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST))
+    if (!tex.Create(textureName, pDevice, (UINT)width, (UINT)height, (UINT)depth, fmt, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, mipLevels))
     {
         Muon::Printf(L"Error: Failed to create default heap resource for 3d texture %s!\n", textureName);
         return false;
     }
 
-    if (!stagingBuffer.UploadToTexture(tex, data, pCommandList))
+    bool uploaded = false;
+    if (mips.empty())
+    {
+        uploaded = stagingBuffer.UploadToTexture(tex, data, pCommandList);
+    }
+    else
+    {
+        std::vector<const void*> mipData;
+        for (const std::vector<float>& mip : mips)
+            mipData.push_back(mip.data());
+
+        uploaded = stagingBuffer.UploadMipsToTexture(tex, mipData.data(), (UINT)mipData.size(), pCommandList);
+    }
+
+    if (!uploaded)
     {
         Muon::Printf(L"Error: Failed to create default heap resource for 3d texture %s!\n", textureName);
         return false;
@@ -335,6 +471,163 @@ bool TextureFactory::CreateOffscreenRenderTarget(ID3D12Device* pDevice, UINT wid
     return success;
 }
 
+// Intermediate targets written by the cloud raymarch and read by the upsample/composite pass.
+// Allocated at full resolution so the march resolution can change without reallocating; reduced resolution marches only write the top-left region.
+bool TextureFactory::CreateCloudTargets(ID3D12Device* pDevice, UINT width, UINT height)
+{
+    DescriptorHeap* pSRVHeap = Muon::GetSRVHeap();
+    if (!pSRVHeap)
+        return false;
+
+    struct CloudTargetDesc
+    {
+        const wchar_t* name;
+        DXGI_FORMAT format;
+    };
+
+    const CloudTargetDesc CLOUD_TARGETS[] =
+    {
+        { L"CloudTarget",        DXGI_FORMAT_R16G16B16A16_FLOAT }, // [in-scattered radiance.rgb, transmittance]
+        { L"CloudDepthTarget",   DXGI_FORMAT_R32G32_FLOAT },       // [linear view Z the march was clipped against, cloud distance]
+
+        // Temporal resolve output, ping-ponged so last frame's result can be read as history
+        { L"CloudHistory0",      DXGI_FORMAT_R16G16B16A16_FLOAT },
+        { L"CloudHistory1",      DXGI_FORMAT_R16G16B16A16_FLOAT },
+        { L"CloudHistoryDepth0", DXGI_FORMAT_R32G32_FLOAT },
+        { L"CloudHistoryDepth1", DXGI_FORMAT_R32G32_FLOAT },
+    };
+
+    ResourceCodex& codex = ResourceCodex::GetSingleton();
+    for (const CloudTargetDesc& desc : CLOUD_TARGETS)
+    {
+        Texture& target = codex.InsertTexture(GetResourceID(desc.name));
+
+        bool success = target.Create(desc.name, pDevice, width, height, 1, desc.format, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+        if (success)
+            success &= target.InitSRV(pDevice, pSRVHeap);
+        if (success)
+            success &= target.InitUAV(pDevice, pSRVHeap);
+
+        if (!success)
+        {
+            Printf(L"Error: Failed to create %s!\n", desc.name);
+            return false;
+        }
+    }
+
+    // Cone march prepass output, one texel per tile of pixels
+    const wchar_t* CONE_START_NAME = L"CloudConeStart";
+    Texture& coneStart = codex.InsertTexture(GetResourceID(CONE_START_NAME));
+
+    bool success = coneStart.Create(CONE_START_NAME, pDevice, GetConeTileCount(width), GetConeTileCount(height), 1, DXGI_FORMAT_R32_FLOAT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+    if (success)
+        success &= coneStart.InitSRV(pDevice, pSRVHeap);
+    if (success)
+        success &= coneStart.InitUAV(pDevice, pSRVHeap);
+
+    if (!success)
+    {
+        Printf(L"Error: Failed to create %s!\n", CONE_START_NAME);
+        return false;
+    }
+
+    // Per march texel [enter, exit] of the occupied cloud bricks, as float bits so CloudRayIntervals.cs can use atomics
+    const wchar_t* RAY_INTERVAL_NAMES[] = { L"CloudRayEnter", L"CloudRayExit" };
+    for (const wchar_t* name : RAY_INTERVAL_NAMES)
+    {
+        Texture& interval = codex.InsertTexture(GetResourceID(name));
+
+        success = interval.Create(name, pDevice, width, height, 1, DXGI_FORMAT_R32_UINT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+        if (success)
+            success &= interval.InitSRV(pDevice, pSRVHeap);
+        if (success)
+            success &= interval.InitUAV(pDevice, pSRVHeap);
+
+        if (!success)
+        {
+            Printf(L"Error: Failed to create %s!\n", name);
+            return false;
+        }
+    }
+
+    // Per hull tile [count, hull indices...], written by HullBinning.cs
+    const wchar_t* HULL_TILES_NAME = L"CloudHullTiles";
+    Texture& hullTiles = codex.InsertTexture(GetResourceID(HULL_TILES_NAME));
+
+    success = hullTiles.Create(HULL_TILES_NAME, pDevice, GetHullTileCount(width) * HULL_TILE_SLOTS, GetHullTileCount(height), 1, DXGI_FORMAT_R32_UINT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+    if (success)
+        success &= hullTiles.InitSRV(pDevice, pSRVHeap);
+    if (success)
+        success &= hullTiles.InitUAV(pDevice, pSRVHeap);
+
+    if (!success)
+    {
+        Printf(L"Error: Failed to create %s!\n", HULL_TILES_NAME);
+        return false;
+    }
+
+    // Adaptive step budget, one texel per tile of march texels
+    const CloudTargetDesc BUDGET_TARGETS[] =
+    {
+        { L"CloudTileStats",     DXGI_FORMAT_R32G32B32A32_FLOAT }, // [mean luminance, mean transmittance, importance, base steps]
+        { L"CloudTileSteps",     DXGI_FORMAT_R32_UINT },           // Steps the raymarch took, accumulated with atomics
+        { L"CloudTileStepScale", DXGI_FORMAT_R32_FLOAT },          // Step size multiplier for next frame's raymarch
+    };
+
+    for (const CloudTargetDesc& desc : BUDGET_TARGETS)
+    {
+        Texture& target = codex.InsertTexture(GetResourceID(desc.name));
+
+        success = target.Create(desc.name, pDevice, GetBudgetTileCount(width), GetBudgetTileCount(height), 1, desc.format, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+        if (success)
+            success &= target.InitSRV(pDevice, pSRVHeap);
+        if (success)
+            success &= target.InitUAV(pDevice, pSRVHeap);
+
+        if (!success)
+        {
+            Printf(L"Error: Failed to create %s!\n", desc.name);
+            return false;
+        }
+    }
+
+    return true;
+}
+
+// Cloud shadows as seen from the sun, written by BeerShadowMap.cs and read by the raymarch and opaque passes
+bool TextureFactory::CreateBeerShadowMap(ID3D12Device* pDevice, UINT resolution)
+{
+    const wchar_t* BEER_SHADOW_MAP_NAME = L"BeerShadowMap";
+
+    DescriptorHeap* pSRVHeap = Muon::GetSRVHeap();
+    if (!pSRVHeap)
+        return false;
+
+    ResourceCodex& codex = ResourceCodex::GetSingleton();
+    Texture& shadowMap = codex.InsertTexture(GetResourceID(BEER_SHADOW_MAP_NAME));
+
+    // [front depth, mean extinction, max optical depth, unused]. Depths span kilometers, so no half floats.
+    bool success = shadowMap.Create(BEER_SHADOW_MAP_NAME, pDevice, resolution, resolution, 1, DXGI_FORMAT_R32G32B32A32_FLOAT, D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ);
+    if (success)
+        success &= shadowMap.InitSRV(pDevice, pSRVHeap);
+    if (success)
+        success &= shadowMap.InitUAV(pDevice, pSRVHeap);
+
+    if (!success)
+    {
+        Printf(L"Error: Failed to create %s!\n", BEER_SHADOW_MAP_NAME);
+        return false;
+    }
+
+    return true;
+}
+
+// The atmosphere tables are also sampled on the CPU to light the clouds with the sky, see SkyAmbientUtils.h
+static bool IsCpuSampledTexture(const std::wstring& name)
+{
+    return name == L"irradiance_high.hdr" || name == L"TestHDR_3D";
+}
+
 // Loads all the textures from the directory and returns them as out params to the ResourceCodex
 void TextureFactory::LoadAllTextures(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex)
 {
@@ -413,6 +706,25 @@ void TextureFactory::LoadAllTextures(ID3D12Device* pDevice, ID3D12GraphicsComman
             CloseCommandList();
             continue;
         }
+
+        if (IsCpuSampledTexture(name))
+        {
+            if (pImage->format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+            {
+                FloatTexture& data = codex.InsertTextureData(tid);
+                data.width = (uint32_t)pImage->width;
+                data.height = (uint32_t)pImage->height;
+                data.texels.resize(pImage->width * pImage->height * 4);
+
+                const size_t rowSize = pImage->width * 4 * sizeof(float);
+                for (size_t y = 0; y < pImage->height; ++y)
+                    memcpy(&data.texels[y * pImage->width * 4], pImage->pixels + y * pImage->rowPitch, rowSize);
+            }
+            else
+            {
+                Muon::Printf(L"Warning: %s isn't RGBA32F, no CPU copy was kept\n", path.c_str());
+            }
+        }
     
         Muon::CloseCommandList();
         Muon::ExecuteCommandList();
@@ -595,6 +907,14 @@ bool TextureFactory::LoadTexturesForNVDF(std::filesystem::path directoryPath, ID
         D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE
     ));
 
+    // Keep a coarse CPU copy of the density for light baking, the full NVDF is too big to march through on the CPU
+    static const uint32_t DENSITY_GRID_DIVISOR = 4;
+    CloudDensityGrid& densityGrid = codex.InsertCloudDensityGrid(GetResourceID(lookupName.c_str()));
+    if (!BuildCloudDensityGrid(outData.data(), (uint32_t)width, (uint32_t)height, (uint32_t)depth, DENSITY_GRID_DIVISOR, densityGrid))
+    {
+        Printf(L"Warning: Failed to build the cloud density grid for %s\n", lookupName.c_str());
+    }
+
     return true;
 }
 
@@ -691,6 +1011,12 @@ static bool LoadWICSlices(const std::vector<std::filesystem::path>& sliceFiles,
     return true;
 }
 
+// Tileable volumes get a wrapped mip chain so they can be sampled at a distance without aliasing or seams
+static bool IsTileable3DTexture(const std::wstring& dirName)
+{
+    return dirName == L"Noise";
+}
+
 bool TextureFactory::Load3DTextureFromSlices(std::filesystem::path directoryPath, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex)
 {
     using namespace DirectX;
@@ -802,9 +1128,19 @@ bool TextureFactory::Load3DTextureFromSlices(std::filesystem::path directoryPath
     if (!success)
         return false;
 
-    std::wstring lookupName = directoryPath.filename().wstring() + L"_3D";
+    std::wstring dirName = directoryPath.filename().wstring();
+    std::wstring lookupName = dirName + L"_3D";
     success = Upload3DTextureFromData(lookupName.c_str(), outData.data(), width, height, sliceFiles.size(),
-        DXGI_FORMAT_R32G32B32A32_FLOAT, pDevice, pCommandList, codex);
+        DXGI_FORMAT_R32G32B32A32_FLOAT, pDevice, pCommandList, codex, IsTileable3DTexture(dirName));
+
+    if (success && IsCpuSampledTexture(lookupName))
+    {
+        FloatTexture& data = codex.InsertTextureData(GetResourceID(lookupName.c_str()));
+        data.width = (uint32_t)width;
+        data.height = (uint32_t)height;
+        data.depth = (uint32_t)sliceFiles.size();
+        data.texels = std::move(outData);
+    }
 
     return success;
 }
@@ -928,6 +1264,55 @@ void TextureFactory::LoadAll3DTextures(ID3D12Device* pDevice, ID3D12GraphicsComm
     }
 }
 
+// Spatiotemporal blue noise for the raymarch step jitter: xy tiles over the march texels, z cycles over frames.
+bool TextureFactory::CreateBlueNoiseTexture(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex)
+{
+    const wchar_t* BLUE_NOISE_NAME = L"BlueNoise_STBN";
+
+    BlueNoiseDesc desc;
+    desc.width = 64;
+    desc.height = 64;
+    desc.depth = 16;
+    desc.spatialSigma = 1.9f;
+    desc.depthSigma = 1.0f; // Tighter along time, so each pixel's sequence is well distributed over a short window
+
+    std::wstring cachePath = CACHEPATHW;
+    cachePath += L"BlueNoise_STBN_64x64x16.bin";
+
+    std::vector<float> values;
+    if (!LoadOrGenerateBlueNoise(desc, cachePath, values))
+    {
+        Printf(L"Error: Failed to generate blue noise for %s\n", BLUE_NOISE_NAME);
+        return false;
+    }
+
+    Muon::ResetCommandList(nullptr);
+
+    bool success = Upload3DTextureFromData(BLUE_NOISE_NAME, values.data(), desc.width, desc.height, desc.depth, DXGI_FORMAT_R32_FLOAT, pDevice, pCommandList, codex);
+
+    Texture* pBlueNoiseTex = success ? codex.GetTexture(GetResourceID(BLUE_NOISE_NAME)) : nullptr;
+    if (pBlueNoiseTex)
+    {
+        // Only read by compute
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+            pBlueNoiseTex->GetResource(),
+            D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+            D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE
+        ));
+    }
+
+    Muon::CloseCommandList();
+    Muon::ExecuteCommandList();
+
+    if (!pBlueNoiseTex)
+    {
+        Printf(L"Error: Failed to upload blue noise texture %s\n", BLUE_NOISE_NAME);
+        return false;
+    }
+
+    return true;
+}
+
 bool MaterialFactory::CreateAllMaterials(ResourceCodex& codex)
 {
     const ResourceID kPhongDiffuseId = GetResourceID(L"Bark_T.png");
@@ -23,14 +23,17 @@ struct ShaderFactory final
 struct TextureFactory final
 {
     static void LoadAllTextures(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
-    static bool Upload3DTextureFromData(const wchar_t* textureName, void* data, size_t width, size_t height, size_t depth, DXGI_FORMAT fmt, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
+    static bool Upload3DTextureFromData(const wchar_t* textureName, const void* data, size_t width, size_t height, size_t depth, DXGI_FORMAT fmt, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex, bool generateWrappedMips = false);
     static bool CreateOffscreenRenderTarget(ID3D12Device* pDevice, UINT width, UINT height);
+    static bool CreateCloudTargets(ID3D12Device* pDevice, UINT width, UINT height);
+    static bool CreateBeerShadowMap(ID3D12Device* pDevice, UINT resolution);
     
     static bool LoadTexturesForNVDF(std::filesystem::path directoryPath, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
     static bool Load3DTextureFromSlices(std::filesystem::path directoryPath, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
     static bool Load3DTextureFromDDS(std::filesystem::path directoryPath, ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
     static void LoadAllNVDF(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
     static void LoadAll3DTextures(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
+    static bool CreateBlueNoiseTexture(ID3D12Device* pDevice, ID3D12GraphicsCommandList* pCommandList, ResourceCodex& codex);
 };
 
 struct MeshFactory final
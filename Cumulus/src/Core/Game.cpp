@@ -17,6 +17,15 @@ Description : Implementation of Game.h
 #include <Core/Texture.h>
 #include <Utils/Utils.h>
 #include <Utils/AtmosphereUtils.h>
+#include <Utils/CloudBudgetUtils.h>
+#include <Utils/CloudInstanceUtils.h>
+#include <Utils/CloudLightingUtils.h>
+#include <Utils/HullBinningUtils.h>
+#include <Utils/RaymarchUtils.h>
+#include <Utils/RayIntervalUtils.h>
+
+#include <algorithm>
+#include <random>
 
 #include <imgui.h>
 #include <imgui_impl_win32.h>
@@ -28,9 +37,28 @@ Game::Game() :
     mOpaquePass(L"OpaquePass"),
     mAtmospherePass(L"AtmospherePass"),
     mSobelPass(L"SobelPass"),
+    mBeerShadowPass(L"BeerShadowPass"),
+    mCloudConeMarchPass(L"CloudConeMarchPass"),
+    mCloudRayIntervalClearPass(L"CloudRayIntervalClearPass"),
+    mCloudRayIntervalPass(L"CloudRayIntervalPass"),
+    mCloudPanoramaPass(L"CloudPanoramaPass"),
+    mHullBinningPass(L"HullBinningPass"),
     mRaymarchPass(L"RaymarchPass"),
-    mPostProcessPass(L"PostProcessPass")
+    mCloudTileStatsPass(L"CloudTileStatsPass"),
+    mCloudTileBudgetPass(L"CloudTileBudgetPass"),
+    mCloudTemporalPass(L"CloudTemporalPass"),
+    mCloudUpsamplePass(L"CloudUpsamplePass"),
+    mPostProcessPass(L"PostProcessPass"),
+    mCloudBrickCount(0),
+    mCloudParams(),
+    mBeerShadowParams(),
+    mBeerShadowRefreshDue(true),
+    mAtmosphereTables(),
+    mCloudHistoryIndex(0),
+    mCloudHistoryValid(false),
+    mTileBudgetValid(false)
 {
+    DirectX::XMStoreFloat4x4(&mPrevViewProj, DirectX::XMMatrixIdentity());
     mTimer.SetFixedTimeStep(false);
 }
 
@@ -52,6 +80,8 @@ bool Game::Init(HWND window, int width, int height)
     Muon::ResetCommandList(nullptr);
     // TODO: Create the offscreen render target externally, but register it in the codex so it can manage its lifetime. 
     TextureFactory::CreateOffscreenRenderTarget(Muon::GetDevice(), width, height);
+    TextureFactory::CreateCloudTargets(Muon::GetDevice(), width, height);
+    TextureFactory::CreateBeerShadowMap(Muon::GetDevice(), Muon::BEER_SHADOW_MAP_RESOLUTION);
 
     ResourceCodex& codex = ResourceCodex::GetSingleton();
 
@@ -85,6 +115,51 @@ bool Game::Init(HWND window, int width, int height)
             Printf(L"Warning: %s failed to generate!\n", mSobelPass.GetName());
     }
 
+    // Assemble cloud shadow map pass
+    {
+        mBeerShadowPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"BeerShadowMap.cs")));
+
+        if (!mBeerShadowPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mBeerShadowPass.GetName());
+    }
+
+    // Assemble cloud cone march prepass
+    {
+        mCloudConeMarchPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudConeMarch.cs")));
+
+        if (!mCloudConeMarchPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudConeMarchPass.GetName());
+    }
+
+    // Assemble cloud ray interval passes
+    {
+        mCloudRayIntervalClearPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudRayIntervalClear.cs")));
+
+        if (!mCloudRayIntervalClearPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudRayIntervalClearPass.GetName());
+
+        mCloudRayIntervalPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudRayIntervals.cs")));
+
+        if (!mCloudRayIntervalPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudRayIntervalPass.GetName());
+    }
+
+    // Assemble far-field cloud panorama pass
+    {
+        mCloudPanoramaPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudPanorama.cs")));
+
+        if (!mCloudPanoramaPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudPanoramaPass.GetName());
+    }
+
+    // Assemble hull tile binning pass
+    {
+        mHullBinningPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"HullBinning.cs")));
+
+        if (!mHullBinningPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mHullBinningPass.GetName());
+    }
+
     // Assemble raymarch pass
     {
         mRaymarchPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"Raymarch.cs")));
@@ -93,6 +168,35 @@ bool Game::Init(HWND window, int width, int height)
             Printf(L"Warning: %s failed to generate!\n", mRaymarchPass.GetName());
     }
 
+    // Assemble adaptive tile budget passes
+    {
+        mCloudTileStatsPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudTileStats.cs")));
+
+        if (!mCloudTileStatsPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudTileStatsPass.GetName());
+
+        mCloudTileBudgetPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudTileBudget.cs")));
+
+        if (!mCloudTileBudgetPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudTileBudgetPass.GetName());
+    }
+
+    // Assemble temporal cloud reconstruction pass
+    {
+        mCloudTemporalPass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudTemporal.cs")));
+
+        if (!mCloudTemporalPass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudTemporalPass.GetName());
+    }
+
+    // Assemble cloud upsample/composite pass
+    {
+        mCloudUpsamplePass.SetComputeShader(codex.GetComputeShader(GetResourceID(L"CloudUpsample.cs")));
+
+        if (!mCloudUpsamplePass.Generate())
+            Printf(L"Warning: %s failed to generate!\n", mCloudUpsamplePass.GetName());
+    }
+
     // Assemble post-process render pass
     {
         mPostProcessPass.SetVertexShader(codex.GetVertexShader(GetResourceID(L"Passthrough.vs")));
@@ -104,11 +208,6 @@ bool Game::Init(HWND window, int width, int height)
     }
 
 
-    mWorldMatrixBuffer.Create(L"world matrix buffer", sizeof(cbPerEntity));
-    UINT8* mapped = mWorldMatrixBuffer.GetMappedPtr();
-    assert(mapped);
-
-
     const float PI = 3.14159f;
     DirectX::XMMATRIX debugEntityWorld = DirectX::XMMatrixIdentity();
     debugEntityWorld = XMMatrixMultiply(debugEntityWorld, DirectX::XMMatrixRotationRollPitchYaw(0, 0, PI / 2.0f));
@@ -116,15 +215,17 @@ bool Game::Init(HWND window, int width, int height)
     debugEntityWorld = XMMatrixMultiply(debugEntityWorld, DirectX::XMMatrixScaling(0.12f, 0.12f, 0.12f));
     debugEntityWorld = XMMatrixMultiply(debugEntityWorld, DirectX::XMMatrixTranslation(0, 1, 0));
 
-    if (mapped)
+    // Everything the opaque pass draws. The raymarch tests the hulls of the same meshes, placed the same way.
+    if (const Mesh* pTeapot = codex.GetMesh(GetResourceID(L"teapot.obj")))
     {
-        using namespace DirectX;
-        cbPerEntity entity;
-        XMStoreFloat4x4(&entity.world, debugEntityWorld);
-        XMStoreFloat4x4(&entity.invWorld, DirectX::XMMatrixInverse(nullptr, debugEntityWorld));
-        memcpy(mapped, &entity, sizeof(entity));
+        mEntities.push_back({ pTeapot, DirectX::XMFLOAT4X4(), HULL_REGISTRY_INVALID, true });
+        DirectX::XMStoreFloat4x4(&mEntities.back().world, debugEntityWorld);
     }
 
+    mWorldMatrixBuffer.Create(L"world matrix buffer", AlignToBoundary((UINT)sizeof(cbPerEntity), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT) * std::max<size_t>(mEntities.size(), 1));
+    UINT8* mapped = mWorldMatrixBuffer.GetMappedPtr();
+    assert(mapped);
+
     mLightBuffer.Create(L"Light Buffer", sizeof(cbLights));
     mTimeBuffer.Create(L"Time", sizeof(cbTime));
     mAtmosphereBuffer.Create(L"Atmosphere CB", sizeof(cbAtmosphere));
@@ -152,48 +253,60 @@ bool Game::Init(HWND window, int width, int height)
         }
     }
 
-    //HULL:
-    //todo: concat all hulls
-    Hull h = m->GetHull();
-    mHullBuffer.Create(L"Hull Buffer", sizeof(cbHulls));
+    RegisterSceneHulls();
+    UpdateSceneEntities();
 
-    if (m && mHullBuffer.GetMappedPtr())
-    {
-        cbHulls hulls = {};
-        cbConvexHull cHull = {};
-        cHull.faceCount = (uint32_t)h.faces.size();
-        cHull.faceOffset = 0;
+    mTimeBuffer.Create(L"Time", sizeof(cbTime));
+    mCloudParamsBuffer.Create(L"Cloud Params", sizeof(cbCloudParams));
+    mBeerShadowParamsBuffer.Create(L"Beer Shadow Params", sizeof(cbBeerShadowParams));
+    mSkyAmbientBuffer.Create(L"Sky Ambient", sizeof(cbSkyAmbient));
 
+    mAtmosphereTables.irradiance = codex.GetTextureData(GetResourceID(L"irradiance_high.hdr"));
+    mAtmosphereTables.scattering = codex.GetTextureData(GetResourceID(L"TestHDR_3D"));
+    if (!mAtmosphereTables.irradiance || !mAtmosphereTables.scattering)
+        Printf(L"Warning: Atmosphere tables aren't on the CPU, clouds will render without sky ambient!\n");
 
-        XMStoreFloat4x4(&cHull.world, debugEntityWorld);
-        XMStoreFloat4x4(&cHull.invWorld, DirectX::XMMatrixInverse(nullptr, debugEntityWorld));
+    if (!mSunShadowVolume.Init(Muon::GetDevice(), codex.GetCloudDensityGrid(GetResourceID(L"StormbirdCloud_NVDF"))))
+        Printf(L"Warning: Clouds will render without sun shadows!\n");
 
-        hulls.hulls[0] = cHull;
-        hulls.hullCount = 1;
-        memcpy(mHullBuffer.GetMappedPtr(), &hulls, sizeof(hulls));
-    }
+    if (!mCloudScatteringLut.Init(Muon::GetDevice()))
+        Printf(L"Warning: Clouds will render without the scattering LUT!\n");
 
-    mHullFaceBuffer.Create(L"Hull Faces Buffer", sizeof(cbHullFaces));
-    if (m && h.faces.size() > 0) {
-        UINT8* facePtr = mHullFaceBuffer.GetMappedPtr();
-        cbHullFaces faces = {};
+    if (!mCloudDistanceBounds.Init(Muon::GetDevice(), codex.GetCloudDensityGrid(GetResourceID(L"StormbirdCloud_NVDF"))))
+        Printf(L"Warning: Clouds will march without the cone march prepass!\n");
+
+    if (!mCloudPanorama.Init(Muon::GetDevice()))
+        Printf(L"Warning: Clouds will march every sky ray to the far plane!\n");
+
+    // Bounds of the occupied bricks of the cloud volume, splatted every frame into per-ray intervals
+    mCloudBricksBuffer.Create(L"Cloud Bricks", sizeof(cbCloudBricks));
+    if (const CloudDensityGrid* pGrid = codex.GetCloudDensityGrid(GetResourceID(L"StormbirdCloud_NVDF")))
+    {
+        std::vector<CloudBrick> bricks;
+        BuildCloudBricks(*pGrid, bricks);
 
-        for (size_t i = 0; i < h.faces.size(); i++)
+        cbCloudBricks cloudBricks = {};
+        cloudBricks.brickCount = (uint32_t)std::min<size_t>(bricks.size(), MAX_CLOUD_BRICKS);
+        for (uint32_t i = 0; i < cloudBricks.brickCount; ++i)
         {
-            faces.faces[i] = DirectX::XMFLOAT4(
-                h.faces[i].normal.x,
-                h.faces[i].normal.y,
-                h.faces[i].normal.z,
-                h.faces[i].distance
-            );
+            cloudBricks.brickMin[i] = DirectX::XMFLOAT4(bricks[i].minBounds.x, bricks[i].minBounds.y, bricks[i].minBounds.z, 0.0f);
+            cloudBricks.brickMax[i] = DirectX::XMFLOAT4(bricks[i].maxBounds.x, bricks[i].maxBounds.y, bricks[i].maxBounds.z, 0.0f);
         }
 
-        if (facePtr) {
-            memcpy(facePtr, &faces, sizeof(faces));
+        UINT8* bricksPtr = mCloudBricksBuffer.GetMappedPtr();
+        if (bricksPtr)
+        {
+            memcpy(bricksPtr, &cloudBricks, sizeof(cloudBricks));
+            mCloudBrickCount = cloudBricks.brickCount;
         }
     }
+    else
+    {
+        Printf(L"Warning: No cloud density grid, clouds will march the whole volume!\n");
+    }
 
-    mTimeBuffer.Create(L"Time", sizeof(cbTime));
+    // Filled every Update
+    mCloudInstancesBuffer.Create(L"Cloud Instances", sizeof(cbCloudInstances));
 
     Muon::CloseCommandList();
     Muon::ExecuteCommandList();
@@ -247,11 +360,111 @@ void Game::Update(Muon::StepTimer const& timer)
     //Muon::InitializeAtmosphereConstants(atmosphereParams, 1280, 800);
     settings.sunDir = atmosphereParams.sun_direction;
 
+    const DirectX::XMFLOAT3 sunDirWS = Muon::AtmosphereToWorldDirection(atmosphereParams.sun_direction);
+    mSunShadowVolume.Update(sunDirWS, (uint32_t)std::max(settings.sunShadowSliceBudget, 1));
+    mCloudScatteringLut.Update(settings.cloudScattering);
+
+    // The cone march, brick intervals and panorama are all built from the base volume alone, so they sit out while instanced
+    if (settings.isFarFieldPanorama && !settings.isCloudInstanced)
+    {
+        DirectX::XMFLOAT3 cameraPosWS;
+        DirectX::XMStoreFloat3(&cameraPosWS, mCamera.GetPosition());
+        mCloudPanorama.Update(cameraPosWS, sunDirWS, settings.farFieldDistance, settings.panoramaMoveTolerance, (uint32_t)std::max(settings.panoramaRowBudget, 1));
+    }
+
+    // The Beer shadow map is re-rendered every few frames, only then does it follow the sun
+    const uint32_t beerShadowInterval = (uint32_t)std::max(settings.beerShadowRefreshInterval, 1);
+    mBeerShadowRefreshDue = !mBeerShadowParams.beerShadowValid || (timer.GetFrameCount() % beerShadowInterval) == 0;
+    if (mBeerShadowRefreshDue)
+    {
+        Muon::BeerShadowMapView view = Muon::GetBeerShadowMapView(sunDirWS);
+        mBeerShadowParams.sunMapOrigin = view.origin;
+        mBeerShadowParams.sunMapExtent = view.extent;
+        mBeerShadowParams.sunMapRight = view.right;
+        mBeerShadowParams.sunMapDepthRange = view.depthRange;
+        mBeerShadowParams.sunMapUp = view.up;
+        mBeerShadowParams.sunMapForward = view.forward;
+        mBeerShadowParams.beerShadowResolution = Muon::BEER_SHADOW_MAP_RESOLUTION;
+
+        mapped = mBeerShadowParamsBuffer.GetMappedPtr();
+        if (mapped)
+            memcpy(mapped, &mBeerShadowParams, sizeof(Muon::cbBeerShadowParams));
+    }
+
+    // Sky light for the clouds, from the same tables the sky is drawn with. A few hundred table lookups, cheap enough every frame.
+    {
+        Muon::cbSkyAmbient skyAmbient = {};
+        DirectX::XMFLOAT3 skySH[Muon::SKY_SH_COEFFICIENT_COUNT];
+        if (Muon::ProjectSkyAmbientSH(mAtmosphereTables, atmosphereParams.sun_direction, atmosphereParams.exposure, atmosphereParams.white_point, skySH))
+        {
+            for (uint32_t i = 0; i < Muon::SKY_SH_COEFFICIENT_COUNT; ++i)
+                skyAmbient.skySH[i] = DirectX::XMFLOAT4(skySH[i].x * settings.skyAmbientScale, skySH[i].y * settings.skyAmbientScale, skySH[i].z * settings.skyAmbientScale, 0.0f);
+            skyAmbient.skyAmbientValid = 1;
+        }
+
+        mapped = mSkyAmbientBuffer.GetMappedPtr();
+        if (mapped)
+            memcpy(mapped, &skyAmbient, sizeof(Muon::cbSkyAmbient));
+    }
+
     mapped = mAtmosphereBuffer.GetMappedPtr();
     if (mapped)
     {
         memcpy(mapped, &atmosphereParams, sizeof(Muon::cbAtmosphere));
     }
+
+    UpdateCloudInstances(time.totalTime);
+
+    // Writes only the hulls registered or moved since last frame
+    UpdateSceneEntities();
+    mHullRegistry.Update();
+
+    // History is only meaningful while temporal mode stays on
+    if (!settings.isCloudTemporal)
+        mCloudHistoryValid = false;
+
+    const Muon::Texture* pOffscreenTarget = Muon::GetOffscreenTarget();
+    if (pOffscreenTarget)
+    {
+        Muon::cbCloudParams& cloudParams = mCloudParams;
+        cloudParams.prevViewProj = mPrevViewProj;
+        cloudParams.fullResolution = DirectX::XMUINT2((uint32_t)pOffscreenTarget->GetWidth(), (uint32_t)pOffscreenTarget->GetHeight());
+        cloudParams.frameIndex = (uint32_t)timer.GetFrameCount();
+        cloudParams.temporalEnabled = settings.isCloudTemporal ? 1 : 0;
+        cloudParams.historyValid = mCloudHistoryValid ? 1 : 0;
+        cloudParams.stepSizeScale = std::max(settings.cloudStepSizeScale, 0.01f);
+        cloudParams.sunShadowValid = mSunShadowVolume.IsValid() ? 1 : 0;
+        cloudParams.sunDirection = sunDirWS;
+        cloudParams.scatteringLutValid = mCloudScatteringLut.IsValid() ? 1 : 0;
+
+        if (settings.isCloudTemporal)
+        {
+            cloudParams.resolutionDivisor = Muon::CLOUD_TEMPORAL_BLOCK_SIZE;
+            cloudParams.marchPixelOffset = Muon::GetTemporalMarchOffset(cloudParams.frameIndex);
+        }
+        else
+        {
+            cloudParams.resolutionDivisor = (uint32_t)std::max(settings.cloudResolutionDivisor, 1);
+            cloudParams.marchPixelOffset = Muon::GetCenteredMarchOffset(cloudParams.resolutionDivisor);
+        }
+
+        DirectX::XMUINT2 marchResolution = Muon::GetMarchResolution(cloudParams.fullResolution.x, cloudParams.fullResolution.y, cloudParams.resolutionDivisor);
+
+        // The tile allocation only carries over while the tiles cover the same texels
+        if (!settings.isAdaptiveTileBudget || marchResolution.x != cloudParams.marchResolution.x || marchResolution.y != cloudParams.marchResolution.y)
+            mTileBudgetValid = false;
+
+        cloudParams.marchResolution = marchResolution;
+        cloudParams.tileBudgetEnabled = settings.isAdaptiveTileBudget ? 1 : 0;
+        cloudParams.tileBudgetValid = mTileBudgetValid ? 1 : 0;
+
+        mapped = mCloudParamsBuffer.GetMappedPtr();
+        if (mapped)
+            memcpy(mapped, &cloudParams, sizeof(Muon::cbCloudParams));
+    }
+
+    // Next frame reprojects against this frame's camera
+    DirectX::XMStoreFloat4x4(&mPrevViewProj, DirectX::XMMatrixMultiply(mCamera.GetView(), mCamera.GetProjection()));
 }
 
 void Game::Render()
@@ -276,15 +489,61 @@ void Game::Render()
     
     Texture* pOffscreenTarget = codex.GetTexture(GetResourceID(L"OffscreenTarget"));
     Texture* pComputeOutput = codex.GetTexture(GetResourceID(L"SobelOutput"));
-    if (!pOffscreenTarget || !pComputeOutput)
+    Texture* pCloudTarget = codex.GetTexture(GetResourceID(L"CloudTarget"));
+    Texture* pCloudDepthTarget = codex.GetTexture(GetResourceID(L"CloudDepthTarget"));
+    if (!pOffscreenTarget || !pComputeOutput || !pCloudTarget || !pCloudDepthTarget)
     {
-        Muon::Printf("Error: Game::Render Failed to fetch the offscreen target and compute output textures.\n");
+        Muon::Printf("Error: Game::Render Failed to fetch the offscreen target, cloud targets and compute output textures.\n");
         return;
     }
 
     ID3D12GraphicsCommandList* pCommandList = GetCommandList();
     pCommandList->SetDescriptorHeaps(1, GetSRVHeap()->GetHeapAddr());
 
+    // Cloud shadows from the sun, consumed by both the opaque pass and the raymarch
+    Texture* pBeerShadowMap = codex.GetTexture(GetResourceID(L"BeerShadowMap"));
+    if (pBeerShadowMap && mBeerShadowRefreshDue && mBeerShadowPass.Bind(pCommandList))
+    {
+        Texture* pSdfNVDF = codex.GetTexture(GetResourceID(L"StormbirdCloud_NVDF"));
+
+        int32_t beerParamsIdx = mBeerShadowPass.GetResourceRootIndex("BeerShadowParams");
+        if (beerParamsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(beerParamsIdx, mBeerShadowParamsBuffer.GetGPUVirtualAddress());
+        }
+
+        int32_t sdfNvdfIdx = mBeerShadowPass.GetResourceRootIndex("sdfNvdfTex");
+        if (pSdfNVDF && sdfNvdfIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(sdfNvdfIdx, pSdfNVDF->GetSRVHandleGPU());
+        }
+
+        int32_t shadowMapOutIdx = mBeerShadowPass.GetResourceRootIndex("gBeerShadowMap");
+        if (shadowMapOutIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(shadowMapOutIdx, pBeerShadowMap->GetUAVHandleGPU());
+        }
+
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pBeerShadowMap->GetResource(),
+            D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+        UINT numGroups = (UINT)ceilf(Muon::BEER_SHADOW_MAP_RESOLUTION / 8.0f);
+        pCommandList->Dispatch(numGroups, numGroups, 1);
+
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pBeerShadowMap->GetResource(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ));
+
+        // Readers only trust the map once it has been rendered. The command list hasn't been executed yet, so this lands in time.
+        if (!mBeerShadowParams.beerShadowValid)
+        {
+            mBeerShadowParams.beerShadowValid = 1;
+
+            UINT8* mapped = mBeerShadowParamsBuffer.GetMappedPtr();
+            if (mapped)
+                memcpy(mapped, &mBeerShadowParams, sizeof(Muon::cbBeerShadowParams));
+        }
+    }
+
     if (mAtmospherePass.Bind(pCommandList))
     {
         const Texture* pTransmittanceTex = codex.GetTexture(GetResourceID(L"transmittance_high.hdr"));
@@ -341,13 +600,6 @@ void Game::Render()
             mCamera.Bind(cameraRootIdx, pCommandList);
         }
 
-        // Bind the world matrix Upload Buffer to the root index known by the material
-        int32_t worldMatrixRootIdx = mOpaquePass.GetResourceRootIndex("VSWorld");
-        if (worldMatrixRootIdx != ROOTIDX_INVALID)
-        {
-            pCommandList->SetGraphicsRootConstantBufferView(worldMatrixRootIdx, mWorldMatrixBuffer.GetGPUVirtualAddress());
-        }
-     
         int32_t lightsRootIdx = mOpaquePass.GetResourceRootIndex("PSLights");
         if (lightsRootIdx != ROOTIDX_INVALID)
         {
@@ -360,10 +612,29 @@ void Game::Render()
             pCommandList->SetGraphicsRootConstantBufferView(timeRootIdx, mTimeBuffer.GetGPUVirtualAddress());
         }
 
-        const Mesh* pMesh = codex.GetMesh(GetResourceID(L"teapot.obj"));
-        if (pMesh)
+        int32_t beerParamsIdx = mOpaquePass.GetResourceRootIndex("BeerShadowParams");
+        if (beerParamsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetGraphicsRootConstantBufferView(beerParamsIdx, mBeerShadowParamsBuffer.GetGPUVirtualAddress());
+        }
+
+        int32_t beerShadowIdx = mOpaquePass.GetResourceRootIndex("beerShadowMap");
+        if (pBeerShadowMap && beerShadowIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetGraphicsRootDescriptorTable(beerShadowIdx, pBeerShadowMap->GetSRVHandleGPU());
+        }
+
+        // Each entity's world matrix sits at its own offset of the world matrix Upload Buffer
+        int32_t worldMatrixRootIdx = mOpaquePass.GetResourceRootIndex("VSWorld");
+        const UINT entityStride = AlignToBoundary((UINT)sizeof(cbPerEntity), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+        for (size_t i = 0; i < mEntities.size(); ++i)
         {
-            pMesh->DrawIndexed(pCommandList);
+            if (worldMatrixRootIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetGraphicsRootConstantBufferView(worldMatrixRootIdx, mWorldMatrixBuffer.GetGPUVirtualAddress() + i * entityStride);
+            }
+
+            mEntities[i].pMesh->DrawIndexed(pCommandList);
         }
     }
 
@@ -371,69 +642,522 @@ void Game::Render()
     pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(GetDepthStencilResource(),
         D3D12_RESOURCE_STATE_DEPTH_WRITE, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
 
+    pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pOffscreenTarget->GetResource(),
+        D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ));
+
+    const DirectX::XMUINT2 marchResolution = mCloudParams.marchResolution;
+
+    // Copy any sun shadow slices baked during Update
+    mSunShadowVolume.RecordUpload(pCommandList);
+    mCloudScatteringLut.RecordUpload(pCommandList);
+    mCloudDistanceBounds.RecordUpload(pCommandList);
+
+    // Find how far each 8x8 tile's rays can skip before they could reach a cloud
+    Texture* pConeStart = codex.GetTexture(GetResourceID(L"CloudConeStart"));
+    bool coneStartValid = false;
+    if (settings.isConeMarchPrepass && !settings.isCloudInstanced && pConeStart && mCloudDistanceBounds.IsValid() && mCloudConeMarchPass.Bind(pCommandList))
+    {
+        int32_t cameraRootIdx = mCloudConeMarchPass.GetResourceRootIndex("VSCamera");
+        if (cameraRootIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(cameraRootIdx, mCamera.GetGPUVirtualAddress());
+        }
+
+        int32_t cloudParamsIdx = mCloudConeMarchPass.GetResourceRootIndex("CloudParams");
+        if (cloudParamsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+        }
+
+        int32_t boundsIdx = mCloudConeMarchPass.GetResourceRootIndex("cloudEmptyDistanceTex");
+        if (boundsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(boundsIdx, mCloudDistanceBounds.GetTexture().GetSRVHandleGPU());
+        }
+
+        int32_t coneStartOutIdx = mCloudConeMarchPass.GetResourceRootIndex("gConeStart");
+        if (coneStartOutIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(coneStartOutIdx, pConeStart->GetUAVHandleGPU());
+        }
+
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pConeStart->GetResource(),
+            D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+        UINT numGroupsX = (UINT)ceilf(pConeStart->GetWidth() / 8.0f);
+        UINT numGroupsY = (UINT)ceilf(pConeStart->GetHeight() / 8.0f);
+        pCommandList->Dispatch(numGroupsX, numGroupsY, 1);
+
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pConeStart->GetResource(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ));
+
+        coneStartValid = true;
+    }
+
+    // Splat the occupied bricks into each march texel's [enter, exit] interval
+    Texture* pRayEnter = codex.GetTexture(GetResourceID(L"CloudRayEnter"));
+    Texture* pRayExit = codex.GetTexture(GetResourceID(L"CloudRayExit"));
+    bool rayIntervalValid = false;
+    if (settings.isRayIntervals && !settings.isCloudInstanced && pRayEnter && pRayExit && mCloudBrickCount > 0)
+    {
+        CD3DX12_RESOURCE_BARRIER toUAV[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pRayEnter->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+            CD3DX12_RESOURCE_BARRIER::Transition(pRayExit->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+        };
+        pCommandList->ResourceBarrier(_countof(toUAV), toUAV);
+
+        bool cleared = false;
+        if (mCloudRayIntervalClearPass.Bind(pCommandList))
+        {
+            int32_t cloudParamsIdx = mCloudRayIntervalClearPass.GetResourceRootIndex("CloudParams");
+            if (cloudParamsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+            }
+
+            int32_t enterIdx = mCloudRayIntervalClearPass.GetResourceRootIndex("gRayEnter");
+            if (enterIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(enterIdx, pRayEnter->GetUAVHandleGPU());
+            }
+
+            int32_t exitIdx = mCloudRayIntervalClearPass.GetResourceRootIndex("gRayExit");
+            if (exitIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(exitIdx, pRayExit->GetUAVHandleGPU());
+            }
+
+            UINT numGroupsX = (UINT)ceilf(marchResolution.x / 8.0f);
+            UINT numGroupsY = (UINT)ceilf(marchResolution.y / 8.0f);
+            pCommandList->Dispatch(numGroupsX, numGroupsY, 1);
+            cleared = true;
+        }
+
+        // The splat's atomics have to land after the clear
+        CD3DX12_RESOURCE_BARRIER clearDone[] = {
+            CD3DX12_RESOURCE_BARRIER::UAV(pRayEnter->GetResource()),
+            CD3DX12_RESOURCE_BARRIER::UAV(pRayExit->GetResource())
+        };
+        pCommandList->ResourceBarrier(_countof(clearDone), clearDone);
+
+        if (cleared && mCloudRayIntervalPass.Bind(pCommandList))
+        {
+            int32_t cameraRootIdx = mCloudRayIntervalPass.GetResourceRootIndex("VSCamera");
+            if (cameraRootIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootConstantBufferView(cameraRootIdx, mCamera.GetGPUVirtualAddress());
+            }
+
+            int32_t cloudParamsIdx = mCloudRayIntervalPass.GetResourceRootIndex("CloudParams");
+            if (cloudParamsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+            }
+
+            int32_t bricksIdx = mCloudRayIntervalPass.GetResourceRootIndex("CloudBricks");
+            if (bricksIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootConstantBufferView(bricksIdx, mCloudBricksBuffer.GetGPUVirtualAddress());
+            }
+
+            int32_t enterIdx = mCloudRayIntervalPass.GetResourceRootIndex("gRayEnter");
+            if (enterIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(enterIdx, pRayEnter->GetUAVHandleGPU());
+            }
+
+            int32_t exitIdx = mCloudRayIntervalPass.GetResourceRootIndex("gRayExit");
+            if (exitIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(exitIdx, pRayExit->GetUAVHandleGPU());
+            }
+
+            // One group per brick
+            pCommandList->Dispatch(mCloudBrickCount, 1, 1);
+            rayIntervalValid = true;
+        }
+
+        CD3DX12_RESOURCE_BARRIER toRead[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pRayEnter->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(pRayExit->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ)
+        };
+        pCommandList->ResourceBarrier(_countof(toRead), toRead);
+    }
+
+    // Far-field panorama rows scheduled during Update. Recorded before the raymarch so a finished sweep is read this frame.
+    if (settings.isFarFieldPanorama && !settings.isCloudInstanced && mCloudPanorama.IsBakeDue() && mCloudPanoramaPass.Bind(pCommandList))
+    {
+        BindCloudMarchResources(mCloudPanoramaPass, pCommandList);
+        mCloudPanorama.RecordBake(mCloudPanoramaPass, pCommandList);
+    }
+
+    // Bin the hulls' screen boxes into the tiles the raymarch reads its hull lists from
+    Texture* pHullTiles = codex.GetTexture(GetResourceID(L"CloudHullTiles"));
+    bool hullTilesValid = false;
+    if (settings.isHullTiles && pHullTiles && mHullRegistry.GetHullBounds().size() > 0 && mHullBinningPass.Bind(pCommandList))
+    {
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pHullTiles->GetResource(),
+            D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+        int32_t cameraRootIdx = mHullBinningPass.GetResourceRootIndex("VSCamera");
+        if (cameraRootIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(cameraRootIdx, mCamera.GetGPUVirtualAddress());
+        }
+
+        int32_t cloudParamsIdx = mHullBinningPass.GetResourceRootIndex("CloudParams");
+        if (cloudParamsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+        }
+
+        mHullRegistry.Bind(mHullBinningPass, pCommandList);
+
+        int32_t hullTilesIdx = mHullBinningPass.GetResourceRootIndex("gHullTiles");
+        if (hullTilesIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(hullTilesIdx, pHullTiles->GetUAVHandleGPU());
+        }
+
+        // One group per tile
+        pCommandList->Dispatch(Muon::GetHullTileCount(marchResolution.x), Muon::GetHullTileCount(marchResolution.y), 1);
+        hullTilesValid = true;
+
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pHullTiles->GetResource(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ));
+    }
+
+    // Neither pass above reads these, so patching them in now is safe
+    {
+        mCloudParams.hullTilesValid = hullTilesValid ? 1 : 0;
+        mCloudParams.coneStartValid = coneStartValid ? 1 : 0;
+        mCloudParams.rayIntervalValid = rayIntervalValid ? 1 : 0;
+        mCloudParams.panoramaValid = settings.isFarFieldPanorama && !settings.isCloudInstanced && mCloudPanorama.IsValid() ? 1 : 0;
+        mCloudParams.panoramaOrigin = mCloudPanorama.GetOrigin();
+        mCloudParams.farFieldDistance = mCloudPanorama.GetFarFieldDistance();
+
+        UINT8* mapped = mCloudParamsBuffer.GetMappedPtr();
+        if (mapped)
+            memcpy(mapped, &mCloudParams, sizeof(Muon::cbCloudParams));
+    }
+
+    // The raymarch counts its steps per tile into these, and next frame's multipliers come out of them
+    Texture* pTileStats = codex.GetTexture(GetResourceID(L"CloudTileStats"));
+    Texture* pTileSteps = codex.GetTexture(GetResourceID(L"CloudTileSteps"));
+    Texture* pTileStepScale = codex.GetTexture(GetResourceID(L"CloudTileStepScale"));
+    const bool tileBudgetEnabled = mCloudParams.tileBudgetEnabled && pTileStats && pTileSteps && pTileStepScale;
+    if (tileBudgetEnabled)
+    {
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pTileSteps->GetResource(),
+            D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+    }
+
     if (mRaymarchPass.Bind(pCommandList))
     {
-        Texture* pSdfNVDF = codex.GetTexture(GetResourceID(L"StormbirdCloud_NVDF"));
-        Texture* pNoise = codex.GetTexture(GetResourceID(L"Noise_3D"));
+        BindCloudMarchResources(mRaymarchPass, pCommandList);
 
-        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pOffscreenTarget->GetResource(),
-            D3D12_RESOURCE_STATE_RENDER_TARGET, D3D12_RESOURCE_STATE_GENERIC_READ));
+        int32_t cloudOutIdx = mRaymarchPass.GetResourceRootIndex("gCloudOutput");
+        if (cloudOutIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(cloudOutIdx, pCloudTarget->GetUAVHandleGPU());
+        }
 
-        // Bind the Camera's Upload Buffer to the root index known by the material
-        int32_t cameraRootIdx = mRaymarchPass.GetResourceRootIndex("VSCamera");
+        int32_t cloudDepthOutIdx = mRaymarchPass.GetResourceRootIndex("gCloudDepth");
+        if (cloudDepthOutIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(cloudDepthOutIdx, pCloudDepthTarget->GetUAVHandleGPU());
+        }
+
+        int32_t coneStartIdx = mRaymarchPass.GetResourceRootIndex("coneStartTex");
+        if (coneStartValid && coneStartIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(coneStartIdx, pConeStart->GetSRVHandleGPU());
+        }
+
+        int32_t rayEnterIdx = mRaymarchPass.GetResourceRootIndex("rayEnterTex");
+        if (rayIntervalValid && rayEnterIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(rayEnterIdx, pRayEnter->GetSRVHandleGPU());
+        }
+
+        int32_t rayExitIdx = mRaymarchPass.GetResourceRootIndex("rayExitTex");
+        if (rayIntervalValid && rayExitIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(rayExitIdx, pRayExit->GetSRVHandleGPU());
+        }
+
+        int32_t hullTilesIdx = mRaymarchPass.GetResourceRootIndex("hullTilesTex");
+        if (hullTilesValid && hullTilesIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(hullTilesIdx, pHullTiles->GetSRVHandleGPU());
+        }
+
+        int32_t tileStepScaleIdx = mRaymarchPass.GetResourceRootIndex("tileStepScaleTex");
+        if (tileBudgetEnabled && tileStepScaleIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(tileStepScaleIdx, pTileStepScale->GetSRVHandleGPU());
+        }
+
+        int32_t tileStepsIdx = mRaymarchPass.GetResourceRootIndex("gTileSteps");
+        if (tileBudgetEnabled && tileStepsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(tileStepsIdx, pTileSteps->GetUAVHandleGPU());
+        }
+
+        int32_t panoramaIdx = mRaymarchPass.GetResourceRootIndex("cloudPanoramaTex");
+        if (mCloudPanorama.IsValid() && panoramaIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(panoramaIdx, mCloudPanorama.GetTexture().GetSRVHandleGPU());
+        }
+
+        CD3DX12_RESOURCE_BARRIER toUAV[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pCloudTarget->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+            CD3DX12_RESOURCE_BARRIER::Transition(pCloudDepthTarget->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+        };
+        pCommandList->ResourceBarrier(_countof(toUAV), toUAV);
+
+        // Only the march resolution region of the cloud targets is written
+        UINT numGroupsX = (UINT)ceilf(marchResolution.x / 16.0f);
+        UINT numGroupsY = (UINT)ceilf(marchResolution.y / 16.0f);
+        pCommandList->Dispatch(numGroupsX, numGroupsY, 1);
+
+        CD3DX12_RESOURCE_BARRIER toRead[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pCloudTarget->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(pCloudDepthTarget->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ)
+        };
+        pCommandList->ResourceBarrier(_countof(toRead), toRead);
+    }
+
+    // Measure this frame's tiles and hand out next frame's step size multipliers
+    if (tileBudgetEnabled)
+    {
+        // Stats read the step counts the raymarch just added
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::UAV(pTileSteps->GetResource()));
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pTileStats->GetResource(),
+            D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
+
+        const UINT tilesX = GetBudgetTileCount(marchResolution.x);
+        const UINT tilesY = GetBudgetTileCount(marchResolution.y);
+
+        bool measured = false;
+        if (mCloudTileStatsPass.Bind(pCommandList))
+        {
+            int32_t cloudParamsIdx = mCloudTileStatsPass.GetResourceRootIndex("CloudParams");
+            if (cloudParamsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+            }
+
+            int32_t cloudIdx = mCloudTileStatsPass.GetResourceRootIndex("cloudTex");
+            if (cloudIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(cloudIdx, pCloudTarget->GetSRVHandleGPU());
+            }
+
+            int32_t stepScaleIdx = mCloudTileStatsPass.GetResourceRootIndex("tileStepScaleTex");
+            if (stepScaleIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(stepScaleIdx, pTileStepScale->GetSRVHandleGPU());
+            }
+
+            int32_t statsIdx = mCloudTileStatsPass.GetResourceRootIndex("gTileStats");
+            if (statsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(statsIdx, pTileStats->GetUAVHandleGPU());
+            }
+
+            int32_t stepsIdx = mCloudTileStatsPass.GetResourceRootIndex("gTileSteps");
+            if (stepsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(stepsIdx, pTileSteps->GetUAVHandleGPU());
+            }
+
+            // One group per tile
+            pCommandList->Dispatch(tilesX, tilesY, 1);
+            measured = true;
+        }
+
+        CD3DX12_RESOURCE_BARRIER statsDone[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pTileStats->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(pTileSteps->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(pTileStepScale->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+        };
+        pCommandList->ResourceBarrier(_countof(statsDone), statsDone);
+
+        if (measured && mCloudTileBudgetPass.Bind(pCommandList))
+        {
+            int32_t cloudParamsIdx = mCloudTileBudgetPass.GetResourceRootIndex("CloudParams");
+            if (cloudParamsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+            }
+
+            int32_t statsIdx = mCloudTileBudgetPass.GetResourceRootIndex("tileStatsTex");
+            if (statsIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(statsIdx, pTileStats->GetSRVHandleGPU());
+            }
+
+            int32_t stepScaleIdx = mCloudTileBudgetPass.GetResourceRootIndex("gTileStepScale");
+            if (stepScaleIdx != ROOTIDX_INVALID)
+            {
+                pCommandList->SetComputeRootDescriptorTable(stepScaleIdx, pTileStepScale->GetUAVHandleGPU());
+            }
+
+            // A single group solves the whole screen
+            pCommandList->Dispatch(1, 1, 1);
+            mTileBudgetValid = true;
+        }
+
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pTileStepScale->GetResource(),
+            D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ));
+    }
+
+    // In temporal mode the sparse samples are first resolved to full resolution against last frame's result
+    Texture* pCloudComposite = pCloudTarget;
+    Texture* pHistory = codex.GetTexture(GetResourceID(mCloudHistoryIndex == 0 ? L"CloudHistory0" : L"CloudHistory1"));
+    Texture* pHistoryDepth = codex.GetTexture(GetResourceID(mCloudHistoryIndex == 0 ? L"CloudHistoryDepth0" : L"CloudHistoryDepth1"));
+    Texture* pResolved = codex.GetTexture(GetResourceID(mCloudHistoryIndex == 0 ? L"CloudHistory1" : L"CloudHistory0"));
+    Texture* pResolvedDepth = codex.GetTexture(GetResourceID(mCloudHistoryIndex == 0 ? L"CloudHistoryDepth1" : L"CloudHistoryDepth0"));
+    bool hasHistoryTargets = pHistory && pHistoryDepth && pResolved && pResolvedDepth;
+    bool cloudsResolved = false;
+
+    if (mCloudParams.temporalEnabled && hasHistoryTargets && mCloudTemporalPass.Bind(pCommandList))
+    {
+        int32_t cameraRootIdx = mCloudTemporalPass.GetResourceRootIndex("VSCamera");
         if (cameraRootIdx != ROOTIDX_INVALID)
         {
             pCommandList->SetComputeRootConstantBufferView(cameraRootIdx, mCamera.GetGPUVirtualAddress());
         }
 
-        int32_t aabbIdx = mRaymarchPass.GetResourceRootIndex("AABBBuffer");
-        if (aabbIdx != ROOTIDX_INVALID)
+        int32_t cloudParamsIdx = mCloudTemporalPass.GetResourceRootIndex("CloudParams");
+        if (cloudParamsIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootConstantBufferView(aabbIdx, mAABBBuffer.GetGPUVirtualAddress());
+            pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
         }
 
-        int32_t hullIdx = mRaymarchPass.GetResourceRootIndex("HullsBuffer");
-        if (hullIdx != ROOTIDX_INVALID)
+        int32_t cloudIdx = mCloudTemporalPass.GetResourceRootIndex("cloudTex");
+        if (cloudIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootConstantBufferView(hullIdx, mHullBuffer.GetGPUVirtualAddress());
+            pCommandList->SetComputeRootDescriptorTable(cloudIdx, pCloudTarget->GetSRVHandleGPU());
         }
 
-        int32_t hullFaceIdx = mRaymarchPass.GetResourceRootIndex("HullFacesBuffer");
-        if (hullFaceIdx != ROOTIDX_INVALID)
+        int32_t cloudDepthIdx = mCloudTemporalPass.GetResourceRootIndex("cloudDepthTex");
+        if (cloudDepthIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootConstantBufferView(hullFaceIdx, mHullFaceBuffer.GetGPUVirtualAddress());
+            pCommandList->SetComputeRootDescriptorTable(cloudDepthIdx, pCloudDepthTarget->GetSRVHandleGPU());
         }
 
-        int32_t inIdx = mRaymarchPass.GetResourceRootIndex("gInput");
-        if (inIdx != ROOTIDX_INVALID)
+        int32_t historyIdx = mCloudTemporalPass.GetResourceRootIndex("historyTex");
+        if (historyIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootDescriptorTable(inIdx, pOffscreenTarget->GetSRVHandleGPU());
+            pCommandList->SetComputeRootDescriptorTable(historyIdx, pHistory->GetSRVHandleGPU());
         }
 
-        int32_t outIdx = mRaymarchPass.GetResourceRootIndex("gOutput");
-        if (outIdx != ROOTIDX_INVALID)
+        int32_t historyDepthIdx = mCloudTemporalPass.GetResourceRootIndex("historyDepthTex");
+        if (historyDepthIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootDescriptorTable(outIdx, pComputeOutput->GetUAVHandleGPU());
+            pCommandList->SetComputeRootDescriptorTable(historyDepthIdx, pHistoryDepth->GetSRVHandleGPU());
+        }
+
+        int32_t depthBufferIdx = mCloudTemporalPass.GetResourceRootIndex("depthStencilBuffer");
+        if (depthBufferIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(depthBufferIdx, GetDepthStencilSRV().HandleGPU);
+        }
+
+        int32_t resolvedIdx = mCloudTemporalPass.GetResourceRootIndex("gCloudResolved");
+        if (resolvedIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(resolvedIdx, pResolved->GetUAVHandleGPU());
+        }
+
+        int32_t resolvedDepthIdx = mCloudTemporalPass.GetResourceRootIndex("gCloudResolvedDepth");
+        if (resolvedDepthIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(resolvedDepthIdx, pResolvedDepth->GetUAVHandleGPU());
+        }
+
+        CD3DX12_RESOURCE_BARRIER toUAV[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pResolved->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS),
+            CD3DX12_RESOURCE_BARRIER::Transition(pResolvedDepth->GetResource(), D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS)
+        };
+        pCommandList->ResourceBarrier(_countof(toUAV), toUAV);
+
+        UINT numGroupsX = (UINT)ceilf(pOffscreenTarget->GetWidth() / 16.0f);
+        UINT numGroupsY = (UINT)ceilf(pOffscreenTarget->GetHeight() / 16.0f);
+        pCommandList->Dispatch(numGroupsX, numGroupsY, 1);
+
+        CD3DX12_RESOURCE_BARRIER toRead[] = {
+            CD3DX12_RESOURCE_BARRIER::Transition(pResolved->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ),
+            CD3DX12_RESOURCE_BARRIER::Transition(pResolvedDepth->GetResource(), D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ)
+        };
+        pCommandList->ResourceBarrier(_countof(toRead), toRead);
+
+        // This frame's result becomes next frame's history
+        pCloudComposite = pResolved;
+        mCloudHistoryIndex = 1 - mCloudHistoryIndex;
+        mCloudHistoryValid = true;
+        cloudsResolved = true;
+    }
+
+    // Without the resolve, cloudTex is still the sparse march output, so the upsample has to filter it like a reduced
+    // resolution march. Only the upsample reads temporalEnabled, so patching it in now is safe.
+    if (mCloudParams.temporalEnabled && !cloudsResolved)
+    {
+        mCloudParams.temporalEnabled = 0;
+        mCloudHistoryValid = false;
+
+        UINT8* mapped = mCloudParamsBuffer.GetMappedPtr();
+        if (mapped)
+            memcpy(mapped, &mCloudParams, sizeof(Muon::cbCloudParams));
+    }
+
+    // Upsample the clouds to full resolution and composite them over the scene
+    if (mCloudUpsamplePass.Bind(pCommandList))
+    {
+        int32_t cameraRootIdx = mCloudUpsamplePass.GetResourceRootIndex("VSCamera");
+        if (cameraRootIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(cameraRootIdx, mCamera.GetGPUVirtualAddress());
+        }
+
+        int32_t cloudParamsIdx = mCloudUpsamplePass.GetResourceRootIndex("CloudParams");
+        if (cloudParamsIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+        }
+
+        int32_t inIdx = mCloudUpsamplePass.GetResourceRootIndex("gInput");
+        if (inIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(inIdx, pOffscreenTarget->GetSRVHandleGPU());
         }
 
-        int32_t sdfNVDFIndex = mRaymarchPass.GetResourceRootIndex("sdfNvdfTex");
-        if (sdfNVDFIndex != ROOTIDX_INVALID)
+        int32_t cloudIdx = mCloudUpsamplePass.GetResourceRootIndex("cloudTex");
+        if (cloudIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootDescriptorTable(sdfNVDFIndex, pSdfNVDF->GetSRVHandleGPU());
+            pCommandList->SetComputeRootDescriptorTable(cloudIdx, pCloudComposite->GetSRVHandleGPU());
         }
 
-        int32_t noiseIndex = mRaymarchPass.GetResourceRootIndex("noiseTex"); 
-        if (noiseIndex != ROOTIDX_INVALID)
+        int32_t cloudDepthIdx = mCloudUpsamplePass.GetResourceRootIndex("cloudDepthTex");
+        if (cloudDepthIdx != ROOTIDX_INVALID)
         {
-            pCommandList->SetComputeRootDescriptorTable(noiseIndex, pNoise->GetSRVHandleGPU()); 
+            pCommandList->SetComputeRootDescriptorTable(cloudDepthIdx, pCloudDepthTarget->GetSRVHandleGPU());
         }
 
-        int32_t depthBufferIdx = mRaymarchPass.GetResourceRootIndex("depthStencilBuffer");
+        int32_t depthBufferIdx = mCloudUpsamplePass.GetResourceRootIndex("depthStencilBuffer");
         if (depthBufferIdx != ROOTIDX_INVALID)
         {
             pCommandList->SetComputeRootDescriptorTable(depthBufferIdx, GetDepthStencilSRV().HandleGPU);
         }
 
+        int32_t outIdx = mCloudUpsamplePass.GetResourceRootIndex("gOutput");
+        if (outIdx != ROOTIDX_INVALID)
+        {
+            pCommandList->SetComputeRootDescriptorTable(outIdx, pComputeOutput->GetUAVHandleGPU());
+        }
+
         pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pComputeOutput->GetResource(),
             D3D12_RESOURCE_STATE_GENERIC_READ, D3D12_RESOURCE_STATE_UNORDERED_ACCESS));
 
@@ -443,14 +1167,14 @@ void Game::Render()
 
         pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(pComputeOutput->GetResource(),
             D3D12_RESOURCE_STATE_UNORDERED_ACCESS, D3D12_RESOURCE_STATE_GENERIC_READ));
+    }
 
-        // Indicate a state transition on the resource usage.
-        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(GetCurrentBackBuffer(),
-            D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
+    // Indicate a state transition on the resource usage.
+    pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(GetCurrentBackBuffer(),
+        D3D12_RESOURCE_STATE_PRESENT, D3D12_RESOURCE_STATE_RENDER_TARGET));
 
-        // Specify the buffers we are going to render to.
-        pCommandList->OMSetRenderTargets(1, &GetCurrentBackBufferView(), true, nullptr);
-    }
+    // Specify the buffers we are going to render to.
+    pCommandList->OMSetRenderTargets(1, &GetCurrentBackBufferView(), true, nullptr);
 
     // Get depth buffer ready to write depth again
     pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(GetDepthStencilResource(),
@@ -481,6 +1205,314 @@ void Game::Render()
     UpdateBackBufferIndex();
 }
 
+// Scatters copies of the cloud volume around the base one and uploads them with their BVH.
+// With instancing off only the base volume is uploaded, which marches exactly like the single volume did.
+void Game::UpdateCloudInstances(float totalTime)
+{
+    using namespace Muon;
+
+    static const float INSTANCE_FIELD_RADIUS = 1500.0f;
+    static const uint32_t INSTANCE_SEED = 0x5107u;
+
+    const ResourceID baseNVDF = GetResourceID(L"StormbirdCloud_NVDF");
+
+    mCloudInstances.clear();
+    mCloudInstances.push_back(CloudInstance{});
+    mCloudInstances.back().nvdf = baseNVDF;
+
+    if (settings.isCloudInstanced)
+    {
+        const uint32_t count = (uint32_t)std::clamp(settings.cloudInstanceCount, 1, (int)MAX_CLOUD_INSTANCES);
+
+        // Same seed every frame so the field only moves by drifting
+        std::mt19937 rng(INSTANCE_SEED);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+
+        const float drift = settings.cloudInstanceDriftSpeed * totalTime;
+        for (uint32_t i = 1; i < count; ++i)
+        {
+            float angle = unit(rng) * DirectX::XM_2PI;
+            float radius = sqrtf(unit(rng)) * INSTANCE_FIELD_RADIUS;
+
+            CloudInstance instance;
+            instance.position.y = 100.0f + unit(rng) * 250.0f;
+            instance.yaw = unit(rng) * DirectX::XM_2PI;
+            instance.scale = 0.08f + unit(rng) * 0.12f;
+            instance.densityScale = 0.6f + unit(rng) * 0.8f;
+            instance.nvdf = baseNVDF;
+
+            // Drift along +x, wrapping back around to the far side of the field
+            float x = radius * cosf(angle) + drift;
+            x = fmodf(x + INSTANCE_FIELD_RADIUS, 2.0f * INSTANCE_FIELD_RADIUS);
+            instance.position.x = (x < 0.0f ? x + 2.0f * INSTANCE_FIELD_RADIUS : x) - INSTANCE_FIELD_RADIUS;
+            instance.position.z = radius * sinf(angle);
+
+            mCloudInstances.push_back(instance);
+        }
+    }
+
+    // Only one NVDF is bound to the raymarch, instances of any other can't be drawn yet
+    size_t kept = 0;
+    for (const CloudInstance& instance : mCloudInstances)
+    {
+        if (instance.nvdf == baseNVDF)
+            mCloudInstances[kept++] = instance;
+    }
+    if (kept != mCloudInstances.size())
+    {
+        Printf(L"Warning: Skipping %u cloud instances of an NVDF that isn't bound!\n", (uint32_t)(mCloudInstances.size() - kept));
+        mCloudInstances.resize(kept);
+    }
+
+    cbCloudInstances cloudInstances = {};
+    if (BuildCloudInstanceBVH(mCloudInstances, mCloudInstanceBVH))
+    {
+        for (size_t slot = 0; slot < mCloudInstanceBVH.instanceOrder.size(); ++slot)
+        {
+            const CloudInstance& instance = mCloudInstances[mCloudInstanceBVH.instanceOrder[slot]];
+            GetCloudInstanceToLocal(instance, &cloudInstances.instanceToLocal[slot * 3]);
+            cloudInstances.instanceParams[slot] = DirectX::XMFLOAT4(instance.scale, instance.densityScale, 0.0f, 0.0f);
+        }
+
+        for (size_t i = 0; i < mCloudInstanceBVH.nodes.size(); ++i)
+        {
+            const CloudBVHNode& node = mCloudInstanceBVH.nodes[i];
+            cloudInstances.bvhNodeMin[i] = DirectX::XMFLOAT4(node.minBounds.x, node.minBounds.y, node.minBounds.z, 0.0f);
+            cloudInstances.bvhNodeMax[i] = DirectX::XMFLOAT4(node.maxBounds.x, node.maxBounds.y, node.maxBounds.z, 0.0f);
+            memcpy(&cloudInstances.bvhNodeMin[i].w, &node.firstOrChild, sizeof(uint32_t));
+            memcpy(&cloudInstances.bvhNodeMax[i].w, &node.count, sizeof(uint32_t));
+        }
+
+        cloudInstances.cloudInstanceCount = (uint32_t)mCloudInstanceBVH.instanceOrder.size();
+    }
+
+    UINT8* mapped = mCloudInstancesBuffer.GetMappedPtr();
+    if (mapped)
+        memcpy(mapped, &cloudInstances, sizeof(cbCloudInstances));
+}
+
+// Everything VolumeRaymarchNvdf() reads, shared by Raymarch.cs and CloudPanorama.cs
+void Game::RegisterSceneHulls()
+{
+    using namespace Muon;
+
+    ResourceCodex& codex = ResourceCodex::GetSingleton();
+
+    // One shape per mesh, however many entities place it
+    std::vector<const Mesh*> meshes;
+    for (const SceneEntity& entity : mEntities)
+    {
+        if (std::find(meshes.begin(), meshes.end(), entity.pMesh) == meshes.end())
+            meshes.push_back(entity.pMesh);
+    }
+
+    // The raymarch thins clouds out around each hull instance with its shape's mesh SDF, all of them packed into one atlas
+    std::vector<const MeshSdf*> sdfs;
+    std::vector<uint32_t> meshSdfSlots(meshes.size(), MESH_SDF_SLOT_NONE);
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        if (meshes[i]->GetSdf().distances.empty())
+        {
+            Printf(L"Warning: %s has no SDF, clouds will pass through it!\n", meshes[i]->GetName());
+            continue;
+        }
+
+        meshSdfSlots[i] = (uint32_t)sdfs.size();
+        sdfs.push_back(&meshes[i]->GetSdf());
+    }
+
+    MeshSdfAtlas meshSdfAtlas;
+    if (!sdfs.empty() && BuildMeshSdfAtlas(sdfs.data(), (uint32_t)sdfs.size(), 4.0f, meshSdfAtlas))
+    {
+        // Only read by compute, like the NVDFs
+        Texture* pAtlasTex = nullptr;
+        if (TextureFactory::Upload3DTextureFromData(L"MeshSdfAtlas", meshSdfAtlas.distances.data(), meshSdfAtlas.width, meshSdfAtlas.height, meshSdfAtlas.depth,
+                                                    DXGI_FORMAT_R32_FLOAT, GetDevice(), GetCommandList(), codex))
+            pAtlasTex = codex.GetTexture(GetResourceID(L"MeshSdfAtlas"));
+
+        if (pAtlasTex)
+        {
+            GetCommandList()->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(
+                pAtlasTex->GetResource(),
+                D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+                D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE
+            ));
+            mCloudParams.meshSdfValid = 1;
+        }
+        else
+        {
+            Printf(L"Warning: Failed to upload the mesh SDF atlas, clouds will pass through every mesh!\n");
+        }
+    }
+
+    if (meshSdfAtlas.slots.empty())
+        std::fill(meshSdfSlots.begin(), meshSdfSlots.end(), MESH_SDF_SLOT_NONE);
+
+    if (!mHullRegistry.Init())
+        return;
+
+    // Every pixel tests every plane, so dense hulls are simplified down to a few conservative planes each
+    HullPlaneParams planeParams;
+    planeParams.maxPlanes = 64;
+
+    std::vector<uint32_t> shapes(meshes.size(), HULL_REGISTRY_INVALID);
+    for (size_t i = 0; i < meshes.size(); ++i)
+    {
+        // The convex decomposition hugs concave meshes much closer than the single hull, which stays as the fallback
+        std::vector<Hull> shapeHulls = meshes[i]->GetConvexDecomposition();
+        if (shapeHulls.empty())
+            shapeHulls.assign(1, meshes[i]->GetHull());
+
+        const sbMeshSdfSlot* pSdfSlot = meshSdfSlots[i] != MESH_SDF_SLOT_NONE ? &meshSdfAtlas.slots[meshSdfSlots[i]] : nullptr;
+        shapes[i] = mHullRegistry.AddShape(shapeHulls, planeParams, pSdfSlot);
+        if (shapes[i] == HULL_REGISTRY_INVALID)
+            Printf(L"Warning: %s has no hull to raymarch against!\n", meshes[i]->GetName());
+    }
+
+    for (SceneEntity& entity : mEntities)
+    {
+        const uint32_t shape = shapes[std::find(meshes.begin(), meshes.end(), entity.pMesh) - meshes.begin()];
+        if (shape != HULL_REGISTRY_INVALID)
+            entity.hullInstance = mHullRegistry.AddInstance(shape, DirectX::XMLoadFloat4x4(&entity.world));
+    }
+}
+
+void Game::SetEntityTransform(size_t entity, const DirectX::XMMATRIX& world)
+{
+    if (entity >= mEntities.size())
+        return;
+
+    DirectX::XMStoreFloat4x4(&mEntities[entity].world, world);
+    mEntities[entity].moved = true;
+}
+
+void Game::UpdateSceneEntities()
+{
+    using namespace Muon;
+
+    UINT8* mapped = mWorldMatrixBuffer.GetMappedPtr();
+    const UINT entityStride = AlignToBoundary((UINT)sizeof(cbPerEntity), D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+    for (size_t i = 0; i < mEntities.size(); ++i)
+    {
+        SceneEntity& entity = mEntities[i];
+        if (!entity.moved || !mapped)
+            continue;
+
+        const DirectX::XMMATRIX world = DirectX::XMLoadFloat4x4(&entity.world);
+
+        cbPerEntity entityParams;
+        entityParams.world = entity.world;
+        DirectX::XMStoreFloat4x4(&entityParams.invWorld, DirectX::XMMatrixInverse(nullptr, world));
+        memcpy(mapped + i * entityStride, &entityParams, sizeof(entityParams));
+
+        // The registry only rewrites this instance's inverse and bounds on its next Update
+        if (entity.hullInstance != HULL_REGISTRY_INVALID)
+            mHullRegistry.SetInstanceTransform(entity.hullInstance, world);
+
+        entity.moved = false;
+    }
+}
+
+void Game::BindCloudMarchResources(const Muon::ComputePass& pass, ID3D12GraphicsCommandList* pCommandList)
+{
+    using namespace Muon;
+
+    ResourceCodex& codex = ResourceCodex::GetSingleton();
+    Texture* pSdfNVDF = codex.GetTexture(GetResourceID(L"StormbirdCloud_NVDF"));
+    Texture* pNoise = codex.GetTexture(GetResourceID(L"Noise_3D"));
+    Texture* pBlueNoise = codex.GetTexture(GetResourceID(L"BlueNoise_STBN"));
+    Texture* pBeerShadowMap = codex.GetTexture(GetResourceID(L"BeerShadowMap"));
+    Texture* pMeshSdfAtlas = codex.GetTexture(GetResourceID(L"MeshSdfAtlas"));
+
+    // Bind the Camera's Upload Buffer to the root index known by the material
+    int32_t cameraRootIdx = pass.GetResourceRootIndex("VSCamera");
+    if (cameraRootIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(cameraRootIdx, mCamera.GetGPUVirtualAddress());
+    }
+
+    int32_t cloudParamsIdx = pass.GetResourceRootIndex("CloudParams");
+    if (cloudParamsIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(cloudParamsIdx, mCloudParamsBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t instancesIdx = pass.GetResourceRootIndex("CloudInstances");
+    if (instancesIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(instancesIdx, mCloudInstancesBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t aabbIdx = pass.GetResourceRootIndex("AABBBuffer");
+    if (aabbIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(aabbIdx, mAABBBuffer.GetGPUVirtualAddress());
+    }
+
+    mHullRegistry.Bind(pass, pCommandList);
+
+    int32_t meshSdfIdx = pass.GetResourceRootIndex("meshSdfAtlas");
+    if (pMeshSdfAtlas && meshSdfIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(meshSdfIdx, pMeshSdfAtlas->GetSRVHandleGPU());
+    }
+
+    int32_t sdfNVDFIndex = pass.GetResourceRootIndex("sdfNvdfTex");
+    if (pSdfNVDF && sdfNVDFIndex != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(sdfNVDFIndex, pSdfNVDF->GetSRVHandleGPU());
+    }
+
+    int32_t noiseIndex = pass.GetResourceRootIndex("noiseTex"); 
+    if (pNoise && noiseIndex != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(noiseIndex, pNoise->GetSRVHandleGPU()); 
+    }
+
+    int32_t depthBufferIdx = pass.GetResourceRootIndex("depthStencilBuffer");
+    if (depthBufferIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(depthBufferIdx, GetDepthStencilSRV().HandleGPU);
+    }
+
+    int32_t blueNoiseIdx = pass.GetResourceRootIndex("blueNoiseTex");
+    if (pBlueNoise && blueNoiseIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(blueNoiseIdx, pBlueNoise->GetSRVHandleGPU());
+    }
+
+    int32_t sunShadowIdx = pass.GetResourceRootIndex("sunShadowTex");
+    if (mSunShadowVolume.IsValid() && sunShadowIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(sunShadowIdx, mSunShadowVolume.GetTexture().GetSRVHandleGPU());
+    }
+
+    int32_t scatteringLutIdx = pass.GetResourceRootIndex("cloudScatteringLut");
+    if (mCloudScatteringLut.IsValid() && scatteringLutIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(scatteringLutIdx, mCloudScatteringLut.GetTexture().GetSRVHandleGPU());
+    }
+
+    int32_t skyAmbientIdx = pass.GetResourceRootIndex("SkyAmbient");
+    if (skyAmbientIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(skyAmbientIdx, mSkyAmbientBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t beerParamsIdx = pass.GetResourceRootIndex("BeerShadowParams");
+    if (beerParamsIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootConstantBufferView(beerParamsIdx, mBeerShadowParamsBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t beerShadowIdx = pass.GetResourceRootIndex("beerShadowMap");
+    if (pBeerShadowMap && beerShadowIdx != ROOTIDX_INVALID)
+    {
+        pCommandList->SetComputeRootDescriptorTable(beerShadowIdx, pBeerShadowMap->GetSRVHandleGPU());
+    }
+}
+
 void Game::CreateDeviceDependentResources()
 {
 }
@@ -499,14 +1531,31 @@ Game::~Game()
     mTimeBuffer.Destroy();
     mAABBBuffer.Destroy();
     mAtmosphereBuffer.Destroy();
-    mHullBuffer.Destroy();
-    mHullFaceBuffer.Destroy();
+    mHullRegistry.Destroy();
+    mCloudParamsBuffer.Destroy();
+    mBeerShadowParamsBuffer.Destroy();
+    mSkyAmbientBuffer.Destroy();
+    mCloudBricksBuffer.Destroy();
+    mCloudInstancesBuffer.Destroy();
+    mSunShadowVolume.Destroy();
+    mCloudScatteringLut.Destroy();
+    mCloudDistanceBounds.Destroy();
+    mCloudPanorama.Destroy();
     mCamera.Destroy();
     mInput.Destroy();
     mOpaquePass.Destroy();
     mAtmospherePass.Destroy();
     mSobelPass.Destroy();
+    mBeerShadowPass.Destroy();
+    mCloudConeMarchPass.Destroy();
+    mCloudRayIntervalClearPass.Destroy();
+    mCloudRayIntervalPass.Destroy();
+    mCloudPanoramaPass.Destroy();
     mRaymarchPass.Destroy();
+    mCloudTileStatsPass.Destroy();
+    mCloudTileBudgetPass.Destroy();
+    mCloudTemporalPass.Destroy();
+    mCloudUpsamplePass.Destroy();
     mPostProcessPass.Destroy();
 
     Muon::ImguiShutdown();
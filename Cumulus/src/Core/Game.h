@@ -8,10 +8,18 @@ This class encapsulates all app functionality
 #define GAME_H
 
 #include <Core/Camera.h>
+#include <Core/CBufferStructs.h>
 #include <Core/Mesh.h>
 #include <Core/PipelineState.h>
 #include <Core/Pass.h>
 #include <Core/StepTimer.h>
+#include <Core/CloudDistanceBounds.h>
+#include <Core/CloudPanorama.h>
+#include <Core/CloudScatteringLut.h>
+#include <Core/HullRegistry.h>
+#include <Core/SunShadowVolume.h>
+#include <Utils/CloudInstanceUtils.h>
+#include <Utils/SkyAmbientUtils.h>
 
 #include <Input/GameInput.h>
 #include "MuonImgui.h"
@@ -41,6 +49,16 @@ public:
 private:
     void Update(Muon::StepTimer const& timer);
     void Render();
+    void BindCloudMarchResources(const Muon::ComputePass& pass, ID3D12GraphicsCommandList* pCommandList);
+    void UpdateCloudInstances(float totalTime);
+
+    // Registers the hulls and mesh SDFs of every entity's mesh, once per mesh, and places them with the entities.
+    // Records the SDF atlas upload, so the command list has to be open.
+    void RegisterSceneHulls();
+
+    // Moves an entity's draws and hulls together. Written out by UpdateSceneEntities.
+    void SetEntityTransform(size_t entity, const DirectX::XMMATRIX& world);
+    void UpdateSceneEntities();
 
     void CreateDeviceDependentResources();
     void CreateWindowSizeDependentResources(int newWidth, int newHeight);
@@ -57,20 +75,84 @@ private:
     Muon::GraphicsPass mOpaquePass;
     Muon::GraphicsPass mAtmospherePass;
     Muon::ComputePass mSobelPass;
+    Muon::ComputePass mBeerShadowPass;
+    Muon::ComputePass mCloudConeMarchPass;
+    Muon::ComputePass mCloudRayIntervalClearPass;
+    Muon::ComputePass mCloudRayIntervalPass;
+    Muon::ComputePass mCloudPanoramaPass;
+    Muon::ComputePass mHullBinningPass;
     Muon::ComputePass mRaymarchPass;
+    Muon::ComputePass mCloudTileStatsPass;
+    Muon::ComputePass mCloudTileBudgetPass;
+    Muon::ComputePass mCloudTemporalPass;
+    Muon::ComputePass mCloudUpsamplePass;
     Muon::GraphicsPass mPostProcessPass;
 
     // TEMP: For testing
     Muon::Mesh mCube;
 
+    // One cbPerEntity per scene entity, each at a constant buffer aligned offset
     Muon::UploadBuffer mWorldMatrixBuffer;
     Muon::UploadBuffer mLightBuffer;
     Muon::UploadBuffer mTimeBuffer;
     Muon::UploadBuffer mAABBBuffer;
     Muon::UploadBuffer mAtmosphereBuffer;
 
-    Muon::UploadBuffer mHullBuffer;
-    Muon::UploadBuffer mHullFaceBuffer;
+    Muon::UploadBuffer mCloudParamsBuffer;
+    Muon::UploadBuffer mBeerShadowParamsBuffer;
+    Muon::UploadBuffer mSkyAmbientBuffer;
+
+    // Occupied cloud bricks, splatted into per-ray intervals for the raymarch
+    Muon::UploadBuffer mCloudBricksBuffer;
+    uint32_t mCloudBrickCount;
+
+    // Placed copies of the cloud volume and the BVH the raymarch finds them through, rebuilt every frame as they drift
+    std::vector<Muon::CloudInstance> mCloudInstances;
+    Muon::CloudInstanceBVH mCloudInstanceBVH;
+    Muon::UploadBuffer mCloudInstancesBuffer;
+
+    // A mesh the opaque pass draws, whose hulls the raymarch tests with the same transform
+    struct SceneEntity
+    {
+        const Muon::Mesh* pMesh;
+        DirectX::XMFLOAT4X4 world;
+        uint32_t hullInstance;  // Muon::HULL_REGISTRY_INVALID when the mesh has no hull
+        bool moved;             // world hasn't been written out yet
+    };
+    std::vector<SceneEntity> mEntities;
+
+    // Planes of every hull the raymarch tests, and where each mesh's hulls are placed
+    Muon::HullRegistry mHullRegistry;
+
+    // CPU copy of this frame's cloud params
+    Muon::cbCloudParams mCloudParams;
+
+    // Optical depth toward the sun, re-baked incrementally as the sun moves
+    Muon::SunShadowVolume mSunShadowVolume;
+
+    // Phase function and multiple scattering, rebuilt when the scattering settings change
+    Muon::CloudScatteringLut mCloudScatteringLut;
+
+    // Conservative distance to the clouds, traced by the cone march prepass
+    Muon::CloudDistanceBounds mCloudDistanceBounds;
+
+    // Clouds past the far-field distance, re-baked a band of rows per frame as the camera moves
+    Muon::CloudPanorama mCloudPanorama;
+
+    // Beer shadow map state. The params only change on frames the map is re-rendered, so readers always match the map.
+    Muon::cbBeerShadowParams mBeerShadowParams;
+    bool mBeerShadowRefreshDue;
+
+    // CPU copies of the atmosphere tables, the sky ambient SH is projected from them every frame
+    Muon::AtmosphereTables mAtmosphereTables;
+
+    // Temporal cloud state
+    DirectX::XMFLOAT4X4 mPrevViewProj;
+    uint32_t mCloudHistoryIndex;
+    bool mCloudHistoryValid;
+
+    // Set once the tile budget passes have run at the current march resolution
+    bool mTileBudgetValid;
 
     // Timer for the main game loop
     Muon::StepTimer mTimer;
@@ -1,7 +1,11 @@
 #include "Hull.h"
 #include <assimp/vector3.h>
-#include <unordered_map>
-#include <unordered_set>
+#include <Utils/PointCloudUtils.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
 using namespace DirectX;
 
 namespace Muon
@@ -14,397 +18,717 @@ namespace Muon
         BuildHull(points, pointsCount);
     }
 
-    static bool FaceVisibleFromPoint(const HullFace& face, XMVECTOR P)
+namespace
+{
+    struct Vec3d
     {
-        XMVECTOR N = XMLoadFloat3(&face.normal);
-        float side = XMVectorGetX(XMVector3Dot(N, P)) + face.distance;
-        return side > 1e-6f;
-    }
+        double x, y, z;
+    };
 
-    //returns (-1,-1) if no face point pairs exist
-    //returns face to point
-    static std::pair<int, int> FindFurthestFacePointPair(const std::unordered_map<int, std::vector<int>>& faceToPoints, const std::unordered_map<int, double>& pointToFaceDistance) {
-        int bestFace = -1;
-        int bestPoint = -1;
-        double maxDist = -std::numeric_limits<double>::infinity();
+    static Vec3d Sub(const Vec3d& a, const Vec3d& b) { return { a.x - b.x, a.y - b.y, a.z - b.z }; }
+    static double Dot(const Vec3d& a, const Vec3d& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+    static Vec3d Cross(const Vec3d& a, const Vec3d& b) { return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x }; }
 
-        for (const auto& [faceIdx, points] : faceToPoints)
+    // Half edges run tail -> next's tail, counter clockwise around their face when seen from outside
+    struct HalfEdge
+    {
+        int tail;
+        int next;
+        int twin;
+        int face;
+    };
+
+    struct QuickhullFace
+    {
+        int edge;            // Any of the face's three half edges
+        Vec3d normal;
+        double distance;     // n.p + distance > 0 outside
+        int outsideHead = -1;     // Conflict list: points above this face that no earlier face claimed, linked through mNextOutside
+        int furthest = -1;
+        double furthestDistance = 0.0;
+        uint32_t visitStamp = 0;
+        uint32_t forcedStamp = 0; // Counted as visible while finding this stamp's horizon
+        bool alive = true;
+    };
+
+    // Edges of a visible face still to be walked while finding the horizon
+    struct HorizonFrame
+    {
+        int edge;
+        int remaining;
+    };
+
+    class Quickhull
+    {
+    public:
+        Quickhull(const aiVector3D* points, int pointsCount) :
+            mPointsCount(std::max(pointsCount, 0))
         {
-            for (int p : points)
+            // Converted once, every pass over the points after this runs 8 at a time
+            BuildPointCloudSoA(reinterpret_cast<const XMFLOAT3*>(points), (uint32_t)mPointsCount, mCloud);
+            mNextOutside.assign(mPointsCount, -1);
+            mVertexStamp.assign(mPointsCount, 0);
+
+            // Hulls of dense meshes end up with about two faces per point
+            mFaces.reserve((size_t)mPointsCount * 2);
+            mEdges.reserve((size_t)mPointsCount * 6);
+        }
+
+        bool Build()
+        {
+            if (mPointsCount < 4)
             {
-                auto it = pointToFaceDistance.find(p);
-                if (it == pointToFaceDistance.end()) continue; // no distance for this point
+                Printf(L"Error: Not enough points for hull!\n");
+                return false;
+            }
 
-                double d = it->second;
-                if (d > maxDist)
-                {
-                    maxDist = d;
-                    bestFace = faceIdx;
-                    bestPoint = p;
-                }
+            uint32_t minIdx[3], maxIdx[3];
+            FindExtremePoints(mCloud, minIdx, maxIdx);
+
+            // Points are floats, so anything within float precision of a plane is treated as lying on it
+            double maxAbsSum = 0.0;
+            for (int axis = 0; axis < 3; ++axis)
+                maxAbsSum += std::max(fabs(Coord(minIdx[axis], axis)), fabs(Coord(maxIdx[axis], axis)));
+            mEpsilon = 3.0 * (double)FLT_EPSILON * maxAbsSum;
+
+            int simplex[4];
+            if (!FindInitialSimplex(minIdx, maxIdx, simplex))
+                return false;
+
+            BuildSimplex(simplex);
+
+            // Seed the conflict lists, each point goes to the face it is furthest above
+            XMFLOAT4 planes[4];
+            for (int f = 0; f < 4; ++f)
+                planes[f] = GetPlane(mFaces[f]);
+
+            const uint32_t padded = GetPaddedPointCount((uint32_t)mPointsCount);
+            mAssignedFace.resize(padded);
+            mAssignedDistance.resize(padded);
+            mBatchIndices.resize(padded);
+            mBatchX.resize(padded);
+            mBatchY.resize(padded);
+            mBatchZ.resize(padded);
+            AssignPointsToPlanes(mCloud.x.data(), mCloud.y.data(), mCloud.z.data(), (uint32_t)mPointsCount, planes, 4, (float)mEpsilon,
+                                 mAssignedFace.data(), mAssignedDistance.data());
+
+            for (int i = 0; i < mPointsCount; ++i)
+            {
+                if (mAssignedFace[i] == -1 || i == simplex[0] || i == simplex[1] || i == simplex[2] || i == simplex[3])
+                    continue;
+
+                AddOutsidePoint(mAssignedFace[i], i, mAssignedDistance[i]);
             }
-        }
 
-        return { bestFace, bestPoint };
-    }
+            for (int f = 0; f < 4; ++f)
+            {
+                if (mFaces[f].outsideHead != -1)
+                    mPending.push_back(f);
+            }
 
-    static bool FaceHasDirectedEdge(const HullFace& f, int a, int b)
-    {
-        return (f.indices[0] == a && f.indices[1] == b) ||
-            (f.indices[1] == a && f.indices[2] == b) ||
-            (f.indices[2] == a && f.indices[0] == b);
-    }
+            // No iteration cap: every expansion strictly shrinks the set of outside points
+            while (!mPending.empty())
+            {
+                int f = mPending.back();
+                mPending.pop_back();
 
-    static void BuildHorizon(
-        const std::vector<HullFace>& faces,
-        const std::vector<int>& visibleFaces,
-        std::vector<Edge>& outHorizon)
-    {
-        std::unordered_set<int> visibleSet(visibleFaces.begin(), visibleFaces.end());
+                if (!mFaces[f].alive || mFaces[f].outsideHead == -1)
+                    continue;
+
+                AddPoint(f);
+            }
 
-        std::unordered_set<Edge, EdgeHash> horizonSet;
+            return true;
+        }
 
-        auto AddOrRemoveEdge = [&](int a, int b)
+        void GetFaces(std::vector<HullFace>& out_faces) const
+        {
+            out_faces.clear();
+            for (const QuickhullFace& face : mFaces)
             {
-                Edge e{ a, b };
+                if (!face.alive)
+                    continue;
 
-                // If the opposite directed edge already exists, remove it.
-                // That means edge belongs to INTERNAL region between two visible faces.
-                Edge opposite{ b, a };
-                if (horizonSet.count(opposite))
-                {
-                    horizonSet.erase(opposite);
-                }
-                else
+                HullFace hullFace;
+                int e = face.edge;
+                for (int i = 0; i < 3; ++i)
                 {
-                    horizonSet.insert(e);
+                    hullFace.indices[i] = mEdges[e].tail;
+                    e = mEdges[e].next;
                 }
-            };
-
-        for (int fIdx : visibleFaces)
-        {
-            const HullFace& f = faces[fIdx];
-
-            int v0 = f.indices[0];
-            int v1 = f.indices[1];
-            int v2 = f.indices[2];
-
-            // Each face has 3 directed edges
-            AddOrRemoveEdge(v0, v1);
-            AddOrRemoveEdge(v1, v2);
-            AddOrRemoveEdge(v2, v0);
+                hullFace.normal = XMFLOAT3A((float)face.normal.x, (float)face.normal.y, (float)face.normal.z);
+                hullFace.distance = (float)face.distance;
+                out_faces.push_back(hullFace);
+            }
         }
 
-        // Remaining edges form the boundary between visible and non-visible
-        outHorizon.assign(horizonSet.begin(), horizonSet.end());
-    }
+    private:
+        Vec3d Point(int i) const { return { (double)mCloud.x[i], (double)mCloud.y[i], (double)mCloud.z[i] }; }
+        double Coord(uint32_t i, int axis) const { return (double)(axis == 0 ? mCloud.x[i] : axis == 1 ? mCloud.y[i] : mCloud.z[i]); }
 
-    void Hull::ReassignOutsidePoints(
-        std::unordered_map<int, std::vector<int>>& faceToFurthestPoints,
-        std::unordered_map<int, double>& pointToFaceDistance,
-        const aiVector3D* points,
-        const std::vector<Muon::HullFace>& faces,
-        const std::vector<bool>& faceDeleted,
-        const std::vector<int>& removedFaces
-    )
-    {
-        std::vector<int> toReassign;
-
-        // Collect points from removed faces
-        for (int f : removedFaces)
+        static XMFLOAT4 GetPlane(const QuickhullFace& face)
         {
-            auto& pts = faceToFurthestPoints[f];
-            toReassign.insert(toReassign.end(), pts.begin(), pts.end());
-            pts.clear();
+            return XMFLOAT4((float)face.normal.x, (float)face.normal.y, (float)face.normal.z, (float)face.distance);
         }
 
-        // Now reassign them to new or existing faces
-        for (auto& op : toReassign)
+        double Distance(const QuickhullFace& face, int point) const
         {
-            int idx = op;
-            XMVECTOR P = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[idx]));
-            float maxDist = 0;
-            int bestFace = -1;
+            return Dot(face.normal, Point(point)) + face.distance;
+        }
 
-            for (int f = 0; f < faces.size(); ++f)
+        // Extreme points along the widest axis, then the furthest from their line, then the furthest from that plane.
+        // The searches run in float, the degeneracy checks on the chosen points in double.
+        bool FindInitialSimplex(const uint32_t minIdx[3], const uint32_t maxIdx[3], int out_simplex[4]) const
+        {
+            int widest = 0;
+            double widestSpan = -1.0;
+            for (int axis = 0; axis < 3; ++axis)
             {
-                if (f < faceDeleted.size() && faceDeleted[f]) continue;
-
-                XMVECTOR N = XMLoadFloat3(&faces[f].normal);
-                float dist = XMVectorGetX(XMVector3Dot(N, P)) + faces[f].distance;
-
-                if (dist > maxDist)
+                double span = Coord(maxIdx[axis], axis) - Coord(minIdx[axis], axis);
+                if (span > widestSpan)
                 {
-                    maxDist = dist;
-                    bestFace = f;
+                    widestSpan = span;
+                    widest = axis;
                 }
             }
 
-            if (bestFace != -1) {
-                faceToFurthestPoints[bestFace].push_back(idx);
-                pointToFaceDistance[idx] = maxDist;
+            if (widestSpan <= mEpsilon)
+            {
+                Printf(L"Error: All points are identical in Hull!\n");
+                return false;
             }
-        }
-    }
 
+            const int a = (int)minIdx[widest];
+            const int b = (int)maxIdx[widest];
+            const Vec3d A = Point(a);
+            const Vec3d AB = Sub(Point(b), A);
 
+            float unused;
+            const int c = (int)FindFurthestFromLine(mCloud, XMFLOAT3((float)A.x, (float)A.y, (float)A.z), XMFLOAT3((float)AB.x, (float)AB.y, (float)AB.z), unused);
 
+            Vec3d n = Cross(AB, Sub(Point(c), A));
+            const double nLength = sqrt(Dot(n, n));
+            if (nLength / sqrt(Dot(AB, AB)) <= mEpsilon)
+            {
+                Printf(L"Error: Points are collinear in Hull!\n");
+                return false;
+            }
 
+            n = { n.x / nLength, n.y / nLength, n.z / nLength };
+            const XMFLOAT4 plane((float)n.x, (float)n.y, (float)n.z, (float)-Dot(n, A));
+            const int d = (int)FindFurthestFromPlane(mCloud, plane, unused);
 
-    void Hull::BuildHull(const aiVector3D* points, int pointsCount)
-    {
-        if (pointsCount < 4)
+            if (fabs(Dot(n, Sub(Point(d), A))) <= mEpsilon)
+            {
+                Printf(L"Error: Points are coplanar in Hull!\n");
+                return false;
+            }
+
+            out_simplex[0] = a;
+            out_simplex[1] = b;
+            out_simplex[2] = c;
+            out_simplex[3] = d;
+            return true;
+        }
+
+        int AddFace(int v0, int v1, int v2)
         {
-            perror("ERROR: Not enough points for hull");
-            return;
+            const int faceIdx = (int)mFaces.size();
+            const int e0 = (int)mEdges.size();
+
+            mEdges.push_back({ v0, e0 + 1, -1, faceIdx });
+            mEdges.push_back({ v1, e0 + 2, -1, faceIdx });
+            mEdges.push_back({ v2, e0, -1, faceIdx });
+
+            const Vec3d p0 = Point(v0);
+            Vec3d n = Cross(Sub(Point(v1), p0), Sub(Point(v2), p0));
+            double length = sqrt(Dot(n, n));
+            if (length > 0.0)
+                n = { n.x / length, n.y / length, n.z / length };
+
+            QuickhullFace& face = mFaces.emplace_back();
+            face.edge = e0;
+            face.normal = n;
+            face.distance = -Dot(n, p0);
+            return faceIdx;
         }
 
-        float maxX = -FLT_MAX;
-        float minX = FLT_MAX;
+        static void LinkTwins(std::vector<HalfEdge>& edges, int a, int b)
+        {
+            edges[a].twin = b;
+            edges[b].twin = a;
+        }
 
-        int aIndex = -1;
-        int bIndex = -1;
+        // Half edge of face f that runs from -> to
+        int FindEdge(int f, int from, int to) const
+        {
+            int e = mFaces[f].edge;
+            for (int i = 0; i < 3; ++i)
+            {
+                if (mEdges[e].tail == from && mEdges[mEdges[e].next].tail == to)
+                    return e;
+                e = mEdges[e].next;
+            }
+            return -1;
+        }
 
-        // Step 1: find extreme X points
-        for (int i = 0; i < pointsCount; ++i)
+        void BuildSimplex(const int simplex[4])
         {
-            float x = points[i].x;
-            if (x < minX)
+            int a = simplex[0], b = simplex[1], c = simplex[2], d = simplex[3];
+
+            // Wind abc so d is behind it, the other faces follow from that
+            Vec3d n = Cross(Sub(Point(b), Point(a)), Sub(Point(c), Point(a)));
+            if (Dot(n, Sub(Point(d), Point(a))) > 0.0)
+                std::swap(b, c);
+
+            AddFace(a, b, c);
+            AddFace(a, d, b);
+            AddFace(b, d, c);
+            AddFace(c, d, a);
+
+            for (int f = 0; f < 4; ++f)
             {
-                minX = x;
-                aIndex = i;
+                int e = mFaces[f].edge;
+                for (int i = 0; i < 3; ++i)
+                {
+                    if (mEdges[e].twin == -1)
+                    {
+                        int from = mEdges[e].tail;
+                        int to = mEdges[mEdges[e].next].tail;
+                        for (int other = 0; other < 4; ++other)
+                        {
+                            int twin = other != f ? FindEdge(other, to, from) : -1;
+                            if (twin != -1)
+                            {
+                                LinkTwins(mEdges, e, twin);
+                                break;
+                            }
+                        }
+                    }
+                    e = mEdges[e].next;
+                }
             }
+        }
 
-            if (x > maxX)
+        void AddOutsidePoint(int f, int point, double dist)
+        {
+            QuickhullFace& face = mFaces[f];
+            mNextOutside[point] = face.outsideHead;
+            face.outsideHead = point;
+            if (dist > face.furthestDistance)
             {
-                maxX = x;
-                bIndex = i;
+                face.furthestDistance = dist;
+                face.furthest = point;
             }
         }
 
-        if (aIndex == bIndex)
+        // Whether the fan face from horizon edge e to the eye would fold back over the hidden face across e, or be a
+        // sliver with no usable normal. Only possible when the eye is level with that face, which lattice points
+        // like voxel corners hit all the time.
+        bool FoldsOver(int e, const QuickhullFace& hidden, int eye) const
         {
-            perror("ERROR: all points are identical in Hull");
-            return;
+            if (Distance(hidden, eye) < -mEpsilon)
+                return false;
+
+            const Vec3d from = Point(mEdges[e].tail);
+            const Vec3d dir = Sub(Point(mEdges[mEdges[e].next].tail), from);
+            const Vec3d n = Cross(dir, Sub(Point(eye), from));
+            return Dot(n, hidden.normal) <= mEpsilon * sqrt(Dot(dir, dir));
         }
 
-        XMVECTOR A = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[aIndex]));
-        XMVECTOR B = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[bIndex]));
+        // Depth first walk over the faces visible from the eye point.
+        // Entering each face through the edge it was reached by and walking its other edges in order keeps
+        // the horizon edges in a counter clockwise loop.
+        void FindHorizon(int startFace, int eye)
+        {
+            ++mVisitStamp;
+            mVisible.clear();
+            mHorizon.clear();
+
+            mFaces[startFace].visitStamp = mVisitStamp;
+            mVisible.push_back(startFace);
+
+            mStack.clear();
+            mStack.push_back({ mFaces[startFace].edge, 3 });
+
+            while (!mStack.empty())
+            {
+                HorizonFrame& frame = mStack.back();
+                if (frame.remaining == 0)
+                {
+                    mStack.pop_back();
+                    continue;
+                }
 
+                const int e = frame.edge;
+                frame.edge = mEdges[e].next;
+                --frame.remaining;
 
-        // Step 2: find point C farthest from AB line
-        XMVECTOR AB = XMVectorSubtract(B, A);
-        XMVECTOR ABn = XMVector3Normalize(AB);
+                const int twin = mEdges[e].twin;
+                const int neighbor = mEdges[twin].face;
+                QuickhullFace& neighborFace = mFaces[neighbor];
 
-        int cIndex = -1;
-        float maxDistFromLine = 0.0f;
+                if (neighborFace.visitStamp == mVisitStamp)
+                    continue;
 
-        for (int i = 0; i < pointsCount; ++i)
+                // Visibility is an exact sign test, not the tolerance points are assigned with. A face the eye sits barely
+                // above but is kept would fold against the new fan, and those folds compound into inverted faces.
+                if (Distance(neighborFace, eye) > 0.0 || neighborFace.forcedStamp == mForcedStamp || FoldsOver(e, neighborFace, eye))
+                {
+                    neighborFace.visitStamp = mVisitStamp;
+                    mVisible.push_back(neighbor);
+                    mStack.push_back({ mEdges[twin].next, 2 });
+                }
+                else
+                {
+                    mHorizon.push_back(e);
+                }
+            }
+        }
+
+        // The horizon has to be one simple loop for the fan to close. Faces the eye is almost level with can leave
+        // the visible set pinched at a vertex or wrapped around a hidden face. Returns the hidden face to give up
+        // to the visible set, the one across the loop's first repeated vertex the eye is closest to seeing, or -1.
+        int FindHorizonBreak(int eye)
         {
-            if (i == aIndex || i == bIndex)
-                continue;
+            int breakVertex = -1;
+            for (int h : mHorizon)
+            {
+                const int tail = mEdges[h].tail;
+                if (mVertexStamp[tail] == mVisitStamp)
+                {
+                    breakVertex = tail;
+                    break;
+                }
+                mVertexStamp[tail] = mVisitStamp;
+            }
+
+            // No repeat, but the edges don't chain into a single loop
+            bool chained = true;
+            for (size_t i = 0; i < mHorizon.size() && chained; ++i)
+                chained = mEdges[mEdges[mHorizon[i]].next].tail == mEdges[mHorizon[(i + 1) % mHorizon.size()]].tail;
 
-            XMVECTOR P = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[i]));
-            XMVECTOR AP = XMVectorSubtract(P, A);
-            // perpendicular distance to line AB = |AP × ABn|
-            XMVECTOR crossProd = XMVector3Cross(AP, ABn);
-            float dist = XMVectorGetX(XMVector3Length(crossProd));
+            if (breakVertex == -1 && chained)
+                return -1;
 
-            if (dist > maxDistFromLine)
+            int hidden = -1;
+            double closest = -DBL_MAX;
+            for (int h : mHorizon)
             {
-                maxDistFromLine = dist;
-                cIndex = i;
+                if (breakVertex != -1 && mEdges[h].tail != breakVertex && mEdges[mEdges[h].next].tail != breakVertex)
+                    continue;
+
+                const int neighbor = mEdges[mEdges[h].twin].face;
+                const double dist = Distance(mFaces[neighbor], eye);
+                if (dist > closest)
+                {
+                    closest = dist;
+                    hidden = neighbor;
+                }
             }
+            return hidden;
         }
 
-        if (cIndex == -1 || maxDistFromLine < 1e-5f)
+        void AddPoint(int f)
         {
-            perror("ERROR: Points are collinear in Hull");
-            return;
-        }
+            const int eye = mFaces[f].furthest;
 
-        XMVECTOR C = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[cIndex]));
+            ++mForcedStamp;
+            FindHorizon(f, eye);
+            for (int hidden = FindHorizonBreak(eye); hidden != -1; hidden = FindHorizonBreak(eye))
+            {
+                mFaces[hidden].forcedStamp = mForcedStamp;
+                FindHorizon(f, eye);
+            }
 
-        // Step 3: find point D farthest from plane ABC
-        XMVECTOR ABv = XMVectorSubtract(B, A);
-        XMVECTOR ACv = XMVectorSubtract(C, A);
-        XMVECTOR n = XMVector3Normalize(XMVector3Cross(ABv, ACv));
+            // Fan of new faces from the horizon to the eye
+            const int firstNewFace = (int)mFaces.size();
+            const int horizonCount = (int)mHorizon.size();
+            for (int i = 0; i < horizonCount; ++i)
+            {
+                const int h = mHorizon[i];
+                const int from = mEdges[h].tail;
+                const int to = mEdges[mEdges[h].next].tail;
+                const int outerTwin = mEdges[h].twin;
 
-        float maxPlaneDist = 0.0f;
-        int dIndex = -1;
+                int newFace = AddFace(from, to, eye);
+                LinkTwins(mEdges, mFaces[newFace].edge, outerTwin);
+            }
 
-        float planeD = XMVectorGetX(XMVector3Dot(n, A)); // plane eq: n·x = d
+            // Face i's (to -> eye) edge borders face i + 1's (eye -> from) edge
+            for (int i = 0; i < horizonCount; ++i)
+            {
+                const int current = mFaces[firstNewFace + i].edge;
+                const int following = mFaces[firstNewFace + (i + 1) % horizonCount].edge;
+                LinkTwins(mEdges, mEdges[current].next, mEdges[mEdges[following].next].next);
+            }
 
-        for (int i = 0; i < pointsCount; ++i)
-        {
-            if (i == aIndex || i == bIndex || i == cIndex)
-                continue;
+            // Gather the visible faces' conflict lists into one batch
+            uint32_t batchCount = 0;
+            for (int v : mVisible)
+            {
+                QuickhullFace& visible = mFaces[v];
+                visible.alive = false;
+
+                for (int point = visible.outsideHead; point != -1; point = mNextOutside[point])
+                {
+                    if (point == eye)
+                        continue;
+
+                    mBatchIndices[batchCount] = point;
+                    mBatchX[batchCount] = mCloud.x[point];
+                    mBatchY[batchCount] = mCloud.y[point];
+                    mBatchZ[batchCount] = mCloud.z[point];
+                    ++batchCount;
+                }
+                visible.outsideHead = -1;
+            }
 
-            XMVECTOR P = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[i]));
-            float dist = fabsf(XMVectorGetX(XMVector3Dot(n, P)) - planeD);
+            if (batchCount == 0)
+                return;
 
-            if (dist > maxPlaneDist)
+            // Hand each point to the new face it is furthest above, points under all of them are inside the hull now.
+            // Not just the first new face it is above: a point only just above its face can end up under every face
+            // a later eye of that face makes, while still far above a neighbor the eye can't see, and it's dropped there.
+            // On lattice input that left points several units outside the hull.
+            for (uint32_t i = batchCount; i < GetPaddedPointCount(batchCount); ++i)
             {
-                maxPlaneDist = dist;
-                dIndex = i;
+                mBatchX[i] = mBatchX[batchCount - 1];
+                mBatchY[i] = mBatchY[batchCount - 1];
+                mBatchZ[i] = mBatchZ[batchCount - 1];
             }
-        }
 
-        if (dIndex == -1 || maxPlaneDist < 1e-5f)
-        {
-            perror("ERROR: Points are coplanar in Hull");
-            return;
-        }
+            mNewPlanes.clear();
+            for (int nf = firstNewFace; nf < (int)mFaces.size(); ++nf)
+                mNewPlanes.push_back(GetPlane(mFaces[nf]));
+
+            AssignPointsToPlanes(mBatchX.data(), mBatchY.data(), mBatchZ.data(), batchCount, mNewPlanes.data(), (uint32_t)mNewPlanes.size(),
+                                 (float)mEpsilon, mAssignedFace.data(), mAssignedDistance.data());
+
+            for (uint32_t i = 0; i < batchCount; ++i)
+            {
+                if (mAssignedFace[i] != -1)
+                    AddOutsidePoint(firstNewFace + mAssignedFace[i], mBatchIndices[i], mAssignedDistance[i]);
+            }
 
-        XMVECTOR D = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[dIndex]));
+            for (int nf = firstNewFace; nf < (int)mFaces.size(); ++nf)
+            {
+                if (mFaces[nf].outsideHead != -1)
+                    mPending.push_back(nf);
+            }
+        }
 
+        PointCloudSoA mCloud;
+        int mPointsCount;
+        double mEpsilon = 0.0;
+
+        std::vector<HalfEdge> mEdges;
+        std::vector<QuickhullFace> mFaces;
+        std::vector<int> mNextOutside;
+        std::vector<int> mPending; // Faces that may still have outside points
+
+        uint32_t mVisitStamp = 0;
+        uint32_t mForcedStamp = 0;
+        std::vector<uint32_t> mVertexStamp;
+        std::vector<int> mVisible;
+        std::vector<int> mHorizon;
+        std::vector<HorizonFrame> mStack;
+
+        // Scratch for the batched conflict list reassignment, sized for the whole cloud
+        std::vector<int> mBatchIndices;
+        std::vector<float> mBatchX, mBatchY, mBatchZ;
+        std::vector<XMFLOAT4> mNewPlanes;
+        std::vector<int32_t> mAssignedFace;
+        std::vector<float> mAssignedDistance;
+    };
+}
 
-        // Step 4: Build tetrahedron faces
+    void Hull::BuildHull(const aiVector3D* points, int pointsCount)
+    {
         faces.clear();
+        vertices.clear();
+        volume = 0.0f;
 
-        std::vector<bool> faceDeleted(faces.size(), false);
-        std::vector<int> removedFaces;
+        Quickhull quickhull(points, pointsCount);
+        if (!quickhull.Build())
+            return;
 
-        auto AddFace = [&](int i0, int i1, int i2)
-            {
-                Muon::HullFace face;
-                face.indices[0] = i0;
-                face.indices[1] = i1;
-                face.indices[2] = i2;
-
-                XMVECTOR p0 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[i0]));
-                XMVECTOR p1 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[i1]));
-                XMVECTOR p2 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[i2]));
-                XMVECTOR n = XMVector3Normalize(XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0)));
-                float d = -XMVectorGetX(XMVector3Dot(n, p0));
-
-                XMFLOAT3A out;
-                XMStoreFloat3A(&out, n);
-                face.normal = out;
-                face.distance = d;
-
-                faces.push_back(face);
-                //consistent sizing for hull context:
-                faceDeleted.push_back(false);
-            };
-
-        // Create 4 tetrahedron faces
-        AddFace(aIndex, bIndex, cIndex);
-        AddFace(aIndex, cIndex, dIndex);
-        AddFace(aIndex, dIndex, bIndex);
-        AddFace(bIndex, dIndex, cIndex);
-
-        // Step 5: Ensure outward normals
-        for (int fi = 0; fi < (int)faces.size(); ++fi)
+        quickhull.GetFaces(faces);
+
+        // Keep only the points on the hull, faces index those from here on
+        std::vector<int> remap(pointsCount, -1);
+        for (HullFace& face : faces)
         {
-            Muon::HullFace face = faces[fi];
-            // find the opposite vertex
-            int opp = -1;
-            for (int i = 0; i < 4; ++i)
+            for (int& index : face.indices)
             {
-                if (i != face.indices[0] && i != face.indices[1] && i != face.indices[2])
+                if (remap[index] == -1)
                 {
-                    opp = i;
-                    break;
+                    remap[index] = (int)vertices.size();
+                    vertices.push_back(XMFLOAT3(points[index].x, points[index].y, points[index].z));
                 }
+                index = remap[index];
             }
-            if (opp == -1) continue;
+        }
 
-            XMVECTOR N = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&face.normal));
-            float side = XMVectorGetX(XMVector3Dot(N, XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[opp])))) - face.distance;
-            if (side > 0)
-            {
-                // inward normal — flip winding
-                std::swap(face.indices[1], face.indices[2]);
-                XMVECTOR p0 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[face.indices[0]]));
-                XMVECTOR p1 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[face.indices[1]]));
-                XMVECTOR p2 = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[face.indices[2]]));
-
-                XMFLOAT3A outNorm;
-                auto & norm = XMVector3Normalize(XMVector3Cross(XMVectorSubtract(p1, p0), XMVectorSubtract(p2, p0)));
-                XMStoreFloat3A(&outNorm, norm);
-                face.normal = outNorm;
-                face.distance = XMVectorGetX(XMVector3Dot(N, p0));
-            }
+        // Faces wind outward, so each contributes a positive cone to the origin
+        double sixVolume = 0.0;
+        for (const HullFace& face : faces)
+        {
+            const XMFLOAT3& a = vertices[face.indices[0]];
+            const XMFLOAT3& b = vertices[face.indices[1]];
+            const XMFLOAT3& c = vertices[face.indices[2]];
+            sixVolume += Dot({ a.x, a.y, a.z }, Cross({ b.x, b.y, b.z }, { c.x, c.y, c.z }));
         }
+        volume = (float)(sixVolume / 6.0);
+    }
+
+    void Hull::GetPlanes(std::vector<XMFLOAT4>& out_planes, const HullPlaneParams& params) const
+    {
+        out_planes.clear();
+        if (faces.empty())
+            return;
+
+        Vec3d center = { 0.0, 0.0, 0.0 };
+        for (const XMFLOAT3& v : vertices)
+            center = { center.x + v.x, center.y + v.y, center.z + v.z };
+        center = { center.x / vertices.size(), center.y / vertices.size(), center.z / vertices.size() };
 
-        std::unordered_map<int, std::vector<int>> faceToFurthestPoints;
-        std::unordered_map<int, double> pointToFaceDistance;
+        double radius = 0.0;
+        for (const XMFLOAT3& v : vertices)
+        {
+            Vec3d offset = Sub({ v.x, v.y, v.z }, center);
+            radius = std::max(radius, sqrt(Dot(offset, offset)));
+        }
 
-        //Step 6: find points outside faces
-        for (int i = 0; i < pointsCount; ++i)
+        struct PlaneCluster
         {
-            //tetra verts
-            if (i == aIndex || i == bIndex || i == cIndex || i == dIndex)
-                continue;
+            Vec3d seedNormal;
+            double seedDistance;
+            Vec3d weightedNormal; // Sum of the member faces' area scaled normals
+            double area;
+        };
+
+        // Largest faces first so each cluster is seeded by its most reliable plane
+        std::vector<std::pair<double, uint32_t>> byArea;
+        byArea.reserve(faces.size());
+        for (uint32_t i = 0; i < (uint32_t)faces.size(); ++i)
+        {
+            const XMFLOAT3& a = vertices[faces[i].indices[0]];
+            const XMFLOAT3& b = vertices[faces[i].indices[1]];
+            const XMFLOAT3& c = vertices[faces[i].indices[2]];
+            Vec3d n = Cross(Sub({ b.x, b.y, b.z }, { a.x, a.y, a.z }), Sub({ c.x, c.y, c.z }, { a.x, a.y, a.z }));
+            byArea.push_back({ 0.5 * sqrt(Dot(n, n)), i });
+        }
+        std::sort(byArea.begin(), byArea.end(), [](const std::pair<double, uint32_t>& a, const std::pair<double, uint32_t>& b) { return a.first > b.first; });
 
-            XMVECTOR P = XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(&points[i]));
+        const double minDot = cos((double)params.angleTolerance);
+        const double maxDistanceDelta = (double)params.distanceTolerance * radius;
 
-            float maxDist = 0;
-            int bestFace = -1;
+        std::vector<PlaneCluster> clusters;
+        for (const std::pair<double, uint32_t>& entry : byArea)
+        {
+            const HullFace& face = faces[entry.second];
+            const Vec3d n = { face.normal.x, face.normal.y, face.normal.z };
+            const double d = face.distance;
 
-            for (int f = 0; f < faces.size(); ++f)
+            PlaneCluster* match = nullptr;
+            for (PlaneCluster& cluster : clusters)
             {
-                XMVECTOR N = XMLoadFloat3(&faces[f].normal);
-                float dist = XMVectorGetX(XMVector3Dot(N, P)) + faces[f].distance;
-
-                if (dist > maxDist)
+                if (Dot(n, cluster.seedNormal) >= minDot && fabs(d - cluster.seedDistance) <= maxDistanceDelta)
                 {
-                    maxDist = dist;
-                    bestFace = f;
+                    match = &cluster;
+                    break;
                 }
             }
 
-
-            if (bestFace != -1) {
-                faceToFurthestPoints[bestFace].push_back(i);
-                pointToFaceDistance[i] = maxDist;
+            if (!match)
+            {
+                clusters.push_back({ n, d, { 0.0, 0.0, 0.0 }, 0.0 });
+                match = &clusters.back();
             }
+
+            match->weightedNormal = { match->weightedNormal.x + n.x * entry.first, match->weightedNormal.y + n.y * entry.first, match->weightedNormal.z + n.z * entry.first };
+            match->area += entry.first;
         }
 
-        //Step 7: Expand Hull
-        int run = 0;
-        while (true && run < MAX_HULL_LOOPS)
+        std::vector<Vec3d> normals;
+        normals.reserve(clusters.size());
+        for (const PlaneCluster& cluster : clusters)
         {
-            run++;
-            int faceWithFurthest = 0;
-            std::pair<int, int> furthestPoint = FindFurthestFacePointPair(faceToFurthestPoints, pointToFaceDistance);
-            
-            //done!
-            if (furthestPoint.first == -1) break;
-
-            XMVECTOR P = XMLoadFloat3((XMFLOAT3*)&points[furthestPoint.second]);
-
-            std::vector<int> visibleFaces;
-            for (int f = 0; f < faces.size(); ++f) {
-                if (!faceDeleted[f] && FaceVisibleFromPoint(faces[f], P)) {
-                    visibleFaces.push_back(f);
-                }
-            }
+            double length = sqrt(Dot(cluster.weightedNormal, cluster.weightedNormal));
+            normals.push_back(length > 0.0 ? Vec3d{ cluster.weightedNormal.x / length, cluster.weightedNormal.y / length, cluster.weightedNormal.z / length } : cluster.seedNormal);
+        }
 
-            std::vector<Edge> horizon;
-            BuildHorizon(faces, visibleFaces, horizon);
+        // Past the cap, keep the planes that leave the least behind: broad ones, facing away from those already kept.
+        // Greedy picks can still leave a direction open, so the vertex box's six planes take six of the slots and
+        // close the set. Those are supporting planes of the hull too, so they cut nothing off it, and anything
+        // bounding the vertices also bounds the planes.
+        static const Vec3d BOX_NORMALS[6] = { { 1.0, 0.0, 0.0 }, { -1.0, 0.0, 0.0 }, { 0.0, 1.0, 0.0 }, { 0.0, -1.0, 0.0 }, { 0.0, 0.0, 1.0 }, { 0.0, 0.0, -1.0 } };
+        const bool capped = params.maxPlanes > 0 && clusters.size() > params.maxPlanes;
+        const uint32_t boxPlaneCount = capped ? 6 : 0;
+        const uint32_t clusterCount = capped ? (params.maxPlanes > boxPlaneCount ? params.maxPlanes - boxPlaneCount : 0) : (uint32_t)clusters.size();
+
+        std::vector<uint32_t> kept;
+        if (clusterCount > 0 && capped)
+        {
+            // The box planes count as kept already
+            std::vector<double> closestDot(clusters.size(), -1.0);
+            for (uint32_t i = 0; i < (uint32_t)clusters.size(); ++i)
+                closestDot[i] = std::max(fabs(normals[i].x), std::max(fabs(normals[i].y), fabs(normals[i].z)));
+
+            std::vector<bool> isKept(clusters.size(), false);
+            uint32_t next = 0; // clusters are in decreasing seed area, the first is the broadest
+            while (kept.size() < clusterCount)
+            {
+                kept.push_back(next);
+                isKept[next] = true;
 
-            for (int idx : visibleFaces) {
-                faceDeleted[idx] = true;
-                removedFaces.push_back(idx);
+                double bestScore = -1.0;
+                for (uint32_t i = 0; i < (uint32_t)clusters.size(); ++i)
+                {
+                    if (isKept[i])
+                        continue;
+
+                    closestDot[i] = std::max(closestDot[i], Dot(normals[i], normals[next]));
+                    double score = (1.0 - closestDot[i]) * sqrt(clusters[i].area);
+                    if (score > bestScore)
+                    {
+                        bestScore = score;
+                        next = i;
+                    }
+                }
             }
+        }
+        else if (!capped)
+        {
+            for (uint32_t i = 0; i < (uint32_t)clusters.size(); ++i)
+                kept.push_back(i);
+        }
 
+        std::vector<Vec3d> keptNormals;
+        keptNormals.reserve(kept.size() + boxPlaneCount);
+        for (uint32_t i : kept)
+            keptNormals.push_back(normals[i]);
 
-            for (auto& e : horizon) {
-                AddFace(e.v0, e.v1, furthestPoint.second);
-            }
-
-            ReassignOutsidePoints(faceToFurthestPoints, pointToFaceDistance, points, faces, faceDeleted, removedFaces);
+        // Unless a kept plane is already the same one
+        for (uint32_t i = 0; i < boxPlaneCount; ++i)
+        {
+            bool covered = false;
+            for (uint32_t k : kept)
+                covered |= Dot(normals[k], BOX_NORMALS[i]) >= 1.0 - 1e-9;
+            if (!covered)
+                keptNormals.push_back(BOX_NORMALS[i]);
         }
 
-        std::vector<HullFace> finalFaces;
-        for (int i = 0; i < faceDeleted.size(); ++i) {
-            if (!faceDeleted[i]) {
-                finalFaces.push_back(faces[i]);
-            }
-        }
+        // Each plane moves out until every vertex is on or under it
+        out_planes.reserve(keptNormals.size());
+        for (const Vec3d& n : keptNormals)
+        {
+            double support = -DBL_MAX;
+            for (const XMFLOAT3& v : vertices)
+                support = std::max(support, Dot(n, { v.x, v.y, v.z }));
 
-        faces = finalFaces;
+            out_planes.push_back(XMFLOAT4((float)n.x, (float)n.y, (float)n.z, (float)-support));
+        }
     }
-}
\ No newline at end of file
+}
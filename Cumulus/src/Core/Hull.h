@@ -1,28 +1,40 @@
 #pragma once
 #include <DirectXMath.h>
+#include <cstdint>
 #include <vector>
 #include "CommonTypes.h"
 #include <assimp/vector3.h>
-#include <unordered_map>
 
 namespace Muon
 {
+	struct HullPlaneParams
+	{
+		float angleTolerance = 0.01f;       // Radians between normals of faces merged into one plane
+		float distanceTolerance = 0.001f;   // Plane offsets merged together, as a fraction of the hull's radius
+		uint32_t maxPlanes = UINT32_MAX;    // Keeps the broadest, most spread out planes past this, six of them the vertex box's
+	};
+
+	// Convex hull of a point cloud, built with Quickhull.
+	// Every face keeps a conflict list of the points outside it, and the faces are linked by half edges,
+	// so each expansion only touches the faces the new point can see and the points that were outside them.
 	class Hull
 	{
 	public:
 		Hull();
 		Hull(const aiVector3D* points, int pointsCount);
+
+		// Bounding planes (xyz outward normal, w distance) for intersection tests, far fewer than faces.
+		// Coplanar faces share one plane, and every plane is pushed out to touch the hull, so the planes
+		// never cut into it even once capped. Capped sets stay inside the box around the vertices.
+		void GetPlanes(std::vector<DirectX::XMFLOAT4>& out_planes, const HullPlaneParams& params = HullPlaneParams()) const;
+
+		// Outward facing triangles indexing vertices, n.p + distance > 0 outside
 		std::vector<Muon::HullFace> faces;
+		std::vector<DirectX::XMFLOAT3> vertices;
+
+		// Enclosed volume, 0 if the points had no hull
+		float volume = 0.0f;
 	protected:
-		static const int MAX_HULL_LOOPS = 25;
 		void BuildHull(const aiVector3D* points, int pointsCount);
-		void ReassignOutsidePoints(
-			std::unordered_map<int, std::vector<int>>& faceToFurthestPoints,
-			std::unordered_map<int, double>& pointToFaceDistance,
-			const aiVector3D* points,
-			const std::vector<Muon::HullFace>& faces,
-			const std::vector<bool>& faceDeleted,
-			const std::vector<int>& removedFaces
-		);
 	};
 }
@@ -0,0 +1,308 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of HullRegistry.h
+----------------------------------------------*/
+#include "HullRegistry.h"
+
+#include <Core/CBufferStructs.h>
+#include <Core/DXCore.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cstring>
+
+namespace Muon
+{
+
+namespace
+{
+    // Room for a few decomposed meshes before the first regrow
+    static const size_t INITIAL_PLANE_CAPACITY = 1024;
+    static const size_t INITIAL_RANGE_CAPACITY = 64;
+    static const size_t INITIAL_INSTANCE_CAPACITY = 16;
+    static const size_t INITIAL_SDF_SLOT_CAPACITY = 8;
+}
+
+bool HullRegistry::Init()
+{
+    mParamsBuffer.Create(L"Hull Registry Params", sizeof(cbHullRegistryParams));
+
+    mPlaneCapacity = mRangeCapacity = mSdfSlotCapacity = mInstanceCapacity = mBoundsCapacity = 0;
+    Reserve(mPlaneBuffer, L"Hull Planes", sizeof(DirectX::XMFLOAT4), INITIAL_PLANE_CAPACITY, mPlaneCapacity);
+    Reserve(mRangeBuffer, L"Hull Ranges", sizeof(sbHullRange), INITIAL_RANGE_CAPACITY, mRangeCapacity);
+    Reserve(mSdfSlotBuffer, L"Mesh SDF Slots", sizeof(sbMeshSdfSlot), INITIAL_SDF_SLOT_CAPACITY, mSdfSlotCapacity);
+    Reserve(mInstanceBuffer, L"Hull Instances", sizeof(sbHullInstance), INITIAL_INSTANCE_CAPACITY, mInstanceCapacity);
+    Reserve(mBoundsBuffer, L"Hull Bounds", sizeof(sbHullBounds), INITIAL_RANGE_CAPACITY, mBoundsCapacity);
+
+    if (!mParamsBuffer.GetMappedPtr() || !mPlaneBuffer.GetMappedPtr() || !mRangeBuffer.GetMappedPtr() || !mSdfSlotBuffer.GetMappedPtr() || !mInstanceBuffer.GetMappedPtr() || !mBoundsBuffer.GetMappedPtr())
+    {
+        Printf(L"Error: Failed to create the hull registry buffers!\n");
+        return false;
+    }
+
+    mUploadedPlaneCount = mUploadedRangeCount = mUploadedSdfSlotCount = 0;
+    mDirtyInstanceBegin = mDirtyInstanceEnd = 0;
+    mParamsDirty = true;
+    return true;
+}
+
+void HullRegistry::Destroy()
+{
+    mParamsBuffer.Destroy();
+    mPlaneBuffer.Destroy();
+    mRangeBuffer.Destroy();
+    mSdfSlotBuffer.Destroy();
+    mInstanceBuffer.Destroy();
+    mBoundsBuffer.Destroy();
+
+    mPlanes.clear();
+    mRanges.clear();
+    mShapes.clear();
+    mSdfSlots.clear();
+    mInstances.clear();
+    mBounds.clear();
+    mRangeBounds.clear();
+    mInstanceBoundsOffset.clear();
+    mPlaneCapacity = mRangeCapacity = mSdfSlotCapacity = mInstanceCapacity = mBoundsCapacity = 0;
+}
+
+uint32_t HullRegistry::AddShape(const std::vector<Hull>& hulls, const HullPlaneParams& params, const sbMeshSdfSlot* pSdfSlot)
+{
+    Shape shape = { (uint32_t)mRanges.size(), 0, MESH_SDF_SLOT_NONE };
+
+    // Past the falloff the SDF leaves clouds alone, and the hulls enclose the mesh, so their boxes grown by it enclose everything it touches
+    const float sdfMargin = pSdfSlot ? pSdfSlot->falloff : 0.0f;
+
+    std::vector<DirectX::XMFLOAT4> planes;
+    for (const Hull& hull : hulls)
+    {
+        hull.GetPlanes(planes, params);
+        if (planes.empty())
+            continue;
+
+        mRanges.push_back({ (uint32_t)mPlanes.size(), (uint32_t)planes.size() });
+        mPlanes.insert(mPlanes.end(), planes.begin(), planes.end());
+        ++shape.rangeCount;
+
+        // GetPlanes closes capped plane sets with this same box, so it bounds them. It's what gets binned into screen tiles.
+        Box box = { hull.vertices[0], hull.vertices[0] };
+        for (const DirectX::XMFLOAT3& v : hull.vertices)
+        {
+            box.minBounds = DirectX::XMFLOAT3(std::min(box.minBounds.x, v.x), std::min(box.minBounds.y, v.y), std::min(box.minBounds.z, v.z));
+            box.maxBounds = DirectX::XMFLOAT3(std::max(box.maxBounds.x, v.x), std::max(box.maxBounds.y, v.y), std::max(box.maxBounds.z, v.z));
+        }
+        box.minBounds = DirectX::XMFLOAT3(box.minBounds.x - sdfMargin, box.minBounds.y - sdfMargin, box.minBounds.z - sdfMargin);
+        box.maxBounds = DirectX::XMFLOAT3(box.maxBounds.x + sdfMargin, box.maxBounds.y + sdfMargin, box.maxBounds.z + sdfMargin);
+        mRangeBounds.push_back(box);
+    }
+
+    if (shape.rangeCount == 0)
+        return HULL_REGISTRY_INVALID;
+
+    if (pSdfSlot)
+    {
+        shape.sdfSlot = (uint32_t)mSdfSlots.size();
+        mSdfSlots.push_back(*pSdfSlot);
+    }
+
+    mShapes.push_back(shape);
+    return (uint32_t)mShapes.size() - 1;
+}
+
+uint32_t HullRegistry::AddInstance(uint32_t shape, const DirectX::XMMATRIX& world)
+{
+    if (shape >= mShapes.size())
+        return HULL_REGISTRY_INVALID;
+
+    sbHullInstance instance = {};
+    instance.rangeOffset = mShapes[shape].rangeOffset;
+    instance.rangeCount = mShapes[shape].rangeCount;
+    instance.sdfSlot = mShapes[shape].sdfSlot;
+    mInstances.push_back(instance);
+    mParamsDirty = true;
+
+    mInstanceBoundsOffset.push_back((uint32_t)mBounds.size());
+    for (uint32_t i = 0; i < instance.rangeCount; ++i)
+    {
+        sbHullBounds bounds = {};
+        bounds.instance = (uint32_t)mInstances.size() - 1;
+        bounds.range = instance.rangeOffset + i;
+        mBounds.push_back(bounds);
+    }
+
+    uint32_t index = (uint32_t)mInstances.size() - 1;
+    SetInstanceTransform(index, world);
+    return index;
+}
+
+void HullRegistry::SetInstanceTransform(uint32_t instance, const DirectX::XMMATRIX& world)
+{
+    if (instance >= mInstances.size())
+        return;
+
+    DirectX::XMStoreFloat4x4(&mInstances[instance].invWorld, DirectX::XMMatrixInverse(nullptr, world));
+
+    // World box around the transformed corners of each hull's box
+    for (uint32_t i = 0; i < mInstances[instance].rangeCount; ++i)
+    {
+        sbHullBounds& bounds = mBounds[mInstanceBoundsOffset[instance] + i];
+        const Box& box = mRangeBounds[bounds.range];
+
+        DirectX::XMVECTOR worldMin = DirectX::XMVectorReplicate(FLT_MAX);
+        DirectX::XMVECTOR worldMax = DirectX::XMVectorReplicate(-FLT_MAX);
+        for (uint32_t c = 0; c < 8; ++c)
+        {
+            DirectX::XMVECTOR corner = DirectX::XMVectorSet(
+                (c & 1) ? box.maxBounds.x : box.minBounds.x,
+                (c & 2) ? box.maxBounds.y : box.minBounds.y,
+                (c & 4) ? box.maxBounds.z : box.minBounds.z, 1.0f);
+            corner = DirectX::XMVector3TransformCoord(corner, world);
+            worldMin = DirectX::XMVectorMin(worldMin, corner);
+            worldMax = DirectX::XMVectorMax(worldMax, corner);
+        }
+        DirectX::XMStoreFloat3(&bounds.minBounds, worldMin);
+        DirectX::XMStoreFloat3(&bounds.maxBounds, worldMax);
+    }
+
+    if (mDirtyInstanceBegin == mDirtyInstanceEnd)
+    {
+        mDirtyInstanceBegin = instance;
+        mDirtyInstanceEnd = instance + 1;
+    }
+    else
+    {
+        mDirtyInstanceBegin = std::min<size_t>(mDirtyInstanceBegin, instance);
+        mDirtyInstanceEnd = std::max<size_t>(mDirtyInstanceEnd, instance + 1);
+    }
+}
+
+bool HullRegistry::Reserve(UploadBuffer& buffer, const wchar_t* name, size_t elementSize, size_t count, size_t& inout_capacity)
+{
+    if (count <= inout_capacity && buffer.GetResource())
+        return false;
+
+    inout_capacity = std::max(inout_capacity * 2, std::max<size_t>(count, 1));
+    buffer.Create(name, inout_capacity * elementSize);
+    return true;
+}
+
+bool HullRegistry::Update()
+{
+    if (mPlanes.size() > mPlaneCapacity || mRanges.size() > mRangeCapacity || mSdfSlots.size() > mSdfSlotCapacity || mInstances.size() > mInstanceCapacity || mBounds.size() > mBoundsCapacity)
+    {
+        // Earlier frames may still be reading the buffers about to be replaced
+        FlushCommandQueue();
+
+        if (Reserve(mPlaneBuffer, L"Hull Planes", sizeof(DirectX::XMFLOAT4), mPlanes.size(), mPlaneCapacity))
+            mUploadedPlaneCount = 0;
+
+        if (Reserve(mRangeBuffer, L"Hull Ranges", sizeof(sbHullRange), mRanges.size(), mRangeCapacity))
+            mUploadedRangeCount = 0;
+
+        if (Reserve(mSdfSlotBuffer, L"Mesh SDF Slots", sizeof(sbMeshSdfSlot), mSdfSlots.size(), mSdfSlotCapacity))
+            mUploadedSdfSlotCount = 0;
+
+        // Instances and their bounds are written together, so either being replaced rewrites both
+        bool instancesReplaced = Reserve(mInstanceBuffer, L"Hull Instances", sizeof(sbHullInstance), mInstances.size(), mInstanceCapacity);
+        instancesReplaced |= Reserve(mBoundsBuffer, L"Hull Bounds", sizeof(sbHullBounds), mBounds.size(), mBoundsCapacity);
+        if (instancesReplaced)
+        {
+            mDirtyInstanceBegin = 0;
+            mDirtyInstanceEnd = mInstances.size();
+        }
+    }
+
+    if (!mParamsBuffer.GetMappedPtr() || !mPlaneBuffer.GetMappedPtr() || !mRangeBuffer.GetMappedPtr() || !mSdfSlotBuffer.GetMappedPtr() || !mInstanceBuffer.GetMappedPtr() || !mBoundsBuffer.GetMappedPtr())
+    {
+        Printf(L"Error: Hull registry buffers aren't mapped!\n");
+        return false;
+    }
+
+    if (mUploadedPlaneCount < mPlanes.size())
+    {
+        memcpy(mPlaneBuffer.GetMappedPtr() + mUploadedPlaneCount * sizeof(DirectX::XMFLOAT4), mPlanes.data() + mUploadedPlaneCount,
+            (mPlanes.size() - mUploadedPlaneCount) * sizeof(DirectX::XMFLOAT4));
+        mUploadedPlaneCount = mPlanes.size();
+    }
+
+    if (mUploadedRangeCount < mRanges.size())
+    {
+        memcpy(mRangeBuffer.GetMappedPtr() + mUploadedRangeCount * sizeof(sbHullRange), mRanges.data() + mUploadedRangeCount,
+            (mRanges.size() - mUploadedRangeCount) * sizeof(sbHullRange));
+        mUploadedRangeCount = mRanges.size();
+    }
+
+    if (mUploadedSdfSlotCount < mSdfSlots.size())
+    {
+        memcpy(mSdfSlotBuffer.GetMappedPtr() + mUploadedSdfSlotCount * sizeof(sbMeshSdfSlot), mSdfSlots.data() + mUploadedSdfSlotCount,
+            (mSdfSlots.size() - mUploadedSdfSlotCount) * sizeof(sbMeshSdfSlot));
+        mUploadedSdfSlotCount = mSdfSlots.size();
+    }
+
+    if (mDirtyInstanceBegin < mDirtyInstanceEnd)
+    {
+        memcpy(mInstanceBuffer.GetMappedPtr() + mDirtyInstanceBegin * sizeof(sbHullInstance), mInstances.data() + mDirtyInstanceBegin,
+            (mDirtyInstanceEnd - mDirtyInstanceBegin) * sizeof(sbHullInstance));
+
+        const size_t boundsBegin = mInstanceBoundsOffset[mDirtyInstanceBegin];
+        const size_t boundsEnd = mInstanceBoundsOffset[mDirtyInstanceEnd - 1] + mInstances[mDirtyInstanceEnd - 1].rangeCount;
+        memcpy(mBoundsBuffer.GetMappedPtr() + boundsBegin * sizeof(sbHullBounds), mBounds.data() + boundsBegin,
+            (boundsEnd - boundsBegin) * sizeof(sbHullBounds));
+
+        mDirtyInstanceBegin = mDirtyInstanceEnd = 0;
+    }
+
+    if (mParamsDirty)
+    {
+        cbHullRegistryParams params = {};
+        params.hullInstanceCount = (uint32_t)mInstances.size();
+        params.hullBoundsCount = (uint32_t)mBounds.size();
+        memcpy(mParamsBuffer.GetMappedPtr(), &params, sizeof(params));
+        mParamsDirty = false;
+    }
+
+    return true;
+}
+
+void HullRegistry::Bind(const ComputePass& pass, ID3D12GraphicsCommandList* pCommandList) const
+{
+    int32_t paramsIdx = pass.GetResourceRootIndex("HullRegistryParams");
+    if (paramsIdx != ROOTIDX_INVALID && mParamsBuffer.GetBufferSize() > 0)
+    {
+        pCommandList->SetComputeRootConstantBufferView(paramsIdx, mParamsBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t planesIdx = pass.GetResourceRootIndex("hullPlanes");
+    if (planesIdx != ROOTIDX_INVALID && mPlaneBuffer.GetBufferSize() > 0)
+    {
+        pCommandList->SetComputeRootShaderResourceView(planesIdx, mPlaneBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t rangesIdx = pass.GetResourceRootIndex("hullRanges");
+    if (rangesIdx != ROOTIDX_INVALID && mRangeBuffer.GetBufferSize() > 0)
+    {
+        pCommandList->SetComputeRootShaderResourceView(rangesIdx, mRangeBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t sdfSlotsIdx = pass.GetResourceRootIndex("meshSdfSlots");
+    if (sdfSlotsIdx != ROOTIDX_INVALID && mSdfSlotBuffer.GetBufferSize() > 0)
+    {
+        pCommandList->SetComputeRootShaderResourceView(sdfSlotsIdx, mSdfSlotBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t instancesIdx = pass.GetResourceRootIndex("hullInstances");
+    if (instancesIdx != ROOTIDX_INVALID && mInstanceBuffer.GetBufferSize() > 0)
+    {
+        pCommandList->SetComputeRootShaderResourceView(instancesIdx, mInstanceBuffer.GetGPUVirtualAddress());
+    }
+
+    int32_t boundsIdx = pass.GetResourceRootIndex("hullBounds");
+    if (boundsIdx != ROOTIDX_INVALID && mBoundsBuffer.GetBufferSize() > 0)
+    {
+        pCommandList->SetComputeRootShaderResourceView(boundsIdx, mBoundsBuffer.GetGPUVirtualAddress());
+    }
+}
+
+}
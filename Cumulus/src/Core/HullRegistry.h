@@ -0,0 +1,110 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Every convex hull the raymarch intersects, in structured buffers.
+Shapes (a mesh's hull, or its convex decomposition) are registered once and
+their planes concatenated into one buffer, with a table of each hull's plane
+range. A shape can also own a slot of the mesh SDF atlas, which the raymarch
+thins clouds out around. Instances place a shape with their own transform, and
+each of their hulls gets a world space box for binning into screen tiles. Only what changed
+since the last Update is written, so moving an instance rewrites just its entries.
+----------------------------------------------*/
+#ifndef MUON_HULLREGISTRY_H
+#define MUON_HULLREGISTRY_H
+
+#include <Core/Buffers.h>
+#include <Core/Hull.h>
+#include <Core/Pass.h>
+#include <Core/SBufferStructs.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+
+static const uint32_t HULL_REGISTRY_INVALID = UINT32_MAX;
+
+class HullRegistry
+{
+public:
+    bool Init();
+    void Destroy();
+
+    // Appends the hulls' planes, simplified with params. Returns the shape's index, or HULL_REGISTRY_INVALID if none of the hulls had any.
+    // pSdfSlot is where the shape's mesh SDF sits in the atlas, if it has one. Its hulls' boxes grow by the slot's falloff,
+    // so the tiles they're binned into cover every ray the SDF thins.
+    uint32_t AddShape(const std::vector<Hull>& hulls, const HullPlaneParams& params, const sbMeshSdfSlot* pSdfSlot = nullptr);
+
+    // Places a registered shape. Returns the instance's index, or HULL_REGISTRY_INVALID for an unknown shape.
+    uint32_t AddInstance(uint32_t shape, const DirectX::XMMATRIX& world);
+    void SetInstanceTransform(uint32_t instance, const DirectX::XMMATRIX& world);
+
+    // Call once per frame before binding. Writes new shapes and moved instances to the GPU.
+    // Outgrowing the buffers recreates them, which waits for the GPU first.
+    bool Update();
+
+    // Binds HullRegistryParams and the hull buffers, for passes that include Raymarch_Common.hlsli
+    void Bind(const ComputePass& pass, ID3D12GraphicsCommandList* pCommandList) const;
+
+    uint32_t GetInstanceCount() const { return (uint32_t)mInstances.size(); }
+    uint32_t GetPlaneCount() const { return (uint32_t)mPlanes.size(); }
+
+    // One per hull of every instance, in instance order
+    const std::vector<sbHullBounds>& GetHullBounds() const { return mBounds; }
+
+private:
+    struct Shape
+    {
+        uint32_t rangeOffset;
+        uint32_t rangeCount;
+        uint32_t sdfSlot;
+    };
+
+    struct Box
+    {
+        DirectX::XMFLOAT3 minBounds;
+        DirectX::XMFLOAT3 maxBounds;
+    };
+
+    bool Reserve(UploadBuffer& buffer, const wchar_t* name, size_t elementSize, size_t count, size_t& inout_capacity);
+
+    std::vector<DirectX::XMFLOAT4> mPlanes;
+    std::vector<sbHullRange> mRanges;
+    std::vector<Shape> mShapes;
+    std::vector<sbMeshSdfSlot> mSdfSlots;
+    std::vector<sbHullInstance> mInstances;
+    std::vector<sbHullBounds> mBounds;
+
+    // Box around each range's hull vertices in the shape's space, and each instance's first entry in mBounds
+    std::vector<Box> mRangeBounds;
+    std::vector<uint32_t> mInstanceBoundsOffset;
+
+    UploadBuffer mParamsBuffer;
+    UploadBuffer mPlaneBuffer;
+    UploadBuffer mRangeBuffer;
+    UploadBuffer mSdfSlotBuffer;
+    UploadBuffer mInstanceBuffer;
+    UploadBuffer mBoundsBuffer;
+
+    // Elements each buffer has room for
+    size_t mPlaneCapacity = 0;
+    size_t mRangeCapacity = 0;
+    size_t mSdfSlotCapacity = 0;
+    size_t mInstanceCapacity = 0;
+    size_t mBoundsCapacity = 0;
+
+    // Planes, ranges and SDF slots are only ever appended, so everything before these is already on the GPU
+    size_t mUploadedPlaneCount = 0;
+    size_t mUploadedRangeCount = 0;
+    size_t mUploadedSdfSlotCount = 0;
+
+    // Instances added or moved since the last Update, their bounds entries follow along
+    size_t mDirtyInstanceBegin = 0;
+    size_t mDirtyInstanceEnd = 0;
+    bool mParamsDirty = true;
+};
+
+}
+
+#endif
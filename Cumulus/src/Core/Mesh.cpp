@@ -15,7 +15,7 @@ Description : Mesh initialization logic, for DX12
 namespace Muon
 {
 
-bool Mesh::Create(const wchar_t* name, UINT vtxDataSize, UINT vtxStride, UINT vtxCount, UINT idxDataSize, UINT idxCount, DXGI_FORMAT idxFormat, AABB aabb, Hull hull)
+bool Mesh::Create(const wchar_t* name, UINT vtxDataSize, UINT vtxStride, UINT vtxCount, UINT idxDataSize, UINT idxCount, DXGI_FORMAT idxFormat, AABB aabb, Hull hull, const std::vector<Hull>& convexDecomposition, const MeshSdf& sdf)
 {
     if (!Muon::GetDevice() || vtxDataSize == 0)
         return false;
@@ -25,6 +25,8 @@ bool Mesh::Create(const wchar_t* name, UINT vtxDataSize, UINT vtxStride, UINT vt
     {
         this->aabb = aabb;
         this->hull = hull;
+        this->convexDecomposition = convexDecomposition;
+        this->sdf = sdf;
 
         // Creates as with default heap type. This is fast to read from the GPU but inaccessible from the CPU. 
         // We need to go through a staging buffer (UploadBuffer) to get the data to it.
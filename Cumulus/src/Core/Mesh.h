@@ -11,12 +11,13 @@ Description : Mesh stores the vertex,index buffers ready to be drawn by DirectX
 #include <DirectXMath.h>
 #include <Core/CommonTypes.h>
 #include <Core/Hull.h>
+#include <Core/MeshSdf.h>
 
 namespace Muon
 {
 struct Mesh
 {
-    bool Create(const wchar_t* name, UINT vtxDataSize, UINT vtxStride, UINT vtxCount, UINT idxDataSize = 0, UINT idxCount = 0, DXGI_FORMAT idxFormat = DXGI_FORMAT_UNKNOWN, AABB aabb = {}, Hull hull = Hull());
+    bool Create(const wchar_t* name, UINT vtxDataSize, UINT vtxStride, UINT vtxCount, UINT idxDataSize = 0, UINT idxCount = 0, DXGI_FORMAT idxFormat = DXGI_FORMAT_UNKNOWN, AABB aabb = {}, Hull hull = Hull(), const std::vector<Hull>& convexDecomposition = {}, const MeshSdf& sdf = MeshSdf());
     bool Destroy();
     bool Draw(ID3D12GraphicsCommandList* pCommandList) const;
     bool DrawIndexed(ID3D12GraphicsCommandList* pCommandList) const;
@@ -26,6 +27,8 @@ struct Mesh
     const wchar_t* GetName() const { return mName.c_str(); }
     AABB GetAABB() const { return aabb; }
     Hull GetHull() const { return hull; }
+    const std::vector<Hull>& GetConvexDecomposition() const { return convexDecomposition; }
+    const MeshSdf& GetSdf() const { return sdf; }
 protected:
     std::wstring mName;
     Microsoft::WRL::ComPtr<ID3D12Resource> mpVertexBuffer;
@@ -37,6 +40,8 @@ protected:
     UINT Stride = 0;
     AABB aabb;
     Hull hull;
+    std::vector<Hull> convexDecomposition; // Tighter cover than hull for concave meshes, empty if it couldn't be built
+    MeshSdf sdf;                           // Empty if it couldn't be baked
 };
 
 }
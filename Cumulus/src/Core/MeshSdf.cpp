@@ -0,0 +1,495 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of MeshSdf.h
+The winding number follows Barill et al., "Fast Winding Numbers for Soups and
+Clouds": a node far enough away only sees the sum of its triangles' area
+vectors, the first term of their multipole expansion.
+----------------------------------------------*/
+#include <Core/MeshSdf.h>
+
+#include <Utils/ParallelUtils.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    static const uint32_t MESH_SDF_LEAF_SIZE = 4;
+    static const uint32_t MESH_SDF_STACK_SIZE = 64;
+
+    // Nodes further than this many of their radii away are treated as a single dipole
+    static const float WINDING_FAR_RATIO = 2.0f;
+    static const float INV_FOUR_PI = 0.0795774715f;
+
+    struct Triangle
+    {
+        DirectX::XMFLOAT3 a, b, c;
+    };
+
+    // Inner nodes: count == 0 and the children are firstOrChild and firstOrChild + 1.
+    // Leaves: triangles [firstOrChild, firstOrChild + count).
+    struct TriangleBVHNode
+    {
+        DirectX::XMFLOAT3 minBounds;
+        uint32_t firstOrChild;
+        DirectX::XMFLOAT3 maxBounds;
+        uint32_t count;
+        DirectX::XMFLOAT3 areaNormal;   // Sum of the triangles' normals scaled by their area
+        float radius;                   // Of the triangles around center
+        DirectX::XMFLOAT3 center;       // Area weighted centroid
+    };
+
+    struct TriangleBVH
+    {
+        std::vector<TriangleBVHNode> nodes;
+        std::vector<Triangle> triangles;
+    };
+
+    DirectX::XMFLOAT3 Sub(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) { return DirectX::XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z); }
+    DirectX::XMFLOAT3 Add(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) { return DirectX::XMFLOAT3(a.x + b.x, a.y + b.y, a.z + b.z); }
+    DirectX::XMFLOAT3 Scale(const DirectX::XMFLOAT3& a, float s) { return DirectX::XMFLOAT3(a.x * s, a.y * s, a.z * s); }
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b) { return a.x * b.x + a.y * b.y + a.z * b.z; }
+
+    DirectX::XMFLOAT3 Cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return DirectX::XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    float GetAxis(const DirectX::XMFLOAT3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    float BoxDistanceSq(const TriangleBVHNode& node, const DirectX::XMFLOAT3& p)
+    {
+        float dx = std::max(std::max(node.minBounds.x - p.x, p.x - node.maxBounds.x), 0.0f);
+        float dy = std::max(std::max(node.minBounds.y - p.y, p.y - node.maxBounds.y), 0.0f);
+        float dz = std::max(std::max(node.minBounds.z - p.z, p.z - node.maxBounds.z), 0.0f);
+        return dx * dx + dy * dy + dz * dz;
+    }
+
+    // Ericson, Real-Time Collision Detection 5.1.5, by Voronoi region
+    float ClosestPointDistanceSq(const Triangle& t, const DirectX::XMFLOAT3& p)
+    {
+        const DirectX::XMFLOAT3 ab = Sub(t.b, t.a);
+        const DirectX::XMFLOAT3 ac = Sub(t.c, t.a);
+        const DirectX::XMFLOAT3 ap = Sub(p, t.a);
+
+        DirectX::XMFLOAT3 closest;
+        float d1 = Dot(ab, ap);
+        float d2 = Dot(ac, ap);
+        if (d1 <= 0.0f && d2 <= 0.0f)
+        {
+            closest = t.a;
+        }
+        else
+        {
+            const DirectX::XMFLOAT3 bp = Sub(p, t.b);
+            float d3 = Dot(ab, bp);
+            float d4 = Dot(ac, bp);
+            const DirectX::XMFLOAT3 cp = Sub(p, t.c);
+            float d5 = Dot(ab, cp);
+            float d6 = Dot(ac, cp);
+
+            float vc = d1 * d4 - d3 * d2;
+            float vb = d5 * d2 - d1 * d6;
+            float va = d3 * d6 - d5 * d4;
+
+            if (d3 >= 0.0f && d4 <= d3)
+                closest = t.b;
+            else if (d6 >= 0.0f && d5 <= d6)
+                closest = t.c;
+            else if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f)
+                closest = Add(t.a, Scale(ab, d1 / (d1 - d3)));
+            else if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f)
+                closest = Add(t.a, Scale(ac, d2 / (d2 - d6)));
+            else if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f)
+                closest = Add(t.b, Scale(Sub(t.c, t.b), (d4 - d3) / ((d4 - d3) + (d5 - d6))));
+            else
+            {
+                float denom = 1.0f / (va + vb + vc);
+                closest = Add(t.a, Add(Scale(ab, vb * denom), Scale(ac, vc * denom)));
+            }
+        }
+
+        const DirectX::XMFLOAT3 d = Sub(p, closest);
+        return Dot(d, d);
+    }
+
+    // Van Oosterom and Strackee, signed by the triangle's winding
+    float GetSolidAngle(const Triangle& t, const DirectX::XMFLOAT3& p)
+    {
+        const DirectX::XMFLOAT3 a = Sub(t.a, p);
+        const DirectX::XMFLOAT3 b = Sub(t.b, p);
+        const DirectX::XMFLOAT3 c = Sub(t.c, p);
+        float la = sqrtf(Dot(a, a));
+        float lb = sqrtf(Dot(b, b));
+        float lc = sqrtf(Dot(c, c));
+
+        float numerator = Dot(a, Cross(b, c));
+        float denominator = la * lb * lc + Dot(a, b) * lc + Dot(a, c) * lb + Dot(b, c) * la;
+        return 2.0f * atan2f(numerator, denominator);
+    }
+
+    // Median split on the longest axis of the triangle centroids
+    void BuildNode(TriangleBVH& bvh, std::vector<uint32_t>& order, const std::vector<DirectX::XMFLOAT3>& centroids,
+                   const std::vector<Triangle>& triangles, uint32_t nodeIndex, uint32_t first, uint32_t count)
+    {
+        TriangleBVHNode node = {};
+        node.minBounds = DirectX::XMFLOAT3(FLT_MAX, FLT_MAX, FLT_MAX);
+        node.maxBounds = DirectX::XMFLOAT3(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+
+        DirectX::XMFLOAT3 centroidMin = node.minBounds;
+        DirectX::XMFLOAT3 centroidMax = node.maxBounds;
+        DirectX::XMFLOAT3 weightedCenter(0.0f, 0.0f, 0.0f);
+        float totalArea = 0.0f;
+
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            const Triangle& t = triangles[order[i]];
+            for (const DirectX::XMFLOAT3* v : { &t.a, &t.b, &t.c })
+            {
+                node.minBounds = DirectX::XMFLOAT3(std::min(node.minBounds.x, v->x), std::min(node.minBounds.y, v->y), std::min(node.minBounds.z, v->z));
+                node.maxBounds = DirectX::XMFLOAT3(std::max(node.maxBounds.x, v->x), std::max(node.maxBounds.y, v->y), std::max(node.maxBounds.z, v->z));
+            }
+
+            const DirectX::XMFLOAT3& centroid = centroids[order[i]];
+            centroidMin = DirectX::XMFLOAT3(std::min(centroidMin.x, centroid.x), std::min(centroidMin.y, centroid.y), std::min(centroidMin.z, centroid.z));
+            centroidMax = DirectX::XMFLOAT3(std::max(centroidMax.x, centroid.x), std::max(centroidMax.y, centroid.y), std::max(centroidMax.z, centroid.z));
+
+            DirectX::XMFLOAT3 areaNormal = Scale(Cross(Sub(t.b, t.a), Sub(t.c, t.a)), 0.5f);
+            float area = sqrtf(Dot(areaNormal, areaNormal));
+            node.areaNormal = Add(node.areaNormal, areaNormal);
+            weightedCenter = Add(weightedCenter, Scale(centroid, area));
+            totalArea += area;
+        }
+
+        node.center = totalArea > 0.0f ? Scale(weightedCenter, 1.0f / totalArea) : Scale(Add(node.minBounds, node.maxBounds), 0.5f);
+        for (uint32_t i = first; i < first + count; ++i)
+        {
+            const Triangle& t = triangles[order[i]];
+            for (const DirectX::XMFLOAT3* v : { &t.a, &t.b, &t.c })
+            {
+                DirectX::XMFLOAT3 d = Sub(*v, node.center);
+                node.radius = std::max(node.radius, sqrtf(Dot(d, d)));
+            }
+        }
+
+        if (count <= MESH_SDF_LEAF_SIZE)
+        {
+            node.firstOrChild = first;
+            node.count = count;
+            bvh.nodes[nodeIndex] = node;
+            return;
+        }
+
+        const DirectX::XMFLOAT3 extent = Sub(centroidMax, centroidMin);
+        const int axis = (extent.x >= extent.y && extent.x >= extent.z) ? 0 : (extent.y >= extent.z ? 1 : 2);
+        const uint32_t half = count / 2;
+        std::nth_element(order.begin() + first, order.begin() + first + half, order.begin() + first + count, [&](uint32_t a, uint32_t b)
+        {
+            return GetAxis(centroids[a], axis) < GetAxis(centroids[b], axis);
+        });
+
+        node.firstOrChild = (uint32_t)bvh.nodes.size();
+        node.count = 0;
+        bvh.nodes[nodeIndex] = node;
+        bvh.nodes.resize(bvh.nodes.size() + 2);
+
+        BuildNode(bvh, order, centroids, triangles, node.firstOrChild, first, half);
+        BuildNode(bvh, order, centroids, triangles, node.firstOrChild + 1, first + half, count - half);
+    }
+
+    bool BuildTriangleBVH(const DirectX::XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount, TriangleBVH& out_bvh)
+    {
+        std::vector<Triangle> triangles;
+        triangles.reserve(indexCount / 3);
+        for (uint32_t i = 0; i + 2 < indexCount; i += 3)
+        {
+            if (indices[i] >= vertexCount || indices[i + 1] >= vertexCount || indices[i + 2] >= vertexCount)
+                return false;
+            triangles.push_back({ positions[indices[i]], positions[indices[i + 1]], positions[indices[i + 2]] });
+        }
+
+        if (triangles.empty())
+            return false;
+
+        std::vector<DirectX::XMFLOAT3> centroids(triangles.size());
+        std::vector<uint32_t> order(triangles.size());
+        for (uint32_t i = 0; i < triangles.size(); ++i)
+        {
+            centroids[i] = Scale(Add(Add(triangles[i].a, triangles[i].b), triangles[i].c), 1.0f / 3.0f);
+            order[i] = i;
+        }
+
+        out_bvh.nodes.clear();
+        out_bvh.nodes.reserve(2 * triangles.size() / MESH_SDF_LEAF_SIZE + 1);
+        out_bvh.nodes.resize(1);
+        BuildNode(out_bvh, order, centroids, triangles, 0, 0, (uint32_t)triangles.size());
+
+        // Leaves index straight into the triangles
+        out_bvh.triangles.resize(triangles.size());
+        for (uint32_t i = 0; i < order.size(); ++i)
+            out_bvh.triangles[i] = triangles[order[i]];
+        return true;
+    }
+
+    // Nearest children first, so bestSq shrinks quickly and prunes the rest. Returns bestSq if nothing is closer.
+    float FindClosestDistanceSq(const TriangleBVH& bvh, const DirectX::XMFLOAT3& p, float bestSq)
+    {
+        uint32_t stack[MESH_SDF_STACK_SIZE];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        while (top > 0)
+        {
+            const TriangleBVHNode& node = bvh.nodes[stack[--top]];
+            if (BoxDistanceSq(node, p) >= bestSq)
+                continue;
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.firstOrChild; i < node.firstOrChild + node.count; ++i)
+                    bestSq = std::min(bestSq, ClosestPointDistanceSq(bvh.triangles[i], p));
+                continue;
+            }
+
+            uint32_t nearChild = node.firstOrChild;
+            uint32_t farChild = node.firstOrChild + 1;
+            float nearSq = BoxDistanceSq(bvh.nodes[nearChild], p);
+            float farSq = BoxDistanceSq(bvh.nodes[farChild], p);
+            if (farSq < nearSq)
+            {
+                std::swap(nearChild, farChild);
+                std::swap(nearSq, farSq);
+            }
+
+            if (farSq < bestSq)
+                stack[top++] = farChild;
+            if (nearSq < bestSq)
+                stack[top++] = nearChild;
+        }
+
+        return bestSq;
+    }
+
+    // About 1 inside a closed mesh and 0 outside, whichever way its triangles wind
+    float GetWindingNumber(const TriangleBVH& bvh, const DirectX::XMFLOAT3& p)
+    {
+        uint32_t stack[MESH_SDF_STACK_SIZE];
+        uint32_t top = 0;
+        stack[top++] = 0;
+
+        float solidAngle = 0.0f;
+        while (top > 0)
+        {
+            const TriangleBVHNode& node = bvh.nodes[stack[--top]];
+
+            const DirectX::XMFLOAT3 d = Sub(node.center, p);
+            const float distanceSq = Dot(d, d);
+            const float farDistance = WINDING_FAR_RATIO * node.radius;
+            if (distanceSq > farDistance * farDistance)
+            {
+                solidAngle += Dot(node.areaNormal, d) / (distanceSq * sqrtf(distanceSq));
+                continue;
+            }
+
+            if (node.count > 0)
+            {
+                for (uint32_t i = node.firstOrChild; i < node.firstOrChild + node.count; ++i)
+                    solidAngle += GetSolidAngle(bvh.triangles[i], p);
+                continue;
+            }
+
+            stack[top++] = node.firstOrChild;
+            stack[top++] = node.firstOrChild + 1;
+        }
+
+        return fabsf(solidAngle * INV_FOUR_PI);
+    }
+
+    // Trilinear distance in a volume of size texels starting at slice zOffset of a rowWidth x sliceHeight grid,
+    // covering [lo, lo + extent] of local space. Clamped onto that box, like the clamp sampler in MeshSdf.hlsli.
+    float SampleTrilinear(const float* distances, uint32_t rowWidth, uint32_t sliceHeight, uint32_t zOffset,
+                          const uint32_t size[3], const float lo[3], const float extent[3], const DirectX::XMFLOAT3& localPos)
+    {
+        const float p[3] = { localPos.x, localPos.y, localPos.z };
+
+        float outsideSq = 0.0f;
+        uint32_t i0[3], i1[3];
+        float f[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float closest = std::clamp(p[axis], lo[axis], lo[axis] + extent[axis]);
+            outsideSq += (p[axis] - closest) * (p[axis] - closest);
+
+            float texel = std::clamp((closest - lo[axis]) / extent[axis] * (float)size[axis] - 0.5f, 0.0f, (float)(size[axis] - 1));
+            i0[axis] = std::min((uint32_t)texel, size[axis] - 1);
+            i1[axis] = std::min(i0[axis] + 1, size[axis] - 1);
+            f[axis] = texel - (float)i0[axis];
+        }
+
+        auto At = [&](uint32_t x, uint32_t y, uint32_t z) { return distances[((size_t)(zOffset + z) * sliceHeight + y) * rowWidth + x]; };
+
+        float c00 = At(i0[0], i0[1], i0[2]) + (At(i1[0], i0[1], i0[2]) - At(i0[0], i0[1], i0[2])) * f[0];
+        float c10 = At(i0[0], i1[1], i0[2]) + (At(i1[0], i1[1], i0[2]) - At(i0[0], i1[1], i0[2])) * f[0];
+        float c01 = At(i0[0], i0[1], i1[2]) + (At(i1[0], i0[1], i1[2]) - At(i0[0], i0[1], i1[2])) * f[0];
+        float c11 = At(i0[0], i1[1], i1[2]) + (At(i1[0], i1[1], i1[2]) - At(i0[0], i1[1], i1[2])) * f[0];
+
+        float c0 = c00 + (c10 - c00) * f[1];
+        float c1 = c01 + (c11 - c01) * f[1];
+        return c0 + (c1 - c0) * f[2] + sqrtf(outsideSq);
+    }
+}
+
+bool BakeMeshSdf(const DirectX::XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                 const MeshSdfDesc& desc, MeshSdf& out_sdf, uint32_t threadCount)
+{
+    out_sdf = MeshSdf();
+    if (!positions || !indices || indexCount < 3 || desc.resolution < 2)
+        return false;
+
+    TriangleBVH bvh;
+    if (!BuildTriangleBVH(positions, vertexCount, indices, indexCount, bvh))
+        return false;
+
+    // Cubic voxels over the padded box, centered on the mesh
+    const TriangleBVHNode& root = bvh.nodes[0];
+    const DirectX::XMFLOAT3 size = Sub(root.maxBounds, root.minBounds);
+    const float longest = std::max(size.x, std::max(size.y, size.z));
+    if (longest <= 0.0f)
+        return false;
+
+    const float padding = longest * desc.padding;
+    out_sdf.voxelSize = (longest + 2.0f * padding) / (float)desc.resolution;
+    out_sdf.width = std::max(2u, (uint32_t)ceilf((size.x + 2.0f * padding) / out_sdf.voxelSize));
+    out_sdf.height = std::max(2u, (uint32_t)ceilf((size.y + 2.0f * padding) / out_sdf.voxelSize));
+    out_sdf.depth = std::max(2u, (uint32_t)ceilf((size.z + 2.0f * padding) / out_sdf.voxelSize));
+
+    const DirectX::XMFLOAT3 center = Scale(Add(root.minBounds, root.maxBounds), 0.5f);
+    out_sdf.boundsMin = DirectX::XMFLOAT3(
+        center.x - 0.5f * out_sdf.voxelSize * (float)out_sdf.width,
+        center.y - 0.5f * out_sdf.voxelSize * (float)out_sdf.height,
+        center.z - 0.5f * out_sdf.voxelSize * (float)out_sdf.depth);
+    out_sdf.distances.resize((size_t)out_sdf.width * out_sdf.height * out_sdf.depth);
+
+    ParallelFor(out_sdf.height * out_sdf.depth, threadCount, [&](uint32_t row)
+    {
+        const uint32_t y = row % out_sdf.height;
+        const uint32_t z = row / out_sdf.height;
+        float* rowDistances = out_sdf.distances.data() + (size_t)row * out_sdf.width;
+
+        // Distance changes by at most a voxel between neighbors, which bounds each search by the last one.
+        // A voxel further than that from the surface can't have crossed it since the last one either, so it keeps the last sign.
+        float previous = -1.0f;
+        bool inside = false;
+        for (uint32_t x = 0; x < out_sdf.width; ++x)
+        {
+            const DirectX::XMFLOAT3 p(
+                out_sdf.boundsMin.x + ((float)x + 0.5f) * out_sdf.voxelSize,
+                out_sdf.boundsMin.y + ((float)y + 0.5f) * out_sdf.voxelSize,
+                out_sdf.boundsMin.z + ((float)z + 0.5f) * out_sdf.voxelSize);
+
+            float bound = previous < 0.0f ? FLT_MAX : (previous + out_sdf.voxelSize) * 1.001f;
+            float distance = sqrtf(FindClosestDistanceSq(bvh, p, bound < FLT_MAX ? bound * bound : FLT_MAX));
+
+            if (previous < 0.0f || distance <= out_sdf.voxelSize)
+                inside = GetWindingNumber(bvh, p) > 0.5f;
+            previous = distance;
+
+            rowDistances[x] = inside ? -distance : distance;
+        }
+    });
+
+    return true;
+}
+
+float SampleMeshSdf(const MeshSdf& sdf, const DirectX::XMFLOAT3& localPos)
+{
+    if (sdf.distances.empty())
+        return FLT_MAX;
+
+    const uint32_t size[3] = { sdf.width, sdf.height, sdf.depth };
+    const float lo[3] = { sdf.boundsMin.x, sdf.boundsMin.y, sdf.boundsMin.z };
+    const float extent[3] = { sdf.voxelSize * sdf.width, sdf.voxelSize * sdf.height, sdf.voxelSize * sdf.depth };
+    return SampleTrilinear(sdf.distances.data(), sdf.width, sdf.height, 0, size, lo, extent, localPos);
+}
+
+bool BuildMeshSdfAtlas(const MeshSdf* const* sdfs, uint32_t count, float falloffVoxels, MeshSdfAtlas& out_atlas)
+{
+    out_atlas = MeshSdfAtlas();
+
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const MeshSdf& sdf = *sdfs[i];
+        if (sdf.distances.empty() || sdf.distances.size() != (size_t)sdf.width * sdf.height * sdf.depth)
+        {
+            Printf(L"Error: Mesh SDF %u is empty or doesn't match its dimensions!\n", i);
+            out_atlas = MeshSdfAtlas();
+            return false;
+        }
+
+        sbMeshSdfSlot slot = {};
+        slot.boundsMin = sdf.boundsMin;
+        slot.falloff = falloffVoxels * sdf.voxelSize;
+        slot.boundsSize = DirectX::XMFLOAT3(sdf.voxelSize * sdf.width, sdf.voxelSize * sdf.height, sdf.voxelSize * sdf.depth);
+        slot.zOffset = out_atlas.depth;
+        slot.dimensions = DirectX::XMUINT3(sdf.width, sdf.height, sdf.depth);
+        out_atlas.slots.push_back(slot);
+
+        out_atlas.width = std::max(out_atlas.width, sdf.width);
+        out_atlas.height = std::max(out_atlas.height, sdf.height);
+        out_atlas.depth += sdf.depth;
+    }
+
+    if (out_atlas.depth > MESH_SDF_ATLAS_MAX_DEPTH)
+    {
+        Printf(L"Error: Mesh SDF atlas is %u slices deep, more than a 3d texture can hold!\n", out_atlas.depth);
+        out_atlas = MeshSdfAtlas();
+        return false;
+    }
+
+    out_atlas.distances.resize((size_t)out_atlas.width * out_atlas.height * out_atlas.depth);
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        const MeshSdf& sdf = *sdfs[i];
+        const uint32_t zOffset = out_atlas.slots[i].zOffset;
+        for (uint32_t z = 0; z < sdf.depth; ++z)
+        {
+            for (uint32_t y = 0; y < out_atlas.height; ++y)
+            {
+                const float* srcRow = sdf.distances.data() + ((size_t)z * sdf.height + std::min(y, sdf.height - 1)) * sdf.width;
+                float* dstRow = out_atlas.distances.data() + ((size_t)(zOffset + z) * out_atlas.height + y) * out_atlas.width;
+                for (uint32_t x = 0; x < out_atlas.width; ++x)
+                    dstRow[x] = srcRow[std::min(x, sdf.width - 1)];
+            }
+        }
+    }
+
+    return true;
+}
+
+float SampleMeshSdfAtlas(const MeshSdfAtlas& atlas, uint32_t slot, const DirectX::XMFLOAT3& localPos)
+{
+    if (slot >= atlas.slots.size())
+        return FLT_MAX;
+
+    const sbMeshSdfSlot& s = atlas.slots[slot];
+    const uint32_t size[3] = { s.dimensions.x, s.dimensions.y, s.dimensions.z };
+    const float lo[3] = { s.boundsMin.x, s.boundsMin.y, s.boundsMin.z };
+    const float extent[3] = { s.boundsSize.x, s.boundsSize.y, s.boundsSize.z };
+    return SampleTrilinear(atlas.distances.data(), atlas.width, atlas.height, s.zOffset, size, lo, extent, localPos);
+}
+
+float BlendMeshSdfDensity(float density, float distance, float falloff)
+{
+    float t = std::clamp(distance / std::max(falloff, 1e-4f), 0.0f, 1.0f);
+    return density * t * t * (3.0f - 2.0f * t);
+}
+
+}
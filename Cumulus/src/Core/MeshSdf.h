@@ -0,0 +1,74 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Signed distance volumes baked from triangle meshes, so clouds
+can flow around the real shape of an object rather than its hull. The
+distance to each voxel comes from a closest triangle query down a BVH. The
+sign comes from the generalized winding number, with far BVH nodes collapsed
+to dipoles, so open or messy meshes still get a sensible inside. Bakes are
+slow, so they are stored in the mesh's cooked file (CookedMesh.h).
+----------------------------------------------*/
+#ifndef MUON_MESHSDF_H
+#define MUON_MESHSDF_H
+
+#include <Core/SBufferStructs.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // D3D12's limit on any side of a 3d texture, which the atlas' stacked depth has to fit in
+    static const uint32_t MESH_SDF_ATLAS_MAX_DEPTH = 2048;
+
+    struct MeshSdfDesc
+    {
+        uint32_t resolution = 32;   // Voxels along the longest side of the mesh's box, voxels are cubes
+        float padding = 0.1f;       // Margin around the mesh, as a fraction of its longest side
+    };
+
+    // Distances in the mesh's local units, negative inside, laid out x fastest, then y, then z.
+    struct MeshSdf
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        DirectX::XMFLOAT3 boundsMin = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);  // Corner of the first voxel
+        float voxelSize = 0.0f;
+        std::vector<float> distances;
+    };
+
+    // Every mesh's SDF in one volume, stacked along z, since there are no 3d texture arrays to give each its own slice.
+    // The slots say where each one sits and what box of its mesh's local space it covers. Uploaded as MeshSdfAtlas.
+    struct MeshSdfAtlas
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 0;
+        std::vector<float> distances;
+        std::vector<sbMeshSdfSlot> slots;
+    };
+
+    // positions are tightly packed xyz like aiVector3D arrays, indices are triangle lists.
+    // Slices are shared out between threadCount threads, 0 uses every hardware thread.
+    bool BakeMeshSdf(const DirectX::XMFLOAT3* positions, uint32_t vertexCount, const uint32_t* indices, uint32_t indexCount,
+                     const MeshSdfDesc& desc, MeshSdf& out_sdf, uint32_t threadCount = 0);
+
+    // Trilinear distance at a local position. Outside the volume, the distance at the closest point on its box plus the way there.
+    // The shaders sample the same way through the atlas.
+    float SampleMeshSdf(const MeshSdf& sdf, const DirectX::XMFLOAT3& localPos);
+
+    // One slot per sdf, in order. Each slot's falloff is falloffVoxels of its own voxels.
+    // Slots narrower than the atlas repeat their edge texels out to its sides, so filtering at the edges never sees a neighbor.
+    bool BuildMeshSdfAtlas(const MeshSdf* const* sdfs, uint32_t count, float falloffVoxels, MeshSdfAtlas& out_atlas);
+
+    // SampleMeshSdf() on the SDF in one of the atlas' slots. Mirrors SampleMeshSdfAtlas() in MeshSdf.hlsli.
+    float SampleMeshSdfAtlas(const MeshSdfAtlas& atlas, uint32_t slot, const DirectX::XMFLOAT3& localPos);
+
+    // Cloud density near an object, thinned out to nothing at its surface over falloff units. Mirrors BlendMeshSdfDensity() in MeshSdf.hlsli.
+    float BlendMeshSdfDensity(float density, float distance, float falloff);
+}
+
+#endif
@@ -121,6 +121,56 @@ void ImguiNewFrame(float gameTime, const Camera& cam, SceneSettings& settings)
 
             ImGui::EndTabItem();
         }
+        if (ImGui::BeginTabItem("Clouds"))
+        {
+            static const char* RESOLUTION_NAMES[] = { "Full", "Half", "Quarter" };
+            static const int RESOLUTION_DIVISORS[] = { 1, 2, 4 };
+
+            ImGui::Checkbox("Temporal Reprojection (4x4)", &settings.isCloudTemporal);
+            ImGui::SliderFloat("Step Size Scale", &settings.cloudStepSizeScale, 0.5f, 4.0f);
+            ImGui::Checkbox("Cone March Prepass", &settings.isConeMarchPrepass);
+            ImGui::Checkbox("Brick Ray Intervals", &settings.isRayIntervals);
+            ImGui::Checkbox("Hull Tile Binning", &settings.isHullTiles);
+            ImGui::Checkbox("Adaptive Tile Budget", &settings.isAdaptiveTileBudget);
+            if (!settings.isCloudTemporal)
+            {
+                int resolutionIdx = settings.cloudResolutionDivisor >= 4 ? 2 : settings.cloudResolutionDivisor - 1;
+                if (ImGui::Combo("Raymarch Resolution", &resolutionIdx, RESOLUTION_NAMES, IM_ARRAYSIZE(RESOLUTION_NAMES)))
+                {
+                    settings.cloudResolutionDivisor = RESOLUTION_DIVISORS[resolutionIdx];
+                }
+            }
+            ImGui::SliderInt("Sun Shadow Slices / Frame", &settings.sunShadowSliceBudget, 1, 16);
+            ImGui::SliderInt("Beer Shadow Map Interval", &settings.beerShadowRefreshInterval, 1, 30);
+            ImGui::SliderFloat("Sky Ambient", &settings.skyAmbientScale, 0.0f, 4.0f);
+
+            ImGui::SeparatorText("Scattering");
+            ImGui::SliderFloat("Forward Eccentricity", &settings.cloudScattering.forwardG, 0.0f, 0.95f);
+            ImGui::SliderFloat("Backward Eccentricity", &settings.cloudScattering.backwardG, -0.95f, 0.0f);
+            ImGui::SliderFloat("Forward Lobe Weight", &settings.cloudScattering.forwardWeight, 0.0f, 1.0f);
+            int octaves = (int)settings.cloudScattering.octaves;
+            if (ImGui::SliderInt("Scattering Octaves", &octaves, 1, 8))
+                settings.cloudScattering.octaves = (uint32_t)octaves;
+
+            ImGui::SeparatorText("Far Field");
+            ImGui::Checkbox("Far Field Panorama", &settings.isFarFieldPanorama);
+            if (settings.isFarFieldPanorama)
+            {
+                ImGui::SliderFloat("Far Field Distance", &settings.farFieldDistance, 100.0f, 900.0f);
+                ImGui::SliderFloat("Panorama Move Tolerance", &settings.panoramaMoveTolerance, 1.0f, 100.0f);
+                ImGui::SliderInt("Panorama Rows / Frame", &settings.panoramaRowBudget, 1, 128);
+            }
+
+            ImGui::SeparatorText("Instances");
+            ImGui::Checkbox("Cloud Instances", &settings.isCloudInstanced);
+            if (settings.isCloudInstanced)
+            {
+                ImGui::SliderInt("Instance Count", &settings.cloudInstanceCount, 1, 256);
+                ImGui::SliderFloat("Instance Drift", &settings.cloudInstanceDriftSpeed, 0.0f, 50.0f);
+            }
+
+            ImGui::EndTabItem();
+        }
         if (ImGui::BeginTabItem("Interactables"))
         {
             ImGui::Checkbox("Visualize Convex Hull", &settings.isSunDynamic);
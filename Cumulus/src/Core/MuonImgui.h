@@ -8,6 +8,7 @@ Description : Helpers for initializing/using ImGui
 
 #include <Core/WinApp.h>
 #include "Camera.h"
+#include <Utils/CloudLightingUtils.h>
 
 namespace Muon
 {
@@ -15,6 +16,24 @@ namespace Muon
 		bool isSunDynamic = false;
 		int timeOfDay = 800; // stored as military time for now
 		DirectX::XMFLOAT3 sunDir;
+		int cloudResolutionDivisor = 1; // 1 = full, 2 = half, 4 = quarter res cloud raymarch
+		bool isCloudTemporal = false; // March 1 of every 4x4 pixels per frame and reproject the rest
+		float cloudStepSizeScale = 1.0f; // Blue noise jitter holds up at larger steps than white noise did
+		bool isConeMarchPrepass = true; // Start rays where a 1/8 resolution cone march found the first possible cloud
+		bool isRayIntervals = true; // Clip rays to the span of the occupied cloud bricks they cross
+		bool isHullTiles = true; // Bin the hulls into screen tiles so each ray only intersects its tile's hulls
+		bool isAdaptiveTileBudget = true; // Shift step size between tiles by their noise, at a fixed total step count
+		int sunShadowSliceBudget = 2; // Sun shadow volume slices re-baked per frame while the sun moves
+		int beerShadowRefreshInterval = 4; // Frames between Beer shadow map renders
+		float skyAmbientScale = 1.0f; // Multiplier on the sky light the clouds receive
+		CloudScatteringParams cloudScattering; // Changing these rebuilds the scattering LUT
+		bool isFarFieldPanorama = true; // Sky rays read clouds past farFieldDistance from a cached panorama
+		float farFieldDistance = 300.0f;
+		float panoramaMoveTolerance = 20.0f; // Camera movement that triggers a new panorama sweep
+		int panoramaRowBudget = 16; // Panorama rows baked per frame during a sweep
+		bool isCloudInstanced = false; // Scatter scaled, rotated copies of the cloud volume, found per ray through a BVH
+		int cloudInstanceCount = 128;
+		float cloudInstanceDriftSpeed = 4.0f; // World units per second along +x
 	};
 
 	bool ImguiInit();
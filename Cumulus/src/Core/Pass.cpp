@@ -42,6 +42,7 @@ bool Pass::GenerateRootSignature()
 
     std::vector<ShaderResourceBinding> CBVs;
     std::vector<ShaderResourceBinding> SRVs;
+    std::vector<ShaderResourceBinding> BufferSRVs;
     std::vector<ShaderResourceBinding> UAVs;
     std::vector<ShaderResourceBinding> Samplers;
 
@@ -55,9 +56,11 @@ bool Pass::GenerateRootSignature()
             CBVs.push_back(res);
             break;
         case ShaderResourceType::Texture:
-        case ShaderResourceType::StructuredBuffer:
             SRVs.push_back(res);
             break;
+        case ShaderResourceType::StructuredBuffer:
+            BufferSRVs.push_back(res);
+            break;
         case ShaderResourceType::RWTexture:
         case ShaderResourceType::RWStructuredBuffer:
             UAVs.push_back(res);
@@ -82,6 +85,13 @@ bool Pass::GenerateRootSignature()
         mResourceNameToRootIndex[srv.Name] = rootParamIndex++;
     }
 
+    // Structured buffers don't need a descriptor, they're bound straight from their GPU address
+    for (const auto& srv : BufferSRVs)
+    {
+        builder.AddRootShaderResourceView(srv.BindPoint, srv.Space, srv.Visibility);
+        mResourceNameToRootIndex[srv.Name] = rootParamIndex++;
+    }
+
     for (const auto& uav : UAVs)
     {
         builder.AddUnorderedAccessView(uav.BindPoint, uav.Space, uav.Visibility);
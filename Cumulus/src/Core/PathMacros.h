@@ -28,6 +28,8 @@ helper macros for reaching certain paths
 #define TEX3DPATHW WIDEN(TEX3DPATH)
 #define NOISEPATH TGAPATH ## "Noise\\"
 #define NOISEPATHW WIDEN(NOISEPATH)
+#define CACHEPATH ASSETPATH ## "Cache\\"
+#define CACHEPATHW WIDEN(CACHEPATH)
 #define SHADERPATH "..\\_bin\\Shaders\\"
 #define SHADERPATHW WIDEN(SHADERPATH)
 
@@ -59,6 +59,7 @@ void ResourceCodex::Init()
     MeshFactory::LoadAllMeshes(*gCodexInstance);
     TextureFactory::LoadAllNVDF(GetDevice(), GetCommandList(), *gCodexInstance);
     TextureFactory::LoadAll3DTextures(GetDevice(), GetCommandList(), *gCodexInstance);
+    TextureFactory::CreateBlueNoiseTexture(GetDevice(), GetCommandList(), *gCodexInstance);
     MaterialFactory::CreateAllMaterials(*gCodexInstance);
 
     // After initialization, before real frame loop:
@@ -104,6 +105,8 @@ void ResourceCodex::Destroy()
         tex.Destroy();
     }
     gCodexInstance->mTextureMap.clear();
+    gCodexInstance->mCloudDensityGrids.clear();
+    gCodexInstance->mTextureData.clear();
     gCodexInstance->m2DTextureStagingBuffer.Destroy();
     gCodexInstance->m3DTextureStagingBuffer.Destroy();
 
@@ -161,6 +164,22 @@ const Texture* ResourceCodex::GetTexture(ResourceID UID) const
         return nullptr;
 }
 
+const CloudDensityGrid* ResourceCodex::GetCloudDensityGrid(ResourceID UID) const
+{
+    if (mCloudDensityGrids.find(UID) != mCloudDensityGrids.end())
+        return &mCloudDensityGrids.at(UID);
+    else
+        return nullptr;
+}
+
+const FloatTexture* ResourceCodex::GetTextureData(ResourceID UID) const
+{
+    if (mTextureData.find(UID) != mTextureData.end())
+        return &mTextureData.at(UID);
+    else
+        return nullptr;
+}
+
 Texture* ResourceCodex::GetTexture(ResourceID UID)
 {
     if (mTextureMap.find(UID) != mTextureMap.end())
@@ -194,6 +213,26 @@ Texture& ResourceCodex::InsertTexture(ResourceID hash)
     return mTextureMap[hash];
 }
 
+CloudDensityGrid& ResourceCodex::InsertCloudDensityGrid(ResourceID hash)
+{
+    if (mCloudDensityGrids.find(hash) != mCloudDensityGrids.end())
+    {
+        Muon::Printf(L"Warning: Attempted to insert duplicate cloud density grid: 0x%08x!\n", hash);
+    }
+
+    return mCloudDensityGrids[hash];
+}
+
+FloatTexture& ResourceCodex::InsertTextureData(ResourceID hash)
+{
+    if (mTextureData.find(hash) != mTextureData.end())
+    {
+        Muon::Printf(L"Warning: Attempted to insert duplicate texture data: 0x%08x!\n", hash);
+    }
+
+    return mTextureData[hash];
+}
+
 Material* ResourceCodex::InsertMaterialType(const wchar_t* name)
 {
     if (!name)
@@ -14,6 +14,8 @@ Description : Loads and distributes all static resources (materials, textures, e
 #include <Core/Shader.h>
 #include <Core/Buffers.h>
 #include <Core/DescriptorHeap.h>
+#include <Utils/CloudLightingUtils.h>
+#include <Utils/TextureUtils.h>
 
 #include <unordered_map>
 #include <memory>
@@ -45,6 +47,8 @@ public:
     const Mesh* GetMesh(ResourceID UID) const;
     const Texture* GetTexture(ResourceID UID) const;
     const Material* GetMaterialType(ResourceID UID) const;
+    const CloudDensityGrid* GetCloudDensityGrid(ResourceID UID) const; // Keyed by the NVDF texture's name
+    const FloatTexture* GetTextureData(ResourceID UID) const; // CPU copies, only kept for textures that are also sampled on the CPU
 
     Texture* GetTexture(ResourceID UID); // TODO: find some way to make this a const ptr again
 
@@ -60,6 +64,8 @@ private:
     std::unordered_map<ResourceID, Mesh>          mMeshMap;
     std::unordered_map<ResourceID, Texture>       mTextureMap;
     std::unordered_map<ResourceID, Material>      mMaterialMap;
+    std::unordered_map<ResourceID, CloudDensityGrid> mCloudDensityGrids;
+    std::unordered_map<ResourceID, FloatTexture>  mTextureData;
 
     // Intermediate upload buffers used for uploading resource data to the GPU
     UploadBuffer mMeshStagingBuffer;
@@ -70,6 +76,8 @@ private:
 private:
     friend struct TextureFactory;
     Texture& InsertTexture(ResourceID hash);
+    CloudDensityGrid& InsertCloudDensityGrid(ResourceID hash);
+    FloatTexture& InsertTextureData(ResourceID hash);
 
     friend struct MaterialFactory;
     Material* InsertMaterialType(const wchar_t* name);
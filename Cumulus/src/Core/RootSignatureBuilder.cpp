@@ -94,6 +94,16 @@ void RootSignatureBuilder::AddShaderResourceView(UINT shaderRegister, UINT space
     AddDescriptorTable(&srvRange, 1, visibility);
 }
 
+void RootSignatureBuilder::AddRootShaderResourceView(UINT shaderRegister, UINT space, D3D12_SHADER_VISIBILITY visibility)
+{
+    D3D12_ROOT_PARAMETER srv = {};
+    srv.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
+    srv.ShaderVisibility = visibility;
+    srv.Descriptor.ShaderRegister = shaderRegister;
+    srv.Descriptor.RegisterSpace = space;
+    mParameters.push_back(srv);
+}
+
 void RootSignatureBuilder::AddUnorderedAccessView(UINT shaderRegister, UINT space, D3D12_SHADER_VISIBILITY visibility)
 {
     D3D12_DESCRIPTOR_RANGE uavRange = {};
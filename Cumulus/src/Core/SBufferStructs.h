@@ -0,0 +1,60 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Declaration of structs used as structured buffer elements by various shaders.
+Structured buffers are tightly packed, so unlike the cbuffer structs these
+carry no 16 byte alignment.
+----------------------------------------------*/
+#ifndef SBUFFERSTRUCTS_H
+#define SBUFFERSTRUCTS_H
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+
+namespace Muon
+{
+
+static const uint32_t MESH_SDF_SLOT_NONE = UINT32_MAX;
+
+// Mirrors HullRange in Raymarch_Common.hlsli. One convex hull's planes in hullPlanes.
+struct sbHullRange
+{
+    uint32_t planeOffset;
+    uint32_t planeCount;
+};
+
+// Mirrors HullInstance in Raymarch_Common.hlsli. A placed shape, whose hulls are a run of hullRanges.
+struct sbHullInstance
+{
+    uint32_t rangeOffset;
+    uint32_t rangeCount;
+    uint32_t sdfSlot;   // Into meshSdfSlots, or MESH_SDF_SLOT_NONE
+    uint32_t pad;
+
+    DirectX::XMFLOAT4X4 invWorld;
+};
+
+// Mirrors MeshSdfSlot in MeshSdf.hlsli. Where one mesh's SDF sits in the MeshSdfAtlas, and the box of the mesh's local space it covers.
+struct sbMeshSdfSlot
+{
+    DirectX::XMFLOAT3 boundsMin;    // MeshSdf::boundsMin
+    float falloff;                  // Distance from the surface over which clouds thin out, in the mesh's local units
+    DirectX::XMFLOAT3 boundsSize;   // MeshSdf::voxelSize times its dimensions
+    uint32_t zOffset;               // First slice of the atlas the SDF fills
+    DirectX::XMUINT3 dimensions;
+    uint32_t pad;
+};
+
+// Mirrors HullBounds in Raymarch_Common.hlsli. World space box of one hull of one instance, what the tiles are binned from.
+struct sbHullBounds
+{
+    DirectX::XMFLOAT3 minBounds;
+    uint32_t instance;
+    DirectX::XMFLOAT3 maxBounds;
+    uint32_t range;
+};
+
+}
+
+#endif
@@ -0,0 +1,148 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of SunShadowVolume.h
+----------------------------------------------*/
+#include "SunShadowVolume.h"
+
+#include <Core/DescriptorHeap.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+
+namespace Muon
+{
+
+namespace
+{
+    // Roughly a quarter of a degree. Smaller sun movements don't visibly change the shadows.
+    static const float SUN_DIRECTION_TOLERANCE_COS = 0.99999f;
+
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+}
+
+bool SunShadowVolume::Init(ID3D12Device* pDevice, const CloudDensityGrid* pDensityGrid)
+{
+    if (!pDensityGrid || pDensityGrid->extinction.empty() || pDensityGrid->depth < 2)
+    {
+        Printf(L"Error: SunShadowVolume needs a 3D cloud density grid!\n");
+        return false;
+    }
+
+    mpDensityGrid = pDensityGrid;
+
+    const UINT width = pDensityGrid->width;
+    const UINT height = pDensityGrid->height;
+    const UINT depth = pDensityGrid->depth;
+
+    if (!mTexture.Create(L"SunShadowVolume", pDevice, width, height, depth, DXGI_FORMAT_R32_FLOAT, D3D12_RESOURCE_FLAG_NONE, D3D12_RESOURCE_STATE_COPY_DEST))
+    {
+        Printf(L"Error: Failed to create the sun shadow volume texture!\n");
+        return false;
+    }
+    mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+    if (!mTexture.InitSRV(pDevice, GetSRVHeap()))
+    {
+        Printf(L"Error: Failed to create the sun shadow volume SRV!\n");
+        return false;
+    }
+
+    // Room for every slice at its own offset, see UploadBuffer::UploadSlicesToTexture
+    const size_t rowPitch = AlignToBoundary(width * (UINT)sizeof(float), D3D12_TEXTURE_DATA_PITCH_ALIGNMENT);
+    const size_t slicePitch = AlignToBoundary((UINT)(rowPitch * height), D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+    mStagingBuffer.Create(L"Sun Shadow Staging Buffer", slicePitch * depth);
+
+    mOpticalDepth.assign((size_t)width * height * depth, 0.0f);
+    mNextSlice = 0;
+    mSweepActive = false;
+    mHasBaked = false;
+    mDirtyBegin = mDirtyEnd = 0;
+    return true;
+}
+
+void SunShadowVolume::Destroy()
+{
+    mTexture.Destroy();
+    mStagingBuffer.Destroy();
+    mOpticalDepth.clear();
+    mpDensityGrid = nullptr;
+    mHasBaked = false;
+    mSweepActive = false;
+}
+
+void SunShadowVolume::Update(const DirectX::XMFLOAT3& sunDirWS, uint32_t sliceBudget)
+{
+    if (!mpDensityGrid || mOpticalDepth.empty())
+        return;
+
+    const uint32_t width = mpDensityGrid->width;
+    const uint32_t height = mpDensityGrid->height;
+    const uint32_t depth = mpDensityGrid->depth;
+
+    // A sweep in flight always finishes against the sun it started with, otherwise a sun that never stops would never finish one
+    if (!mSweepActive && (!mHasBaked || Dot(sunDirWS, mSweepSunDir) < SUN_DIRECTION_TOLERANCE_COS))
+    {
+        mSweepSunDir = sunDirWS;
+        mNextSlice = 0;
+        mSweepActive = true;
+    }
+
+    if (!mSweepActive)
+        return;
+
+    const uint32_t sliceCount = mHasBaked ? std::min(std::max(sliceBudget, 1u), depth - mNextSlice) : depth;
+    BakeSunShadowSlices(*mpDensityGrid, mSweepSunDir, width, height, depth, mNextSlice, sliceCount, mOpticalDepth.data());
+
+    if (mDirtyBegin == mDirtyEnd)
+    {
+        mDirtyBegin = mNextSlice;
+        mDirtyEnd = mNextSlice + sliceCount;
+    }
+    else
+    {
+        mDirtyBegin = std::min(mDirtyBegin, mNextSlice);
+        mDirtyEnd = std::max(mDirtyEnd, mNextSlice + sliceCount);
+    }
+
+    mNextSlice += sliceCount;
+    if (mNextSlice >= depth)
+    {
+        mSweepActive = false;
+        mHasBaked = true;
+    }
+}
+
+void SunShadowVolume::RecordUpload(ID3D12GraphicsCommandList* pCommandList)
+{
+    if (!mTexture.GetResource())
+        return;
+
+    const bool hasDirtySlices = mDirtyEnd > mDirtyBegin;
+    if (hasDirtySlices)
+    {
+        if (mTextureState != D3D12_RESOURCE_STATE_COPY_DEST)
+        {
+            pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mTexture.GetResource(),
+                mTextureState, D3D12_RESOURCE_STATE_COPY_DEST));
+            mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+        }
+
+        if (!mStagingBuffer.UploadSlicesToTexture(mTexture, mOpticalDepth.data(), mDirtyBegin, mDirtyEnd - mDirtyBegin, pCommandList))
+            Printf(L"Warning: Failed to upload sun shadow slices %u-%u\n", mDirtyBegin, mDirtyEnd - 1);
+
+        mDirtyBegin = mDirtyEnd = 0;
+    }
+
+    if (mTextureState != D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE)
+    {
+        pCommandList->ResourceBarrier(1, &CD3DX12_RESOURCE_BARRIER::Transition(mTexture.GetResource(),
+            mTextureState, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE));
+        mTextureState = D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE;
+    }
+}
+
+}
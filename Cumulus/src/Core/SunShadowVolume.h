@@ -0,0 +1,60 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Optical depth toward the sun over the whole cloud volume.
+Baked on the CPU from the NVDF's coarse density grid. When the sun moves the
+volume is re-baked a few slices per frame instead of all at once.
+----------------------------------------------*/
+#ifndef MUON_SUNSHADOWVOLUME_H
+#define MUON_SUNSHADOWVOLUME_H
+
+#include <Core/Buffers.h>
+#include <Core/Texture.h>
+#include <Utils/CloudLightingUtils.h>
+
+#include <vector>
+
+namespace Muon
+{
+
+class SunShadowVolume
+{
+public:
+    // The volume matches the density grid's resolution and layout, so Raymarch.cs samples both with WorldToNvdfUV().
+    bool Init(ID3D12Device* pDevice, const CloudDensityGrid* pDensityGrid);
+    void Destroy();
+
+    // Call once per frame with the world space direction toward the sun.
+    // Starts a new sweep once the sun has moved past the tolerance, then bakes up to sliceBudget slices of it.
+    // The very first bake covers every slice so the volume is never sampled empty.
+    void Update(const DirectX::XMFLOAT3& sunDirWS, uint32_t sliceBudget);
+
+    // Records the copy of every slice baked since the last call.
+    // The texture is left in NON_PIXEL_SHADER_RESOURCE.
+    void RecordUpload(ID3D12GraphicsCommandList* pCommandList);
+
+    bool IsValid() const { return mHasBaked; }
+    const Texture& GetTexture() const { return mTexture; }
+
+private:
+    const CloudDensityGrid* mpDensityGrid = nullptr;
+
+    Texture mTexture;
+    UploadBuffer mStagingBuffer;
+    D3D12_RESOURCE_STATES mTextureState = D3D12_RESOURCE_STATE_COPY_DEST;
+
+    std::vector<float> mOpticalDepth;
+
+    DirectX::XMFLOAT3 mSweepSunDir = DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f); // Sun the slices are currently being baked against
+    uint32_t mNextSlice = 0;
+    bool mSweepActive = false;
+    bool mHasBaked = false;
+
+    // Slices baked but not yet copied to the texture
+    uint32_t mDirtyBegin = 0;
+    uint32_t mDirtyEnd = 0;
+};
+
+}
+
+#endif
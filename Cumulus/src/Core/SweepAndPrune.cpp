@@ -0,0 +1,298 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of SweepAndPrune.h
+----------------------------------------------*/
+#include <Core/SweepAndPrune.h>
+
+#include <Utils/Utils.h>
+
+#include <algorithm>
+
+namespace Muon
+{
+namespace
+{
+    uint32_t Owner(uint32_t data) { return data >> 1; }
+    bool IsMax(uint32_t data) { return (data & 1) != 0; }
+
+    // Mins sort ahead of maxes at the same value, so boxes that only touch still count as overlapping
+    bool Before(float valueA, uint32_t dataA, float valueB, uint32_t dataB)
+    {
+        return valueA < valueB || (valueA == valueB && !IsMax(dataA) && IsMax(dataB));
+    }
+
+    float GetAxis(const DirectX::XMFLOAT3A& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    bool Overlaps(const AABB& a, const AABB& b)
+    {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x
+            && a.min.y <= b.max.y && b.min.y <= a.max.y
+            && a.min.z <= b.max.z && b.min.z <= a.max.z;
+    }
+
+    uint64_t GetPairKey(uint32_t a, uint32_t b)
+    {
+        return a < b ? ((uint64_t)a << 32 | b) : ((uint64_t)b << 32 | a);
+    }
+}
+
+uint32_t SweepAndPrune::AllocateObject(const AABB& bounds, uint32_t layer, uint32_t mask)
+{
+    uint32_t handle;
+    if (!mFreeHandles.empty())
+    {
+        handle = mFreeHandles.back();
+        mFreeHandles.pop_back();
+    }
+    else
+    {
+        handle = (uint32_t)mObjects.size();
+        mObjects.emplace_back();
+    }
+
+    Object& object = mObjects[handle];
+    object.bounds = bounds;
+    object.layer = layer;
+    object.mask = mask;
+    object.alive = true;
+    return handle;
+}
+
+uint32_t SweepAndPrune::AddObject(const AABB& bounds, uint32_t layer, uint32_t mask)
+{
+    uint32_t handle = AllocateObject(bounds, layer, mask);
+    Object& object = mObjects[handle];
+
+    // Appended at the end, then sorted into place like any other move. The min goes first so it sweeps
+    // past the maxes of every box it lands inside, and the max only ever passes boxes that start after it.
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        std::vector<Endpoint>& endpoints = mEndpoints[axis];
+
+        object.minIndex[axis] = (uint32_t)endpoints.size();
+        endpoints.push_back({ GetAxis(bounds.min, axis), handle << 1 });
+        SortEndpoint(axis, object.minIndex[axis]);
+
+        object.maxIndex[axis] = (uint32_t)endpoints.size();
+        endpoints.push_back({ GetAxis(bounds.max, axis), handle << 1 | 1 });
+        SortEndpoint(axis, object.maxIndex[axis]);
+    }
+
+    return handle;
+}
+
+void SweepAndPrune::AddObjects(const AABB* bounds, uint32_t count, uint32_t* out_handles, uint32_t layer, uint32_t mask)
+{
+    for (uint32_t i = 0; i < count; ++i)
+    {
+        uint32_t handle = AllocateObject(bounds[i], layer, mask);
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            mEndpoints[axis].push_back({ GetAxis(bounds[i].min, axis), handle << 1 });
+            mEndpoints[axis].push_back({ GetAxis(bounds[i].max, axis), handle << 1 | 1 });
+        }
+        out_handles[i] = handle;
+    }
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        std::vector<Endpoint>& endpoints = mEndpoints[axis];
+        std::sort(endpoints.begin(), endpoints.end(), [](const Endpoint& a, const Endpoint& b) { return Before(a.value, a.data, b.value, b.data); });
+
+        for (uint32_t i = 0; i < endpoints.size(); ++i)
+        {
+            Object& owner = mObjects[Owner(endpoints[i].data)];
+            (IsMax(endpoints[i].data) ? owner.maxIndex : owner.minIndex)[axis] = i;
+        }
+    }
+
+    // Sweep x with the boxes it is currently inside of, every box that opens is tested against those
+    mPairs.clear();
+    mPairIndices.clear();
+
+    std::vector<uint32_t> open;
+    std::vector<uint32_t> openIndex(mObjects.size());
+    for (const Endpoint& endpoint : mEndpoints[0])
+    {
+        uint32_t handle = Owner(endpoint.data);
+        if (IsMax(endpoint.data))
+        {
+            uint32_t index = openIndex[handle];
+            open[index] = open.back();
+            openIndex[open[index]] = index;
+            open.pop_back();
+            continue;
+        }
+
+        for (uint32_t other : open)
+            AddPairIfOverlapping(handle, other);
+
+        openIndex[handle] = (uint32_t)open.size();
+        open.push_back(handle);
+    }
+}
+
+void SweepAndPrune::RemoveObject(uint32_t handle)
+{
+    if (handle >= mObjects.size() || !mObjects[handle].alive)
+    {
+        Printf(L"Error: Removing unknown broadphase object %u!\n", handle);
+        return;
+    }
+
+    // Removal is rare, so the endpoint arrays are just compacted
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        std::vector<Endpoint>& endpoints = mEndpoints[axis];
+
+        uint32_t write = 0;
+        for (uint32_t read = 0; read < endpoints.size(); ++read)
+        {
+            const Endpoint& endpoint = endpoints[read];
+            if (Owner(endpoint.data) == handle)
+                continue;
+
+            Object& owner = mObjects[Owner(endpoint.data)];
+            (IsMax(endpoint.data) ? owner.maxIndex : owner.minIndex)[axis] = write;
+            endpoints[write++] = endpoint;
+        }
+        endpoints.resize(write);
+    }
+
+    for (uint32_t i = 0; i < mPairs.size();)
+    {
+        if (mPairs[i].objectA == handle || mPairs[i].objectB == handle)
+            RemovePair(mPairs[i].objectA, mPairs[i].objectB);
+        else
+            ++i;
+    }
+
+    mObjects[handle].alive = false;
+    mFreeHandles.push_back(handle);
+}
+
+void SweepAndPrune::UpdateObject(uint32_t handle, const AABB& bounds)
+{
+    if (handle >= mObjects.size() || !mObjects[handle].alive)
+    {
+        Printf(L"Error: Updating unknown broadphase object %u!\n", handle);
+        return;
+    }
+
+    Object& object = mObjects[handle];
+    object.bounds = bounds;
+
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        std::vector<Endpoint>& endpoints = mEndpoints[axis];
+        Endpoint& minEndpoint = endpoints[object.minIndex[axis]];
+        Endpoint& maxEndpoint = endpoints[object.maxIndex[axis]];
+
+        // The leading endpoint moves first, so the other never has to get past it
+        bool growing = GetAxis(bounds.max, axis) > maxEndpoint.value;
+        minEndpoint.value = GetAxis(bounds.min, axis);
+        maxEndpoint.value = GetAxis(bounds.max, axis);
+
+        if (growing)
+        {
+            SortEndpoint(axis, object.maxIndex[axis]);
+            SortEndpoint(axis, object.minIndex[axis]);
+        }
+        else
+        {
+            SortEndpoint(axis, object.minIndex[axis]);
+            SortEndpoint(axis, object.maxIndex[axis]);
+        }
+    }
+}
+
+void SweepAndPrune::SortEndpoint(int axis, uint32_t index)
+{
+    std::vector<Endpoint>& endpoints = mEndpoints[axis];
+    const Endpoint moving = endpoints[index];
+    const uint32_t owner = Owner(moving.data);
+
+    auto Place = [&](const Endpoint& endpoint, uint32_t at)
+    {
+        endpoints[at] = endpoint;
+        Object& object = mObjects[Owner(endpoint.data)];
+        (IsMax(endpoint.data) ? object.maxIndex : object.minIndex)[axis] = at;
+    };
+
+    // Left: a min passing a max starts an overlap on this axis, a max passing a min ends one
+    while (index > 0 && Before(moving.value, moving.data, endpoints[index - 1].value, endpoints[index - 1].data))
+    {
+        const Endpoint other = endpoints[index - 1];
+        if (Owner(other.data) != owner && IsMax(moving.data) != IsMax(other.data))
+        {
+            if (IsMax(other.data))
+                AddPairIfOverlapping(owner, Owner(other.data));
+            else if (CanPair(mObjects[owner], mObjects[Owner(other.data)]))
+                RemovePair(owner, Owner(other.data));
+        }
+
+        Place(other, index);
+        --index;
+    }
+
+    // Right: the same swaps the other way around
+    while (index + 1 < endpoints.size() && Before(endpoints[index + 1].value, endpoints[index + 1].data, moving.value, moving.data))
+    {
+        const Endpoint other = endpoints[index + 1];
+        if (Owner(other.data) != owner && IsMax(moving.data) != IsMax(other.data))
+        {
+            if (IsMax(moving.data))
+                AddPairIfOverlapping(owner, Owner(other.data));
+            else if (CanPair(mObjects[owner], mObjects[Owner(other.data)]))
+                RemovePair(owner, Owner(other.data));
+        }
+
+        Place(other, index);
+        ++index;
+    }
+
+    Place(moving, index);
+}
+
+void SweepAndPrune::AddPairIfOverlapping(uint32_t a, uint32_t b)
+{
+    const Object& objectA = mObjects[a];
+    const Object& objectB = mObjects[b];
+    if (!CanPair(objectA, objectB))
+        return;
+
+    // Only this axis is known to overlap, the others are checked against the boxes
+    if (!Overlaps(objectA.bounds, objectB.bounds))
+        return;
+
+    uint64_t key = GetPairKey(a, b);
+    if (mPairIndices.find(key) != mPairIndices.end())
+        return;
+
+    mPairIndices.emplace(key, (uint32_t)mPairs.size());
+    mPairs.push_back({ a < b ? a : b, a < b ? b : a });
+}
+
+void SweepAndPrune::RemovePair(uint32_t a, uint32_t b)
+{
+    auto it = mPairIndices.find(GetPairKey(a, b));
+    if (it == mPairIndices.end())
+        return;
+
+    // Swap with the last so removal stays constant time
+    uint32_t index = it->second;
+    mPairIndices.erase(it);
+
+    if (index + 1 != mPairs.size())
+    {
+        mPairs[index] = mPairs.back();
+        mPairIndices[GetPairKey(mPairs[index].objectA, mPairs[index].objectB)] = index;
+    }
+    mPairs.pop_back();
+}
+
+}
@@ -0,0 +1,79 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Incremental sweep and prune broadphase over object boxes.
+Each axis keeps every box's min and max in one sorted endpoint array. A box
+that moves only insertion sorts its own six endpoints, and every swap of a
+min past a max is exactly where two boxes start or stop overlapping on that
+axis, so the overlapping pairs are kept up to date as the endpoints swap.
+Between frames most objects barely move, so an update costs about one swap.
+----------------------------------------------*/
+#ifndef MUON_SWEEPANDPRUNE_H
+#define MUON_SWEEPANDPRUNE_H
+
+#include <Core/CommonTypes.h>
+#include <Core/ConvexQuery.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace Muon
+{
+
+static const uint32_t BROADPHASE_INVALID = UINT32_MAX;
+
+class SweepAndPrune
+{
+public:
+    // Returns the object's handle. Handles are dense from 0 and reused once removed, so they can index the
+    // ConvexObjects the pairs are queried against. Two objects pair up if each one's layer is in the other's mask.
+    uint32_t AddObject(const AABB& bounds, uint32_t layer = 1, uint32_t mask = UINT32_MAX);
+
+    // For loading a scene. Sorts all the endpoints and sweeps for the pairs once, instead of moving each box in from the end.
+    void AddObjects(const AABB* bounds, uint32_t count, uint32_t* out_handles, uint32_t layer = 1, uint32_t mask = UINT32_MAX);
+    void RemoveObject(uint32_t handle);
+
+    // Cost grows with how far the box moved through its neighbors, not with the object count
+    void UpdateObject(uint32_t handle, const AABB& bounds);
+
+    // Boxes overlapping right now, objectA < objectB. Feed them to QueryConvexPairs.
+    const std::vector<ConvexQueryPair>& GetPairs() const { return mPairs; }
+
+    uint32_t GetObjectCount() const { return (uint32_t)(mObjects.size() - mFreeHandles.size()); }
+
+private:
+    // Packed as the owning handle, shifted up, with the low bit set for max endpoints
+    struct Endpoint
+    {
+        float value;
+        uint32_t data;
+    };
+
+    struct Object
+    {
+        AABB bounds;
+        uint32_t minIndex[3];   // Where its endpoints sit in mEndpoints
+        uint32_t maxIndex[3];
+        uint32_t layer;
+        uint32_t mask;
+        bool alive;
+    };
+
+    uint32_t AllocateObject(const AABB& bounds, uint32_t layer, uint32_t mask);
+    void SortEndpoint(int axis, uint32_t index);
+    bool CanPair(const Object& a, const Object& b) const { return (a.layer & b.mask) != 0 && (b.layer & a.mask) != 0; }
+    void AddPairIfOverlapping(uint32_t a, uint32_t b);
+    void RemovePair(uint32_t a, uint32_t b);
+
+    std::vector<Endpoint> mEndpoints[3];
+    std::vector<Object> mObjects;
+    std::vector<uint32_t> mFreeHandles;
+
+    std::vector<ConvexQueryPair> mPairs;
+    std::unordered_map<uint64_t, uint32_t> mPairIndices; // Pair key to its place in mPairs
+};
+
+}
+
+#endif
@@ -12,13 +12,14 @@ namespace Muon
 
 bool Texture::Create(const wchar_t* name, ID3D12Device* pDevice, UINT width, UINT height, UINT depth,
     DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState,
-    D3D12_CLEAR_VALUE* pClearValue)
+    D3D12_CLEAR_VALUE* pClearValue, UINT16 mipLevels)
 {
     mName = name;
     mWidth = width;
     mHeight = height;
     mDepth = depth;
     mFormat = format;
+    mMipLevels = mipLevels;
 
     bool is3D = depth > 1;
 
@@ -28,7 +29,7 @@ bool Texture::Create(const wchar_t* name, ID3D12Device* pDevice, UINT width, UIN
     desc.Width = width;
     desc.Height = height;
     desc.DepthOrArraySize = depth;
-    desc.MipLevels = 1;
+    desc.MipLevels = mipLevels;
     desc.Format = format;
     desc.SampleDesc.Count = 1;
     desc.SampleDesc.Quality = 0;
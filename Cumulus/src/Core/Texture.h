@@ -33,7 +33,7 @@ class Texture
 public:
     bool Create(const wchar_t* name, ID3D12Device* pDevice, UINT width, UINT height, UINT depth,
         DXGI_FORMAT format, D3D12_RESOURCE_FLAGS flags, D3D12_RESOURCE_STATES initialState,
-        D3D12_CLEAR_VALUE* pClearValue = nullptr);
+        D3D12_CLEAR_VALUE* pClearValue = nullptr, UINT16 mipLevels = 1);
 
     bool InitSRV(ID3D12Device* pDevice, DescriptorHeap* pSRVHeap);
     bool InitUAV(ID3D12Device* pDevice, DescriptorHeap* pSRVHeap);
@@ -54,6 +54,7 @@ public:
     UINT GetWidth() const { return mWidth; }
     UINT GetHeight() const { return mHeight; }
     UINT GetDepth() const { return mDepth; }
+    UINT16 GetMipLevels() const { return mMipLevels; }
 
     DXGI_FORMAT GetFormat() const { return mFormat; }
 
@@ -70,6 +71,7 @@ private:
     UINT mWidth = 0;
     UINT mHeight = 0;
     UINT mDepth = 0;
+    UINT16 mMipLevels = 1;
     DXGI_FORMAT mFormat = DXGI_FORMAT_UNKNOWN;
 
     Microsoft::WRL::ComPtr<ID3D12Resource> mpResource;
@@ -0,0 +1,108 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CloudBudgetUtils.h
+----------------------------------------------*/
+#include <Utils/CloudBudgetUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    float Luminance(const DirectX::XMFLOAT4& texel)
+    {
+        return 0.2126f * texel.x + 0.7152f * texel.y + 0.0722f * texel.z;
+    }
+
+    // Relative step count of a tile at lambda, the inverse of its step size multiplier
+    float GetTileStepFraction(float importance, float log2Lambda)
+    {
+        float fraction = exp2f(log2Lambda) * importance;
+        return std::clamp(fraction, 1.0f / CLOUD_BUDGET_MAX_STEP_SCALE, 1.0f / CLOUD_BUDGET_MIN_STEP_SCALE);
+    }
+}
+
+uint32_t GetBudgetTileCount(uint32_t marchSize)
+{
+    return (marchSize + CLOUD_BUDGET_TILE_SIZE - 1) / CLOUD_BUDGET_TILE_SIZE;
+}
+
+CloudTileStats MeasureCloudTile(const DirectX::XMFLOAT4* texels, uint32_t texelCount, uint32_t steps, float stepScale, const CloudTileStats* previous)
+{
+    CloudTileStats stats;
+    if (texelCount == 0)
+        return stats;
+
+    float sumLuminance = 0.0f, sumLuminanceSq = 0.0f;
+    float sumTransmittance = 0.0f, sumTransmittanceSq = 0.0f;
+    for (uint32_t i = 0; i < texelCount; ++i)
+    {
+        float luminance = Luminance(texels[i]);
+        sumLuminance += luminance;
+        sumLuminanceSq += luminance * luminance;
+        sumTransmittance += texels[i].w;
+        sumTransmittanceSq += texels[i].w * texels[i].w;
+    }
+
+    float invCount = 1.0f / (float)texelCount;
+    stats.meanLuminance = sumLuminance * invCount;
+    stats.meanTransmittance = sumTransmittance * invCount;
+
+    // Spread within the tile is mostly step noise, which shrinks with the step size
+    float luminanceDeviation = sqrtf(std::max(sumLuminanceSq * invCount - stats.meanLuminance * stats.meanLuminance, 0.0f));
+    float transmittanceDeviation = sqrtf(std::max(sumTransmittanceSq * invCount - stats.meanTransmittance * stats.meanTransmittance, 0.0f));
+    float importance = luminanceDeviation + transmittanceDeviation;
+
+    // Tiles that changed since last frame haven't converged yet
+    if (previous)
+    {
+        importance += fabsf(stats.meanLuminance - previous->meanLuminance) + fabsf(stats.meanTransmittance - previous->meanTransmittance);
+        importance = previous->importance + (importance - previous->importance) * CLOUD_BUDGET_RESPONSE;
+    }
+
+    stats.importance = std::max(importance, CLOUD_BUDGET_IMPORTANCE_FLOOR);
+
+    // Step count goes roughly as the inverse of the step size
+    stats.baseSteps = (float)steps * stepScale;
+    return stats;
+}
+
+float SolveCloudTileBudget(const std::vector<CloudTileStats>& tiles, std::vector<float>& out_stepScale)
+{
+    out_stepScale.assign(tiles.size(), 1.0f);
+
+    float budget = 0.0f;
+    for (const CloudTileStats& tile : tiles)
+        budget += tile.baseSteps;
+
+    if (budget <= 0.0f)
+        return 1.0f;
+
+    // Spent steps only grow with lambda, so bisect it in log space
+    float log2Low = -32.0f;
+    float log2High = 32.0f;
+    for (uint32_t iteration = 0; iteration < CLOUD_BUDGET_SOLVER_ITERATIONS; ++iteration)
+    {
+        float log2Mid = 0.5f * (log2Low + log2High);
+
+        float spent = 0.0f;
+        for (const CloudTileStats& tile : tiles)
+            spent += tile.baseSteps * GetTileStepFraction(tile.importance, log2Mid);
+
+        if (spent > budget)
+            log2High = log2Mid;
+        else
+            log2Low = log2Mid;
+    }
+
+    float log2Lambda = 0.5f * (log2Low + log2High);
+    for (size_t i = 0; i < tiles.size(); ++i)
+        out_stepScale[i] = 1.0f / GetTileStepFraction(tiles[i].importance, log2Lambda);
+
+    return exp2f(log2Lambda);
+}
+
+}
@@ -0,0 +1,56 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Per-tile adaptive step budget for the cloud raymarch.
+Each frame measures how noisy and how unsettled every tile of march texels
+is, then hands out step size multipliers so busy tiles take smaller steps
+and quiet ones larger, keeping the frame's total step count where a uniform
+step size would have put it.
+CPU model of CloudTileStats.cs and CloudTileBudget.cs
+----------------------------------------------*/
+#ifndef MUON_CLOUDBUDGETUTILS_H
+#define MUON_CLOUDBUDGETUTILS_H
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Side of a budget tile, in march texels
+    static const uint32_t CLOUD_BUDGET_TILE_SIZE = 8;
+
+    // Range of the per-tile multiplier on the step size
+    static const float CLOUD_BUDGET_MIN_STEP_SCALE = 0.5f;
+    static const float CLOUD_BUDGET_MAX_STEP_SCALE = 3.0f;
+
+    // Importance every tile has even when flat, so empty tiles still get a share
+    static const float CLOUD_BUDGET_IMPORTANCE_FLOOR = 1e-3f;
+
+    // Fraction of this frame's measurement blended into the running importance. Keeps the allocation from flickering.
+    static const float CLOUD_BUDGET_RESPONSE = 0.25f;
+
+    static const uint32_t CLOUD_BUDGET_SOLVER_ITERATIONS = 32;
+
+    // Matches the layout of the CloudTileStats texture
+    struct CloudTileStats
+    {
+        float meanLuminance = 0.0f;
+        float meanTransmittance = 1.0f;
+        float importance = CLOUD_BUDGET_IMPORTANCE_FLOOR;
+        float baseSteps = 0.0f; // Steps the tile would have taken at a multiplier of 1
+    };
+
+    uint32_t GetBudgetTileCount(uint32_t marchSize);
+
+    // Measures one tile from its march texels ([radiance.rgb, transmittance]), the steps its rays took and the multiplier they took them at.
+    // previous is last frame's stats for the tile, or null when there are none. Mirrors CloudTileStats.cs.
+    CloudTileStats MeasureCloudTile(const DirectX::XMFLOAT4* texels, uint32_t texelCount, uint32_t steps, float stepScale, const CloudTileStats* previous);
+
+    // Step size multiplier for every tile such that sum(baseSteps / multiplier) == sum(baseSteps), as far as the multiplier range allows.
+    // Multipliers go as 1 / (lambda * importance); returns lambda. Mirrors CloudTileBudget.cs.
+    float SolveCloudTileBudget(const std::vector<CloudTileStats>& tiles, std::vector<float>& out_stepScale);
+}
+
+#endif
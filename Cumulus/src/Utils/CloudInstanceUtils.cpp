@@ -0,0 +1,243 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CloudInstanceUtils.h
+----------------------------------------------*/
+#include <Utils/CloudInstanceUtils.h>
+
+#include <Utils/CloudLightingUtils.h>
+#include <Utils/RayIntervalUtils.h>
+#include <Utils/Utils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    static const uint32_t CLOUD_BVH_STACK_SIZE = 32;
+
+    DirectX::XMFLOAT3 GetVolumeMin()
+    {
+        return DirectX::XMFLOAT3(-CLOUD_VOLUME_SIDE_LENGTH * 0.5f, 0.0f, -CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+    }
+
+    DirectX::XMFLOAT3 GetVolumeMax()
+    {
+        return DirectX::XMFLOAT3(CLOUD_VOLUME_SIDE_LENGTH * 0.5f, CLOUD_VOLUME_HEIGHT, CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+    }
+
+    float GetAxis(const DirectX::XMFLOAT3& v, int axis)
+    {
+        return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+    }
+
+    DirectX::XMFLOAT3 TransformRow(const DirectX::XMFLOAT4 rows[3], const DirectX::XMFLOAT3& v, float w)
+    {
+        return DirectX::XMFLOAT3(
+            rows[0].x * v.x + rows[0].y * v.y + rows[0].z * v.z + rows[0].w * w,
+            rows[1].x * v.x + rows[1].y * v.y + rows[1].z * v.z + rows[1].w * w,
+            rows[2].x * v.x + rows[2].y * v.y + rows[2].z * v.z + rows[2].w * w);
+    }
+
+    struct BuildItem
+    {
+        uint32_t instance;
+        DirectX::XMFLOAT3 minBounds;
+        DirectX::XMFLOAT3 maxBounds;
+        DirectX::XMFLOAT3 center;
+    };
+
+    void BuildNode(std::vector<BuildItem>& items, uint32_t begin, uint32_t end, uint32_t nodeIdx, CloudInstanceBVH& bvh)
+    {
+        CloudBVHNode& node = bvh.nodes[nodeIdx];
+        node.minBounds = items[begin].minBounds;
+        node.maxBounds = items[begin].maxBounds;
+        DirectX::XMFLOAT3 centerMin = items[begin].center;
+        DirectX::XMFLOAT3 centerMax = items[begin].center;
+        for (uint32_t i = begin + 1; i < end; ++i)
+        {
+            const BuildItem& item = items[i];
+            node.minBounds = DirectX::XMFLOAT3(std::min(node.minBounds.x, item.minBounds.x), std::min(node.minBounds.y, item.minBounds.y), std::min(node.minBounds.z, item.minBounds.z));
+            node.maxBounds = DirectX::XMFLOAT3(std::max(node.maxBounds.x, item.maxBounds.x), std::max(node.maxBounds.y, item.maxBounds.y), std::max(node.maxBounds.z, item.maxBounds.z));
+            centerMin = DirectX::XMFLOAT3(std::min(centerMin.x, item.center.x), std::min(centerMin.y, item.center.y), std::min(centerMin.z, item.center.z));
+            centerMax = DirectX::XMFLOAT3(std::max(centerMax.x, item.center.x), std::max(centerMax.y, item.center.y), std::max(centerMax.z, item.center.z));
+        }
+
+        if (end - begin <= CLOUD_BVH_LEAF_SIZE)
+        {
+            node.firstOrChild = begin;
+            node.count = end - begin;
+            return;
+        }
+
+        int axis = 0;
+        DirectX::XMFLOAT3 extent(centerMax.x - centerMin.x, centerMax.y - centerMin.y, centerMax.z - centerMin.z);
+        if (extent.y > GetAxis(extent, axis))
+            axis = 1;
+        if (extent.z > GetAxis(extent, axis))
+            axis = 2;
+
+        uint32_t mid = begin + (end - begin) / 2;
+        std::nth_element(items.begin() + begin, items.begin() + mid, items.begin() + end,
+            [axis](const BuildItem& a, const BuildItem& b) { return GetAxis(a.center, axis) < GetAxis(b.center, axis); });
+
+        uint32_t leftIdx = (uint32_t)bvh.nodes.size();
+        bvh.nodes.resize(bvh.nodes.size() + 2);
+
+        // Resizing may have moved the node
+        bvh.nodes[nodeIdx].firstOrChild = leftIdx;
+        bvh.nodes[nodeIdx].count = 0;
+
+        BuildNode(items, begin, mid, leftIdx, bvh);
+        BuildNode(items, mid, end, leftIdx + 1, bvh);
+    }
+}
+
+void GetCloudInstanceToLocal(const CloudInstance& instance, DirectX::XMFLOAT4 out_rows[3])
+{
+    // world = position + R(yaw) * scale * local, so local = R^T * (world - position) / scale
+    float invScale = 1.0f / std::max(instance.scale, 1e-6f);
+    float c = cosf(instance.yaw) * invScale;
+    float s = sinf(instance.yaw) * invScale;
+
+    const DirectX::XMFLOAT3& p = instance.position;
+    out_rows[0] = DirectX::XMFLOAT4(c, 0.0f, -s, -(c * p.x - s * p.z));
+    out_rows[1] = DirectX::XMFLOAT4(0.0f, invScale, 0.0f, -invScale * p.y);
+    out_rows[2] = DirectX::XMFLOAT4(s, 0.0f, c, -(s * p.x + c * p.z));
+}
+
+void GetCloudInstanceBounds(const CloudInstance& instance, DirectX::XMFLOAT3& out_min, DirectX::XMFLOAT3& out_max)
+{
+    const DirectX::XMFLOAT3 volumeMin = GetVolumeMin();
+    const DirectX::XMFLOAT3 volumeMax = GetVolumeMax();
+
+    float c = cosf(instance.yaw) * instance.scale;
+    float s = sinf(instance.yaw) * instance.scale;
+
+    out_min = DirectX::XMFLOAT3(INFINITY, INFINITY, INFINITY);
+    out_max = DirectX::XMFLOAT3(-INFINITY, -INFINITY, -INFINITY);
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        DirectX::XMFLOAT3 local(
+            (i & 1) ? volumeMax.x : volumeMin.x,
+            (i & 2) ? volumeMax.y : volumeMin.y,
+            (i & 4) ? volumeMax.z : volumeMin.z);
+
+        DirectX::XMFLOAT3 world(
+            instance.position.x + c * local.x + s * local.z,
+            instance.position.y + instance.scale * local.y,
+            instance.position.z - s * local.x + c * local.z);
+
+        out_min = DirectX::XMFLOAT3(std::min(out_min.x, world.x), std::min(out_min.y, world.y), std::min(out_min.z, world.z));
+        out_max = DirectX::XMFLOAT3(std::max(out_max.x, world.x), std::max(out_max.y, world.y), std::max(out_max.z, world.z));
+    }
+}
+
+bool BuildCloudInstanceBVH(const std::vector<CloudInstance>& instances, CloudInstanceBVH& out_bvh)
+{
+    out_bvh.nodes.clear();
+    out_bvh.instanceOrder.clear();
+
+    if (instances.size() > MAX_CLOUD_INSTANCES)
+    {
+        Printf(L"Error: %zu cloud instances is more than the %u the raymarch supports!\n", instances.size(), MAX_CLOUD_INSTANCES);
+        return false;
+    }
+
+    if (instances.empty())
+        return true;
+
+    std::vector<BuildItem> items(instances.size());
+    for (uint32_t i = 0; i < (uint32_t)instances.size(); ++i)
+    {
+        BuildItem& item = items[i];
+        item.instance = i;
+        GetCloudInstanceBounds(instances[i], item.minBounds, item.maxBounds);
+        item.center = DirectX::XMFLOAT3(
+            0.5f * (item.minBounds.x + item.maxBounds.x),
+            0.5f * (item.minBounds.y + item.maxBounds.y),
+            0.5f * (item.minBounds.z + item.maxBounds.z));
+    }
+
+    out_bvh.nodes.reserve(2 * instances.size() - 1);
+    out_bvh.nodes.resize(1);
+    BuildNode(items, 0, (uint32_t)items.size(), 0, out_bvh);
+
+    out_bvh.instanceOrder.resize(items.size());
+    for (size_t i = 0; i < items.size(); ++i)
+        out_bvh.instanceOrder[i] = items[i].instance;
+
+    return true;
+}
+
+uint32_t CollectCloudRayHits(const CloudInstanceBVH& bvh, const std::vector<CloudInstance>& instances,
+                             const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, float tMin, float tMax,
+                             CloudRayHit out_hits[MAX_RAY_CLOUD_INSTANCES])
+{
+    if (bvh.nodes.empty())
+        return 0;
+
+    const DirectX::XMFLOAT3 volumeMin = GetVolumeMin();
+    const DirectX::XMFLOAT3 volumeMax = GetVolumeMax();
+
+    uint32_t hitCount = 0;
+    uint32_t stack[CLOUD_BVH_STACK_SIZE];
+    uint32_t stackSize = 0;
+    stack[stackSize++] = 0;
+
+    while (stackSize > 0)
+    {
+        const CloudBVHNode& node = bvh.nodes[stack[--stackSize]];
+
+        float tEnter, tExit;
+        if (!RayBoxIntersect(origin, dir, node.minBounds, node.maxBounds, tEnter, tExit) || tEnter > tMax || tExit < tMin)
+            continue;
+
+        if (node.count == 0)
+        {
+            if (stackSize + 2 <= CLOUD_BVH_STACK_SIZE)
+            {
+                stack[stackSize++] = node.firstOrChild + 1;
+                stack[stackSize++] = node.firstOrChild;
+            }
+            continue;
+        }
+
+        for (uint32_t slot = node.firstOrChild; slot < node.firstOrChild + node.count; ++slot)
+        {
+            // Similarity transform, so the unnormalized local ray keeps world distances as its parameter
+            DirectX::XMFLOAT4 rows[3];
+            GetCloudInstanceToLocal(instances[bvh.instanceOrder[slot]], rows);
+            DirectX::XMFLOAT3 localOrigin = TransformRow(rows, origin, 1.0f);
+            DirectX::XMFLOAT3 localDir = TransformRow(rows, dir, 0.0f);
+
+            if (!RayBoxIntersect(localOrigin, localDir, volumeMin, volumeMax, tEnter, tExit))
+                continue;
+
+            tEnter = std::max(tEnter, tMin);
+            tExit = std::min(tExit, tMax);
+            if (tExit <= tEnter)
+                continue;
+
+            // Insert by entry, dropping the furthest once full
+            uint32_t insertAt = hitCount;
+            while (insertAt > 0 && out_hits[insertAt - 1].tEnter > tEnter)
+                --insertAt;
+
+            if (insertAt >= MAX_RAY_CLOUD_INSTANCES)
+                continue;
+
+            for (uint32_t i = std::min(hitCount, MAX_RAY_CLOUD_INSTANCES - 1); i > insertAt; --i)
+                out_hits[i] = out_hits[i - 1];
+
+            out_hits[insertAt] = { bvh.instanceOrder[slot], tEnter, tExit };
+            hitCount = std::min(hitCount + 1, MAX_RAY_CLOUD_INSTANCES);
+        }
+    }
+
+    return hitCount;
+}
+
+}
@@ -0,0 +1,78 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Placed cloud instances and the BVH the raymarch walks to find
+the ones a ray overlaps. Each instance places an NVDF volume (the 4 km box
+the single cloud used to fill) in the world with a position, yaw and uniform
+scale, and multiplies its density.
+CPU mirror of the traversal in CloudInstances.hlsli
+----------------------------------------------*/
+#ifndef MUON_CLOUDINSTANCEUTILS_H
+#define MUON_CLOUDINSTANCEUTILS_H
+
+#include <Core/CommonTypes.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Sized to fit the CloudInstances cbuffer
+    static const uint32_t MAX_CLOUD_INSTANCES = 256;
+    static const uint32_t MAX_CLOUD_BVH_NODES = 2 * MAX_CLOUD_INSTANCES - 1;
+    static const uint32_t CLOUD_BVH_LEAF_SIZE = 2;
+
+    // Nearest instances a single ray marches through, further overlaps are dropped
+    static const uint32_t MAX_RAY_CLOUD_INSTANCES = 8;
+
+    struct CloudInstance
+    {
+        DirectX::XMFLOAT3 position = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f); // World position of the NVDF volume's origin
+        float yaw = 0.0f;          // Radians about world y
+        float scale = 1.0f;        // World units per NVDF volume unit
+        float densityScale = 1.0f; // Multiplier on the NVDF's extinction
+        ResourceID nvdf = ResourceID_INVALID;
+    };
+
+    // Inner nodes: count == 0 and the children are firstOrChild and firstOrChild + 1.
+    // Leaves: instances [firstOrChild, firstOrChild + count) of the BVH's instance order.
+    struct CloudBVHNode
+    {
+        DirectX::XMFLOAT3 minBounds;
+        uint32_t firstOrChild;
+        DirectX::XMFLOAT3 maxBounds;
+        uint32_t count;
+    };
+
+    struct CloudInstanceBVH
+    {
+        std::vector<CloudBVHNode> nodes;
+        std::vector<uint32_t> instanceOrder; // Leaf slot -> index into the instance list
+    };
+
+    struct CloudRayHit
+    {
+        uint32_t instance; // Index into the instance list
+        float tEnter;
+        float tExit;
+    };
+
+    // Rows of the affine transform from world space into the instance's NVDF volume space
+    void GetCloudInstanceToLocal(const CloudInstance& instance, DirectX::XMFLOAT4 out_rows[3]);
+
+    // World space bounds of the instance's volume
+    void GetCloudInstanceBounds(const CloudInstance& instance, DirectX::XMFLOAT3& out_min, DirectX::XMFLOAT3& out_max);
+
+    // Median split on the longest axis of the instance centers. Fails past MAX_CLOUD_INSTANCES.
+    bool BuildCloudInstanceBVH(const std::vector<CloudInstance>& instances, CloudInstanceBVH& out_bvh);
+
+    // Instances the ray overlaps within [tMin, tMax], nearest entry first, at most MAX_RAY_CLOUD_INSTANCES.
+    // Mirrors CollectCloudRayHits() in CloudInstances.hlsli.
+    uint32_t CollectCloudRayHits(const CloudInstanceBVH& bvh, const std::vector<CloudInstance>& instances,
+                                 const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, float tMin, float tMax,
+                                 CloudRayHit out_hits[MAX_RAY_CLOUD_INSTANCES]);
+}
+
+#endif
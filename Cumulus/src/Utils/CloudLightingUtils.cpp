@@ -0,0 +1,431 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of CloudLightingUtils.h
+----------------------------------------------*/
+#include <Utils/CloudLightingUtils.h>
+
+#include <Utils/ParallelUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    static const float SDF_ENCODED_MIN = -256.0f;
+    static const float SDF_ENCODED_MAX = 4096.0f;
+
+    float DecodeNvdfSdf(const float* texel)
+    {
+        return SDF_ENCODED_MIN + (SDF_ENCODED_MAX - SDF_ENCODED_MIN) * texel[0];
+    }
+
+    float GetCellDiagonal(uint32_t width, uint32_t height, uint32_t depth)
+    {
+        float cellX = CLOUD_VOLUME_SIDE_LENGTH / (float)width;
+        float cellZ = CLOUD_VOLUME_SIDE_LENGTH / (float)height;
+        float cellY = CLOUD_VOLUME_HEIGHT / (float)depth;
+        return sqrtf(cellX * cellX + cellY * cellY + cellZ * cellZ);
+    }
+
+    // Mirrors GetUprezzedVoxelCloudDensity() with no erosion noise
+    float GetNvdfTexelExtinction(const float* texel)
+    {
+        float sdf = DecodeNvdfSdf(texel);
+        if (sdf >= 0.0f)
+            return 0.0f;
+
+        float profile = std::clamp(texel[1], 0.0f, 1.0f);
+        float densityScale = std::clamp(texel[3], 0.0f, 1.0f);
+        float poweredScale = densityScale * densityScale * densityScale * densityScale;
+
+        float density = powf(profile * poweredScale, 0.3f + 0.3f * std::max(poweredScale, 0.001f));
+        return density * CLOUD_DENSITY_SCALE;
+    }
+
+    void GetVolumeMinMax(DirectX::XMFLOAT3& out_min, DirectX::XMFLOAT3& out_max)
+    {
+        out_min = DirectX::XMFLOAT3(-CLOUD_VOLUME_SIDE_LENGTH * 0.5f, 0.0f, -CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+        out_max = DirectX::XMFLOAT3(CLOUD_VOLUME_SIDE_LENGTH * 0.5f, CLOUD_VOLUME_HEIGHT, CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+    }
+
+    // Distance along dir to where a ray starting inside the volume leaves it
+    float GetVolumeExitDistance(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir)
+    {
+        DirectX::XMFLOAT3 boxMin, boxMax;
+        GetVolumeMinMax(boxMin, boxMax);
+
+        const float o[3] = { origin.x, origin.y, origin.z };
+        const float d[3] = { dir.x, dir.y, dir.z };
+        const float lo[3] = { boxMin.x, boxMin.y, boxMin.z };
+        const float hi[3] = { boxMax.x, boxMax.y, boxMax.z };
+
+        float tExit = 1e30f;
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            if (fabsf(d[axis]) < 1e-8f)
+                continue;
+
+            float bound = d[axis] > 0.0f ? hi[axis] : lo[axis];
+            tExit = std::min(tExit, (bound - o[axis]) / d[axis]);
+        }
+        return std::max(tExit, 0.0f);
+    }
+
+    DirectX::XMFLOAT3 Cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return DirectX::XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    DirectX::XMFLOAT3 Normalize(const DirectX::XMFLOAT3& v)
+    {
+        float length = sqrtf(Dot(v, v));
+        return length > 0.0f ? DirectX::XMFLOAT3(v.x / length, v.y / length, v.z / length) : v;
+    }
+
+    // Half the grid's smallest texel keeps the march from skipping over features
+    float GetGridMarchStepSize(const CloudDensityGrid& grid)
+    {
+        float texelX = CLOUD_VOLUME_SIDE_LENGTH / (float)std::max(1u, grid.width);
+        float texelZ = CLOUD_VOLUME_SIDE_LENGTH / (float)std::max(1u, grid.height);
+        float texelY = CLOUD_VOLUME_HEIGHT / (float)std::max(1u, grid.depth);
+        return 0.5f * std::min(texelX, std::min(texelY, texelZ));
+    }
+}
+
+bool BuildCloudDensityGrid(const float* nvdfTexels, uint32_t width, uint32_t height, uint32_t depth, uint32_t divisor, CloudDensityGrid& out_grid)
+{
+    static const uint32_t CHANNELS_PER_VOXEL = 4;
+
+    if (!nvdfTexels || width == 0 || height == 0 || depth == 0 || divisor == 0)
+        return false;
+
+    out_grid.width = std::max(1u, width / divisor);
+    out_grid.height = std::max(1u, height / divisor);
+    out_grid.depth = std::max(1u, depth / divisor);
+    out_grid.extinction.assign((size_t)out_grid.width * out_grid.height * out_grid.depth, 0.0f);
+    out_grid.emptyDistance.assign(out_grid.extinction.size(), 0.0f);
+
+    // The SDF is 1-Lipschitz, so anywhere in a cell is at most a cell diagonal from the cell's smallest texel.
+    // Filtering blends texels up to one NVDF texel diagonal away, which may sit in the neighboring cell.
+    const float emptyMargin = GetCellDiagonal(out_grid.width, out_grid.height, out_grid.depth) + GetCellDiagonal(width, height, depth);
+
+    for (uint32_t z = 0; z < out_grid.depth; ++z)
+    {
+        uint32_t z0 = z * depth / out_grid.depth, z1 = std::max(z0 + 1, (z + 1) * depth / out_grid.depth);
+        for (uint32_t y = 0; y < out_grid.height; ++y)
+        {
+            uint32_t y0 = y * height / out_grid.height, y1 = std::max(y0 + 1, (y + 1) * height / out_grid.height);
+            for (uint32_t x = 0; x < out_grid.width; ++x)
+            {
+                uint32_t x0 = x * width / out_grid.width, x1 = std::max(x0 + 1, (x + 1) * width / out_grid.width);
+
+                float sum = 0.0f;
+                float minSdf = SDF_ENCODED_MAX;
+                for (uint32_t sz = z0; sz < z1; ++sz)
+                    for (uint32_t sy = y0; sy < y1; ++sy)
+                        for (uint32_t sx = x0; sx < x1; ++sx)
+                        {
+                            const float* texel = &nvdfTexels[(((size_t)sz * height + sy) * width + sx) * CHANNELS_PER_VOXEL];
+                            sum += GetNvdfTexelExtinction(texel);
+                            minSdf = std::min(minSdf, DecodeNvdfSdf(texel));
+                        }
+
+                size_t count = (size_t)(x1 - x0) * (y1 - y0) * (z1 - z0);
+                size_t cell = ((size_t)z * out_grid.height + y) * out_grid.width + x;
+                out_grid.extinction[cell] = sum / (float)count;
+                out_grid.emptyDistance[cell] = minSdf - emptyMargin;
+            }
+        }
+    }
+
+    return true;
+}
+
+float SampleCloudExtinction(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& positionWS)
+{
+    DirectX::XMFLOAT3 boxMin, boxMax;
+    GetVolumeMinMax(boxMin, boxMax);
+
+    if (grid.extinction.empty() ||
+        positionWS.x < boxMin.x || positionWS.y < boxMin.y || positionWS.z < boxMin.z ||
+        positionWS.x > boxMax.x || positionWS.y > boxMax.y || positionWS.z > boxMax.z)
+        return 0.0f;
+
+    // Same axis swizzle as WorldToNvdfUV(): world y stacks the slices
+    float u = (positionWS.x - boxMin.x) / (boxMax.x - boxMin.x);
+    float v = (positionWS.z - boxMin.z) / (boxMax.z - boxMin.z);
+    float w = (positionWS.y - boxMin.y) / (boxMax.y - boxMin.y);
+
+    auto Axis = [](float uvw, uint32_t size, uint32_t& out_i0, uint32_t& out_i1, float& out_frac)
+    {
+        float coord = std::clamp(uvw * (float)size - 0.5f, 0.0f, (float)(size - 1));
+        out_i0 = (uint32_t)coord;
+        out_i1 = std::min(out_i0 + 1, size - 1);
+        out_frac = coord - (float)out_i0;
+    };
+
+    uint32_t x0, x1, y0, y1, z0, z1;
+    float fx, fy, fz;
+    Axis(u, grid.width, x0, x1, fx);
+    Axis(v, grid.height, y0, y1, fy);
+    Axis(w, grid.depth, z0, z1, fz);
+
+    auto At = [&grid](uint32_t x, uint32_t y, uint32_t z)
+    {
+        return grid.extinction[((size_t)z * grid.height + y) * grid.width + x];
+    };
+
+    float c00 = At(x0, y0, z0) + (At(x1, y0, z0) - At(x0, y0, z0)) * fx;
+    float c10 = At(x0, y1, z0) + (At(x1, y1, z0) - At(x0, y1, z0)) * fx;
+    float c01 = At(x0, y0, z1) + (At(x1, y0, z1) - At(x0, y0, z1)) * fx;
+    float c11 = At(x0, y1, z1) + (At(x1, y1, z1) - At(x0, y1, z1)) * fx;
+
+    float c0 = c00 + (c10 - c00) * fy;
+    float c1 = c01 + (c11 - c01) * fy;
+    return c0 + (c1 - c0) * fz;
+}
+
+DirectX::XMFLOAT3 GetCloudVolumeTexelCenter(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint32_t height, uint32_t depth)
+{
+    DirectX::XMFLOAT3 boxMin, boxMax;
+    GetVolumeMinMax(boxMin, boxMax);
+
+    return DirectX::XMFLOAT3(
+        boxMin.x + (boxMax.x - boxMin.x) * ((float)x + 0.5f) / (float)width,
+        boxMin.y + (boxMax.y - boxMin.y) * ((float)z + 0.5f) / (float)depth,
+        boxMin.z + (boxMax.z - boxMin.z) * ((float)y + 0.5f) / (float)height);
+}
+
+float MarchSunOpticalDepth(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& positionWS, const DirectX::XMFLOAT3& sunDirWS, float stepSize)
+{
+    if (stepSize <= 0.0f)
+        return 0.0f;
+
+    float tExit = GetVolumeExitDistance(positionWS, sunDirWS);
+    if (tExit <= 0.0f)
+        return 0.0f;
+
+    // Midpoint rule with the step stretched to land exactly on the exit
+    uint32_t stepCount = std::max(1u, (uint32_t)ceilf(tExit / stepSize));
+    float ds = tExit / (float)stepCount;
+
+    float opticalDepth = 0.0f;
+    for (uint32_t i = 0; i < stepCount; ++i)
+    {
+        float t = ((float)i + 0.5f) * ds;
+        DirectX::XMFLOAT3 p(positionWS.x + sunDirWS.x * t, positionWS.y + sunDirWS.y * t, positionWS.z + sunDirWS.z * t);
+        opticalDepth += SampleCloudExtinction(grid, p) * ds;
+    }
+    return opticalDepth;
+}
+
+void BakeSunShadowSlices(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& sunDirWS, uint32_t width, uint32_t height, uint32_t depth,
+                         uint32_t firstSlice, uint32_t sliceCount, float* out_opticalDepth, uint32_t threadCount)
+{
+    if (!out_opticalDepth || firstSlice >= depth || sliceCount == 0)
+        return;
+
+    sliceCount = std::min(sliceCount, depth - firstSlice);
+
+    if (Dot(sunDirWS, sunDirWS) <= 0.0f)
+        return;
+
+    const DirectX::XMFLOAT3 sunDir = Normalize(sunDirWS);
+
+    const float stepSize = GetGridMarchStepSize(grid);
+
+    ParallelFor(height * sliceCount, threadCount, [&](uint32_t row)
+    {
+        uint32_t z = firstSlice + row / height;
+        uint32_t y = row % height;
+
+        float* pRow = out_opticalDepth + ((size_t)z * height + y) * width;
+        for (uint32_t x = 0; x < width; ++x)
+            pRow[x] = MarchSunOpticalDepth(grid, GetCloudVolumeTexelCenter(x, y, z, width, height, depth), sunDir, stepSize);
+    });
+}
+
+BeerShadowMapView GetBeerShadowMapView(const DirectX::XMFLOAT3& sunDirWS)
+{
+    BeerShadowMapView view;
+
+    DirectX::XMFLOAT3 toSun = Normalize(sunDirWS);
+    view.forward = DirectX::XMFLOAT3(-toSun.x, -toSun.y, -toSun.z);
+
+    // Same basis as XMMatrixLookToLH, falling back to +z as up when the sun is overhead
+    DirectX::XMFLOAT3 worldUp = fabsf(view.forward.y) > 0.999f ? DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f) : DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f);
+    view.right = Normalize(Cross(worldUp, view.forward));
+    view.up = Cross(view.forward, view.right);
+
+    const float halfX = CLOUD_VOLUME_SIDE_LENGTH * 0.5f;
+    const float halfY = CLOUD_VOLUME_HEIGHT * 0.5f;
+    const float radius = sqrtf(2.0f * halfX * halfX + halfY * halfY);
+
+    const DirectX::XMFLOAT3 center(0.0f, halfY, 0.0f);
+    view.origin = DirectX::XMFLOAT3(center.x - view.forward.x * radius, center.y - view.forward.y * radius, center.z - view.forward.z * radius);
+    view.extent = radius;
+    view.depthRange = 2.0f * radius;
+    return view;
+}
+
+void BuildBeerShadowMap(const CloudDensityGrid& grid, const BeerShadowMapView& view, uint32_t resolution,
+                        std::vector<DirectX::XMFLOAT4>& out_texels, uint32_t threadCount)
+{
+    out_texels.assign((size_t)resolution * resolution, DirectX::XMFLOAT4(view.depthRange, 0.0f, 0.0f, 0.0f));
+    if (resolution == 0 || grid.extinction.empty())
+        return;
+
+    const float stepSize = GetGridMarchStepSize(grid);
+    const uint32_t stepCount = (uint32_t)ceilf(view.depthRange / stepSize);
+
+    ParallelFor(resolution, threadCount, [&](uint32_t row)
+    {
+        float ndcY = 1.0f - 2.0f * ((float)row + 0.5f) / (float)resolution;
+        for (uint32_t col = 0; col < resolution; ++col)
+        {
+            float ndcX = 2.0f * ((float)col + 0.5f) / (float)resolution - 1.0f;
+
+            DirectX::XMFLOAT3 rayOrigin(
+                view.origin.x + (view.right.x * ndcX + view.up.x * ndcY) * view.extent,
+                view.origin.y + (view.right.y * ndcX + view.up.y * ndcY) * view.extent,
+                view.origin.z + (view.right.z * ndcX + view.up.z * ndcY) * view.extent);
+
+            float frontDepth = -1.0f;
+            float backDepth = 0.0f;
+            float opticalDepth = 0.0f;
+            for (uint32_t i = 0; i < stepCount; ++i)
+            {
+                float t = ((float)i + 0.5f) * stepSize;
+                DirectX::XMFLOAT3 p(rayOrigin.x + view.forward.x * t, rayOrigin.y + view.forward.y * t, rayOrigin.z + view.forward.z * t);
+
+                float extinction = SampleCloudExtinction(grid, p);
+                if (extinction <= 0.0f)
+                    continue;
+
+                // Each sample stands for the whole step around it
+                if (frontDepth < 0.0f)
+                    frontDepth = t - 0.5f * stepSize;
+                backDepth = t + 0.5f * stepSize;
+                opticalDepth += extinction * stepSize;
+            }
+
+            if (frontDepth < 0.0f)
+                continue;
+
+            float thickness = backDepth - frontDepth;
+            out_texels[(size_t)row * resolution + col] = DirectX::XMFLOAT4(frontDepth, opticalDepth / thickness, opticalDepth, 0.0f);
+        }
+    });
+}
+
+float EvaluateBeerShadowTransmittance(const DirectX::XMFLOAT4* texels, uint32_t resolution, const BeerShadowMapView& view, const DirectX::XMFLOAT3& positionWS)
+{
+    if (!texels || resolution == 0 || view.extent <= 0.0f)
+        return 1.0f;
+
+    DirectX::XMFLOAT3 d(positionWS.x - view.origin.x, positionWS.y - view.origin.y, positionWS.z - view.origin.z);
+    float ndcX = Dot(d, view.right) / view.extent;
+    float ndcY = Dot(d, view.up) / view.extent;
+    float depth = Dot(d, view.forward);
+
+    if (fabsf(ndcX) > 1.0f || fabsf(ndcY) > 1.0f)
+        return 1.0f;
+
+    // Bilinear with clamp, like the linearClamp sampler
+    float u = (ndcX * 0.5f + 0.5f) * (float)resolution - 0.5f;
+    float v = (0.5f - ndcY * 0.5f) * (float)resolution - 0.5f;
+    u = std::clamp(u, 0.0f, (float)(resolution - 1));
+    v = std::clamp(v, 0.0f, (float)(resolution - 1));
+
+    uint32_t x0 = (uint32_t)u, y0 = (uint32_t)v;
+    uint32_t x1 = std::min(x0 + 1, resolution - 1), y1 = std::min(y0 + 1, resolution - 1);
+    float fx = u - (float)x0, fy = v - (float)y0;
+
+    auto Lerp4 = [](const DirectX::XMFLOAT4& a, const DirectX::XMFLOAT4& b, float t)
+    {
+        return DirectX::XMFLOAT4(a.x + (b.x - a.x) * t, a.y + (b.y - a.y) * t, a.z + (b.z - a.z) * t, a.w + (b.w - a.w) * t);
+    };
+
+    DirectX::XMFLOAT4 top = Lerp4(texels[(size_t)y0 * resolution + x0], texels[(size_t)y0 * resolution + x1], fx);
+    DirectX::XMFLOAT4 bottom = Lerp4(texels[(size_t)y1 * resolution + x0], texels[(size_t)y1 * resolution + x1], fx);
+    DirectX::XMFLOAT4 bsm = Lerp4(top, bottom, fy);
+
+    float opticalDepth = std::min(bsm.y * std::max(depth - bsm.x, 0.0f), bsm.z);
+    return expf(-opticalDepth);
+}
+
+bool CloudScatteringParamsMatch(const CloudScatteringParams& a, const CloudScatteringParams& b)
+{
+    return a.forwardG == b.forwardG && a.backwardG == b.backwardG && a.forwardWeight == b.forwardWeight && a.octaves == b.octaves &&
+           a.scatteringFalloff == b.scatteringFalloff && a.extinctionFalloff == b.extinctionFalloff && a.eccentricityFalloff == b.eccentricityFalloff;
+}
+
+float EvaluateCloudScattering(const CloudScatteringParams& params, float cosTheta, float opticalDepth)
+{
+    // Henyey-Greenstein times 4pi
+    auto HenyeyGreenstein = [](float g, float cosTheta)
+    {
+        float denom = std::max(1.0f + g * g - 2.0f * g * cosTheta, 1e-6f);
+        return (1.0f - g * g) / (denom * sqrtf(denom));
+    };
+
+    float result = 0.0f;
+    float scattering = 1.0f;
+    float extinction = 1.0f;
+    float eccentricity = 1.0f;
+    for (uint32_t i = 0; i < std::max(params.octaves, 1u); ++i)
+    {
+        float phase = params.forwardWeight * HenyeyGreenstein(params.forwardG * eccentricity, cosTheta) +
+                      (1.0f - params.forwardWeight) * HenyeyGreenstein(params.backwardG * eccentricity, cosTheta);
+        result += scattering * phase * expf(-opticalDepth * extinction);
+
+        scattering *= params.scatteringFalloff;
+        extinction *= params.extinctionFalloff;
+        eccentricity *= params.eccentricityFalloff;
+    }
+    return result;
+}
+
+void BuildCloudScatteringLut(const CloudScatteringParams& params, std::vector<float>& out_texels)
+{
+    out_texels.resize((size_t)CLOUD_SCATTERING_LUT_WIDTH * CLOUD_SCATTERING_LUT_HEIGHT);
+
+    for (uint32_t y = 0; y < CLOUD_SCATTERING_LUT_HEIGHT; ++y)
+    {
+        float v = (float)y / (float)(CLOUD_SCATTERING_LUT_HEIGHT - 1);
+        float opticalDepth = v * v * CLOUD_SCATTERING_LUT_MAX_OPTICAL_DEPTH;
+
+        for (uint32_t x = 0; x < CLOUD_SCATTERING_LUT_WIDTH; ++x)
+        {
+            float cosTheta = 2.0f * (float)x / (float)(CLOUD_SCATTERING_LUT_WIDTH - 1) - 1.0f;
+            out_texels[(size_t)y * CLOUD_SCATTERING_LUT_WIDTH + x] = EvaluateCloudScattering(params, cosTheta, opticalDepth);
+        }
+    }
+}
+
+DirectX::XMFLOAT2 GetCloudScatteringLutCoord(float cosTheta, float opticalDepth)
+{
+    float x = std::clamp(cosTheta * 0.5f + 0.5f, 0.0f, 1.0f);
+    float y = sqrtf(std::clamp(opticalDepth / CLOUD_SCATTERING_LUT_MAX_OPTICAL_DEPTH, 0.0f, 1.0f));
+
+    // Remap [0,1] onto the first and last texel centers
+    return DirectX::XMFLOAT2(
+        (0.5f + x * (float)(CLOUD_SCATTERING_LUT_WIDTH - 1)) / (float)CLOUD_SCATTERING_LUT_WIDTH,
+        (0.5f + y * (float)(CLOUD_SCATTERING_LUT_HEIGHT - 1)) / (float)CLOUD_SCATTERING_LUT_HEIGHT);
+}
+
+DirectX::XMFLOAT3 AtmosphereToWorldDirection(const DirectX::XMFLOAT3& atmosphereDir)
+{
+    // Swapping y and z changes both the up axis and the handedness
+    return DirectX::XMFLOAT3(atmosphereDir.x, atmosphereDir.z, atmosphereDir.y);
+}
+
+}
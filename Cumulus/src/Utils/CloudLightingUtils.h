@@ -0,0 +1,120 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU side cloud lighting precomputation.
+Works on a coarse extinction grid built from the NVDF at load time, so light
+can be marched off the GPU and handed to Raymarch.cs.hlsl as a lookup.
+----------------------------------------------*/
+#ifndef MUON_CLOUDLIGHTINGUTILS_H
+#define MUON_CLOUDLIGHTINGUTILS_H
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Cloud volume bounds in world units. Mirrors SIDE_LENGTH / VOLUME_MIN_WS / VOLUME_MAX_WS in Raymarch.cs.hlsl.
+    static const float CLOUD_VOLUME_SIDE_LENGTH = 4000.0f;
+    static const float CLOUD_VOLUME_HEIGHT = CLOUD_VOLUME_SIDE_LENGTH / 8.0f;
+
+    // Density to extinction scale. Mirrors DENSITY_SCALE in Raymarch.cs.hlsl.
+    static const float CLOUD_DENSITY_SCALE = 0.035f;
+
+    // Extinction (per world unit) over the whole cloud volume.
+    // Laid out like the NVDF texture: x fastest, then world z, then world y.
+    struct CloudDensityGrid
+    {
+        uint32_t width = 0;  // world x
+        uint32_t height = 0; // world z
+        uint32_t depth = 0;  // world y
+        std::vector<float> extinction;
+
+        // Lower bound on the distance (world units) from anywhere in the cell to the nearest cloud, for empty space skipping.
+        // The smallest SDF in the cell, less enough margin to also cover the trilinearly filtered NVDF.
+        std::vector<float> emptyDistance;
+    };
+
+    // Box filters an NVDF ([sdf, profile, detail type, density scale] per texel) down by divisor on every axis.
+    // Uses the uprezzed density without detail noise, so it runs slightly denser than what the raymarch integrates.
+    // Also fills the grid's conservative empty distances from the SDF.
+    bool BuildCloudDensityGrid(const float* nvdfTexels, uint32_t width, uint32_t height, uint32_t depth, uint32_t divisor, CloudDensityGrid& out_grid);
+
+    // Trilinear extinction at a world position. Zero outside the volume.
+    float SampleCloudExtinction(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& positionWS);
+
+    // World position of the center of texel (x, y, z) of a volume with the NVDF layout.
+    DirectX::XMFLOAT3 GetCloudVolumeTexelCenter(uint32_t x, uint32_t y, uint32_t z, uint32_t width, uint32_t height, uint32_t depth);
+
+    // Optical depth from positionWS to where a ray toward the sun leaves the volume.
+    float MarchSunOpticalDepth(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& positionWS, const DirectX::XMFLOAT3& sunDirWS, float stepSize);
+
+    // Bakes slices [firstSlice, firstSlice + sliceCount) of a width x height x depth sun optical depth volume with the NVDF layout.
+    // out_opticalDepth holds the whole volume, only the requested slices are written.
+    // Rows are shared out between threadCount threads, 0 uses every hardware thread.
+    void BakeSunShadowSlices(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& sunDirWS, uint32_t width, uint32_t height, uint32_t depth,
+                             uint32_t firstSlice, uint32_t sliceCount, float* out_opticalDepth, uint32_t threadCount = 0);
+
+    // ~11m per texel across the volume's bounding sphere
+    static const uint32_t BEER_SHADOW_MAP_RESOLUTION = 512;
+
+    // Orthographic view from the sun that covers the whole cloud volume.
+    // Sized to the volume's bounding sphere so the map doesn't shimmer as the sun turns.
+    struct BeerShadowMapView
+    {
+        DirectX::XMFLOAT3 origin;  // Center of the near plane
+        DirectX::XMFLOAT3 right;
+        DirectX::XMFLOAT3 up;
+        DirectX::XMFLOAT3 forward; // Direction light travels, away from the sun
+        float extent = 0.0f;       // Half the width of the map in world units
+        float depthRange = 0.0f;   // Distance from the near plane to the far plane
+    };
+
+    BeerShadowMapView GetBeerShadowMapView(const DirectX::XMFLOAT3& sunDirWS);
+
+    // Renders a resolution x resolution Beer shadow map: [front depth, mean extinction, max optical depth, unused] per texel.
+    // Depths are world units from the near plane, texel rows run top (+up) to bottom. Texels that miss the clouds hold [depthRange, 0, 0, 0].
+    // Marches the coarse density grid, so it is a close but not exact match for BeerShadowMap.cs.hlsl which marches the full NVDF.
+    void BuildBeerShadowMap(const CloudDensityGrid& grid, const BeerShadowMapView& view, uint32_t resolution,
+                            std::vector<DirectX::XMFLOAT4>& out_texels, uint32_t threadCount = 0);
+
+    // Bilinearly filtered sun transmittance at a world position. Mirrors SampleBeerShadowTransmittance() in BeerShadowMap.hlsli.
+    float EvaluateBeerShadowTransmittance(const DirectX::XMFLOAT4* texels, uint32_t resolution, const BeerShadowMapView& view, const DirectX::XMFLOAT3& positionWS);
+
+    // Dual lobe Henyey-Greenstein phase function with Wrenninge style multiple scattering octaves.
+    // Each octave i adds scatteringFalloff^i of light that saw extinctionFalloff^i of the optical depth,
+    // through lobes with eccentricityFalloff^i of the eccentricity.
+    struct CloudScatteringParams
+    {
+        float forwardG = 0.8f;            // Eccentricity of the forward lobe, the silver lining toward the sun
+        float backwardG = -0.3f;          // Eccentricity of the backward lobe
+        float forwardWeight = 0.7f;       // Blend between the lobes
+        uint32_t octaves = 4;             // 1 = single scattering only
+        float scatteringFalloff = 0.5f;
+        float extinctionFalloff = 0.5f;
+        float eccentricityFalloff = 0.5f;
+    };
+
+    bool CloudScatteringParamsMatch(const CloudScatteringParams& a, const CloudScatteringParams& b);
+
+    // LUT layout, mirrored in CloudScatteringLut.hlsli. u = cos theta, v = sqrt of the normalized sun optical depth.
+    static const uint32_t CLOUD_SCATTERING_LUT_WIDTH = 256;
+    static const uint32_t CLOUD_SCATTERING_LUT_HEIGHT = 128;
+    static const float CLOUD_SCATTERING_LUT_MAX_OPTICAL_DEPTH = 64.0f;
+
+    // Sunlight scattered toward the viewer by a sample behind opticalDepth of cloud, cosTheta = dot(view dir, dir to sun).
+    // The phase function is scaled by 4pi, so an isotropic phase with no shadowing and one octave gives 1.
+    float EvaluateCloudScattering(const CloudScatteringParams& params, float cosTheta, float opticalDepth);
+
+    // Tabulates EvaluateCloudScattering over the LUT, x fastest. Texel centers land exactly on cos theta = -1, 1 and optical depth 0, max.
+    void BuildCloudScatteringLut(const CloudScatteringParams& params, std::vector<float>& out_texels);
+
+    // Mirrors GetCloudScatteringLutCoord() in CloudScatteringLut.hlsli
+    DirectX::XMFLOAT2 GetCloudScatteringLutCoord(float cosTheta, float opticalDepth);
+
+    // The atmosphere model is right handed and z-up, the scene is left handed and y-up.
+    DirectX::XMFLOAT3 AtmosphereToWorldDirection(const DirectX::XMFLOAT3& atmosphereDir);
+}
+
+#endif
@@ -0,0 +1,137 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of ConeMarchUtils.h
+----------------------------------------------*/
+#include <Utils/ConeMarchUtils.h>
+
+#include <Utils/RaymarchUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    DirectX::XMFLOAT3 Normalize(const DirectX::XMFLOAT3& v)
+    {
+        float length = sqrtf(Dot(v, v));
+        return length > 0.0f ? DirectX::XMFLOAT3(v.x / length, v.y / length, v.z / length) : v;
+    }
+}
+
+uint32_t GetConeTileCount(uint32_t fullSize)
+{
+    return (fullSize + CLOUD_CONE_TILE_SIZE - 1) / CLOUD_CONE_TILE_SIZE;
+}
+
+float GetCloudEmptyDistance(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& positionWS)
+{
+    if (grid.emptyDistance.empty())
+        return 0.0f;
+
+    const DirectX::XMFLOAT3 boxMin(-CLOUD_VOLUME_SIDE_LENGTH * 0.5f, 0.0f, -CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+    const DirectX::XMFLOAT3 boxMax(CLOUD_VOLUME_SIDE_LENGTH * 0.5f, CLOUD_VOLUME_HEIGHT, CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+
+    DirectX::XMFLOAT3 clamped(
+        std::clamp(positionWS.x, boxMin.x, boxMax.x),
+        std::clamp(positionWS.y, boxMin.y, boxMax.y),
+        std::clamp(positionWS.z, boxMin.z, boxMax.z));
+
+    DirectX::XMFLOAT3 offset(positionWS.x - clamped.x, positionWS.y - clamped.y, positionWS.z - clamped.z);
+    float outside = sqrtf(Dot(offset, offset));
+
+    // Same axis swizzle as WorldToNvdfUV(): world y stacks the slices
+    uint32_t x = std::min((uint32_t)((clamped.x - boxMin.x) / (boxMax.x - boxMin.x) * (float)grid.width), grid.width - 1);
+    uint32_t y = std::min((uint32_t)((clamped.z - boxMin.z) / (boxMax.z - boxMin.z) * (float)grid.height), grid.height - 1);
+    uint32_t z = std::min((uint32_t)((clamped.y - boxMin.y) / (boxMax.y - boxMin.y) * (float)grid.depth), grid.depth - 1);
+    float cellDistance = grid.emptyDistance[((size_t)z * grid.height + y) * grid.width + x];
+
+    // Clouds only live inside the volume, and the closest point of it is outside away from the cell's bound
+    return std::max(outside, cellDistance - outside);
+}
+
+float ConeMarchFirstHit(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& axis, float tanHalfAngle, float maxDistance)
+{
+    float t = 0.0f;
+    for (uint32_t i = 0; i < CLOUD_CONE_MAX_STEPS && t < maxDistance; ++i)
+    {
+        DirectX::XMFLOAT3 position(origin.x + axis.x * t, origin.y + axis.y * t, origin.z + axis.z * t);
+        float emptyDistance = GetCloudEmptyDistance(grid, position);
+        float coneRadius = t * tanHalfAngle;
+        if (emptyDistance <= coneRadius)
+            return t;
+
+        // The empty ball covers the cone section at t + step as long as step + (t + step) * tan <= emptyDistance
+        t += (emptyDistance - coneRadius) / (1.0f + tanHalfAngle);
+    }
+
+    return std::min(t, maxDistance);
+}
+
+void GetTileCone(uint32_t tileX, uint32_t tileY, uint32_t fullWidth, uint32_t fullHeight, const DirectX::XMFLOAT4X4& proj,
+                 DirectX::XMFLOAT3& out_axisVS, float& out_tanHalfAngle)
+{
+    // Every ray the raymarch traces from this tile passes through a pixel center, so the corner pixels bound them all
+    float x0 = (float)(tileX * CLOUD_CONE_TILE_SIZE);
+    float y0 = (float)(tileY * CLOUD_CONE_TILE_SIZE);
+    float x1 = (float)std::min(tileX * CLOUD_CONE_TILE_SIZE + CLOUD_CONE_TILE_SIZE, fullWidth) - 1.0f;
+    float y1 = (float)std::min(tileY * CLOUD_CONE_TILE_SIZE + CLOUD_CONE_TILE_SIZE, fullHeight) - 1.0f;
+
+    const DirectX::XMFLOAT3 corners[4] =
+    {
+        GetViewRayDirection(x0, y0, (float)fullWidth, (float)fullHeight, proj),
+        GetViewRayDirection(x1, y0, (float)fullWidth, (float)fullHeight, proj),
+        GetViewRayDirection(x0, y1, (float)fullWidth, (float)fullHeight, proj),
+        GetViewRayDirection(x1, y1, (float)fullWidth, (float)fullHeight, proj),
+    };
+
+    out_axisVS = Normalize(DirectX::XMFLOAT3(
+        corners[0].x + corners[1].x + corners[2].x + corners[3].x,
+        corners[0].y + corners[1].y + corners[2].y + corners[3].y,
+        corners[0].z + corners[1].z + corners[2].z + corners[3].z));
+
+    float minCos = 1.0f;
+    for (const DirectX::XMFLOAT3& corner : corners)
+        minCos = std::min(minCos, Dot(out_axisVS, corner));
+
+    // A hair wider to absorb rounding
+    minCos = std::clamp(minCos - 1e-5f, 1e-3f, 1.0f);
+    out_tanHalfAngle = sqrtf(1.0f - minCos * minCos) / minCos;
+}
+
+void BuildConeStartTiles(const CloudDensityGrid& grid, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4X4& invView,
+                         uint32_t fullWidth, uint32_t fullHeight, float maxDistance, std::vector<float>& out_coneStart)
+{
+    const uint32_t tilesX = GetConeTileCount(fullWidth);
+    const uint32_t tilesY = GetConeTileCount(fullHeight);
+    out_coneStart.assign((size_t)tilesX * tilesY, 0.0f);
+
+    const DirectX::XMFLOAT4X4& iv = invView;
+    const DirectX::XMFLOAT3 eyePos(iv._41, iv._42, iv._43);
+
+    for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+    {
+        for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+        {
+            DirectX::XMFLOAT3 axisVS;
+            float tanHalfAngle;
+            GetTileCone(tileX, tileY, fullWidth, fullHeight, proj, axisVS, tanHalfAngle);
+
+            DirectX::XMFLOAT3 axisWS = Normalize(DirectX::XMFLOAT3(
+                axisVS.x * iv._11 + axisVS.y * iv._21 + axisVS.z * iv._31,
+                axisVS.x * iv._12 + axisVS.y * iv._22 + axisVS.z * iv._32,
+                axisVS.x * iv._13 + axisVS.y * iv._23 + axisVS.z * iv._33));
+
+            out_coneStart[(size_t)tileY * tilesX + tileX] = ConeMarchFirstHit(grid, eyePos, axisWS, tanHalfAngle, maxDistance);
+        }
+    }
+}
+
+}
@@ -0,0 +1,49 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU mirror of the cloud cone march prepass.
+One cone per screen tile is sphere traced through the density grid's
+conservative empty distances, giving the distance along the tile's axis
+before which none of the tile's rays can touch a cloud.
+Kept in sync with CloudConeMarch.hlsli and CloudConeMarch.cs.hlsl
+----------------------------------------------*/
+#ifndef MUON_CONEMARCHUTILS_H
+#define MUON_CONEMARCHUTILS_H
+
+#include <Utils/CloudLightingUtils.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Full resolution pixels per side of a cone tile
+    static const uint32_t CLOUD_CONE_TILE_SIZE = 8;
+
+    // Cones stuck grazing a cloud stop here and report how far they got, which is still conservative
+    static const uint32_t CLOUD_CONE_MAX_STEPS = 64;
+
+    // Number of tiles covering fullSize pixels
+    uint32_t GetConeTileCount(uint32_t fullSize);
+
+    // Lower bound on the distance from positionWS to the nearest cloud. Mirrors GetCloudEmptyDistance() in CloudConeMarch.hlsli.
+    float GetCloudEmptyDistance(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& positionWS);
+
+    // Distance along axis before which nothing inside the cone can touch a cloud, at most maxDistance.
+    // Mirrors ConeMarchFirstHit() in CloudConeMarch.hlsli.
+    float ConeMarchFirstHit(const CloudDensityGrid& grid, const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& axis, float tanHalfAngle, float maxDistance);
+
+    // Axis and half angle of the cone holding every pixel center ray of a tile, in view space.
+    // Mirrors GetTileCone() in CloudConeMarch.cs.hlsl.
+    void GetTileCone(uint32_t tileX, uint32_t tileY, uint32_t fullWidth, uint32_t fullHeight, const DirectX::XMFLOAT4X4& proj,
+                     DirectX::XMFLOAT3& out_axisVS, float& out_tanHalfAngle);
+
+    // Runs the whole prepass. out_coneStart is GetConeTileCount(fullWidth) x GetConeTileCount(fullHeight).
+    // invView is the CPU-side (row-vector) inverse view. Mirrors CloudConeMarch.cs.hlsl.
+    void BuildConeStartTiles(const CloudDensityGrid& grid, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4X4& invView,
+                             uint32_t fullWidth, uint32_t fullHeight, float maxDistance, std::vector<float>& out_coneStart);
+}
+
+#endif
@@ -6,6 +6,7 @@ Description : Utility functions for hashing
 #ifndef MUON_HASHUTILS_H
 #define MUON_HASHUTILS_H
 
+#include <stddef.h>
 #include <stdint.h>
 
 // Helper function for hashing c strings
@@ -27,4 +28,14 @@ inline uint32_t fnv1a(const wchar_t* text, uint32_t hash = 0x811C9DC5, uint32_t
     return hash;
 }
 
+// Helper function for hashing raw bytes, chain calls through hash to cover several buffers
+inline uint32_t fnv1a(const void* data, size_t size, uint32_t hash = 0x811C9DC5, uint32_t prime = 0x01000193)
+{
+    const unsigned char* ptr = (const unsigned char*)data;
+    for (size_t i = 0; i < size; ++i)
+        hash = (ptr[i] ^ hash) * prime;
+
+    return hash;
+}
+
 #endif
\ No newline at end of file
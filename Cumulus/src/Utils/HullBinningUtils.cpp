@@ -0,0 +1,70 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of HullBinningUtils.h
+----------------------------------------------*/
+#include "HullBinningUtils.h"
+
+#include <Utils/RaymarchUtils.h>
+#include <Utils/RayIntervalUtils.h>
+
+#include <algorithm>
+
+namespace Muon
+{
+
+void GetHullTilePixelRect(uint32_t tileX, uint32_t tileY, uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset,
+                          uint32_t marchWidth, uint32_t marchHeight, DirectX::XMUINT2& out_min, DirectX::XMUINT2& out_max)
+{
+    // Pixels grow with march texels, so the tile's corner texels bound all of them
+    const uint32_t lastX = std::min((tileX + 1) * HULL_TILE_SIZE, marchWidth) - 1;
+    const uint32_t lastY = std::min((tileY + 1) * HULL_TILE_SIZE, marchHeight) - 1;
+    out_min = GetMarchPixelCoord(tileX * HULL_TILE_SIZE, tileY * HULL_TILE_SIZE, fullWidth, fullHeight, divisor, marchOffset);
+    out_max = GetMarchPixelCoord(lastX, lastY, fullWidth, fullHeight, divisor, marchOffset);
+}
+
+void BinHullsToTiles(const std::vector<sbHullBounds>& bounds, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4X4& invView,
+                     uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset,
+                     uint32_t marchWidth, uint32_t marchHeight, std::vector<uint32_t>& out_tiles)
+{
+    const uint32_t tilesX = GetHullTileCount(marchWidth);
+    const uint32_t tilesY = GetHullTileCount(marchHeight);
+    out_tiles.assign((size_t)tilesX * HULL_TILE_SLOTS * tilesY, 0);
+
+    const DirectX::XMFLOAT3 eyePos(invView._41, invView._42, invView._43);
+
+    // Every hull's rectangle once up front, the GPU recomputes them per tile instead
+    std::vector<DirectX::XMUINT2> rectMin(bounds.size());
+    std::vector<DirectX::XMUINT2> rectMax(bounds.size());
+    std::vector<bool> visible(bounds.size());
+    for (size_t i = 0; i < bounds.size(); ++i)
+    {
+        CloudBrick box = { bounds[i].minBounds, bounds[i].maxBounds };
+        visible[i] = GetBrickPixelRect(box, eyePos, view, proj, fullWidth, fullHeight, rectMin[i], rectMax[i]);
+    }
+
+    for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+    {
+        for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+        {
+            DirectX::XMUINT2 tileMin, tileMax;
+            GetHullTilePixelRect(tileX, tileY, fullWidth, fullHeight, divisor, marchOffset, marchWidth, marchHeight, tileMin, tileMax);
+
+            uint32_t* tile = &out_tiles[((size_t)tileY * tilesX + tileX) * HULL_TILE_SLOTS];
+            uint32_t count = 0;
+            for (size_t i = 0; i < bounds.size(); ++i)
+            {
+                if (!visible[i] || rectMin[i].x > tileMax.x || rectMax[i].x < tileMin.x || rectMin[i].y > tileMax.y || rectMax[i].y < tileMin.y)
+                    continue;
+
+                if (count < MAX_HULLS_PER_TILE)
+                    tile[1 + count] = (uint32_t)i;
+                ++count;
+            }
+
+            tile[0] = count > MAX_HULLS_PER_TILE ? HULL_TILE_OVERFLOW : count;
+        }
+    }
+}
+
+}
@@ -0,0 +1,47 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Screen tile lists of the hulls each tile's rays can hit.
+The march texels are split into 16x16 tiles, one per raymarch thread group.
+Every hull's world space box is projected to a pixel rectangle, and each
+tile keeps the hulls whose rectangle overlaps the pixels its texels trace,
+so a ray only intersects the hulls near it, in the style of tiled light culling.
+CPU mirror of HullBinning.cs.hlsl
+----------------------------------------------*/
+#ifndef MUON_HULLBINNINGUTILS_H
+#define MUON_HULLBINNINGUTILS_H
+
+#include <Core/SBufferStructs.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Side of a tile in march texels, matches the raymarch's thread groups
+    static const uint32_t HULL_TILE_SIZE = 16;
+
+    // Each tile is a run of HULL_TILE_SLOTS texels in the CloudHullTiles texture: the count, then the hull indices
+    static const uint32_t MAX_HULLS_PER_TILE = 31;
+    static const uint32_t HULL_TILE_SLOTS = MAX_HULLS_PER_TILE + 1;
+
+    // Count of a tile with more hulls than fit. Its rays test every hull instead.
+    static const uint32_t HULL_TILE_OVERFLOW = 0xFFFFFFFF;
+
+    inline uint32_t GetHullTileCount(uint32_t marchSize) { return (marchSize + HULL_TILE_SIZE - 1) / HULL_TILE_SIZE; }
+
+    // Inclusive rectangle of full resolution pixels traced by the march texels of a tile
+    void GetHullTilePixelRect(uint32_t tileX, uint32_t tileY, uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset,
+                              uint32_t marchWidth, uint32_t marchHeight, DirectX::XMUINT2& out_min, DirectX::XMUINT2& out_max);
+
+    // Fills every tile of a marchWidth x marchHeight march, laid out like the CloudHullTiles texture
+    // (GetHullTileCount(marchWidth) * HULL_TILE_SLOTS wide). Indices are into bounds, ascending.
+    // The GPU appends in whatever order its threads get there, so compare tiles as sets.
+    void BinHullsToTiles(const std::vector<sbHullBounds>& bounds, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4X4& invView,
+                         uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset,
+                         uint32_t marchWidth, uint32_t marchHeight, std::vector<uint32_t>& out_tiles);
+}
+
+#endif
@@ -0,0 +1,426 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of HullVoxelUtils.h
+----------------------------------------------*/
+#include <Utils/HullVoxelUtils.h>
+
+#include <Utils/ParallelUtils.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace Muon
+{
+namespace
+{
+    // Per side of a voxel the hull's surface passes through, 64 samples is 8 batches of 8
+    static const uint32_t COVERAGE_SAMPLES_PER_SIDE = 4;
+    static const uint32_t COVERAGE_SAMPLES = COVERAGE_SAMPLES_PER_SIDE * COVERAGE_SAMPLES_PER_SIDE * COVERAGE_SAMPLES_PER_SIDE;
+    static const uint32_t ROW_WIDTH = HULL_VOXEL_BLOCK_SIZE;
+
+    // Hull planes in world space, renormalized so n.p + w is a distance
+    struct VoxelPlanes
+    {
+        std::vector<float> nx;
+        std::vector<float> ny;
+        std::vector<float> nz;
+        std::vector<float> w;
+        std::vector<float> radius;  // Half of a voxel's extent along the normal
+        uint32_t count = 0;
+    };
+
+    // Voxel centers of the grid in world space, grid axes are x, world z, world y
+    struct VoxelLayout
+    {
+        uint32_t size[3];       // In grid order
+        DirectX::XMFLOAT3 cell; // World size of one voxel
+        DirectX::XMFLOAT3 origin;
+
+        DirectX::XMFLOAT3 GetVoxelCenter(uint32_t x, uint32_t y, uint32_t z) const
+        {
+            return DirectX::XMFLOAT3(
+                origin.x + ((float)x + 0.5f) * cell.x,
+                origin.y + ((float)z + 0.5f) * cell.y,
+                origin.z + ((float)y + 0.5f) * cell.z);
+        }
+    };
+
+    struct CandidateBlock
+    {
+        uint32_t x, y, z;
+        DirectX::XMFLOAT3 center;
+        bool inside;    // Every voxel is entirely inside the hull
+    };
+
+    DirectX::XMFLOAT3 Cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return DirectX::XMFLOAT3(a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x);
+    }
+
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    // Points go p * A + t, so normals go A^-1 n. The columns of A^-1 are the cross products of A's rows over the determinant.
+    bool TransformPlanes(const std::vector<DirectX::XMFLOAT4>& planes, const DirectX::XMFLOAT4X4& world, const DirectX::XMFLOAT3& halfCell, VoxelPlanes& out_planes)
+    {
+        const DirectX::XMFLOAT3 r0(world._11, world._12, world._13);
+        const DirectX::XMFLOAT3 r1(world._21, world._22, world._23);
+        const DirectX::XMFLOAT3 r2(world._31, world._32, world._33);
+        const DirectX::XMFLOAT3 t(world._41, world._42, world._43);
+
+        const DirectX::XMFLOAT3 c0 = Cross(r1, r2);
+        const DirectX::XMFLOAT3 c1 = Cross(r2, r0);
+        const DirectX::XMFLOAT3 c2 = Cross(r0, r1);
+        const float det = Dot(r0, c0);
+        if (fabsf(det) < 1e-12f)
+            return false;
+
+        out_planes.count = (uint32_t)planes.size();
+        out_planes.nx.resize(planes.size());
+        out_planes.ny.resize(planes.size());
+        out_planes.nz.resize(planes.size());
+        out_planes.w.resize(planes.size());
+        out_planes.radius.resize(planes.size());
+
+        for (uint32_t i = 0; i < out_planes.count; ++i)
+        {
+            const DirectX::XMFLOAT4& plane = planes[i];
+            DirectX::XMFLOAT3 n(
+                (c0.x * plane.x + c1.x * plane.y + c2.x * plane.z) / det,
+                (c0.y * plane.x + c1.y * plane.y + c2.y * plane.z) / det,
+                (c0.z * plane.x + c1.z * plane.y + c2.z * plane.z) / det);
+
+            float length = sqrtf(Dot(n, n));
+            if (length <= 0.0f)
+                return false;
+
+            out_planes.nx[i] = n.x / length;
+            out_planes.ny[i] = n.y / length;
+            out_planes.nz[i] = n.z / length;
+            out_planes.w[i] = (plane.w - Dot(t, n)) / length;
+            out_planes.radius[i] = fabsf(out_planes.nx[i]) * halfCell.x + fabsf(out_planes.ny[i]) * halfCell.y + fabsf(out_planes.nz[i]) * halfCell.z;
+        }
+        return true;
+    }
+
+    // Largest n.p + w over the planes for 8 points, less (outer) and plus (inner) each plane's voxel radius times radiusScale.
+    // outer > 0: the voxel around the point is outside the hull. inner <= 0: it is entirely inside.
+    void ClassifyPoints8(const VoxelPlanes& planes, const float* x, const float* y, const float* z, float radiusScale, float* out_outer, float* out_inner)
+    {
+#if defined(__AVX2__)
+        const __m256 px = _mm256_loadu_ps(x), py = _mm256_loadu_ps(y), pz = _mm256_loadu_ps(z);
+        const __m256 scale = _mm256_set1_ps(radiusScale);
+
+        __m256 outer = _mm256_set1_ps(-FLT_MAX);
+        __m256 inner = _mm256_set1_ps(-FLT_MAX);
+        for (uint32_t i = 0; i < planes.count; ++i)
+        {
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(px, _mm256_set1_ps(planes.nx[i])), _mm256_mul_ps(py, _mm256_set1_ps(planes.ny[i]))),
+                                     _mm256_add_ps(_mm256_mul_ps(pz, _mm256_set1_ps(planes.nz[i])), _mm256_set1_ps(planes.w[i])));
+            __m256 r = _mm256_mul_ps(_mm256_set1_ps(planes.radius[i]), scale);
+
+            outer = _mm256_max_ps(outer, _mm256_sub_ps(d, r));
+            inner = _mm256_max_ps(inner, _mm256_add_ps(d, r));
+        }
+
+        _mm256_storeu_ps(out_outer, outer);
+        _mm256_storeu_ps(out_inner, inner);
+#else
+        for (uint32_t lane = 0; lane < ROW_WIDTH; ++lane)
+        {
+            out_outer[lane] = -FLT_MAX;
+            out_inner[lane] = -FLT_MAX;
+        }
+
+        for (uint32_t i = 0; i < planes.count; ++i)
+        {
+            const float r = planes.radius[i] * radiusScale;
+            for (uint32_t lane = 0; lane < ROW_WIDTH; ++lane)
+            {
+                float d = x[lane] * planes.nx[i] + y[lane] * planes.ny[i] + z[lane] * planes.nz[i] + planes.w[i];
+                out_outer[lane] = std::max(out_outer[lane], d - r);
+                out_inner[lane] = std::max(out_inner[lane], d + r);
+            }
+        }
+#endif
+    }
+
+    // The planes the box of radiusScale voxels around center straddles. Planes the box is entirely inside of can't cut anything in it.
+    void GetStraddlingPlanes(const VoxelPlanes& planes, const DirectX::XMFLOAT3& center, float radiusScale, VoxelPlanes& out_planes)
+    {
+        out_planes.nx.clear();
+        out_planes.ny.clear();
+        out_planes.nz.clear();
+        out_planes.w.clear();
+        out_planes.radius.clear();
+
+        for (uint32_t i = 0; i < planes.count; ++i)
+        {
+            float d = center.x * planes.nx[i] + center.y * planes.ny[i] + center.z * planes.nz[i] + planes.w[i];
+            if (d + planes.radius[i] * radiusScale <= 0.0f)
+                continue;
+
+            out_planes.nx.push_back(planes.nx[i]);
+            out_planes.ny.push_back(planes.ny[i]);
+            out_planes.nz.push_back(planes.nz[i]);
+            out_planes.w.push_back(planes.w[i]);
+            out_planes.radius.push_back(planes.radius[i]);
+        }
+        out_planes.count = (uint32_t)out_planes.nx.size();
+    }
+
+    // Fraction of the voxel's samples inside the hull, planes are the ones the voxel straddles
+    float GetVoxelCoverage(const VoxelPlanes& planes, const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& cell)
+    {
+        float x[ROW_WIDTH], y[ROW_WIDTH], z[ROW_WIDTH];
+        float outer[ROW_WIDTH], inner[ROW_WIDTH];
+
+        uint32_t insideCount = 0;
+        for (uint32_t base = 0; base < COVERAGE_SAMPLES; base += ROW_WIDTH)
+        {
+            for (uint32_t lane = 0; lane < ROW_WIDTH; ++lane)
+            {
+                uint32_t sample = base + lane;
+                uint32_t sx = sample % COVERAGE_SAMPLES_PER_SIDE;
+                uint32_t sy = (sample / COVERAGE_SAMPLES_PER_SIDE) % COVERAGE_SAMPLES_PER_SIDE;
+                uint32_t sz = sample / (COVERAGE_SAMPLES_PER_SIDE * COVERAGE_SAMPLES_PER_SIDE);
+
+                x[lane] = center.x + (((float)sx + 0.5f) / COVERAGE_SAMPLES_PER_SIDE - 0.5f) * cell.x;
+                y[lane] = center.y + (((float)sy + 0.5f) / COVERAGE_SAMPLES_PER_SIDE - 0.5f) * cell.y;
+                z[lane] = center.z + (((float)sz + 0.5f) / COVERAGE_SAMPLES_PER_SIDE - 0.5f) * cell.z;
+            }
+
+            ClassifyPoints8(planes, x, y, z, 0.0f, outer, inner);
+            for (uint32_t lane = 0; lane < ROW_WIDTH; ++lane)
+                insideCount += inner[lane] <= 0.0f ? 1 : 0;
+        }
+
+        return (float)insideCount / (float)COVERAGE_SAMPLES;
+    }
+
+    // Fills the block's voxel coverage. Returns how many voxels the hull touches, out_coverage gets their summed coverage.
+    uint32_t FillBlockCoverage(const VoxelPlanes& planes, const VoxelLayout& layout, const CandidateBlock& block, float* out_voxels, float& out_coverage)
+    {
+        float x[ROW_WIDTH], y[ROW_WIDTH], z[ROW_WIDTH];
+        float outer[ROW_WIDTH], inner[ROW_WIDTH];
+
+        // Only the few planes crossing the block can cut its voxels, and only the one or two crossing a voxel its samples
+        VoxelPlanes blockPlanes, voxelPlanes;
+        if (!block.inside)
+            GetStraddlingPlanes(planes, block.center, (float)HULL_VOXEL_BLOCK_SIZE, blockPlanes);
+
+        const uint32_t firstX = block.x * HULL_VOXEL_BLOCK_SIZE;
+        uint32_t touched = 0;
+        out_coverage = 0.0f;
+
+        for (uint32_t row = 0; row < HULL_VOXEL_BLOCK_SIZE * HULL_VOXEL_BLOCK_SIZE; ++row)
+        {
+            float* rowVoxels = out_voxels + row * ROW_WIDTH;
+            const uint32_t gy = block.y * HULL_VOXEL_BLOCK_SIZE + row % HULL_VOXEL_BLOCK_SIZE;
+            const uint32_t gz = block.z * HULL_VOXEL_BLOCK_SIZE + row / HULL_VOXEL_BLOCK_SIZE;
+            const uint32_t rowLength = (gy < layout.size[1] && gz < layout.size[2] && firstX < layout.size[0]) ? std::min(ROW_WIDTH, layout.size[0] - firstX) : 0;
+
+            std::fill(rowVoxels, rowVoxels + ROW_WIDTH, 0.0f);
+            if (rowLength == 0)
+                continue;
+
+            if (block.inside)
+            {
+                std::fill(rowVoxels, rowVoxels + rowLength, 1.0f);
+                touched += rowLength;
+                out_coverage += (float)rowLength;
+                continue;
+            }
+
+            for (uint32_t lane = 0; lane < ROW_WIDTH; ++lane)
+            {
+                DirectX::XMFLOAT3 center = layout.GetVoxelCenter(firstX + lane, gy, gz);
+                x[lane] = center.x;
+                y[lane] = center.y;
+                z[lane] = center.z;
+            }
+
+            ClassifyPoints8(blockPlanes, x, y, z, 1.0f, outer, inner);
+            for (uint32_t lane = 0; lane < rowLength; ++lane)
+            {
+                if (outer[lane] > 0.0f)
+                    continue;
+
+                float coverage = 1.0f;
+                if (inner[lane] > 0.0f)
+                {
+                    const DirectX::XMFLOAT3 center(x[lane], y[lane], z[lane]);
+                    GetStraddlingPlanes(blockPlanes, center, 1.0f, voxelPlanes);
+                    coverage = GetVoxelCoverage(voxelPlanes, center, layout.cell);
+                }
+                rowVoxels[lane] = coverage;
+                out_coverage += coverage;
+                ++touched;
+            }
+        }
+
+        return touched;
+    }
+
+    // Whether any occupancy cell under the world space box may hold cloud
+    bool MayHoldCloud(const CloudDensityGrid& occupancy, const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax)
+    {
+        if (occupancy.emptyDistance.empty())
+            return true;
+
+        // Grid axes are x, z, y in world terms, see CloudDensityGrid
+        const uint32_t size[3] = { occupancy.width, occupancy.height, occupancy.depth };
+        const float lo[3] = { boxMin.x + CLOUD_VOLUME_SIDE_LENGTH * 0.5f, boxMin.z + CLOUD_VOLUME_SIDE_LENGTH * 0.5f, boxMin.y };
+        const float hi[3] = { boxMax.x + CLOUD_VOLUME_SIDE_LENGTH * 0.5f, boxMax.z + CLOUD_VOLUME_SIDE_LENGTH * 0.5f, boxMax.y };
+        const float extent[3] = { CLOUD_VOLUME_SIDE_LENGTH, CLOUD_VOLUME_SIDE_LENGTH, CLOUD_VOLUME_HEIGHT };
+
+        uint32_t first[3], last[3];
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            float cell = extent[axis] / (float)size[axis];
+            first[axis] = (uint32_t)std::clamp(floorf(lo[axis] / cell), 0.0f, (float)(size[axis] - 1));
+            last[axis] = (uint32_t)std::clamp(floorf(hi[axis] / cell), 0.0f, (float)(size[axis] - 1));
+        }
+
+        for (uint32_t z = first[2]; z <= last[2]; ++z)
+            for (uint32_t y = first[1]; y <= last[1]; ++y)
+                for (uint32_t x = first[0]; x <= last[0]; ++x)
+                    if (occupancy.emptyDistance[((size_t)z * occupancy.height + y) * occupancy.width + x] <= 0.0f)
+                        return true;
+
+        return false;
+    }
+}
+
+bool QueryHullVoxelOverlap(const Hull& hull, const std::vector<DirectX::XMFLOAT4>& planes, const DirectX::XMFLOAT4X4& world,
+                           uint32_t width, uint32_t height, uint32_t depth, const CloudDensityGrid* occupancy,
+                           HullVoxelOverlap& out_overlap, uint32_t threadCount)
+{
+    out_overlap.blocks.clear();
+    out_overlap.voxelCoverage.clear();
+
+    if (hull.vertices.empty() || planes.empty() || width == 0 || height == 0 || depth == 0)
+        return false;
+
+    VoxelLayout layout;
+    layout.size[0] = width;
+    layout.size[1] = height;
+    layout.size[2] = depth;
+    layout.cell = DirectX::XMFLOAT3(CLOUD_VOLUME_SIDE_LENGTH / (float)width, CLOUD_VOLUME_HEIGHT / (float)depth, CLOUD_VOLUME_SIDE_LENGTH / (float)height);
+    layout.origin = DirectX::XMFLOAT3(-CLOUD_VOLUME_SIDE_LENGTH * 0.5f, 0.0f, -CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+
+    VoxelPlanes voxelPlanes;
+    if (!TransformPlanes(planes, world, DirectX::XMFLOAT3(layout.cell.x * 0.5f, layout.cell.y * 0.5f, layout.cell.z * 0.5f), voxelPlanes))
+        return false;
+
+    // The hull's box narrows down the blocks to test, in grid order
+    float boxMin[3] = { FLT_MAX, FLT_MAX, FLT_MAX };
+    float boxMax[3] = { -FLT_MAX, -FLT_MAX, -FLT_MAX };
+    for (const DirectX::XMFLOAT3& v : hull.vertices)
+    {
+        const float p[3] = {
+            v.x * world._11 + v.y * world._21 + v.z * world._31 + world._41,
+            v.x * world._13 + v.y * world._23 + v.z * world._33 + world._43,
+            v.x * world._12 + v.y * world._22 + v.z * world._32 + world._42 };
+
+        for (int axis = 0; axis < 3; ++axis)
+        {
+            boxMin[axis] = std::min(boxMin[axis], p[axis]);
+            boxMax[axis] = std::max(boxMax[axis], p[axis]);
+        }
+    }
+
+    const float origin[3] = { layout.origin.x, layout.origin.z, layout.origin.y };
+    const float cell[3] = { layout.cell.x, layout.cell.z, layout.cell.y };
+
+    uint32_t firstBlock[3], lastBlock[3];
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float first = floorf((boxMin[axis] - origin[axis]) / cell[axis]);
+        float last = floorf((boxMax[axis] - origin[axis]) / cell[axis]);
+        if (last < 0.0f || first >= (float)layout.size[axis])
+            return true;
+
+        firstBlock[axis] = (uint32_t)std::max(first, 0.0f) / HULL_VOXEL_BLOCK_SIZE;
+        lastBlock[axis] = (uint32_t)std::min(last, (float)(layout.size[axis] - 1)) / HULL_VOXEL_BLOCK_SIZE;
+    }
+
+    // Whole blocks against the planes, the same test as a voxel with the block's radius
+    const float blockScale = (float)HULL_VOXEL_BLOCK_SIZE;
+    std::vector<CandidateBlock> candidates;
+    for (uint32_t bz = firstBlock[2]; bz <= lastBlock[2]; ++bz)
+    {
+        for (uint32_t by = firstBlock[1]; by <= lastBlock[1]; ++by)
+        {
+            for (uint32_t bx = firstBlock[0]; bx <= lastBlock[0]; ++bx)
+            {
+                DirectX::XMFLOAT3 blockMin = layout.GetVoxelCenter(bx * HULL_VOXEL_BLOCK_SIZE, by * HULL_VOXEL_BLOCK_SIZE, bz * HULL_VOXEL_BLOCK_SIZE);
+                blockMin = DirectX::XMFLOAT3(blockMin.x - layout.cell.x * 0.5f, blockMin.y - layout.cell.y * 0.5f, blockMin.z - layout.cell.z * 0.5f);
+                const DirectX::XMFLOAT3 blockMax(blockMin.x + layout.cell.x * blockScale, blockMin.y + layout.cell.y * blockScale, blockMin.z + layout.cell.z * blockScale);
+                const DirectX::XMFLOAT3 center((blockMin.x + blockMax.x) * 0.5f, (blockMin.y + blockMax.y) * 0.5f, (blockMin.z + blockMax.z) * 0.5f);
+
+                bool outside = false;
+                bool inside = true;
+                for (uint32_t i = 0; i < voxelPlanes.count && !outside; ++i)
+                {
+                    float d = center.x * voxelPlanes.nx[i] + center.y * voxelPlanes.ny[i] + center.z * voxelPlanes.nz[i] + voxelPlanes.w[i];
+                    float r = voxelPlanes.radius[i] * blockScale;
+                    outside = d - r > 0.0f;
+                    inside = inside && d + r <= 0.0f;
+                }
+
+                if (outside || (occupancy && !MayHoldCloud(*occupancy, blockMin, blockMax)))
+                    continue;
+
+                candidates.push_back({ bx, by, bz, center, inside });
+            }
+        }
+    }
+
+    if (candidates.empty())
+        return true;
+
+    std::vector<uint32_t> touched(candidates.size());
+    std::vector<float> coverage(candidates.size());
+    out_overlap.voxelCoverage.resize(candidates.size() * HULL_VOXEL_BLOCK_VOXELS);
+
+    ParallelFor((uint32_t)candidates.size(), threadCount, [&](uint32_t i)
+    {
+        touched[i] = FillBlockCoverage(voxelPlanes, layout, candidates[i], out_overlap.voxelCoverage.data() + (size_t)i * HULL_VOXEL_BLOCK_VOXELS, coverage[i]);
+    });
+
+    // Blocks only the whole block test let through are dropped, their voxels are compacted down over them
+    for (uint32_t i = 0; i < candidates.size(); ++i)
+    {
+        if (touched[i] == 0)
+            continue;
+
+        const CandidateBlock& candidate = candidates[i];
+        uint32_t voxelCount = 1;
+        const uint32_t blockCoords[3] = { candidate.x, candidate.y, candidate.z };
+        for (int axis = 0; axis < 3; ++axis)
+            voxelCount *= std::min(HULL_VOXEL_BLOCK_SIZE, layout.size[axis] - blockCoords[axis] * HULL_VOXEL_BLOCK_SIZE);
+
+        const uint32_t slot = (uint32_t)out_overlap.blocks.size();
+        if (slot != i)
+        {
+            memcpy(out_overlap.voxelCoverage.data() + (size_t)slot * HULL_VOXEL_BLOCK_VOXELS,
+                   out_overlap.voxelCoverage.data() + (size_t)i * HULL_VOXEL_BLOCK_VOXELS, HULL_VOXEL_BLOCK_VOXELS * sizeof(float));
+        }
+        out_overlap.blocks.push_back({ candidate.x, candidate.y, candidate.z, coverage[i] / (float)voxelCount });
+    }
+
+    out_overlap.voxelCoverage.resize(out_overlap.blocks.size() * HULL_VOXEL_BLOCK_VOXELS);
+    return true;
+}
+
+}
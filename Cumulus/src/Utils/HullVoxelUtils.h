@@ -0,0 +1,53 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Which voxels of the cloud volume a placed hull touches, for
+carving or disturbing the clouds locally. The volume is walked in blocks of
+8x8x8 voxels. Blocks are culled against the hull's planes and, optionally,
+the occupancy of the coarse density grid. Each row of 8 voxels in a surviving
+block then gets one 8-wide plane test. Voxels the hull's surface passes
+through are subsampled for their coverage.
+----------------------------------------------*/
+#ifndef MUON_HULLVOXELUTILS_H
+#define MUON_HULLVOXELUTILS_H
+
+#include <Core/Hull.h>
+#include <Utils/CloudLightingUtils.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Voxels per block side, so each block row is one 8-wide plane test
+    static const uint32_t HULL_VOXEL_BLOCK_SIZE = 8;
+    static const uint32_t HULL_VOXEL_BLOCK_VOXELS = HULL_VOXEL_BLOCK_SIZE * HULL_VOXEL_BLOCK_SIZE * HULL_VOXEL_BLOCK_SIZE;
+
+    struct HullVoxelBlock
+    {
+        uint32_t x, y, z;   // In the grid's layout (x, world z, world y), the first voxel is HULL_VOXEL_BLOCK_SIZE times this
+        float coverage;     // Fraction of the block's voxels, within the grid, that is inside the hull
+    };
+
+    struct HullVoxelOverlap
+    {
+        std::vector<HullVoxelBlock> blocks;
+
+        // HULL_VOXEL_BLOCK_VOXELS per block, in block order, x fastest like the grid. Voxels past the grid's edge are 0.
+        std::vector<float> voxelCoverage;
+    };
+
+    // Every block of a width x height x depth voxel grid with the NVDF layout that the hull may touch, with its voxels' coverage.
+    // Conservative, a block or voxel the hull touches is never dropped, though the coverage of one it only grazes can be 0.
+    // planes come from hull.GetPlanes(), world takes the hull into world space like the single cloud volume's.
+    // Cloud instances can fold their world to volume transform into world.
+    // occupancy is optional, blocks over cells it knows to be empty are skipped since there is nothing to edit.
+    // Blocks are shared out between threadCount threads, 0 uses every hardware thread.
+    bool QueryHullVoxelOverlap(const Hull& hull, const std::vector<DirectX::XMFLOAT4>& planes, const DirectX::XMFLOAT4X4& world,
+                               uint32_t width, uint32_t height, uint32_t depth, const CloudDensityGrid* occupancy,
+                               HullVoxelOverlap& out_overlap, uint32_t threadCount = 0);
+}
+
+#endif
@@ -0,0 +1,45 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Splitting CPU loops over worker threads
+----------------------------------------------*/
+#ifndef MUON_PARALLELUTILS_H
+#define MUON_PARALLELUTILS_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace Muon
+{
+    // Runs fn(i) for every i in [0, count), shared out between threads. Each thread takes the next i as it finishes one,
+    // so uneven iterations still balance. threadCount 0 uses every hardware thread, the caller's thread is one of them.
+    template <typename Fn>
+    void ParallelFor(uint32_t count, uint32_t threadCount, const Fn& fn)
+    {
+        std::atomic<uint32_t> next(0);
+        auto Worker = [&]()
+        {
+            for (uint32_t i = next++; i < count; i = next++)
+                fn(i);
+        };
+
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+        threadCount = std::max(1u, std::min(threadCount, count));
+
+        std::vector<std::thread> workers;
+        workers.reserve(threadCount - 1);
+        for (uint32_t i = 1; i < threadCount; ++i)
+            workers.emplace_back(Worker);
+
+        Worker();
+
+        for (std::thread& worker : workers)
+            worker.join();
+    }
+}
+
+#endif
@@ -0,0 +1,363 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of PointCloudUtils.h
+----------------------------------------------*/
+#include <Utils/PointCloudUtils.h>
+
+#include <cfloat>
+#include <cmath>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+namespace Muon
+{
+namespace
+{
+    // Reduces per-lane winners, keeping the lowest index among equal values
+    uint32_t ReduceLanes(const float values[POINT_BATCH_WIDTH], const uint32_t indices[POINT_BATCH_WIDTH], bool findMax, float& out_value)
+    {
+        uint32_t best = 0;
+        for (uint32_t lane = 1; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            bool better = findMax ? values[lane] > values[best] : values[lane] < values[best];
+            if (better || (values[lane] == values[best] && indices[lane] < indices[best]))
+                best = lane;
+        }
+
+        out_value = values[best];
+        return indices[best];
+    }
+}
+
+void BuildPointCloudSoA(const DirectX::XMFLOAT3* points, uint32_t count, PointCloudSoA& out_cloud)
+{
+    const uint32_t padded = GetPaddedPointCount(count);
+    out_cloud.count = count;
+    out_cloud.x.resize(padded);
+    out_cloud.y.resize(padded);
+    out_cloud.z.resize(padded);
+
+    for (uint32_t i = 0; i < padded; ++i)
+    {
+        const DirectX::XMFLOAT3& p = points[i < count ? i : count - 1];
+        out_cloud.x[i] = p.x;
+        out_cloud.y[i] = p.y;
+        out_cloud.z[i] = p.z;
+    }
+}
+
+void FindExtremePoints(const PointCloudSoA& cloud, uint32_t out_min[3], uint32_t out_max[3])
+{
+    const std::vector<float>* axes[3] = { &cloud.x, &cloud.y, &cloud.z };
+    const uint32_t padded = GetPaddedPointCount(cloud.count);
+
+    for (uint32_t axis = 0; axis < 3; ++axis)
+    {
+        const float* values = axes[axis]->data();
+
+        float minValues[POINT_BATCH_WIDTH], maxValues[POINT_BATCH_WIDTH];
+        uint32_t minIndices[POINT_BATCH_WIDTH], maxIndices[POINT_BATCH_WIDTH];
+
+#if defined(__AVX2__)
+        __m256 vMin = _mm256_set1_ps(FLT_MAX);
+        __m256 vMax = _mm256_set1_ps(-FLT_MAX);
+        __m256i vMinIdx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+        __m256i vMaxIdx = vMinIdx;
+        __m256i vIdx = vMinIdx;
+        const __m256i vStep = _mm256_set1_epi32((int)POINT_BATCH_WIDTH);
+
+        for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+        {
+            __m256 v = _mm256_loadu_ps(values + base);
+
+            __m256 lower = _mm256_cmp_ps(v, vMin, _CMP_LT_OQ);
+            vMin = _mm256_blendv_ps(vMin, v, lower);
+            vMinIdx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(vMinIdx), _mm256_castsi256_ps(vIdx), lower));
+
+            __m256 higher = _mm256_cmp_ps(v, vMax, _CMP_GT_OQ);
+            vMax = _mm256_blendv_ps(vMax, v, higher);
+            vMaxIdx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(vMaxIdx), _mm256_castsi256_ps(vIdx), higher));
+
+            vIdx = _mm256_add_epi32(vIdx, vStep);
+        }
+
+        _mm256_storeu_ps(minValues, vMin);
+        _mm256_storeu_ps(maxValues, vMax);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(minIndices), vMinIdx);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(maxIndices), vMaxIdx);
+#else
+        for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            minValues[lane] = FLT_MAX;
+            maxValues[lane] = -FLT_MAX;
+            minIndices[lane] = maxIndices[lane] = lane;
+        }
+
+        for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+        {
+            for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+            {
+                float v = values[base + lane];
+                if (v < minValues[lane]) { minValues[lane] = v; minIndices[lane] = base + lane; }
+                if (v > maxValues[lane]) { maxValues[lane] = v; maxIndices[lane] = base + lane; }
+            }
+        }
+#endif
+
+        float unused;
+        out_min[axis] = ReduceLanes(minValues, minIndices, false, unused);
+        out_max[axis] = ReduceLanes(maxValues, maxIndices, true, unused);
+    }
+}
+
+uint32_t FindFurthestFromLine(const PointCloudSoA& cloud, const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, float& out_distanceSq)
+{
+    // |(p - o) x d|^2 / |d|^2
+    const float invLengthSq = 1.0f / (dir.x * dir.x + dir.y * dir.y + dir.z * dir.z);
+    const uint32_t padded = GetPaddedPointCount(cloud.count);
+
+    float bestValues[POINT_BATCH_WIDTH];
+    uint32_t bestIndices[POINT_BATCH_WIDTH];
+
+#if defined(__AVX2__)
+    const __m256 ox = _mm256_set1_ps(origin.x), oy = _mm256_set1_ps(origin.y), oz = _mm256_set1_ps(origin.z);
+    const __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+    const __m256 vInvLengthSq = _mm256_set1_ps(invLengthSq);
+
+    __m256 vBest = _mm256_set1_ps(-FLT_MAX);
+    __m256i vBestIdx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i vIdx = vBestIdx;
+    const __m256i vStep = _mm256_set1_epi32((int)POINT_BATCH_WIDTH);
+
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        __m256 px = _mm256_sub_ps(_mm256_loadu_ps(cloud.x.data() + base), ox);
+        __m256 py = _mm256_sub_ps(_mm256_loadu_ps(cloud.y.data() + base), oy);
+        __m256 pz = _mm256_sub_ps(_mm256_loadu_ps(cloud.z.data() + base), oz);
+
+        __m256 cx = _mm256_sub_ps(_mm256_mul_ps(py, dz), _mm256_mul_ps(pz, dy));
+        __m256 cy = _mm256_sub_ps(_mm256_mul_ps(pz, dx), _mm256_mul_ps(px, dz));
+        __m256 cz = _mm256_sub_ps(_mm256_mul_ps(px, dy), _mm256_mul_ps(py, dx));
+        __m256 distSq = _mm256_mul_ps(_mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(cx, cx), _mm256_mul_ps(cy, cy)), _mm256_mul_ps(cz, cz)), vInvLengthSq);
+
+        __m256 further = _mm256_cmp_ps(distSq, vBest, _CMP_GT_OQ);
+        vBest = _mm256_blendv_ps(vBest, distSq, further);
+        vBestIdx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(vBestIdx), _mm256_castsi256_ps(vIdx), further));
+        vIdx = _mm256_add_epi32(vIdx, vStep);
+    }
+
+    _mm256_storeu_ps(bestValues, vBest);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bestIndices), vBestIdx);
+#else
+    for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+    {
+        bestValues[lane] = -FLT_MAX;
+        bestIndices[lane] = lane;
+    }
+
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            uint32_t i = base + lane;
+            float px = cloud.x[i] - origin.x, py = cloud.y[i] - origin.y, pz = cloud.z[i] - origin.z;
+            float cx = py * dir.z - pz * dir.y;
+            float cy = pz * dir.x - px * dir.z;
+            float cz = px * dir.y - py * dir.x;
+            float distSq = (cx * cx + cy * cy + cz * cz) * invLengthSq;
+            if (distSq > bestValues[lane])
+            {
+                bestValues[lane] = distSq;
+                bestIndices[lane] = i;
+            }
+        }
+    }
+#endif
+
+    return ReduceLanes(bestValues, bestIndices, true, out_distanceSq);
+}
+
+uint32_t FindFurthestFromPlane(const PointCloudSoA& cloud, const DirectX::XMFLOAT4& plane, float& out_distance)
+{
+    const uint32_t padded = GetPaddedPointCount(cloud.count);
+
+    float bestValues[POINT_BATCH_WIDTH];
+    uint32_t bestIndices[POINT_BATCH_WIDTH];
+
+#if defined(__AVX2__)
+    const __m256 nx = _mm256_set1_ps(plane.x), ny = _mm256_set1_ps(plane.y), nz = _mm256_set1_ps(plane.z), nw = _mm256_set1_ps(plane.w);
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+
+    __m256 vBest = _mm256_set1_ps(-FLT_MAX);
+    __m256i vBestIdx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i vIdx = vBestIdx;
+    const __m256i vStep = _mm256_set1_epi32((int)POINT_BATCH_WIDTH);
+
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(nx, _mm256_loadu_ps(cloud.x.data() + base)),
+            _mm256_mul_ps(ny, _mm256_loadu_ps(cloud.y.data() + base))),
+            _mm256_mul_ps(nz, _mm256_loadu_ps(cloud.z.data() + base))), nw);
+        d = _mm256_andnot_ps(signMask, d);
+
+        __m256 further = _mm256_cmp_ps(d, vBest, _CMP_GT_OQ);
+        vBest = _mm256_blendv_ps(vBest, d, further);
+        vBestIdx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(vBestIdx), _mm256_castsi256_ps(vIdx), further));
+        vIdx = _mm256_add_epi32(vIdx, vStep);
+    }
+
+    _mm256_storeu_ps(bestValues, vBest);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bestIndices), vBestIdx);
+#else
+    for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+    {
+        bestValues[lane] = -FLT_MAX;
+        bestIndices[lane] = lane;
+    }
+
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            uint32_t i = base + lane;
+            float d = fabsf(plane.x * cloud.x[i] + plane.y * cloud.y[i] + plane.z * cloud.z[i] + plane.w);
+            if (d > bestValues[lane])
+            {
+                bestValues[lane] = d;
+                bestIndices[lane] = i;
+            }
+        }
+    }
+#endif
+
+    return ReduceLanes(bestValues, bestIndices, true, out_distance);
+}
+
+uint32_t FindSupportPoint(const PointCloudSoA& cloud, const DirectX::XMFLOAT3& dir, float& out_dot)
+{
+    const uint32_t padded = GetPaddedPointCount(cloud.count);
+
+    float bestValues[POINT_BATCH_WIDTH];
+    uint32_t bestIndices[POINT_BATCH_WIDTH];
+
+#if defined(__AVX2__)
+    const __m256 dx = _mm256_set1_ps(dir.x), dy = _mm256_set1_ps(dir.y), dz = _mm256_set1_ps(dir.z);
+
+    __m256 vBest = _mm256_set1_ps(-FLT_MAX);
+    __m256i vBestIdx = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+    __m256i vIdx = vBestIdx;
+    const __m256i vStep = _mm256_set1_epi32((int)POINT_BATCH_WIDTH);
+
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        __m256 d = _mm256_add_ps(_mm256_add_ps(
+            _mm256_mul_ps(dx, _mm256_loadu_ps(cloud.x.data() + base)),
+            _mm256_mul_ps(dy, _mm256_loadu_ps(cloud.y.data() + base))),
+            _mm256_mul_ps(dz, _mm256_loadu_ps(cloud.z.data() + base)));
+
+        __m256 further = _mm256_cmp_ps(d, vBest, _CMP_GT_OQ);
+        vBest = _mm256_blendv_ps(vBest, d, further);
+        vBestIdx = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(vBestIdx), _mm256_castsi256_ps(vIdx), further));
+        vIdx = _mm256_add_epi32(vIdx, vStep);
+    }
+
+    _mm256_storeu_ps(bestValues, vBest);
+    _mm256_storeu_si256(reinterpret_cast<__m256i*>(bestIndices), vBestIdx);
+#else
+    for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+    {
+        bestValues[lane] = -FLT_MAX;
+        bestIndices[lane] = lane;
+    }
+
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            uint32_t i = base + lane;
+            float d = dir.x * cloud.x[i] + dir.y * cloud.y[i] + dir.z * cloud.z[i];
+            if (d > bestValues[lane])
+            {
+                bestValues[lane] = d;
+                bestIndices[lane] = i;
+            }
+        }
+    }
+#endif
+
+    return ReduceLanes(bestValues, bestIndices, true, out_dot);
+}
+
+void AssignPointsToPlanes(const float* x, const float* y, const float* z, uint32_t count,
+                          const DirectX::XMFLOAT4* planes, uint32_t planeCount, float minDistance,
+                          int32_t* out_plane, float* out_distance)
+{
+    const uint32_t padded = GetPaddedPointCount(count);
+
+#if defined(__AVX2__)
+    const __m256 vMinDistance = _mm256_set1_ps(minDistance);
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        const __m256 px = _mm256_loadu_ps(x + base);
+        const __m256 py = _mm256_loadu_ps(y + base);
+        const __m256 pz = _mm256_loadu_ps(z + base);
+
+        __m256 bestDistance = vMinDistance;
+        __m256i bestPlane = _mm256_set1_epi32(-1);
+
+        for (uint32_t p = 0; p < planeCount; ++p)
+        {
+            const DirectX::XMFLOAT4& plane = planes[p];
+            __m256 d = _mm256_add_ps(_mm256_add_ps(_mm256_add_ps(
+                _mm256_mul_ps(_mm256_set1_ps(plane.x), px),
+                _mm256_mul_ps(_mm256_set1_ps(plane.y), py)),
+                _mm256_mul_ps(_mm256_set1_ps(plane.z), pz)), _mm256_set1_ps(plane.w));
+
+            __m256 further = _mm256_cmp_ps(d, bestDistance, _CMP_GT_OQ);
+            bestDistance = _mm256_blendv_ps(bestDistance, d, further);
+            bestPlane = _mm256_castps_si256(_mm256_blendv_ps(_mm256_castsi256_ps(bestPlane), _mm256_castsi256_ps(_mm256_set1_epi32((int)p)), further));
+        }
+
+        _mm256_storeu_ps(out_distance + base, bestDistance);
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(out_plane + base), bestPlane);
+    }
+#else
+    for (uint32_t base = 0; base < padded; base += POINT_BATCH_WIDTH)
+    {
+        float bestDistance[POINT_BATCH_WIDTH];
+        int32_t bestPlane[POINT_BATCH_WIDTH];
+        for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            bestDistance[lane] = minDistance;
+            bestPlane[lane] = -1;
+        }
+
+        for (uint32_t p = 0; p < planeCount; ++p)
+        {
+            const DirectX::XMFLOAT4& plane = planes[p];
+            for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+            {
+                uint32_t i = base + lane;
+                float d = plane.x * x[i] + plane.y * y[i] + plane.z * z[i] + plane.w;
+                if (d > bestDistance[lane])
+                {
+                    bestDistance[lane] = d;
+                    bestPlane[lane] = (int32_t)p;
+                }
+            }
+        }
+
+        for (uint32_t lane = 0; lane < POINT_BATCH_WIDTH; ++lane)
+        {
+            out_distance[base + lane] = bestDistance[lane];
+            out_plane[base + lane] = bestPlane[lane];
+        }
+    }
+#endif
+}
+
+}
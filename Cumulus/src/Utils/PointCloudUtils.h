@@ -0,0 +1,55 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Structure of arrays point clouds and the 8-wide kernels hull
+construction runs over them. Every kernel walks the points in blocks of
+POINT_BATCH_WIDTH lanes, as AVX2 when the build enables it and as plain loops
+over the same lanes otherwise, so both paths pick the same points.
+----------------------------------------------*/
+#ifndef MUON_POINTCLOUDUTILS_H
+#define MUON_POINTCLOUDUTILS_H
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    static const uint32_t POINT_BATCH_WIDTH = 8;
+
+    inline uint32_t GetPaddedPointCount(uint32_t count) { return (count + POINT_BATCH_WIDTH - 1) / POINT_BATCH_WIDTH * POINT_BATCH_WIDTH; }
+
+    // Arrays are padded to a multiple of POINT_BATCH_WIDTH by repeating the last point
+    struct PointCloudSoA
+    {
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> z;
+        uint32_t count = 0;
+    };
+
+    // points is tightly packed xyz, like aiVector3D arrays
+    void BuildPointCloudSoA(const DirectX::XMFLOAT3* points, uint32_t count, PointCloudSoA& out_cloud);
+
+    // Indices of the lowest and highest point along x, y and z. Ties go to the lowest index.
+    void FindExtremePoints(const PointCloudSoA& cloud, uint32_t out_min[3], uint32_t out_max[3]);
+
+    // Point with the largest squared distance to the line through origin along dir (any length)
+    uint32_t FindFurthestFromLine(const PointCloudSoA& cloud, const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, float& out_distanceSq);
+
+    // Point with the largest |n.p + w|, plane normal in xyz
+    uint32_t FindFurthestFromPlane(const PointCloudSoA& cloud, const DirectX::XMFLOAT4& plane, float& out_distance);
+
+    // Point with the largest dir.p, the support point of the cloud's hull along dir
+    uint32_t FindSupportPoint(const PointCloudSoA& cloud, const DirectX::XMFLOAT3& dir, float& out_dot);
+
+    // For each point, the plane it is furthest above, counting only planes it is more than minDistance above.
+    // Points above none of them get -1. x, y, z, out_plane and out_distance are read/written up to
+    // GetPaddedPointCount(count), padding lanes are computed but meaningless.
+    void AssignPointsToPlanes(const float* x, const float* y, const float* z, uint32_t count,
+                              const DirectX::XMFLOAT4* planes, uint32_t planeCount, float minDistance,
+                              int32_t* out_plane, float* out_distance);
+}
+
+#endif
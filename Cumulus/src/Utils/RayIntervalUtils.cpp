@@ -0,0 +1,246 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of RayIntervalUtils.h
+----------------------------------------------*/
+#include <Utils/RayIntervalUtils.h>
+
+#include <Utils/RaymarchUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    // Bricks are clipped here in view space before projecting. Anything in the frustum closer than this is
+    // within CLOUD_BRICK_NEAR_PLANE * sqrt(1 + tanX^2 + tanY^2) of the eye, so bricks that close cover the whole screen.
+    static const float CLOUD_BRICK_NEAR_PLANE = 0.1f;
+
+    DirectX::XMFLOAT3 TransformPoint(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT4X4& m)
+    {
+        return DirectX::XMFLOAT3(
+            p.x * m._11 + p.y * m._21 + p.z * m._31 + m._41,
+            p.x * m._12 + p.y * m._22 + p.z * m._32 + m._42,
+            p.x * m._13 + p.y * m._23 + p.z * m._33 + m._43);
+    }
+
+    float DistanceToBox(const DirectX::XMFLOAT3& p, const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax)
+    {
+        float dx = std::max(std::max(boxMin.x - p.x, p.x - boxMax.x), 0.0f);
+        float dy = std::max(std::max(boxMin.y - p.y, p.y - boxMax.y), 0.0f);
+        float dz = std::max(std::max(boxMin.z - p.z, p.z - boxMax.z), 0.0f);
+        return sqrtf(dx * dx + dy * dy + dz * dz);
+    }
+}
+
+void BuildCloudBricks(const CloudDensityGrid& grid, std::vector<CloudBrick>& out_bricks)
+{
+    out_bricks.clear();
+    if (grid.emptyDistance.empty())
+        return;
+
+    const DirectX::XMFLOAT3 volumeMin(-CLOUD_VOLUME_SIDE_LENGTH * 0.5f, 0.0f, -CLOUD_VOLUME_SIDE_LENGTH * 0.5f);
+    const DirectX::XMFLOAT3 cellSize(
+        CLOUD_VOLUME_SIDE_LENGTH / (float)grid.width,
+        CLOUD_VOLUME_HEIGHT / (float)grid.depth,
+        CLOUD_VOLUME_SIDE_LENGTH / (float)grid.height);
+
+    // Grid axes are x, z, y in world terms, see CloudDensityGrid
+    const uint32_t cellsX = (grid.width + CLOUD_BRICKS_XZ - 1) / CLOUD_BRICKS_XZ;
+    const uint32_t cellsZ = (grid.height + CLOUD_BRICKS_XZ - 1) / CLOUD_BRICKS_XZ;
+    const uint32_t cellsY = (grid.depth + CLOUD_BRICKS_Y - 1) / CLOUD_BRICKS_Y;
+
+    for (uint32_t by = 0; by < CLOUD_BRICKS_Y; ++by)
+    {
+        for (uint32_t bz = 0; bz < CLOUD_BRICKS_XZ; ++bz)
+        {
+            for (uint32_t bx = 0; bx < CLOUD_BRICKS_XZ; ++bx)
+            {
+                uint32_t minCell[3] = { UINT32_MAX, UINT32_MAX, UINT32_MAX };
+                uint32_t maxCell[3] = { 0, 0, 0 };
+                bool occupied = false;
+
+                for (uint32_t z = by * cellsY; z < std::min((by + 1) * cellsY, grid.depth); ++z)
+                {
+                    for (uint32_t y = bz * cellsZ; y < std::min((bz + 1) * cellsZ, grid.height); ++y)
+                    {
+                        for (uint32_t x = bx * cellsX; x < std::min((bx + 1) * cellsX, grid.width); ++x)
+                        {
+                            if (grid.emptyDistance[((size_t)z * grid.height + y) * grid.width + x] > 0.0f)
+                                continue;
+
+                            const uint32_t cell[3] = { x, z, y };
+                            for (int axis = 0; axis < 3; ++axis)
+                            {
+                                minCell[axis] = std::min(minCell[axis], cell[axis]);
+                                maxCell[axis] = std::max(maxCell[axis], cell[axis]);
+                            }
+                            occupied = true;
+                        }
+                    }
+                }
+
+                if (!occupied)
+                    continue;
+
+                CloudBrick brick;
+                brick.minBounds = DirectX::XMFLOAT3(
+                    volumeMin.x + (float)minCell[0] * cellSize.x,
+                    volumeMin.y + (float)minCell[1] * cellSize.y,
+                    volumeMin.z + (float)minCell[2] * cellSize.z);
+                brick.maxBounds = DirectX::XMFLOAT3(
+                    volumeMin.x + (float)(maxCell[0] + 1) * cellSize.x,
+                    volumeMin.y + (float)(maxCell[1] + 1) * cellSize.y,
+                    volumeMin.z + (float)(maxCell[2] + 1) * cellSize.z);
+                out_bricks.push_back(brick);
+            }
+        }
+    }
+}
+
+bool RayBoxIntersect(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax,
+                     float& out_tEnter, float& out_tExit)
+{
+    const float o[3] = { origin.x, origin.y, origin.z };
+    const float d[3] = { dir.x, dir.y, dir.z };
+    const float lo[3] = { boxMin.x, boxMin.y, boxMin.z };
+    const float hi[3] = { boxMax.x, boxMax.y, boxMax.z };
+
+    float tEnter = -INFINITY;
+    float tExit = INFINITY;
+    for (int axis = 0; axis < 3; ++axis)
+    {
+        float invDir = 1.0f / d[axis];
+        float t0 = (lo[axis] - o[axis]) * invDir;
+        float t1 = (hi[axis] - o[axis]) * invDir;
+
+        // fmin/fmax drop the NaN of a ray lying in a slab plane, like min/max do on the GPU
+        tEnter = fmaxf(tEnter, fminf(t0, t1));
+        tExit = fminf(tExit, fmaxf(t0, t1));
+    }
+
+    out_tEnter = tEnter;
+    out_tExit = tExit;
+    return tExit > std::max(tEnter, 0.0f);
+}
+
+bool GetBrickPixelRect(const CloudBrick& brick, const DirectX::XMFLOAT3& eyePos, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& proj,
+                       uint32_t fullWidth, uint32_t fullHeight, DirectX::XMUINT2& out_min, DirectX::XMUINT2& out_max)
+{
+    const float tanHalfFovX = 1.0f / proj._11;
+    const float tanHalfFovY = 1.0f / proj._22;
+
+    DirectX::XMFLOAT3 cornersVS[8];
+    float maxZ = -INFINITY;
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        DirectX::XMFLOAT3 corner(
+            (i & 1) ? brick.maxBounds.x : brick.minBounds.x,
+            (i & 2) ? brick.maxBounds.y : brick.minBounds.y,
+            (i & 4) ? brick.maxBounds.z : brick.minBounds.z);
+        cornersVS[i] = TransformPoint(corner, view);
+        maxZ = std::max(maxZ, cornersVS[i].z);
+    }
+
+    if (maxZ < CLOUD_BRICK_NEAR_PLANE)
+        return false;
+
+    out_min = DirectX::XMUINT2(0, 0);
+    out_max = DirectX::XMUINT2(fullWidth - 1, fullHeight - 1);
+
+    if (DistanceToBox(eyePos, brick.minBounds, brick.maxBounds) <= CLOUD_BRICK_NEAR_PLANE * sqrtf(1.0f + tanHalfFovX * tanHalfFovX + tanHalfFovY * tanHalfFovY))
+        return true;
+
+    // Project the corners in front of the near plane, and where the edges cross it
+    float minX = INFINITY, minY = INFINITY;
+    float maxX = -INFINITY, maxY = -INFINITY;
+    auto addPoint = [&](const DirectX::XMFLOAT3& p)
+    {
+        float u = p.x / (p.z * tanHalfFovX);
+        float v = p.y / (p.z * tanHalfFovY);
+        float px = (u + 1.0f) * 0.5f * (float)fullWidth - 0.5f;
+        float py = (1.0f - v) * 0.5f * (float)fullHeight - 0.5f;
+        minX = std::min(minX, px); maxX = std::max(maxX, px);
+        minY = std::min(minY, py); maxY = std::max(maxY, py);
+    };
+
+    for (uint32_t i = 0; i < 8; ++i)
+    {
+        const DirectX::XMFLOAT3& a = cornersVS[i];
+        if (a.z >= CLOUD_BRICK_NEAR_PLANE)
+            addPoint(a);
+
+        for (uint32_t axisBit = 1; axisBit < 8; axisBit <<= 1)
+        {
+            if (i & axisBit)
+                continue;
+
+            const DirectX::XMFLOAT3& b = cornersVS[i | axisBit];
+            if ((a.z < CLOUD_BRICK_NEAR_PLANE) == (b.z < CLOUD_BRICK_NEAR_PLANE))
+                continue;
+
+            float s = (CLOUD_BRICK_NEAR_PLANE - a.z) / (b.z - a.z);
+            addPoint(DirectX::XMFLOAT3(a.x + (b.x - a.x) * s, a.y + (b.y - a.y) * s, CLOUD_BRICK_NEAR_PLANE));
+        }
+    }
+
+    // Pixel centers inside the projected hull, widened a pixel to absorb rounding
+    minX = floorf(minX) - 1.0f; minY = floorf(minY) - 1.0f;
+    maxX = ceilf(maxX) + 1.0f; maxY = ceilf(maxY) + 1.0f;
+    if (maxX < 0.0f || maxY < 0.0f || minX > (float)(fullWidth - 1) || minY > (float)(fullHeight - 1))
+        return false;
+
+    out_min = DirectX::XMUINT2((uint32_t)std::max(minX, 0.0f), (uint32_t)std::max(minY, 0.0f));
+    out_max = DirectX::XMUINT2((uint32_t)std::min(maxX, (float)(fullWidth - 1)), (uint32_t)std::min(maxY, (float)(fullHeight - 1)));
+    return true;
+}
+
+void BuildCloudRayIntervals(const std::vector<CloudBrick>& bricks, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4X4& invView,
+                            uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset,
+                            uint32_t marchWidth, uint32_t marchHeight, std::vector<DirectX::XMFLOAT2>& out_intervals)
+{
+    out_intervals.assign((size_t)marchWidth * marchHeight, DirectX::XMFLOAT2(CLOUD_RAY_NO_ENTER, CLOUD_RAY_NO_EXIT));
+
+    const DirectX::XMFLOAT4X4& iv = invView;
+    const DirectX::XMFLOAT3 eyePos(iv._41, iv._42, iv._43);
+
+    for (const CloudBrick& brick : bricks)
+    {
+        DirectX::XMUINT2 pixelMin, pixelMax;
+        if (!GetBrickPixelRect(brick, eyePos, view, proj, fullWidth, fullHeight, pixelMin, pixelMax))
+            continue;
+
+        // March texels whose pixel lands in the rectangle. The last row/column may be clamped onto the edge pixel.
+        int32_t marchMinX = ((int32_t)pixelMin.x - marchOffset.x + (int32_t)divisor - 1) / (int32_t)divisor;
+        int32_t marchMinY = ((int32_t)pixelMin.y - marchOffset.y + (int32_t)divisor - 1) / (int32_t)divisor;
+        int32_t marchMaxX = pixelMax.x >= fullWidth - 1 ? (int32_t)marchWidth - 1 : ((int32_t)pixelMax.x - marchOffset.x) / (int32_t)divisor;
+        int32_t marchMaxY = pixelMax.y >= fullHeight - 1 ? (int32_t)marchHeight - 1 : ((int32_t)pixelMax.y - marchOffset.y) / (int32_t)divisor;
+        marchMaxX = std::min(marchMaxX, (int32_t)marchWidth - 1);
+        marchMaxY = std::min(marchMaxY, (int32_t)marchHeight - 1);
+
+        for (int32_t marchY = std::max(marchMinY, 0); marchY <= marchMaxY; ++marchY)
+        {
+            for (int32_t marchX = std::max(marchMinX, 0); marchX <= marchMaxX; ++marchX)
+            {
+                DirectX::XMUINT2 pixel = GetMarchPixelCoord((uint32_t)marchX, (uint32_t)marchY, fullWidth, fullHeight, divisor, marchOffset);
+                DirectX::XMFLOAT3 viewDir = GetViewRayDirection((float)pixel.x, (float)pixel.y, (float)fullWidth, (float)fullHeight, proj);
+                DirectX::XMFLOAT3 dir(
+                    viewDir.x * iv._11 + viewDir.y * iv._21 + viewDir.z * iv._31,
+                    viewDir.x * iv._12 + viewDir.y * iv._22 + viewDir.z * iv._32,
+                    viewDir.x * iv._13 + viewDir.y * iv._23 + viewDir.z * iv._33);
+
+                float tEnter, tExit;
+                if (!RayBoxIntersect(eyePos, dir, brick.minBounds, brick.maxBounds, tEnter, tExit))
+                    continue;
+
+                DirectX::XMFLOAT2& interval = out_intervals[(size_t)marchY * marchWidth + marchX];
+                interval.x = std::min(interval.x, std::max(tEnter, 0.0f));
+                interval.y = std::max(interval.y, tExit);
+            }
+        }
+    }
+}
+
+}
@@ -0,0 +1,55 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Per-ray cloud intervals from the occupied bricks of the volume.
+The volume is split into a fixed grid of bricks, each shrunk to the cells
+that may hold cloud. Every brick is splatted over the march texels its screen
+rectangle covers, keeping the nearest entry and furthest exit per ray.
+CPU mirror of CloudRayIntervals.cs.hlsl
+----------------------------------------------*/
+#ifndef MUON_RAYINTERVALUTILS_H
+#define MUON_RAYINTERVALUTILS_H
+
+#include <Utils/CloudLightingUtils.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // Bricks per side of the volume. 16 x 4 x 16 fits the cbuffer in CloudRayIntervals.cs.hlsl
+    static const uint32_t CLOUD_BRICKS_XZ = 16;
+    static const uint32_t CLOUD_BRICKS_Y = 4;
+    static const uint32_t MAX_CLOUD_BRICKS = CLOUD_BRICKS_XZ * CLOUD_BRICKS_XZ * CLOUD_BRICKS_Y;
+
+    // Interval of a ray that touches no brick
+    static const float CLOUD_RAY_NO_ENTER = 3.402823466e+38f;
+    static const float CLOUD_RAY_NO_EXIT = 0.0f;
+
+    struct CloudBrick
+    {
+        DirectX::XMFLOAT3 minBounds;
+        DirectX::XMFLOAT3 maxBounds;
+    };
+
+    // Bounds of the cells in each brick that may hold cloud (empty distance <= 0). Bricks without any are dropped.
+    void BuildCloudBricks(const CloudDensityGrid& grid, std::vector<CloudBrick>& out_bricks);
+
+    // Ray/box slab test. Mirrors RayBoxIntersect() in CloudVolume.hlsli.
+    bool RayBoxIntersect(const DirectX::XMFLOAT3& origin, const DirectX::XMFLOAT3& dir, const DirectX::XMFLOAT3& boxMin, const DirectX::XMFLOAT3& boxMax,
+                         float& out_tEnter, float& out_tExit);
+
+    // Inclusive rectangle of full resolution pixels whose rays may hit the brick. Returns false if it is behind the camera.
+    // view/proj are CPU-side (row-vector). Mirrors GetBrickPixelRect() in BoxPixelRect.hlsli.
+    bool GetBrickPixelRect(const CloudBrick& brick, const DirectX::XMFLOAT3& eyePos, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& proj,
+                           uint32_t fullWidth, uint32_t fullHeight, DirectX::XMUINT2& out_min, DirectX::XMUINT2& out_max);
+
+    // Builds [enter, exit] for every march texel, marchWidth x marchHeight. Rays that hit no brick get [CLOUD_RAY_NO_ENTER, CLOUD_RAY_NO_EXIT].
+    void BuildCloudRayIntervals(const std::vector<CloudBrick>& bricks, const DirectX::XMFLOAT4X4& view, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT4X4& invView,
+                                uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset,
+                                uint32_t marchWidth, uint32_t marchHeight, std::vector<DirectX::XMFLOAT2>& out_intervals);
+}
+
+#endif
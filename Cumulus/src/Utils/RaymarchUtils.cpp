@@ -0,0 +1,362 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU mirrors of the math used by the cloud raymarch shaders.
+----------------------------------------------*/
+#include <Utils/RaymarchUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+    // Note: proj is the CPU-side (row-vector) projection, so the shader's proj[2][3] is proj._43 here.
+    float LinearizeDepth(float deviceDepth, const DirectX::XMFLOAT4X4& proj)
+    {
+        if (deviceDepth >= 1.0f)
+            return RAYMARCH_SKY_DISTANCE;
+
+        float denom = deviceDepth - proj._33;
+        if (fabsf(denom) < 1e-12f)
+            return RAYMARCH_SKY_DISTANCE;
+
+        return proj._43 / denom;
+    }
+
+    float LinearizeDepth(float deviceDepth, float nearZ, float farZ)
+    {
+        if (deviceDepth >= 1.0f)
+            return RAYMARCH_SKY_DISTANCE;
+
+        // XMMatrixPerspectiveFovLH: _33 = f / (f - n), _43 = -n * f / (f - n)
+        float range = farZ / (farZ - nearZ);
+        float denom = deviceDepth - range;
+        if (fabsf(denom) < 1e-12f)
+            return RAYMARCH_SKY_DISTANCE;
+
+        return (-range * nearZ) / denom;
+    }
+
+    float DepthToRayDistance(float deviceDepth, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT3& viewDirVS)
+    {
+        if (deviceDepth >= 1.0f || viewDirVS.z <= 0.0f)
+            return RAYMARCH_SKY_DISTANCE;
+
+        // Linear depth is measured along view Z. Stretch it along the ray.
+        return LinearizeDepth(deviceDepth, proj) / viewDirVS.z;
+    }
+
+    DirectX::XMFLOAT3 GetViewRayDirection(float pixelX, float pixelY, float width, float height, const DirectX::XMFLOAT4X4& proj)
+    {
+        float u = ((pixelX + 0.5f) / width) * 2.0f - 1.0f;
+        float v = -(((pixelY + 0.5f) / height) * 2.0f - 1.0f);
+
+        float x = u / proj._11;
+        float y = v / proj._22;
+        float invLen = 1.0f / sqrtf(x * x + y * y + 1.0f);
+
+        return DirectX::XMFLOAT3(x * invLen, y * invLen, invLen);
+    }
+
+    // Keep in sync with CloudUpsampleCommon.hlsli and CloudTemporal.cs.hlsl
+    static const float UPSAMPLE_DEPTH_SHARPNESS = 32.0f;
+    static const float UPSAMPLE_MIN_TOTAL_WEIGHT = 1e-4f;
+    static const float DISOCCLUSION_THRESHOLD = 0.05f;
+
+    DirectX::XMUINT2 GetMarchResolution(uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor)
+    {
+        divisor = std::max(divisor, 1u);
+        return DirectX::XMUINT2((fullWidth + divisor - 1) / divisor, (fullHeight + divisor - 1) / divisor);
+    }
+
+    DirectX::XMINT2 GetCenteredMarchOffset(uint32_t divisor)
+    {
+        return DirectX::XMINT2((int32_t)(divisor / 2), (int32_t)(divisor / 2));
+    }
+
+    DirectX::XMINT2 GetTemporalMarchOffset(uint32_t frameIndex)
+    {
+        // Pixel positions of 0..15 in the 4x4 Bayer matrix. Consecutive frames land far apart within the block.
+        static const DirectX::XMINT2 BAYER_ORDER[CLOUD_TEMPORAL_BLOCK_SIZE * CLOUD_TEMPORAL_BLOCK_SIZE] = {
+            {0, 0}, {2, 2}, {2, 0}, {0, 2},
+            {1, 1}, {3, 3}, {3, 1}, {1, 3},
+            {1, 0}, {3, 2}, {3, 0}, {1, 2},
+            {0, 1}, {2, 3}, {2, 1}, {0, 3}
+        };
+
+        return BAYER_ORDER[frameIndex % (CLOUD_TEMPORAL_BLOCK_SIZE * CLOUD_TEMPORAL_BLOCK_SIZE)];
+    }
+
+    DirectX::XMUINT2 GetMarchPixelCoord(uint32_t marchX, uint32_t marchY, uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset)
+    {
+        uint32_t x = marchX * divisor + (uint32_t)marchOffset.x;
+        uint32_t y = marchY * divisor + (uint32_t)marchOffset.y;
+        return DirectX::XMUINT2(std::min(x, fullWidth - 1), std::min(y, fullHeight - 1));
+    }
+
+    float CloudUpsampleDepthWeight(float lowResDepth, float fullResDepth)
+    {
+        float relativeDiff = fabsf(lowResDepth - fullResDepth) / std::max(std::min(lowResDepth, fullResDepth), 1e-4f);
+        return expf(-relativeDiff * UPSAMPLE_DEPTH_SHARPNESS);
+    }
+
+    DirectX::XMFLOAT4 BilateralUpsampleCloud(const DirectX::XMFLOAT4* lowResCloud, const DirectX::XMFLOAT2* lowResDepth, uint32_t marchWidth, uint32_t marchHeight,
+                                             uint32_t pixelX, uint32_t pixelY, float fullResDepth, uint32_t divisor, DirectX::XMINT2 marchOffset)
+    {
+        if (divisor <= 1)
+            return lowResCloud[pixelY * marchWidth + pixelX];
+
+        // Position in march texels, relative to the pixels the march texels were traced from
+        float marchX = ((float)pixelX - (float)marchOffset.x) / (float)divisor;
+        float marchY = ((float)pixelY - (float)marchOffset.y) / (float)divisor;
+        int baseX = (int)floorf(marchX);
+        int baseY = (int)floorf(marchY);
+        float fx = marchX - (float)baseX;
+        float fy = marchY - (float)baseY;
+
+        DirectX::XMFLOAT4 sum = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        DirectX::XMFLOAT4 closest = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+        float totalWeight = 0.0f;
+        float closestDiff = 1e30f;
+
+        for (int i = 0; i < 4; ++i)
+        {
+            int offsetX = i & 1;
+            int offsetY = i >> 1;
+            int tapX = std::clamp(baseX + offsetX, 0, (int)marchWidth - 1);
+            int tapY = std::clamp(baseY + offsetY, 0, (int)marchHeight - 1);
+
+            float bilinear = (offsetX ? fx : 1.0f - fx) * (offsetY ? fy : 1.0f - fy);
+            float tapDepth = lowResDepth[tapY * marchWidth + tapX].x;
+            const DirectX::XMFLOAT4& tapCloud = lowResCloud[tapY * marchWidth + tapX];
+
+            float weight = bilinear * CloudUpsampleDepthWeight(tapDepth, fullResDepth);
+            sum.x += tapCloud.x * weight;
+            sum.y += tapCloud.y * weight;
+            sum.z += tapCloud.z * weight;
+            sum.w += tapCloud.w * weight;
+            totalWeight += weight;
+
+            float diff = fabsf(tapDepth - fullResDepth);
+            if (diff < closestDiff)
+            {
+                closestDiff = diff;
+                closest = tapCloud;
+            }
+        }
+
+        if (totalWeight <= UPSAMPLE_MIN_TOTAL_WEIGHT)
+            return closest;
+
+        float invWeight = 1.0f / totalWeight;
+        return DirectX::XMFLOAT4(sum.x * invWeight, sum.y * invWeight, sum.z * invWeight, sum.w * invWeight);
+    }
+
+    void BilateralUpsampleClouds(const DirectX::XMFLOAT4* lowResCloud, const DirectX::XMFLOAT2* lowResDepth, uint32_t marchWidth, uint32_t marchHeight,
+                                 const float* fullResDepth, uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset, DirectX::XMFLOAT4* out_cloud)
+    {
+        if (!lowResCloud || !lowResDepth || !fullResDepth || !out_cloud || marchWidth == 0 || marchHeight == 0)
+            return;
+
+        for (uint32_t y = 0; y < fullHeight; ++y)
+        {
+            for (uint32_t x = 0; x < fullWidth; ++x)
+            {
+                size_t idx = (size_t)y * fullWidth + x;
+                out_cloud[idx] = BilateralUpsampleCloud(lowResCloud, lowResDepth, marchWidth, marchHeight, x, y, fullResDepth[idx], divisor, marchOffset);
+            }
+        }
+    }
+
+    bool ReprojectToPreviousFrame(const DirectX::XMFLOAT3& positionWS, const DirectX::XMFLOAT4X4& prevViewProj, DirectX::XMFLOAT2& out_prevUV, float& out_prevViewZ)
+    {
+        const DirectX::XMFLOAT4X4& m = prevViewProj;
+        float clipX = positionWS.x * m._11 + positionWS.y * m._21 + positionWS.z * m._31 + m._41;
+        float clipY = positionWS.x * m._12 + positionWS.y * m._22 + positionWS.z * m._32 + m._42;
+        float clipW = positionWS.x * m._14 + positionWS.y * m._24 + positionWS.z * m._34 + m._44;
+
+        out_prevViewZ = clipW;
+        out_prevUV = DirectX::XMFLOAT2(0.0f, 0.0f);
+
+        if (clipW <= 0.0f)
+            return false;
+
+        out_prevUV.x = (clipX / clipW) * 0.5f + 0.5f;
+        out_prevUV.y = 0.5f - (clipY / clipW) * 0.5f;
+        return out_prevUV.x >= 0.0f && out_prevUV.x <= 1.0f && out_prevUV.y >= 0.0f && out_prevUV.y <= 1.0f;
+    }
+
+    bool IsHistoryDisoccluded(float expectedPrevDepth, float historyDepth)
+    {
+        // Both at the sky, nothing to compare
+        if (expectedPrevDepth >= RAYMARCH_SKY_DISTANCE && historyDepth >= RAYMARCH_SKY_DISTANCE)
+            return false;
+
+        float relativeDiff = fabsf(expectedPrevDepth - historyDepth) / std::max(std::min(expectedPrevDepth, historyDepth), 1e-4f);
+        return relativeDiff > DISOCCLUSION_THRESHOLD;
+    }
+
+    // Bilinear fetch with clamp addressing, the CPU side of linearClamp
+    static DirectX::XMFLOAT4 SampleBilinearClamp(const DirectX::XMFLOAT4* image, uint32_t width, uint32_t height, const DirectX::XMFLOAT2& uv)
+    {
+        float x = uv.x * width - 0.5f;
+        float y = uv.y * height - 0.5f;
+        int x0 = (int)floorf(x);
+        int y0 = (int)floorf(y);
+        float fx = x - (float)x0;
+        float fy = y - (float)y0;
+
+        DirectX::XMFLOAT4 result = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+        for (int i = 0; i < 4; ++i)
+        {
+            int offsetX = i & 1;
+            int offsetY = i >> 1;
+            int tapX = std::clamp(x0 + offsetX, 0, (int)width - 1);
+            int tapY = std::clamp(y0 + offsetY, 0, (int)height - 1);
+            float w = (offsetX ? fx : 1.0f - fx) * (offsetY ? fy : 1.0f - fy);
+
+            const DirectX::XMFLOAT4& texel = image[tapY * width + tapX];
+            result.x += texel.x * w;
+            result.y += texel.y * w;
+            result.z += texel.z * w;
+            result.w += texel.w * w;
+        }
+        return result;
+    }
+
+    void ResolveTemporalCloudPixel(const TemporalCloudInputs& in, uint32_t pixelX, uint32_t pixelY, DirectX::XMFLOAT4& out_cloud, DirectX::XMFLOAT2& out_depth)
+    {
+        const uint32_t divisor = CLOUD_TEMPORAL_BLOCK_SIZE;
+        uint32_t marchX = std::min(pixelX / divisor, in.marchWidth - 1);
+        uint32_t marchY = std::min(pixelY / divisor, in.marchHeight - 1);
+        size_t marchIdx = (size_t)marchY * in.marchWidth + marchX;
+        const DirectX::XMFLOAT2& marchDepth = in.cloudDepth[marchIdx];
+
+        float sceneDepth = in.sceneDepth[(size_t)pixelY * in.fullWidth + pixelX];
+
+        // This pixel was marched this frame
+        DirectX::XMUINT2 marchedPixel = GetMarchPixelCoord(marchX, marchY, in.fullWidth, in.fullHeight, divisor, in.marchOffset);
+        if (marchedPixel.x == pixelX && marchedPixel.y == pixelY)
+        {
+            out_cloud = in.cloud[marchIdx];
+            out_depth = marchDepth;
+            return;
+        }
+
+        float cloudDistance = marchDepth.y;
+        out_cloud = BilateralUpsampleCloud(in.cloud, in.cloudDepth, in.marchWidth, in.marchHeight, pixelX, pixelY, sceneDepth, divisor, in.marchOffset);
+        out_depth = DirectX::XMFLOAT2(sceneDepth, cloudDistance);
+
+        if (!in.historyValid)
+            return;
+
+        DirectX::XMFLOAT3 viewDir = GetViewRayDirection((float)pixelX, (float)pixelY, (float)in.fullWidth, (float)in.fullHeight, in.proj);
+
+        const DirectX::XMFLOAT4X4& iv = in.invView;
+        DirectX::XMFLOAT3 worldDir = DirectX::XMFLOAT3(
+            viewDir.x * iv._11 + viewDir.y * iv._21 + viewDir.z * iv._31,
+            viewDir.x * iv._12 + viewDir.y * iv._22 + viewDir.z * iv._32,
+            viewDir.x * iv._13 + viewDir.y * iv._23 + viewDir.z * iv._33);
+        float invLen = 1.0f / sqrtf(worldDir.x * worldDir.x + worldDir.y * worldDir.y + worldDir.z * worldDir.z);
+        worldDir = DirectX::XMFLOAT3(worldDir.x * invLen, worldDir.y * invLen, worldDir.z * invLen);
+        DirectX::XMFLOAT3 eyePos = DirectX::XMFLOAT3(iv._41, iv._42, iv._43);
+
+        // Reproject the cloud itself, approximated by the nearest sample's cloud distance
+        DirectX::XMFLOAT3 cloudPos = DirectX::XMFLOAT3(eyePos.x + worldDir.x * cloudDistance, eyePos.y + worldDir.y * cloudDistance, eyePos.z + worldDir.z * cloudDistance);
+        DirectX::XMFLOAT2 prevUV;
+        float prevCloudZ;
+        if (!ReprojectToPreviousFrame(cloudPos, in.prevViewProj, prevUV, prevCloudZ))
+            return;
+
+        uint32_t prevX = std::min((uint32_t)(prevUV.x * in.fullWidth), in.fullWidth - 1);
+        uint32_t prevY = std::min((uint32_t)(prevUV.y * in.fullHeight), in.fullHeight - 1);
+
+        // Where the opaque surface behind this pixel should have been last frame
+        float expectedPrevDepth = RAYMARCH_SKY_DISTANCE;
+        if (sceneDepth < RAYMARCH_SKY_DISTANCE)
+        {
+            float sceneDistance = sceneDepth / viewDir.z;
+            DirectX::XMFLOAT3 scenePos = DirectX::XMFLOAT3(eyePos.x + worldDir.x * sceneDistance, eyePos.y + worldDir.y * sceneDistance, eyePos.z + worldDir.z * sceneDistance);
+            DirectX::XMFLOAT2 unusedUV;
+            ReprojectToPreviousFrame(scenePos, in.prevViewProj, unusedUV, expectedPrevDepth);
+        }
+
+        if (IsHistoryDisoccluded(expectedPrevDepth, in.historyDepth[(size_t)prevY * in.fullWidth + prevX].x))
+            return;
+
+        DirectX::XMFLOAT4 history = SampleBilinearClamp(in.history, in.fullWidth, in.fullHeight, prevUV);
+
+        // Keep the history within the range of this frame's nearby samples to limit ghosting
+        DirectX::XMFLOAT4 neighborMin = DirectX::XMFLOAT4(1e30f, 1e30f, 1e30f, 1e30f);
+        DirectX::XMFLOAT4 neighborMax = DirectX::XMFLOAT4(-1e30f, -1e30f, -1e30f, -1e30f);
+        for (int y = -1; y <= 1; ++y)
+        {
+            for (int x = -1; x <= 1; ++x)
+            {
+                int tapX = std::clamp((int)marchX + x, 0, (int)in.marchWidth - 1);
+                int tapY = std::clamp((int)marchY + y, 0, (int)in.marchHeight - 1);
+                const DirectX::XMFLOAT4& tap = in.cloud[(size_t)tapY * in.marchWidth + tapX];
+                neighborMin = DirectX::XMFLOAT4(std::min(neighborMin.x, tap.x), std::min(neighborMin.y, tap.y), std::min(neighborMin.z, tap.z), std::min(neighborMin.w, tap.w));
+                neighborMax = DirectX::XMFLOAT4(std::max(neighborMax.x, tap.x), std::max(neighborMax.y, tap.y), std::max(neighborMax.z, tap.z), std::max(neighborMax.w, tap.w));
+            }
+        }
+
+        out_cloud = DirectX::XMFLOAT4(
+            std::clamp(history.x, neighborMin.x, neighborMax.x),
+            std::clamp(history.y, neighborMin.y, neighborMax.y),
+            std::clamp(history.z, neighborMin.z, neighborMax.z),
+            std::clamp(history.w, neighborMin.w, neighborMax.w));
+    }
+
+    float GetNoiseMipScale(const DirectX::XMFLOAT4X4& proj, uint32_t fullHeight, uint32_t resolutionDivisor, float noiseTexelSizeWS)
+    {
+        if (fullHeight == 0 || noiseTexelSizeWS <= 0.0f)
+            return 0.0f;
+
+        float pixelAngle = 2.0f / (proj._22 * (float)fullHeight) * (float)resolutionDivisor;
+        return pixelAngle / noiseTexelSizeWS;
+    }
+
+    float GetVoxelCloudMipLevel(float distance, float noiseMipScale, float baseMip)
+    {
+        return log2f(1.0f + fabsf(distance * noiseMipScale)) + baseMip;
+    }
+
+    static float SignNotZero(float v)
+    {
+        return v >= 0.0f ? 1.0f : -1.0f;
+    }
+
+    DirectX::XMFLOAT2 OctahedralEncode(const DirectX::XMFLOAT3& dir)
+    {
+        float sum = fabsf(dir.x) + fabsf(dir.y) + fabsf(dir.z);
+        if (sum <= 0.0f)
+            return DirectX::XMFLOAT2(0.5f, 0.5f);
+
+        float px = dir.x / sum;
+        float py = dir.z / sum;
+        if (dir.y < 0.0f)
+        {
+            float foldedX = (1.0f - fabsf(py)) * SignNotZero(px);
+            float foldedY = (1.0f - fabsf(px)) * SignNotZero(py);
+            px = foldedX;
+            py = foldedY;
+        }
+
+        return DirectX::XMFLOAT2(px * 0.5f + 0.5f, py * 0.5f + 0.5f);
+    }
+
+    DirectX::XMFLOAT3 OctahedralDecode(const DirectX::XMFLOAT2& uv)
+    {
+        float px = uv.x * 2.0f - 1.0f;
+        float py = uv.y * 2.0f - 1.0f;
+        DirectX::XMFLOAT3 dir(px, 1.0f - fabsf(px) - fabsf(py), py);
+
+        float fold = std::clamp(-dir.y, 0.0f, 1.0f);
+        dir.x -= fold * SignNotZero(dir.x);
+        dir.z -= fold * SignNotZero(dir.z);
+
+        float length = sqrtf(dir.x * dir.x + dir.y * dir.y + dir.z * dir.z);
+        return DirectX::XMFLOAT3(dir.x / length, dir.y / length, dir.z / length);
+    }
+}
@@ -0,0 +1,104 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU mirrors of the math used by the cloud raymarch shaders.
+Kept in sync with Raymarch.cs.hlsl so results can be validated off the GPU.
+----------------------------------------------*/
+#ifndef MUON_RAYMARCHUTILS_H
+#define MUON_RAYMARCHUTILS_H
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+
+namespace Muon
+{
+    // Distance returned for pixels with no opaque geometry (depth cleared to 1.0)
+    static const float RAYMARCH_SKY_DISTANCE = 1e20f;
+
+    // Converts a device depth in [0,1] to a positive view-space Z, given the projection matrix used to write it.
+    // Returns RAYMARCH_SKY_DISTANCE for cleared depth. Mirrors LinearizeDepth() in DepthUtils.hlsli.
+    float LinearizeDepth(float deviceDepth, const DirectX::XMFLOAT4X4& proj);
+
+    // Same as above, but derived from the near/far planes of a LH perspective projection.
+    float LinearizeDepth(float deviceDepth, float nearZ, float farZ);
+
+    // Converts a device depth to a distance along a normalized view-space ray direction.
+    // Returns RAYMARCH_SKY_DISTANCE for cleared depth. Mirrors DepthToRayDistance() in DepthUtils.hlsli.
+    float DepthToRayDistance(float deviceDepth, const DirectX::XMFLOAT4X4& proj, const DirectX::XMFLOAT3& viewDirVS);
+
+    // Builds the normalized view-space ray for a pixel the same way Raymarch.cs.hlsl does.
+    DirectX::XMFLOAT3 GetViewRayDirection(float pixelX, float pixelY, float width, float height, const DirectX::XMFLOAT4X4& proj);
+
+    // Size of the block of pixels covered by one march texel in temporal mode. One pixel per block is marched per frame.
+    static const uint32_t CLOUD_TEMPORAL_BLOCK_SIZE = 4;
+
+    // Size of the region of the cloud targets written when marching at 1/divisor resolution.
+    DirectX::XMUINT2 GetMarchResolution(uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor);
+
+    // Pixel within each block marched for a non-temporal reduced resolution march (the block center).
+    DirectX::XMINT2 GetCenteredMarchOffset(uint32_t divisor);
+
+    // Pixel within each 4x4 block marched on a given frame. Walks a Bayer pattern so every pixel is visited once per 16 frames.
+    DirectX::XMINT2 GetTemporalMarchOffset(uint32_t frameIndex);
+
+    // Full resolution pixel that a reduced resolution march texel is traced from. Mirrors GetMarchPixelCoord() in CloudParamsBuffer.hlsli.
+    DirectX::XMUINT2 GetMarchPixelCoord(uint32_t marchX, uint32_t marchY, uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset);
+
+    // Joint bilateral weight of a march texel for a full resolution pixel, from their linear view depths.
+    float CloudUpsampleDepthWeight(float lowResDepth, float fullResDepth);
+
+    // Depth aware upsample of one full resolution pixel. Mirrors BilateralUpsampleCloud() in CloudUpsampleCommon.hlsli.
+    // lowResCloud/lowResDepth are tightly packed marchWidth x marchHeight images of [radiance.rgb, transmittance] and [linear view Z, cloud distance].
+    DirectX::XMFLOAT4 BilateralUpsampleCloud(const DirectX::XMFLOAT4* lowResCloud, const DirectX::XMFLOAT2* lowResDepth, uint32_t marchWidth, uint32_t marchHeight,
+                                             uint32_t pixelX, uint32_t pixelY, float fullResDepth, uint32_t divisor, DirectX::XMINT2 marchOffset);
+
+    // Upsamples a whole image. fullResDepth (linear view Z) and out_cloud are fullWidth x fullHeight.
+    void BilateralUpsampleClouds(const DirectX::XMFLOAT4* lowResCloud, const DirectX::XMFLOAT2* lowResDepth, uint32_t marchWidth, uint32_t marchHeight,
+                                 const float* fullResDepth, uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset, DirectX::XMFLOAT4* out_cloud);
+
+    // Projects a world space point with last frame's (row-vector) view-projection.
+    // Returns false if it lands behind the previous camera or off screen. Mirrors ReprojectToPrevious() in CloudTemporal.cs.hlsl.
+    bool ReprojectToPreviousFrame(const DirectX::XMFLOAT3& positionWS, const DirectX::XMFLOAT4X4& prevViewProj, DirectX::XMFLOAT2& out_prevUV, float& out_prevViewZ);
+
+    // True when the history's linear depth doesn't match where this pixel's surface was expected last frame.
+    bool IsHistoryDisoccluded(float expectedPrevDepth, float historyDepth);
+
+    // Everything the temporal resolve reads for one frame. Images are tightly packed, cloud/cloudDepth at march resolution, the rest at full resolution.
+    struct TemporalCloudInputs
+    {
+        const DirectX::XMFLOAT4* cloud = nullptr;        // This frame's samples, [radiance.rgb, transmittance]
+        const DirectX::XMFLOAT2* cloudDepth = nullptr;   // This frame's samples, [linear view Z, cloud distance]
+        const DirectX::XMFLOAT4* history = nullptr;      // Last frame's resolved clouds
+        const DirectX::XMFLOAT2* historyDepth = nullptr; // Last frame's resolved [linear view Z, cloud distance]
+        const float* sceneDepth = nullptr;               // This frame's linear view Z
+
+        uint32_t fullWidth = 0;
+        uint32_t fullHeight = 0;
+        uint32_t marchWidth = 0;
+        uint32_t marchHeight = 0;
+        DirectX::XMINT2 marchOffset = DirectX::XMINT2(0, 0);
+        bool historyValid = false;
+
+        DirectX::XMFLOAT4X4 proj;
+        DirectX::XMFLOAT4X4 invView;
+        DirectX::XMFLOAT4X4 prevViewProj;
+    };
+
+    // Resolves one full resolution pixel. Mirrors main() in CloudTemporal.cs.hlsl.
+    void ResolveTemporalCloudPixel(const TemporalCloudInputs& inputs, uint32_t pixelX, uint32_t pixelY, DirectX::XMFLOAT4& out_cloud, DirectX::XMFLOAT2& out_depth);
+
+    // Noise texels covered by one marched pixel per world unit of distance. Mirrors GetNoiseMipScale() in Raymarch.cs.hlsl.
+    float GetNoiseMipScale(const DirectX::XMFLOAT4X4& proj, uint32_t fullHeight, uint32_t resolutionDivisor, float noiseTexelSizeWS);
+
+    // Distance-based noise mip. Mirrors GetVoxelCloudMipLevel() in Raymarch.cs.hlsl.
+    float GetVoxelCloudMipLevel(float distance, float noiseMipScale, float baseMip);
+
+    // World space direction (y up) to [0,1] octahedral UV. Mirrors OctahedralEncode() in CloudPanorama.hlsli.
+    DirectX::XMFLOAT2 OctahedralEncode(const DirectX::XMFLOAT3& dir);
+
+    // Normalized world space direction for an octahedral UV. Mirrors OctahedralDecode() in CloudPanorama.hlsli.
+    DirectX::XMFLOAT3 OctahedralDecode(const DirectX::XMFLOAT2& uv);
+}
+
+#endif
@@ -0,0 +1,317 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Implementation of SkyAmbientUtils.h
+The atmosphere functions are ports of the ones in atmosphere.ps.hlsl, keep them in sync.
+----------------------------------------------*/
+#include <Utils/SkyAmbientUtils.h>
+
+#include <Utils/CloudLightingUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+namespace
+{
+    // Mirrors ATMOSPHERE and the table sizes in atmosphere.ps.hlsl. Lengths are in km.
+    static const float BOTTOM_RADIUS = 6360.0f;
+    static const float TOP_RADIUS = 6420.0f;
+    static const float MU_S_MIN = -0.5f;
+    static const float MIE_PHASE_FUNCTION_G = 0.8f;
+    static const float SKY_SPECTRAL_RADIANCE_TO_LUMINANCE = 683.0f;
+    static const DirectX::XMFLOAT3 GROUND_ALBEDO = DirectX::XMFLOAT3(0.0f, 0.0f, 0.04f);
+
+    static const int SCATTERING_TEXTURE_R_SIZE = 32;
+    static const int SCATTERING_TEXTURE_MU_SIZE = 128;
+    static const int SCATTERING_TEXTURE_MU_S_SIZE = 32;
+    static const int SCATTERING_TEXTURE_NU_SIZE = 8;
+    static const int IRRADIANCE_TEXTURE_WIDTH = 64;
+    static const int IRRADIANCE_TEXTURE_HEIGHT = 16;
+
+    static const float PI = 3.14159265358979f;
+
+    // The sky is seen from the middle of the cloud layer. World units are meters.
+    static const float CLOUD_LAYER_ALTITUDE_KM = CLOUD_VOLUME_HEIGHT * 0.5f / 1000.0f;
+
+    // Equal area grid of directions the sky is projected from
+    static const uint32_t SH_SAMPLE_ROWS = 16;
+    static const uint32_t SH_SAMPLE_COLUMNS = 32;
+
+    float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+    {
+        return a.x * b.x + a.y * b.y + a.z * b.z;
+    }
+
+    float SafeSqrt(float a)
+    {
+        return sqrtf(std::max(a, 0.0f));
+    }
+
+    float SmoothStep(float edge0, float edge1, float x)
+    {
+        float t = std::clamp((x - edge0) / (edge1 - edge0), 0.0f, 1.0f);
+        return t * t * (3.0f - 2.0f * t);
+    }
+
+    float GetTextureCoordFromUnitRange(float x, int textureSize)
+    {
+        return 0.5f / (float)textureSize + x * (1.0f - 1.0f / (float)textureSize);
+    }
+
+    float DistanceToTopAtmosphereBoundary(float r, float mu)
+    {
+        r = std::min(r, TOP_RADIUS);
+        float discriminant = r * r * (mu * mu - 1.0f) + TOP_RADIUS * TOP_RADIUS;
+        return std::max(-r * mu + SafeSqrt(discriminant), 0.0f);
+    }
+
+    bool RayIntersectsGround(float r, float mu)
+    {
+        r = std::max(r, BOTTOM_RADIUS);
+        return mu < 0.0f && r * r * (mu * mu - 1.0f) + BOTTOM_RADIUS * BOTTOM_RADIUS >= 0.0f;
+    }
+
+    float RayleighPhaseFunction(float nu)
+    {
+        float k = 3.0f / (16.0f * PI);
+        return k * (1.0f + nu * nu);
+    }
+
+    float MiePhaseFunction(float g, float nu)
+    {
+        float k = 3.0f / (8.0f * PI) * (1.0f - g * g) / (2.0f + g * g);
+        return k * (1.0f + nu * nu) / powf(1.0f + g * g - 2.0f * g * nu, 1.5f);
+    }
+
+    // [u_nu, u_mu_s, u_mu, u_r]
+    DirectX::XMFLOAT4 GetScatteringTextureUvwzFromRMuMuSNu(float r, float mu, float mu_s, float nu, bool rayIntersectsGround)
+    {
+        float H = sqrtf(TOP_RADIUS * TOP_RADIUS - BOTTOM_RADIUS * BOTTOM_RADIUS);
+        float rho = SafeSqrt(r * r - BOTTOM_RADIUS * BOTTOM_RADIUS);
+        float u_r = GetTextureCoordFromUnitRange(rho / H, SCATTERING_TEXTURE_R_SIZE);
+
+        float r_mu = r * mu;
+        float discriminant = r_mu * r_mu - r * r + BOTTOM_RADIUS * BOTTOM_RADIUS;
+        float u_mu;
+        if (rayIntersectsGround)
+        {
+            float d = -r_mu - SafeSqrt(discriminant);
+            float d_min = r - BOTTOM_RADIUS;
+            float d_max = rho;
+            u_mu = 0.5f - 0.5f * GetTextureCoordFromUnitRange(d_max == d_min ? 0.0f : (d - d_min) / (d_max - d_min), SCATTERING_TEXTURE_MU_SIZE / 2);
+        }
+        else
+        {
+            float d = -r_mu + SafeSqrt(discriminant + H * H);
+            float d_min = TOP_RADIUS - r;
+            float d_max = rho + H;
+            u_mu = 0.5f + 0.5f * GetTextureCoordFromUnitRange((d - d_min) / (d_max - d_min), SCATTERING_TEXTURE_MU_SIZE / 2);
+        }
+
+        float d = DistanceToTopAtmosphereBoundary(BOTTOM_RADIUS, mu_s);
+        float d_min = TOP_RADIUS - BOTTOM_RADIUS;
+        float d_max = H;
+        float a = (d - d_min) / (d_max - d_min);
+        float D = DistanceToTopAtmosphereBoundary(BOTTOM_RADIUS, MU_S_MIN);
+        float A = (D - d_min) / (d_max - d_min);
+        float u_mu_s = GetTextureCoordFromUnitRange(std::max(1.0f - a / A, 0.0f) / (1.0f + a), SCATTERING_TEXTURE_MU_S_SIZE);
+        float u_nu = (nu + 1.0f) * 0.5f;
+
+        u_r = std::clamp(u_r, 0.5f / SCATTERING_TEXTURE_R_SIZE, 1.0f - 0.5f / SCATTERING_TEXTURE_R_SIZE);
+        u_mu = std::clamp(u_mu, 0.5f / SCATTERING_TEXTURE_MU_SIZE, 1.0f - 0.5f / SCATTERING_TEXTURE_MU_SIZE);
+        u_mu_s = std::clamp(u_mu_s, 0.5f / SCATTERING_TEXTURE_MU_S_SIZE, 1.0f - 0.5f / SCATTERING_TEXTURE_MU_S_SIZE);
+        u_nu = std::clamp(u_nu, 0.0f, 1.0f);
+
+        return DirectX::XMFLOAT4(u_nu, u_mu_s, u_mu, u_r);
+    }
+
+    // Returns Rayleigh + multiple scattering. The Mie term is extrapolated the same way as the shader, which ignores the alpha channel.
+    DirectX::XMFLOAT3 GetCombinedScattering(const FloatTexture& scatteringTex, float r, float mu, float mu_s, float nu, bool rayIntersectsGround,
+                                            float& out_singleMie)
+    {
+        DirectX::XMFLOAT4 uvwz = GetScatteringTextureUvwzFromRMuMuSNu(r, mu, mu_s, nu, rayIntersectsGround);
+        float texCoordX = uvwz.x * (float)(SCATTERING_TEXTURE_NU_SIZE - 1);
+        float texX = floorf(texCoordX);
+        float lerpFactor = texCoordX - texX;
+
+        // The tables are stored upside down, same flip as the shader
+        DirectX::XMFLOAT4 tex0 = SampleLinearClamp(scatteringTex, (texX + uvwz.y) / SCATTERING_TEXTURE_NU_SIZE, 1.0f - uvwz.z, uvwz.w);
+        DirectX::XMFLOAT4 tex1 = SampleLinearClamp(scatteringTex, (texX + 1.0f + uvwz.y) / SCATTERING_TEXTURE_NU_SIZE, 1.0f - uvwz.z, uvwz.w);
+
+        DirectX::XMFLOAT3 scattering(
+            tex0.x * (1.0f - lerpFactor) + tex1.x * lerpFactor,
+            tex0.y * (1.0f - lerpFactor) + tex1.y * lerpFactor,
+            tex0.z * (1.0f - lerpFactor) + tex1.z * lerpFactor);
+
+        out_singleMie = scattering.x > 0.0f ? 0.1f : 0.0f;
+        return scattering;
+    }
+
+    // Sky irradiance on a horizontal surface at the bottom of the atmosphere
+    DirectX::XMFLOAT3 GetGroundSkyIrradiance(const FloatTexture& irradianceTex, float mu_s)
+    {
+        float u = GetTextureCoordFromUnitRange(mu_s * 0.5f + 0.5f, IRRADIANCE_TEXTURE_WIDTH);
+        float v = GetTextureCoordFromUnitRange(0.0f, IRRADIANCE_TEXTURE_HEIGHT);
+        DirectX::XMFLOAT4 irradiance = SampleLinearClamp(irradianceTex, u, 1.0f - v);
+        return DirectX::XMFLOAT3(irradiance.x, irradiance.y, irradiance.z);
+    }
+
+    // Real L2 SH basis, ordered by band
+    void GetSHBasis(const DirectX::XMFLOAT3& n, float out_basis[SKY_SH_COEFFICIENT_COUNT])
+    {
+        out_basis[0] = 0.282095f;
+        out_basis[1] = 0.488603f * n.y;
+        out_basis[2] = 0.488603f * n.z;
+        out_basis[3] = 0.488603f * n.x;
+        out_basis[4] = 1.092548f * n.x * n.y;
+        out_basis[5] = 1.092548f * n.y * n.z;
+        out_basis[6] = 0.315392f * (3.0f * n.z * n.z - 1.0f);
+        out_basis[7] = 1.092548f * n.x * n.z;
+        out_basis[8] = 0.546274f * (n.x * n.x - n.y * n.y);
+    }
+}
+
+DirectX::XMFLOAT3 GetSkyLuminance(const AtmosphereTables& tables, const DirectX::XMFLOAT3& positionKm,
+                                  const DirectX::XMFLOAT3& viewDir, const DirectX::XMFLOAT3& sunDir)
+{
+    DirectX::XMFLOAT3 luminance(0.0f, 0.0f, 0.0f);
+    if (!tables.scattering || !tables.irradiance)
+        return luminance;
+
+    DirectX::XMFLOAT3 cameraPos = positionKm;
+    float r = sqrtf(Dot(cameraPos, cameraPos));
+    float rmu = Dot(cameraPos, viewDir);
+
+    // Looking at the planet. Only the ground's own radiance is kept,
+    // the in-scattering between the clouds and the ground is negligible over a few hundred meters.
+    float groundDiscriminant = BOTTOM_RADIUS * BOTTOM_RADIUS - (r * r - rmu * rmu);
+    if (groundDiscriminant >= 0.0f && rmu < 0.0f)
+    {
+        float distanceToGround = -rmu - sqrtf(groundDiscriminant);
+        if (distanceToGround > 0.0f)
+        {
+            DirectX::XMFLOAT3 groundPos(cameraPos.x + viewDir.x * distanceToGround,
+                                        cameraPos.y + viewDir.y * distanceToGround,
+                                        cameraPos.z + viewDir.z * distanceToGround);
+            float groundMuS = Dot(groundPos, sunDir) / BOTTOM_RADIUS;
+            DirectX::XMFLOAT3 skyIrradiance = GetGroundSkyIrradiance(*tables.irradiance, groundMuS);
+
+            float scale = SKY_SPECTRAL_RADIANCE_TO_LUMINANCE / PI;
+            return DirectX::XMFLOAT3(GROUND_ALBEDO.x * skyIrradiance.x * scale,
+                                     GROUND_ALBEDO.y * skyIrradiance.y * scale,
+                                     GROUND_ALBEDO.z * skyIrradiance.z * scale);
+        }
+    }
+
+    float distanceToTop = -rmu - sqrtf(rmu * rmu - r * r + TOP_RADIUS * TOP_RADIUS);
+    if (distanceToTop > 0.0f)
+    {
+        cameraPos = DirectX::XMFLOAT3(cameraPos.x + viewDir.x * distanceToTop,
+                                      cameraPos.y + viewDir.y * distanceToTop,
+                                      cameraPos.z + viewDir.z * distanceToTop);
+        r = TOP_RADIUS;
+        rmu += distanceToTop;
+    }
+    else if (r > TOP_RADIUS)
+    {
+        return luminance;
+    }
+
+    float mu = rmu / r;
+    float mu_s = Dot(cameraPos, sunDir) / r;
+    float nu = Dot(viewDir, sunDir);
+
+    float singleMie = 0.0f;
+    DirectX::XMFLOAT3 scattering = GetCombinedScattering(*tables.scattering, r, mu, mu_s, nu, RayIntersectsGround(r, mu), singleMie);
+
+    float rayleighPhase = RayleighPhaseFunction(nu);
+    float mie = singleMie * MiePhaseFunction(MIE_PHASE_FUNCTION_G, nu);
+    luminance.x = (scattering.x * rayleighPhase + mie) * SKY_SPECTRAL_RADIANCE_TO_LUMINANCE;
+    luminance.y = (scattering.y * rayleighPhase + mie) * SKY_SPECTRAL_RADIANCE_TO_LUMINANCE;
+    luminance.z = (scattering.z * rayleighPhase + mie) * SKY_SPECTRAL_RADIANCE_TO_LUMINANCE;
+    return luminance;
+}
+
+bool ProjectSkyAmbientSH(const AtmosphereTables& tables, const DirectX::XMFLOAT3& sunDir, float exposure, const DirectX::XMFLOAT3& whitePoint,
+                         DirectX::XMFLOAT3 out_sh[SKY_SH_COEFFICIENT_COUNT])
+{
+    for (uint32_t i = 0; i < SKY_SH_COEFFICIENT_COUNT; ++i)
+        out_sh[i] = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+    if (!tables.scattering || !tables.irradiance || tables.scattering->texels.empty() || tables.irradiance->texels.empty())
+        return false;
+
+    const DirectX::XMFLOAT3 positionKm(0.0f, 0.0f, BOTTOM_RADIUS + CLOUD_LAYER_ALTITUDE_KM);
+    const DirectX::XMFLOAT3 moonDir(-sunDir.x, -sunDir.y, -sunDir.z);
+
+    // Same day/night blend as atmosphere.ps.hlsl: the night sky is the sky lit from the opposite direction, dimmed.
+    const float moonVisibility = SmoothStep(0.2f, -0.1f, sunDir.z);
+    const float NIGHT_SCALE = 0.05f;
+
+    const float solidAngle = 4.0f * PI / (float)(SH_SAMPLE_ROWS * SH_SAMPLE_COLUMNS);
+    for (uint32_t row = 0; row < SH_SAMPLE_ROWS; ++row)
+    {
+        float cosTheta = 1.0f - 2.0f * ((float)row + 0.5f) / (float)SH_SAMPLE_ROWS;
+        float sinTheta = SafeSqrt(1.0f - cosTheta * cosTheta);
+
+        for (uint32_t column = 0; column < SH_SAMPLE_COLUMNS; ++column)
+        {
+            float phi = 2.0f * PI * ((float)column + 0.5f) / (float)SH_SAMPLE_COLUMNS;
+            DirectX::XMFLOAT3 dirWS(sinTheta * cosf(phi), cosTheta, sinTheta * sinf(phi));
+            DirectX::XMFLOAT3 dirAtmosphere(dirWS.x, dirWS.z, dirWS.y);
+
+            DirectX::XMFLOAT3 day = GetSkyLuminance(tables, positionKm, dirAtmosphere, sunDir);
+            DirectX::XMFLOAT3 night = GetSkyLuminance(tables, positionKm, dirAtmosphere, moonDir);
+
+            DirectX::XMFLOAT3 radiance(
+                (day.x + (night.x * NIGHT_SCALE - day.x) * moonVisibility) / whitePoint.x * exposure,
+                (day.y + (night.y * NIGHT_SCALE - day.y) * moonVisibility) / whitePoint.y * exposure,
+                (day.z + (night.z * NIGHT_SCALE - day.z) * moonVisibility) / whitePoint.z * exposure);
+
+            float basis[SKY_SH_COEFFICIENT_COUNT];
+            GetSHBasis(dirWS, basis);
+            for (uint32_t i = 0; i < SKY_SH_COEFFICIENT_COUNT; ++i)
+            {
+                float weight = basis[i] * solidAngle;
+                out_sh[i].x += radiance.x * weight;
+                out_sh[i].y += radiance.y * weight;
+                out_sh[i].z += radiance.z * weight;
+            }
+        }
+    }
+
+    // Clamped cosine convolution (pi, 2pi/3, pi/4 per band), then divided by pi
+    static const float BAND_SCALE[SKY_SH_COEFFICIENT_COUNT] = { 1.0f, 2.0f / 3.0f, 2.0f / 3.0f, 2.0f / 3.0f, 0.25f, 0.25f, 0.25f, 0.25f, 0.25f };
+    for (uint32_t i = 0; i < SKY_SH_COEFFICIENT_COUNT; ++i)
+    {
+        out_sh[i].x *= BAND_SCALE[i];
+        out_sh[i].y *= BAND_SCALE[i];
+        out_sh[i].z *= BAND_SCALE[i];
+    }
+
+    return true;
+}
+
+DirectX::XMFLOAT3 EvaluateSkyAmbientSH(const DirectX::XMFLOAT3 sh[SKY_SH_COEFFICIENT_COUNT], const DirectX::XMFLOAT3& normalWS)
+{
+    float basis[SKY_SH_COEFFICIENT_COUNT];
+    GetSHBasis(normalWS, basis);
+
+    DirectX::XMFLOAT3 result(0.0f, 0.0f, 0.0f);
+    for (uint32_t i = 0; i < SKY_SH_COEFFICIENT_COUNT; ++i)
+    {
+        result.x += sh[i].x * basis[i];
+        result.y += sh[i].y * basis[i];
+        result.z += sh[i].z * basis[i];
+    }
+
+    // L2 can ring slightly negative opposite a bright sun-side sky
+    result.x = std::max(result.x, 0.0f);
+    result.y = std::max(result.y, 0.0f);
+    result.z = std::max(result.z, 0.0f);
+    return result;
+}
+
+}
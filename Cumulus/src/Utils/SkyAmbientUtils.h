@@ -0,0 +1,46 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU side sky ambient for the clouds.
+Evaluates the same precomputed Bruneton tables atmosphere.ps.hlsl renders the
+sky from, and projects the sky around the cloud layer into L2 spherical
+harmonics so Raymarch.cs.hlsl gets sky light for a few multiply-adds.
+----------------------------------------------*/
+#ifndef MUON_SKYAMBIENTUTILS_H
+#define MUON_SKYAMBIENTUTILS_H
+
+#include <Utils/TextureUtils.h>
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+
+namespace Muon
+{
+    static const uint32_t SKY_SH_COEFFICIENT_COUNT = 9;
+
+    // CPU copies of the precomputed atmosphere textures
+    struct AtmosphereTables
+    {
+        const FloatTexture* irradiance = nullptr; // irradiance_high.hdr
+        const FloatTexture* scattering = nullptr; // TestHDR_3D, Rayleigh + multiple scattering combined
+    };
+
+    // Luminance of the sky along viewDir, seen from positionKm (planet centered, atmosphere frame, z up).
+    // Mirrors GetSkyLuminance() without light shafts. Rays that hit the planet see the ground instead, lit by the
+    // irradiance texture like the ground in atmosphere.ps.hlsl.
+    DirectX::XMFLOAT3 GetSkyLuminance(const AtmosphereTables& tables, const DirectX::XMFLOAT3& positionKm,
+                                      const DirectX::XMFLOAT3& viewDir, const DirectX::XMFLOAT3& sunDir);
+
+    // Projects the sky seen from the cloud layer into L2 SH, with the same day/night blend and exposure as atmosphere.ps.hlsl.
+    // Coefficients are world space (y up), convolved with a clamped cosine and divided by pi,
+    // so EvaluateSkyAmbientSH(n) is the radiance reflected by a white diffuse surface facing n.
+    // sunDir is in the atmosphere frame, as stored in cbAtmosphere.
+    bool ProjectSkyAmbientSH(const AtmosphereTables& tables, const DirectX::XMFLOAT3& sunDir, float exposure, const DirectX::XMFLOAT3& whitePoint,
+                             DirectX::XMFLOAT3 out_sh[SKY_SH_COEFFICIENT_COUNT]);
+
+    // Mirrors EvaluateSkyAmbient() in SkyAmbientBuffer.hlsli
+    DirectX::XMFLOAT3 EvaluateSkyAmbientSH(const DirectX::XMFLOAT3 sh[SKY_SH_COEFFICIENT_COUNT], const DirectX::XMFLOAT3& normalWS);
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU side texture processing helpers
+----------------------------------------------*/
+#include <Utils/TextureUtils.h>
+
+#include <algorithm>
+#include <cmath>
+
+namespace Muon
+{
+    // Texel pair and blend weight along one axis for a clamped linear lookup
+    static void GetLinearTaps(float coord, uint32_t size, uint32_t& out_i0, uint32_t& out_i1, float& out_frac)
+    {
+        float texel = std::clamp(coord * (float)size - 0.5f, 0.0f, (float)(size - 1));
+        out_i0 = (uint32_t)texel;
+        out_i1 = std::min(out_i0 + 1, size - 1);
+        out_frac = texel - (float)out_i0;
+    }
+
+    DirectX::XMFLOAT4 SampleLinearClamp(const FloatTexture& texture, float u, float v, float w)
+    {
+        DirectX::XMFLOAT4 result(0.0f, 0.0f, 0.0f, 0.0f);
+        if (texture.width == 0 || texture.height == 0 || texture.depth == 0 ||
+            texture.texels.size() < (size_t)texture.width * texture.height * texture.depth * 4)
+            return result;
+
+        uint32_t x[2], y[2], z[2];
+        float fx, fy, fz;
+        GetLinearTaps(u, texture.width, x[0], x[1], fx);
+        GetLinearTaps(v, texture.height, y[0], y[1], fy);
+        GetLinearTaps(w, texture.depth, z[0], z[1], fz);
+
+        float* out = &result.x;
+        for (uint32_t k = 0; k < 8; ++k)
+        {
+            uint32_t ix = k & 1, iy = (k >> 1) & 1, iz = k >> 2;
+            float weight = (ix ? fx : 1.0f - fx) * (iy ? fy : 1.0f - fy) * (iz ? fz : 1.0f - fz);
+            if (weight == 0.0f)
+                continue;
+
+            const float* texel = &texture.texels[(((size_t)z[iz] * texture.height + y[iy]) * texture.width + x[ix]) * 4];
+            for (uint32_t c = 0; c < 4; ++c)
+                out[c] += texel[c] * weight;
+        }
+        return result;
+    }
+
+    uint32_t GetMipCount(uint32_t width, uint32_t height, uint32_t depth)
+    {
+        uint32_t largest = std::max(width, std::max(height, depth));
+        uint32_t count = 1;
+        while (largest > 1)
+        {
+            largest >>= 1;
+            ++count;
+        }
+        return count;
+    }
+
+    // Halves one axis. dims is updated to the destination size.
+    static void DownsampleAxisWrapped(const std::vector<float>& src, uint32_t dims[3], uint32_t axis, uint32_t channels, std::vector<float>& dst)
+    {
+        static const float TENT[4] = { 1.0f / 8.0f, 3.0f / 8.0f, 3.0f / 8.0f, 1.0f / 8.0f };
+
+        const uint32_t srcSize = dims[axis];
+        const uint32_t dstSize = std::max(1u, srcSize / 2);
+
+        uint32_t dstDims[3] = { dims[0], dims[1], dims[2] };
+        dstDims[axis] = dstSize;
+
+        const size_t strides[3] = { 1, (size_t)dims[0], (size_t)dims[0] * dims[1] };
+        dst.assign((size_t)dstDims[0] * dstDims[1] * dstDims[2] * channels, 0.0f);
+
+        for (uint32_t z = 0; z < dstDims[2]; ++z)
+        {
+            for (uint32_t y = 0; y < dstDims[1]; ++y)
+            {
+                for (uint32_t x = 0; x < dstDims[0]; ++x)
+                {
+                    uint32_t coord[3] = { x, y, z };
+                    size_t dstIdx = (((size_t)z * dstDims[1] + y) * dstDims[0] + x) * channels;
+
+                    if (srcSize == 1)
+                    {
+                        // Axis is already done, just copy across
+                        size_t srcIdx = ((size_t)z * dims[1] * dims[0] + (size_t)y * dims[0] + x) * channels;
+                        std::copy(&src[srcIdx], &src[srcIdx] + channels, &dst[dstIdx]);
+                        continue;
+                    }
+
+                    // Taps at 2i-1 .. 2i+2, wrapping across the tile edge
+                    size_t base = 0;
+                    for (uint32_t a = 0; a < 3; ++a)
+                    {
+                        if (a != axis)
+                            base += (size_t)coord[a] * strides[a];
+                    }
+
+                    for (int tap = 0; tap < 4; ++tap)
+                    {
+                        int srcCoord = (int)(coord[axis] * 2) - 1 + tap;
+                        srcCoord = (srcCoord % (int)srcSize + (int)srcSize) % (int)srcSize;
+
+                        size_t srcIdx = (base + (size_t)srcCoord * strides[axis]) * channels;
+                        for (uint32_t c = 0; c < channels; ++c)
+                            dst[dstIdx + c] += TENT[tap] * src[srcIdx + c];
+                    }
+                }
+            }
+        }
+
+        dims[axis] = dstSize;
+    }
+
+    void Build3DMipChainWrapped(const float* texels, uint32_t width, uint32_t height, uint32_t depth, uint32_t channels,
+                                std::vector<std::vector<float>>& out_mips)
+    {
+        out_mips.clear();
+        if (!texels || width == 0 || height == 0 || depth == 0 || channels == 0)
+            return;
+
+        const uint32_t mipCount = GetMipCount(width, height, depth);
+        out_mips.resize(mipCount);
+        out_mips[0].assign(texels, texels + (size_t)width * height * depth * channels);
+
+        uint32_t dims[3] = { width, height, depth };
+        std::vector<float> scratch;
+        for (uint32_t mip = 1; mip < mipCount; ++mip)
+        {
+            std::vector<float> current = out_mips[mip - 1];
+            for (uint32_t axis = 0; axis < 3; ++axis)
+            {
+                DownsampleAxisWrapped(current, dims, axis, channels, scratch);
+                current.swap(scratch);
+            }
+            out_mips[mip] = std::move(current);
+        }
+    }
+}
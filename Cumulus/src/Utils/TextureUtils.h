@@ -0,0 +1,40 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : CPU side texture processing helpers
+----------------------------------------------*/
+#ifndef MUON_TEXTUREUTILS_H
+#define MUON_TEXTUREUTILS_H
+
+#include <DirectXMath.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace Muon
+{
+    // CPU copy of an RGBA32F texture, for lookup tables that are also needed off the GPU.
+    // Laid out like the GPU resource: x fastest, then rows top down, then slices.
+    struct FloatTexture
+    {
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t depth = 1;
+        std::vector<float> texels;
+    };
+
+    // Trilinear lookup with clamped addressing and D3D texel centers at (i + 0.5) / size, same as a linearClamp sample.
+    // w is ignored for 2D textures.
+    DirectX::XMFLOAT4 SampleLinearClamp(const FloatTexture& texture, float u, float v, float w = 0.5f);
+
+    // Number of mips in a full chain down to 1x1x1
+    uint32_t GetMipCount(uint32_t width, uint32_t height, uint32_t depth);
+
+    // Builds the full mip chain of a tileable 3D texture. texels holds mip 0, x fastest then y then z, 'channels' floats per texel.
+    // out_mips[0] is a copy of mip 0. Each following level is filtered with a separable [1 3 3 1] tent that wraps at the 
+    // edges, so every level still tiles seamlessly.
+    void Build3DMipChainWrapped(const float* texels, uint32_t width, uint32_t height, uint32_t depth, uint32_t channels,
+                                std::vector<std::vector<float>>& out_mips);
+}
+
+#endif
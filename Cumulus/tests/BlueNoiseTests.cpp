@@ -0,0 +1,215 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the void-and-cluster generator, its disk cache and
+the step jitter lookup in BlueNoise.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Core/BlueNoise.h>
+
+#include <algorithm>
+#include <fstream>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    // Variance of the 3x3 box filtered noise within each z slice, wrapping around the edges.
+    // Blue noise has little low frequency energy, so its local averages stay far closer to 0.5 than white noise's.
+    float GetBoxFilteredVariance(const std::vector<float>& values, uint32_t width, uint32_t height, uint32_t depth)
+    {
+        double sumSq = 0.0;
+        for (uint32_t z = 0; z < depth; ++z)
+        {
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    float mean = 0.0f;
+                    for (int dy = -1; dy <= 1; ++dy)
+                        for (int dx = -1; dx <= 1; ++dx)
+                            mean += values[((size_t)z * height + (y + height + dy) % height) * width + (x + width + dx) % width] / 9.0f;
+                    sumSq += (mean - 0.5) * (mean - 0.5);
+                }
+            }
+        }
+        return (float)(sumSq / ((double)width * height * depth));
+    }
+
+    // Variance of each texel's mean over windows of consecutive z slices, wrapping from the last slice to the first
+    float GetSliceWindowVariance(const std::vector<float>& values, uint32_t width, uint32_t height, uint32_t depth, uint32_t window)
+    {
+        double sumSq = 0.0;
+        for (uint32_t z = 0; z < depth; ++z)
+        {
+            for (uint32_t i = 0; i < width * height; ++i)
+            {
+                float mean = 0.0f;
+                for (uint32_t w = 0; w < window; ++w)
+                    mean += values[(size_t)((z + w) % depth) * width * height + i] / (float)window;
+                sumSq += (mean - 0.5) * (mean - 0.5);
+            }
+        }
+        return (float)(sumSq / ((double)width * height * depth));
+    }
+
+    std::vector<float> MakeWhiteNoise(size_t count)
+    {
+        std::mt19937 rng(12);
+        std::vector<float> values(count);
+        for (size_t i = 0; i < count; ++i)
+            values[i] = ((float)i + 0.5f) / (float)count;
+        std::shuffle(values.begin(), values.end(), rng);
+        return values;
+    }
+}
+
+MN_TEST(BlueNoiseRanksEveryTexelOnce)
+{
+    BlueNoiseDesc desc;
+    desc.width = 32;
+    desc.height = 24;
+
+    std::vector<float> values;
+    MN_CHECK(GenerateBlueNoise(desc, values));
+    MN_CHECK(values.size() == (size_t)desc.width * desc.height);
+
+    // The values are the ranks mapped to [0,1), so sorted they step evenly from half a rank up
+    std::vector<float> sorted = values;
+    std::sort(sorted.begin(), sorted.end());
+    uint32_t misplaced = 0;
+    for (size_t i = 0; i < sorted.size(); ++i)
+        misplaced += fabsf(sorted[i] - ((float)i + 0.5f) / (float)sorted.size()) > 1e-6f ? 1 : 0;
+    MN_CHECK(misplaced == 0);
+
+    // Reproducible from the seed, and a different seed gives a different pattern
+    std::vector<float> again;
+    MN_CHECK(GenerateBlueNoise(desc, again));
+    MN_CHECK(again == values);
+
+    desc.seed += 1;
+    MN_CHECK(GenerateBlueNoise(desc, again));
+    MN_CHECK(again != values);
+
+    BlueNoiseDesc tooSmall;
+    tooSmall.width = 2;
+    MN_CHECK(!GenerateBlueNoise(tooSmall, again));
+}
+
+MN_TEST(BlueNoiseHasLittleLowFrequencyEnergy)
+{
+    BlueNoiseDesc desc;
+    desc.width = 32;
+    desc.height = 32;
+
+    std::vector<float> values;
+    MN_CHECK(GenerateBlueNoise(desc, values));
+
+    // White noise's local averages vary by 1/12 / 9. The wrapped box filter also checks the pattern tiles without a seam.
+    float white = GetBoxFilteredVariance(MakeWhiteNoise(values.size()), desc.width, desc.height, 1);
+    float blue = GetBoxFilteredVariance(values, desc.width, desc.height, 1);
+    MN_CHECK_NEAR(white, 1.0f / 108.0f, 2e-3f);
+    MN_CHECK(blue < 0.25f * white);
+}
+
+MN_TEST(BlueNoiseSpatiotemporal)
+{
+    BlueNoiseDesc desc;
+    desc.width = 16;
+    desc.height = 16;
+    desc.depth = 8;
+    desc.depthSigma = 1.0f;
+
+    std::vector<float> values;
+    MN_CHECK(GenerateBlueNoise(desc, values));
+    MN_CHECK(values.size() == (size_t)desc.width * desc.height * desc.depth);
+
+    // Each slice is blue on its own. The texels' sequences over a few frames only have to beat white noise, the
+    // gaussian along z is what spreads them and it is kept tight so the slices stay blue.
+    std::vector<float> white = MakeWhiteNoise(values.size());
+    MN_CHECK(GetBoxFilteredVariance(values, desc.width, desc.height, desc.depth) < 0.5f * GetBoxFilteredVariance(white, desc.width, desc.height, desc.depth));
+    MN_CHECK(GetSliceWindowVariance(values, desc.width, desc.height, desc.depth, 4) < GetSliceWindowVariance(white, desc.width, desc.height, desc.depth, 4));
+}
+
+MN_TEST(BlueNoiseCache)
+{
+    BlueNoiseDesc desc;
+    desc.width = 16;
+    desc.height = 16;
+    desc.depth = 2;
+
+    const std::filesystem::path cachePath = std::filesystem::temp_directory_path() / "MuonTests" / "BlueNoiseCache.bin";
+    std::error_code ec;
+    std::filesystem::remove(cachePath, ec);
+
+    // Missing, so it's generated and written
+    std::vector<float> generated;
+    MN_CHECK(LoadOrGenerateBlueNoise(desc, cachePath, generated));
+    MN_CHECK(std::filesystem::exists(cachePath));
+
+    std::vector<float> expected;
+    MN_CHECK(GenerateBlueNoise(desc, expected));
+    MN_CHECK(generated == expected);
+
+    // Read back as written. Scribbling over the values first shows they came from the file and weren't generated again.
+    const uintmax_t fileSize = std::filesystem::file_size(cachePath);
+    {
+        std::fstream file(cachePath, std::ios::binary | std::ios::in | std::ios::out);
+        file.seekp((std::streamoff)(fileSize - sizeof(float)));
+        const float marker = 2.0f;
+        file.write(reinterpret_cast<const char*>(&marker), sizeof(marker));
+    }
+
+    std::vector<float> loaded;
+    MN_CHECK(LoadOrGenerateBlueNoise(desc, cachePath, loaded));
+    MN_CHECK(loaded.size() == expected.size());
+    MN_CHECK(!loaded.empty() && loaded.back() == 2.0f);
+
+    // A different desc makes the cache stale, so it's regenerated and rewritten
+    BlueNoiseDesc reseeded = desc;
+    reseeded.seed += 1;
+    std::vector<float> regenerated, reseededExpected;
+    MN_CHECK(LoadOrGenerateBlueNoise(reseeded, cachePath, regenerated));
+    MN_CHECK(GenerateBlueNoise(reseeded, reseededExpected));
+    MN_CHECK(regenerated == reseededExpected);
+
+    // So is a file cut short
+    std::filesystem::resize_file(cachePath, fileSize / 2);
+    std::vector<float> truncated;
+    MN_CHECK(LoadOrGenerateBlueNoise(reseeded, cachePath, truncated));
+    MN_CHECK(truncated == reseededExpected);
+    MN_CHECK(std::filesystem::file_size(cachePath) == fileSize);
+
+    std::filesystem::remove(cachePath, ec);
+}
+
+MN_TEST(BlueNoiseStepJitterLookup)
+{
+    BlueNoiseDesc desc;
+    desc.width = 8;
+    desc.height = 8;
+    desc.depth = 4;
+
+    std::vector<float> values;
+    MN_CHECK(GenerateBlueNoise(desc, values));
+
+    // Step 0 reads the texel directly, tiled over the march texels
+    MN_CHECK_NEAR(BlueNoiseStepJitter(values, desc, 3, 5, 2, false, 2, 0), values[(2 * 8 + 5) * 8 + 3] - 0.5f, 1e-6f);
+    MN_CHECK_NEAR(BlueNoiseStepJitter(values, desc, 11, 13, 6, false, 2, 0), values[(2 * 8 + 5) * 8 + 3] - 0.5f, 1e-6f);
+
+    // Temporal marching revisits a pixel every 16 frames, and only moves to the next slice when it does
+    for (uint32_t frame = 0; frame < 16; ++frame)
+        MN_CHECK_NEAR(BlueNoiseStepJitter(values, desc, 3, 5, frame, true, 4, 0), values[5 * 8 + 3] - 0.5f, 1e-6f);
+    MN_CHECK_NEAR(BlueNoiseStepJitter(values, desc, 3, 5, 16, true, 4, 0), values[(8 + 5) * 8 + 3] - 0.5f, 1e-6f);
+    MN_CHECK_NEAR(BlueNoiseStepJitter(values, desc, 3, 5, 16 * 5, true, 4, 0), values[(8 + 5) * 8 + 3] - 0.5f, 1e-6f);
+
+    // Later steps wrap around [-0.5, 0.5]
+    for (uint32_t step = 0; step < 64; ++step)
+    {
+        float jitter = BlueNoiseStepJitter(values, desc, 1, 2, 3, false, 1, step);
+        MN_CHECK(jitter >= -0.5f && jitter <= 0.5f);
+    }
+}
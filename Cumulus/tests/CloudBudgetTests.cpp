@@ -0,0 +1,117 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the per-tile step budget in CloudBudgetUtils.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Utils/CloudBudgetUtils.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    float GetSpentSteps(const std::vector<CloudTileStats>& tiles, const std::vector<float>& stepScale)
+    {
+        float spent = 0.0f;
+        for (size_t i = 0; i < tiles.size(); ++i)
+            spent += tiles[i].baseSteps / stepScale[i];
+        return spent;
+    }
+}
+
+MN_TEST(MeasureCloudTileImportance)
+{
+    const uint32_t texelCount = CLOUD_BUDGET_TILE_SIZE * CLOUD_BUDGET_TILE_SIZE;
+
+    // A flat tile has nothing to resolve and keeps only the floor
+    std::vector<DirectX::XMFLOAT4> flat(texelCount, DirectX::XMFLOAT4(0.5f, 0.5f, 0.5f, 0.25f));
+    CloudTileStats flatStats = MeasureCloudTile(flat.data(), texelCount, 400, 2.0f, nullptr);
+    MN_CHECK_NEAR(flatStats.meanLuminance, 0.5f, 1e-5f);
+    MN_CHECK_NEAR(flatStats.meanTransmittance, 0.25f, 1e-6f);
+    MN_CHECK_NEAR(flatStats.importance, CLOUD_BUDGET_IMPORTANCE_FLOOR, 1e-3f);
+    MN_CHECK(flatStats.baseSteps == 800.0f);
+
+    // Alternating transmittance of 0 and 1 has a deviation of 0.5
+    std::vector<DirectX::XMFLOAT4> noisy(texelCount);
+    for (uint32_t i = 0; i < texelCount; ++i)
+        noisy[i] = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, (float)(i & 1));
+    CloudTileStats noisyStats = MeasureCloudTile(noisy.data(), texelCount, 100, 1.0f, nullptr);
+    MN_CHECK_NEAR(noisyStats.importance, 0.5f, 1e-5f);
+
+    // With history, the change since last frame counts and the result only moves part of the way
+    CloudTileStats previous;
+    previous.meanLuminance = 0.5f;
+    previous.meanTransmittance = 0.25f;
+    previous.importance = 0.1f;
+    CloudTileStats blended = MeasureCloudTile(noisy.data(), texelCount, 100, 1.0f, &previous);
+    float measured = 0.5f + 0.5f + 0.25f;
+    MN_CHECK_NEAR(blended.importance, 0.1f + (measured - 0.1f) * CLOUD_BUDGET_RESPONSE, 1e-5f);
+
+    CloudTileStats empty = MeasureCloudTile(nullptr, 0, 100, 1.0f, nullptr);
+    MN_CHECK(empty.baseSteps == 0.0f);
+}
+
+MN_TEST(CloudTileBudgetKeepsTotalSteps)
+{
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> importance(0.0f, 0.2f);
+    std::uniform_real_distribution<float> steps(20.0f, 200.0f);
+
+    for (uint32_t trial = 0; trial < 8; ++trial)
+    {
+        std::vector<CloudTileStats> tiles(GetBudgetTileCount(240) * GetBudgetTileCount(135));
+        float budget = 0.0f;
+        for (CloudTileStats& tile : tiles)
+        {
+            tile.importance = std::max(importance(rng), CLOUD_BUDGET_IMPORTANCE_FLOOR);
+            tile.baseSteps = steps(rng);
+            budget += tile.baseSteps;
+        }
+
+        std::vector<float> stepScale;
+        float lambda = SolveCloudTileBudget(tiles, stepScale);
+        MN_CHECK(lambda > 0.0f);
+        MN_CHECK(stepScale.size() == tiles.size());
+
+        // Same frame cost as a uniform step size, just spent elsewhere
+        MN_CHECK_NEAR(GetSpentSteps(tiles, stepScale) / budget, 1.0f, 1e-3f);
+
+        bool inRange = true, ordered = true;
+        for (size_t i = 0; i < tiles.size(); ++i)
+        {
+            inRange &= stepScale[i] >= CLOUD_BUDGET_MIN_STEP_SCALE * (1.0f - 1e-5f) && stepScale[i] <= CLOUD_BUDGET_MAX_STEP_SCALE * (1.0f + 1e-5f);
+            if (i > 0 && tiles[i].importance > tiles[i - 1].importance)
+                ordered &= stepScale[i] <= stepScale[i - 1];
+        }
+        MN_CHECK(inRange);
+
+        // Busier tiles never get the larger steps
+        MN_CHECK(ordered);
+    }
+}
+
+MN_TEST(CloudTileBudgetEdgeCases)
+{
+    // Equal importance leaves every tile at a uniform step size
+    std::vector<CloudTileStats> tiles(16);
+    for (CloudTileStats& tile : tiles)
+    {
+        tile.importance = 0.05f;
+        tile.baseSteps = 64.0f;
+    }
+
+    std::vector<float> stepScale;
+    SolveCloudTileBudget(tiles, stepScale);
+    for (float scale : stepScale)
+        MN_CHECK_NEAR(scale, 1.0f, 1e-3f);
+
+    // Nothing was marched, so there is nothing to hand out
+    std::vector<CloudTileStats> idle(4);
+    MN_CHECK(SolveCloudTileBudget(idle, stepScale) == 1.0f);
+    MN_CHECK(stepScale.size() == idle.size() && stepScale[0] == 1.0f);
+}
@@ -0,0 +1,89 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the Beer shadow map builder in CloudLightingUtils.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Utils/CloudLightingUtils.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    const float SLAB_EXTINCTION = 0.001f;
+
+    // Uniform cloud filling the whole volume, so the optical depth toward the sun is just extinction times the path length
+    CloudDensityGrid MakeUniformGrid()
+    {
+        CloudDensityGrid grid;
+        grid.width = 8;
+        grid.height = 8;
+        grid.depth = 20;
+        grid.extinction.assign((size_t)grid.width * grid.height * grid.depth, SLAB_EXTINCTION);
+        grid.emptyDistance.assign(grid.extinction.size(), 0.0f);
+        return grid;
+    }
+}
+
+MN_TEST(BeerShadowMapOverheadSun)
+{
+    CloudDensityGrid grid = MakeUniformGrid();
+    BeerShadowMapView view = GetBeerShadowMapView(DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f));
+
+    const uint32_t resolution = 64;
+    std::vector<DirectX::XMFLOAT4> texels;
+    BuildBeerShadowMap(grid, view, resolution, texels, 2);
+    MN_CHECK(texels.size() == (size_t)resolution * resolution);
+
+    // The map covers the volume's bounding sphere, so its corners miss the box
+    MN_CHECK(texels[0].x == view.depthRange && texels[0].z == 0.0f);
+
+    // Straight down, the light has crossed everything above the point
+    for (float height : { 450.0f, 250.0f, 60.0f })
+    {
+        DirectX::XMFLOAT3 p(123.0f, height, -321.0f);
+        float expected = expf(-SLAB_EXTINCTION * (CLOUD_VOLUME_HEIGHT - height));
+        MN_CHECK_NEAR(EvaluateBeerShadowTransmittance(texels.data(), resolution, view, p), expected, 0.02f);
+    }
+
+    // Above the clouds nothing is in the way, below them the whole column is
+    MN_CHECK_NEAR(EvaluateBeerShadowTransmittance(texels.data(), resolution, view, DirectX::XMFLOAT3(0.0f, 800.0f, 0.0f)), 1.0f, 1e-6f);
+    MN_CHECK_NEAR(EvaluateBeerShadowTransmittance(texels.data(), resolution, view, DirectX::XMFLOAT3(0.0f, -300.0f, 0.0f)), expf(-SLAB_EXTINCTION * CLOUD_VOLUME_HEIGHT), 0.02f);
+
+    // Off the map there is no shadow
+    MN_CHECK(EvaluateBeerShadowTransmittance(texels.data(), resolution, view, DirectX::XMFLOAT3(1e5f, 100.0f, 0.0f)) == 1.0f);
+}
+
+MN_TEST(BeerShadowMapMatchesSunMarch)
+{
+    // The map's front depth and mean extinction should reproduce a direct march toward a low sun
+    CloudDensityGrid grid = MakeUniformGrid();
+    DirectX::XMFLOAT3 sunDir(0.6f, 0.5f, -0.2f);
+    float length = sqrtf(sunDir.x * sunDir.x + sunDir.y * sunDir.y + sunDir.z * sunDir.z);
+    sunDir = DirectX::XMFLOAT3(sunDir.x / length, sunDir.y / length, sunDir.z / length);
+    BeerShadowMapView view = GetBeerShadowMapView(sunDir);
+
+    const uint32_t resolution = 128;
+    std::vector<DirectX::XMFLOAT4> texels;
+    BuildBeerShadowMap(grid, view, resolution, texels);
+
+    // Stay clear of the box's edges, where the front depth has a kink the bilinear filter rounds off
+    float worstError = 0.0f;
+    for (uint32_t i = 0; i < 64; ++i)
+    {
+        float fx = (float)(i % 4) / 3.0f, fz = (float)((i / 4) % 4) / 3.0f, fy = (float)(i / 16) / 3.0f;
+        DirectX::XMFLOAT3 p(
+            (fx - 0.5f) * 0.6f * CLOUD_VOLUME_SIDE_LENGTH,
+            (0.2f + 0.6f * fy) * CLOUD_VOLUME_HEIGHT,
+            (fz - 0.5f) * 0.6f * CLOUD_VOLUME_SIDE_LENGTH);
+
+        float reference = expf(-MarchSunOpticalDepth(grid, p, sunDir, 5.0f));
+        float mapped = EvaluateBeerShadowTransmittance(texels.data(), resolution, view, p);
+        worstError = std::max(worstError, fabsf(reference - mapped));
+    }
+    MN_CHECK_NEAR(worstError, 0.0f, 0.01f);
+}
@@ -0,0 +1,176 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the cloud cone march prepass in ConeMarchUtils.h,
+checked against tracing every pixel's ray through the occupied cells
+----------------------------------------------*/
+#include "Test.h"
+#include "TestCamera.h"
+
+#include <Utils/ConeMarchUtils.h>
+#include <Utils/RayIntervalUtils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    struct CellBox
+    {
+        DirectX::XMFLOAT3 min;
+        DirectX::XMFLOAT3 max;
+    };
+
+    // World bounds of cell (x, y, z). Grid axes are x, z, y in world terms, see CloudDensityGrid
+    CellBox GetCellBox(const CloudDensityGrid& grid, uint32_t x, uint32_t y, uint32_t z)
+    {
+        const DirectX::XMFLOAT3 cell(CLOUD_VOLUME_SIDE_LENGTH / (float)grid.width, CLOUD_VOLUME_HEIGHT / (float)grid.depth, CLOUD_VOLUME_SIDE_LENGTH / (float)grid.height);
+        CellBox box;
+        box.min = DirectX::XMFLOAT3(-CLOUD_VOLUME_SIDE_LENGTH * 0.5f + x * cell.x, z * cell.y, -CLOUD_VOLUME_SIDE_LENGTH * 0.5f + y * cell.z);
+        box.max = DirectX::XMFLOAT3(box.min.x + cell.x, box.min.y + cell.y, box.min.z + cell.z);
+        return box;
+    }
+
+    float GetBoxDistance(const CellBox& a, const CellBox& b)
+    {
+        float dx = std::max(0.0f, std::max(a.min.x - b.max.x, b.min.x - a.max.x));
+        float dy = std::max(0.0f, std::max(a.min.y - b.max.y, b.min.y - a.max.y));
+        float dz = std::max(0.0f, std::max(a.min.z - b.max.z, b.min.z - a.max.z));
+        return sqrtf(dx * dx + dy * dy + dz * dz);
+    }
+
+    // A few blobs of cloud, with every other cell's empty distance the exact gap to the nearest occupied cell.
+    // That's the tightest bound the grid allows, so the cone march gets no slack from it.
+    CloudDensityGrid MakeBlobGrid(std::vector<CellBox>& out_occupied)
+    {
+        CloudDensityGrid grid;
+        grid.width = 32;
+        grid.height = 32;
+        grid.depth = 8;
+        grid.extinction.assign((size_t)grid.width * grid.height * grid.depth, 0.0f);
+        grid.emptyDistance.assign(grid.extinction.size(), 0.0f);
+
+        const int blobs[3][4] = { { 6, 7, 2, 3 }, { 20, 15, 4, 4 }, { 26, 27, 1, 2 } };
+        out_occupied.clear();
+        for (uint32_t z = 0; z < grid.depth; ++z)
+            for (uint32_t y = 0; y < grid.height; ++y)
+                for (uint32_t x = 0; x < grid.width; ++x)
+                    for (const int* blob : blobs)
+                    {
+                        int dx = (int)x - blob[0], dy = (int)y - blob[1], dz = (int)z - blob[2];
+                        if (dx * dx + dy * dy + dz * dz <= blob[3] * blob[3])
+                        {
+                            out_occupied.push_back(GetCellBox(grid, x, y, z));
+                            break;
+                        }
+                    }
+
+        for (uint32_t z = 0; z < grid.depth; ++z)
+            for (uint32_t y = 0; y < grid.height; ++y)
+                for (uint32_t x = 0; x < grid.width; ++x)
+                {
+                    const CellBox box = GetCellBox(grid, x, y, z);
+                    float distance = INFINITY;
+                    for (const CellBox& occupied : out_occupied)
+                        distance = std::min(distance, GetBoxDistance(box, occupied));
+                    grid.emptyDistance[((size_t)z * grid.height + y) * grid.width + x] = distance;
+                }
+        return grid;
+    }
+
+    // Distance along the ray to the first occupied cell, maxDistance if it misses them all
+    float BruteForceFirstHit(const std::vector<CellBox>& occupied, const DirectX::XMFLOAT3& eye, const DirectX::XMFLOAT3& dir, float maxDistance)
+    {
+        float firstHit = maxDistance;
+        for (const CellBox& box : occupied)
+        {
+            float tEnter, tExit;
+            if (RayBoxIntersect(eye, dir, box.min, box.max, tEnter, tExit))
+                firstHit = std::min(firstHit, std::max(tEnter, 0.0f));
+        }
+        return firstHit;
+    }
+}
+
+MN_TEST(ConeMarchStartsBeforeEveryPixelsFirstHit)
+{
+    std::vector<CellBox> occupied;
+    CloudDensityGrid grid = MakeBlobGrid(occupied);
+    MN_CHECK(!occupied.empty());
+
+    // Not a multiple of the tile size, so the last row and column of tiles are partial
+    const uint32_t fullWidth = 164;
+    const uint32_t fullHeight = 90;
+    const float maxDistance = 20000.0f;
+
+    // From outside the volume looking in, from inside it, skimming over the top of it, and from a couple of cells short of a blob
+    const CellBox& nearBlob = *std::min_element(occupied.begin(), occupied.end(), [](const CellBox& a, const CellBox& b) { return a.min.x < b.min.x; });
+    const TestCamera cameras[] = {
+        MakeCamera(DirectX::XMFLOAT3(-2600.0f, 400.0f, -2600.0f), DirectX::XMFLOAT3(1.0f, -0.15f, 1.0f), (float)fullWidth / fullHeight),
+        MakeCamera(DirectX::XMFLOAT3(-1000.0f, 200.0f, 1000.0f), DirectX::XMFLOAT3(0.7f, 0.1f, -0.6f), (float)fullWidth / fullHeight),
+        MakeCamera(DirectX::XMFLOAT3(-2200.0f, CLOUD_VOLUME_HEIGHT + 20.0f, 300.0f), DirectX::XMFLOAT3(1.0f, -0.02f, 0.1f), (float)fullWidth / fullHeight),
+        MakeCamera(DirectX::XMFLOAT3(nearBlob.min.x - 300.0f, nearBlob.min.y + 1.0f, nearBlob.min.z + 1.0f), DirectX::XMFLOAT3(1.0f, 0.05f, 0.2f), (float)fullWidth / fullHeight)
+    };
+
+    for (const TestCamera& camera : cameras)
+    {
+        std::vector<float> coneStart;
+        BuildConeStartTiles(grid, camera.proj, camera.invView, fullWidth, fullHeight, maxDistance, coneStart);
+
+        const uint32_t tilesX = GetConeTileCount(fullWidth);
+        MN_CHECK(coneStart.size() == (size_t)tilesX * GetConeTileCount(fullHeight));
+
+        const DirectX::XMFLOAT3 eye(camera.invView._41, camera.invView._42, camera.invView._43);
+
+        // A ray can start anywhere before its own first cloud, so no tile may start past any of its pixels'
+        uint32_t overshoots = 0, hits = 0;
+        for (uint32_t y = 0; y < fullHeight; ++y)
+        {
+            for (uint32_t x = 0; x < fullWidth; ++x)
+            {
+                DirectX::XMFLOAT3 dir = Normalize(GetWorldRayDirection(camera, DirectX::XMUINT2(x, y), fullWidth, fullHeight));
+                float firstHit = BruteForceFirstHit(occupied, eye, dir, maxDistance);
+                float start = coneStart[(size_t)(y / CLOUD_CONE_TILE_SIZE) * tilesX + x / CLOUD_CONE_TILE_SIZE];
+
+                overshoots += start > firstHit + 1e-4f * firstHit + 1e-3f ? 1 : 0;
+                hits += firstHit < maxDistance ? 1 : 0;
+            }
+        }
+        MN_CHECK(overshoots == 0);
+        MN_CHECK(hits > 0);
+
+        // And it actually skips something, or the bound would hold trivially
+        MN_CHECK(*std::max_element(coneStart.begin(), coneStart.end()) > 0.0f);
+    }
+}
+
+MN_TEST(ConeMarchFirstHitAlongOneAxis)
+{
+    std::vector<CellBox> occupied;
+    CloudDensityGrid grid = MakeBlobGrid(occupied);
+
+    // Straight at a blob from outside the volume, with cones from a bare ray up to a wide one
+    const CellBox& target = occupied.front();
+    const DirectX::XMFLOAT3 center(0.5f * (target.min.x + target.max.x), 0.5f * (target.min.y + target.max.y), 0.5f * (target.min.z + target.max.z));
+    const DirectX::XMFLOAT3 origin(center.x - 1500.0f, center.y, center.z - 1500.0f);
+    const DirectX::XMFLOAT3 axis = Normalize(DirectX::XMFLOAT3(center.x - origin.x, 0.0f, center.z - origin.z));
+
+    float firstHit = BruteForceFirstHit(occupied, origin, axis, 20000.0f);
+    MN_CHECK(firstHit < 20000.0f);
+    for (float tanHalfAngle : { 0.0f, 0.01f, 0.2f })
+    {
+        float start = ConeMarchFirstHit(grid, origin, axis, tanHalfAngle, 20000.0f);
+        MN_CHECK(start <= firstHit + 1e-3f);
+        MN_CHECK(start > 0.0f);
+    }
+
+    // Never past maxDistance, even when nothing is in the way
+    MN_CHECK(ConeMarchFirstHit(grid, origin, DirectX::XMFLOAT3(0.0f, 1.0f, 0.0f), 0.05f, 300.0f) <= 300.0f);
+
+    // No grid means no bound
+    CloudDensityGrid empty;
+    MN_CHECK(ConeMarchFirstHit(empty, origin, axis, 0.05f, 20000.0f) == 0.0f);
+}
@@ -0,0 +1,291 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the GJK/EPA queries in ConvexQuery.h, checked
+against brute force support functions of the placed shapes
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Core/ConvexQuery.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    // Boxes have big flat faces, which is where EPA meets coplanar support points
+    std::vector<aiVector3D> MakeBoxPoints(float x, float y, float z)
+    {
+        std::vector<aiVector3D> points;
+        for (int i = 0; i < 8; ++i)
+            points.emplace_back(i & 1 ? x : -x, i & 2 ? y : -y, i & 4 ? z : -z);
+        return points;
+    }
+
+    // The hull of a ring of points, a flat polygonal disc like the hull of a torus
+    std::vector<aiVector3D> MakeRingPoints(float radius, float thickness, uint32_t segments)
+    {
+        std::vector<aiVector3D> points;
+        for (uint32_t i = 0; i < segments; ++i)
+        {
+            float angle = 6.2831853f * (float)i / (float)segments;
+            for (float y : { -thickness, thickness })
+                points.emplace_back(radius * cosf(angle), y, radius * sinf(angle));
+        }
+        return points;
+    }
+
+    std::vector<aiVector3D> MakeBlobPoints(uint32_t count)
+    {
+        std::mt19937 rng(5);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+
+        std::vector<aiVector3D> points;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float x = normal(rng), y = normal(rng), z = normal(rng);
+            float length = sqrtf(x * x + y * y + z * z);
+            points.emplace_back(1.2f * x / length, 0.7f * y / length, 0.9f * z / length);
+        }
+        return points;
+    }
+
+    std::vector<ConvexShape> MakeShapes()
+    {
+        std::vector<std::vector<aiVector3D>> clouds = { MakeBoxPoints(0.5f, 0.5f, 0.5f), MakeBoxPoints(1.5f, 0.2f, 0.6f), MakeRingPoints(1.0f, 0.25f, 24), MakeBlobPoints(60) };
+
+        std::vector<ConvexShape> shapes;
+        for (const std::vector<aiVector3D>& points : clouds)
+        {
+            Hull hull(points.data(), (int)points.size());
+            shapes.emplace_back();
+            BuildConvexShape(hull, shapes.back());
+        }
+
+        shapes.emplace_back();
+        BuildSphereShape(0.3f, shapes.back());
+        return shapes;
+    }
+
+    // Random rotation, a little non uniform scale and a translation, row vector like the engine
+    DirectX::XMFLOAT4X4 MakeWorld(std::mt19937& rng, float spread)
+    {
+        std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+        const float ax = 3.0f * unit(rng), ay = 3.0f * unit(rng), az = 3.0f * unit(rng);
+        const float rx[3][3] = { { 1, 0, 0 }, { 0, cosf(ax), sinf(ax) }, { 0, -sinf(ax), cosf(ax) } };
+        const float ry[3][3] = { { cosf(ay), 0, -sinf(ay) }, { 0, 1, 0 }, { sinf(ay), 0, cosf(ay) } };
+        const float rz[3][3] = { { cosf(az), sinf(az), 0 }, { -sinf(az), cosf(az), 0 }, { 0, 0, 1 } };
+
+        float rxy[3][3] = {};
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                for (int k = 0; k < 3; ++k)
+                    rxy[r][c] += rx[r][k] * ry[k][c];
+
+        const float scale = 0.75f + 0.25f * unit(rng);
+        const float scales[3] = { scale, scale * (1.0f + 0.3f * unit(rng)), scale };
+
+        DirectX::XMFLOAT4X4 world = {};
+        for (int r = 0; r < 3; ++r)
+            for (int c = 0; c < 3; ++c)
+                for (int k = 0; k < 3; ++k)
+                    world.m[r][c] += scales[r] * rxy[r][k] * rz[k][c];
+        world._41 = spread * unit(rng);
+        world._42 = spread * unit(rng);
+        world._43 = spread * unit(rng);
+        world._44 = 1.0f;
+        return world;
+    }
+
+    // Furthest any point of the placed shape reaches along dir
+    float GetSupportDistance(const ConvexShape& shape, const DirectX::XMFLOAT4X4& world, const DirectX::XMFLOAT3& dir)
+    {
+        float best = -FLT_MAX;
+        for (const DirectX::XMFLOAT3& v : shape.vertices)
+        {
+            float x = v.x * world._11 + v.y * world._21 + v.z * world._31 + world._41;
+            float y = v.x * world._12 + v.y * world._22 + v.z * world._32 + world._42;
+            float z = v.x * world._13 + v.y * world._23 + v.z * world._33 + world._43;
+            best = std::max(best, x * dir.x + y * dir.y + z * dir.z);
+        }
+        return best + shape.radius;
+    }
+
+    // How far the shapes overlap along dir, negative with the gap between them when dir separates them
+    float GetOverlapAlong(const ConvexShape& a, const DirectX::XMFLOAT4X4& worldA, const ConvexShape& b, const DirectX::XMFLOAT4X4& worldB, const DirectX::XMFLOAT3& dir)
+    {
+        return GetSupportDistance(a, worldA, dir) + GetSupportDistance(b, worldB, DirectX::XMFLOAT3(-dir.x, -dir.y, -dir.z));
+    }
+
+    // Exact depth from the hull of every difference of the placed cores' vertices, the Minkowski difference itself.
+    // False when that hull is flat or misses the origin, where only the sampled directions are left to check against.
+    bool GetHullDepth(const ConvexShape& a, const DirectX::XMFLOAT4X4& worldA, const ConvexShape& b, const DirectX::XMFLOAT4X4& worldB, float& out_depth)
+    {
+        auto place = [](const DirectX::XMFLOAT3& v, const DirectX::XMFLOAT4X4& world)
+        {
+            return DirectX::XMFLOAT3(v.x * world._11 + v.y * world._21 + v.z * world._31 + world._41,
+                              v.x * world._12 + v.y * world._22 + v.z * world._32 + world._42,
+                              v.x * world._13 + v.y * world._23 + v.z * world._33 + world._43);
+        };
+
+        std::vector<aiVector3D> differences;
+        for (const DirectX::XMFLOAT3& va : a.vertices)
+            for (const DirectX::XMFLOAT3& vb : b.vertices)
+            {
+                DirectX::XMFLOAT3 pa = place(va, worldA), pb = place(vb, worldB);
+                differences.emplace_back(pa.x - pb.x, pa.y - pb.y, pa.z - pb.z);
+            }
+
+        Hull hull(differences.data(), (int)differences.size());
+        if (hull.volume <= 0.0f)
+            return false;
+
+        // n.p + distance > 0 outside, so the origin sits -distance inside each face
+        out_depth = FLT_MAX;
+        for (const HullFace& face : hull.faces)
+            out_depth = std::min(out_depth, -face.distance);
+        out_depth += a.radius + b.radius;
+        return out_depth > a.radius + b.radius;
+    }
+
+    // Evenly spread over the sphere
+    std::vector<DirectX::XMFLOAT3> MakeDirections(uint32_t count)
+    {
+        std::vector<DirectX::XMFLOAT3> dirs;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float z = 1.0f - 2.0f * ((float)i + 0.5f) / (float)count;
+            float r = sqrtf(1.0f - z * z);
+            float angle = 2.39996323f * (float)i;
+            dirs.emplace_back(r * cosf(angle), r * sinf(angle), z);
+        }
+        return dirs;
+    }
+}
+
+MN_TEST(ConvexQueryMatchesSupportFunctions)
+{
+    std::vector<ConvexShape> shapes = MakeShapes();
+    std::vector<DirectX::XMFLOAT3> dirs = MakeDirections(4000);
+    std::mt19937 rng(7);
+
+    uint32_t apart = 0, overlapping = 0, exact = 0;
+    for (uint32_t i = 0; i < 1500; ++i)
+    {
+        const ConvexShape& a = shapes[rng() % shapes.size()];
+        const ConvexShape& b = shapes[rng() % shapes.size()];
+        DirectX::XMFLOAT4X4 worldA = MakeWorld(rng, 1.5f);
+        DirectX::XMFLOAT4X4 worldB = MakeWorld(rng, 1.5f);
+
+        ConvexQueryResult result = QueryConvex(a, worldA, b, worldB, CONVEX_QUERY_PENETRATION);
+        MN_CHECK(QueryConvex(a, worldA, b, worldB, CONVEX_QUERY_OVERLAP).overlap == result.overlap);
+
+        // Smallest overlap over the sampled directions. Near edges the overlap changes as fast as the shapes are long,
+        // so sampling only finds it from above and to within a few hundredths.
+        float leastOverlap = FLT_MAX;
+        for (const DirectX::XMFLOAT3& dir : dirs)
+            leastOverlap = std::min(leastOverlap, GetOverlapAlong(a, worldA, b, worldB, dir));
+
+        // The normal is a direction the shapes really overlap or are apart along by the reported amount
+        float along = GetOverlapAlong(a, worldA, b, worldB, result.normal);
+
+        if (!result.overlap)
+        {
+            ++apart;
+            MN_CHECK(along < 1e-4f);
+            MN_CHECK_NEAR(-along, result.distance, 1e-3f + 1e-2f * result.distance);
+            MN_CHECK(result.distance >= -leastOverlap - 1e-4f);
+
+            float dx = result.pointB.x - result.pointA.x, dy = result.pointB.y - result.pointA.y, dz = result.pointB.z - result.pointA.z;
+            MN_CHECK_NEAR(sqrtf(dx * dx + dy * dy + dz * dz), result.distance, 1e-3f + 1e-2f * result.distance);
+        }
+        else
+        {
+            ++overlapping;
+            MN_CHECK(leastOverlap > -1e-4f);
+            MN_CHECK_NEAR(along, result.penetration, 1e-3f + 1e-2f * result.penetration);
+            MN_CHECK(result.penetration <= leastOverlap + 1e-4f);
+
+            // Deep pairs used to come back with no depth at all when EPA started from a flat simplex
+            float depth;
+            if (GetHullDepth(a, worldA, b, worldB, depth))
+            {
+                ++exact;
+                MN_CHECK_NEAR(result.penetration, depth, 1e-4f + 2e-3f * depth);
+            }
+        }
+    }
+
+    // The placements mix both cases
+    MN_CHECK(apart > 100);
+    MN_CHECK(overlapping > 100);
+    MN_CHECK(exact > 100);
+}
+
+MN_TEST(ConvexQueryDeepOverlapDepth)
+{
+    // Deep overlaps are where GJK ends on a nearly flat simplex around the origin, which EPA used to report as no depth
+    std::vector<ConvexShape> shapes = MakeShapes();
+    std::mt19937 rng(3);
+
+    uint32_t exact = 0;
+    for (uint32_t i = 0; i < 1000; ++i)
+    {
+        const ConvexShape& a = shapes[rng() % shapes.size()];
+        const ConvexShape& b = shapes[rng() % shapes.size()];
+        DirectX::XMFLOAT4X4 worldA = MakeWorld(rng, 0.5f);
+        DirectX::XMFLOAT4X4 worldB = MakeWorld(rng, 0.5f);
+
+        ConvexQueryResult result = QueryConvex(a, worldA, b, worldB, CONVEX_QUERY_PENETRATION);
+        float depth;
+        if (!GetHullDepth(a, worldA, b, worldB, depth))
+            continue;
+
+        ++exact;
+        MN_CHECK(result.overlap);
+        MN_CHECK_NEAR(result.penetration, depth, 1e-4f + 2e-3f * depth);
+        MN_CHECK_NEAR(GetOverlapAlong(a, worldA, b, worldB, result.normal), depth, 1e-4f + 2e-3f * depth);
+    }
+
+    MN_CHECK(exact > 500);
+}
+
+MN_TEST(ConvexQueryCacheKeepsResults)
+{
+    // Carrying the axis and support points between frames only changes where the search starts
+    std::vector<ConvexShape> shapes = MakeShapes();
+    std::mt19937 rng(3);
+
+    std::vector<ConvexObject> objects;
+    for (uint32_t i = 0; i < 40; ++i)
+        objects.push_back({ (uint32_t)(rng() % shapes.size()), MakeWorld(rng, 2.5f) });
+
+    std::vector<ConvexQueryPair> pairs;
+    for (uint32_t a = 0; a < objects.size(); ++a)
+        for (uint32_t b = a + 1; b < objects.size(); ++b)
+            pairs.push_back({ a, b });
+
+    std::vector<ConvexQueryCache> caches(pairs.size());
+    std::vector<ConvexQueryResult> cached(pairs.size()), cold(pairs.size());
+    for (uint32_t frame = 0; frame < 5; ++frame)
+    {
+        for (ConvexObject& object : objects)
+            object.world._41 += 0.05f * (float)(object.shape + 1);
+
+        QueryConvexPairs(shapes, objects, pairs.data(), (uint32_t)pairs.size(), CONVEX_QUERY_PENETRATION, cached.data(), caches.data());
+        QueryConvexPairs(shapes, objects, pairs.data(), (uint32_t)pairs.size(), CONVEX_QUERY_PENETRATION, cold.data());
+
+        uint32_t mismatches = 0;
+        for (size_t i = 0; i < pairs.size(); ++i)
+        {
+            mismatches += cached[i].overlap != cold[i].overlap ? 1 : 0;
+            mismatches += fabsf(cached[i].distance - cold[i].distance) > 1e-3f + 1e-2f * cold[i].distance ? 1 : 0;
+            mismatches += fabsf(cached[i].penetration - cold[i].penetration) > 1e-3f + 1e-2f * cold[i].penetration ? 1 : 0;
+        }
+        MN_CHECK(mismatches == 0);
+    }
+}
@@ -0,0 +1,149 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the screen tile hull lists in HullBinningUtils.h
+----------------------------------------------*/
+#include "Test.h"
+#include "TestCamera.h"
+
+#include <Utils/HullBinningUtils.h>
+#include <Utils/RayIntervalUtils.h>
+#include <Utils/RaymarchUtils.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    std::vector<sbHullBounds> MakeRandomBounds(uint32_t count, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> position(-60.0f, 60.0f);
+        std::uniform_real_distribution<float> size(0.5f, 12.0f);
+
+        std::vector<sbHullBounds> bounds(count);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            DirectX::XMFLOAT3 center(position(rng), 0.25f * position(rng), position(rng));
+            DirectX::XMFLOAT3 half(size(rng), size(rng), size(rng));
+            bounds[i].minBounds = DirectX::XMFLOAT3(center.x - half.x, center.y - half.y, center.z - half.z);
+            bounds[i].maxBounds = DirectX::XMFLOAT3(center.x + half.x, center.y + half.y, center.z + half.z);
+            bounds[i].instance = i;
+            bounds[i].range = 0;
+        }
+        return bounds;
+    }
+
+    // Every hull some ray of the tile actually hits has to be in its list, unless the tile overflowed.
+    // Returns how many of those hits were listed, so the caller can tell the check found something.
+    uint32_t CheckTilesAgainstRays(bool& mn_failed, const std::vector<sbHullBounds>& bounds, const TestCamera& camera,
+                                   uint32_t fullWidth, uint32_t fullHeight, uint32_t divisor, DirectX::XMINT2 marchOffset)
+    {
+        DirectX::XMUINT2 march = GetMarchResolution(fullWidth, fullHeight, divisor);
+        std::vector<uint32_t> tiles;
+        BinHullsToTiles(bounds, camera.view, camera.proj, camera.invView, fullWidth, fullHeight, divisor, marchOffset, march.x, march.y, tiles);
+
+        const uint32_t tilesX = GetHullTileCount(march.x);
+        const uint32_t tilesY = GetHullTileCount(march.y);
+        MN_CHECK(tiles.size() == (size_t)tilesX * tilesY * HULL_TILE_SLOTS);
+
+        const DirectX::XMFLOAT3 eye(camera.invView._41, camera.invView._42, camera.invView._43);
+        uint32_t found = 0, missed = 0, unordered = 0;
+        std::vector<bool> listed(bounds.size());
+        for (uint32_t tileY = 0; tileY < tilesY; ++tileY)
+        {
+            for (uint32_t tileX = 0; tileX < tilesX; ++tileX)
+            {
+                const uint32_t* tile = &tiles[((size_t)tileY * tilesX + tileX) * HULL_TILE_SLOTS];
+                if (tile[0] == HULL_TILE_OVERFLOW)
+                    continue;
+
+                std::fill(listed.begin(), listed.end(), false);
+                for (uint32_t i = 0; i < tile[0]; ++i)
+                {
+                    listed[tile[1 + i]] = true;
+                    unordered += i > 0 && tile[1 + i] <= tile[i] ? 1 : 0;
+                }
+
+                const uint32_t lastX = std::min((tileX + 1) * HULL_TILE_SIZE, march.x);
+                const uint32_t lastY = std::min((tileY + 1) * HULL_TILE_SIZE, march.y);
+                for (uint32_t marchY = tileY * HULL_TILE_SIZE; marchY < lastY; ++marchY)
+                {
+                    for (uint32_t marchX = tileX * HULL_TILE_SIZE; marchX < lastX; ++marchX)
+                    {
+                        DirectX::XMUINT2 pixel = GetMarchPixelCoord(marchX, marchY, fullWidth, fullHeight, divisor, marchOffset);
+                        DirectX::XMFLOAT3 dir = GetWorldRayDirection(camera, pixel, fullWidth, fullHeight);
+                        for (size_t i = 0; i < bounds.size(); ++i)
+                        {
+                            float tEnter, tExit;
+                            if (!RayBoxIntersect(eye, dir, bounds[i].minBounds, bounds[i].maxBounds, tEnter, tExit))
+                                continue;
+
+                            found += listed[i] ? 1 : 0;
+                            missed += listed[i] ? 0 : 1;
+                        }
+                    }
+                }
+            }
+        }
+
+        MN_CHECK(missed == 0);
+        MN_CHECK(unordered == 0);
+        return found;
+    }
+}
+
+MN_TEST(HullTilesHoldEveryHitHull)
+{
+    const uint32_t fullWidth = 320;
+    const uint32_t fullHeight = 180;
+    const float aspect = (float)fullWidth / fullHeight;
+
+    // Boxes all around the camera, some of them straddling it or behind it
+    const std::vector<sbHullBounds> bounds = MakeRandomBounds(24, 3);
+    const TestCamera cameras[] = {
+        MakeCamera(DirectX::XMFLOAT3(0.0f, 2.0f, -120.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), aspect),
+        MakeCamera(DirectX::XMFLOAT3(5.0f, 0.0f, 5.0f), DirectX::XMFLOAT3(0.4f, 0.2f, -1.0f), aspect)
+    };
+
+    for (const TestCamera& camera : cameras)
+    {
+        for (uint32_t divisor : { 1u, 2u, 4u })
+        {
+            DirectX::XMINT2 offset = divisor == CLOUD_TEMPORAL_BLOCK_SIZE ? GetTemporalMarchOffset(3) : GetCenteredMarchOffset(divisor);
+            MN_CHECK(CheckTilesAgainstRays(mn_failed, bounds, camera, fullWidth, fullHeight, divisor, offset) > 0);
+        }
+    }
+}
+
+MN_TEST(HullTilesOverflow)
+{
+    // More hulls in front of the camera than a tile holds
+    std::vector<sbHullBounds> bounds(MAX_HULLS_PER_TILE + 4);
+    for (uint32_t i = 0; i < (uint32_t)bounds.size(); ++i)
+    {
+        bounds[i].minBounds = DirectX::XMFLOAT3(-1.0f, -1.0f, 10.0f + i);
+        bounds[i].maxBounds = DirectX::XMFLOAT3(1.0f, 1.0f, 10.5f + i);
+    }
+
+    const uint32_t fullWidth = 64, fullHeight = 64;
+    TestCamera camera = MakeCamera(DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), 1.0f);
+    std::vector<uint32_t> tiles;
+    BinHullsToTiles(bounds, camera.view, camera.proj, camera.invView, fullWidth, fullHeight, 1, GetCenteredMarchOffset(1), fullWidth, fullHeight, tiles);
+
+    // The four tiles meet at the screen center, where every box is
+    for (uint32_t tile : { 5u, 6u, 9u, 10u })
+        MN_CHECK(tiles[tile * HULL_TILE_SLOTS] == HULL_TILE_OVERFLOW);
+    MN_CHECK(tiles[0] == 0);
+
+    // And nothing is listed far off to the side
+    bounds.resize(1);
+    bounds[0].minBounds = DirectX::XMFLOAT3(-500.0f, -1.0f, 10.0f);
+    bounds[0].maxBounds = DirectX::XMFLOAT3(-400.0f, 1.0f, 11.0f);
+    BinHullsToTiles(bounds, camera.view, camera.proj, camera.invView, fullWidth, fullHeight, 1, GetCenteredMarchOffset(1), fullWidth, fullHeight, tiles);
+    for (uint32_t tile = 0; tile < 16; ++tile)
+        MN_CHECK(tiles[tile * HULL_TILE_SLOTS] == 0);
+}
@@ -0,0 +1,285 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the bounding planes in Hull.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Core/Hull.h>
+
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <map>
+#include <random>
+#include <utility>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    // Points on a squashed, tilted ellipsoid, so the hull has lots of faces and no axis aligned ones
+    std::vector<aiVector3D> MakeEllipsoidPoints(uint32_t count)
+    {
+        std::mt19937 rng(11);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+
+        std::vector<aiVector3D> points;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            float x = normal(rng), y = normal(rng), z = normal(rng);
+            float length = sqrtf(x * x + y * y + z * z);
+            x = 3.0f * x / length;
+            y = 1.0f * y / length;
+            z = 2.0f * z / length;
+            points.emplace_back(0.8f * x - 0.6f * y + 5.0f, 0.6f * x + 0.8f * y - 2.0f, z + 1.0f);
+        }
+        return points;
+    }
+
+    // How far the furthest input point is outside the hull's faces
+    float GetMaxOutside(const Hull& hull, const std::vector<aiVector3D>& points)
+    {
+        float maxOutside = -FLT_MAX;
+        for (const aiVector3D& p : points)
+        {
+            float outside = -FLT_MAX;
+            for (const HullFace& face : hull.faces)
+                outside = std::max(outside, face.normal.x * p.x + face.normal.y * p.y + face.normal.z * p.z + face.distance);
+            maxOutside = std::max(maxOutside, outside);
+        }
+        return maxOutside;
+    }
+
+    // Every edge is shared by exactly two faces winding it opposite ways, and V - E + F = 2
+    bool IsClosedSurface(const Hull& hull)
+    {
+        std::map<std::pair<int, int>, int> edges;
+        for (const HullFace& face : hull.faces)
+            for (int i = 0; i < 3; ++i)
+                ++edges[{ face.indices[i], face.indices[(i + 1) % 3] }];
+
+        for (const auto& edge : edges)
+        {
+            auto twin = edges.find({ edge.first.second, edge.first.first });
+            if (edge.second != 1 || twin == edges.end() || twin->second != 1)
+                return false;
+        }
+        return (int)hull.vertices.size() - (int)edges.size() / 2 + (int)hull.faces.size() == 2;
+    }
+
+    bool IsInside(const std::vector<DirectX::XMFLOAT4>& planes, float x, float y, float z, float tolerance)
+    {
+        for (const DirectX::XMFLOAT4& plane : planes)
+            if (plane.x * x + plane.y * y + plane.z * z + plane.w > tolerance)
+                return false;
+        return true;
+    }
+}
+
+MN_TEST(CappedHullPlanesStayInVertexBox)
+{
+    std::vector<aiVector3D> points = MakeEllipsoidPoints(400);
+    Hull hull(points.data(), (int)points.size());
+    MN_CHECK(!hull.faces.empty());
+
+    DirectX::XMFLOAT3 boxMin = hull.vertices[0], boxMax = hull.vertices[0];
+    for (const DirectX::XMFLOAT3& v : hull.vertices)
+    {
+        boxMin = DirectX::XMFLOAT3(std::min(boxMin.x, v.x), std::min(boxMin.y, v.y), std::min(boxMin.z, v.z));
+        boxMax = DirectX::XMFLOAT3(std::max(boxMax.x, v.x), std::max(boxMax.y, v.y), std::max(boxMax.z, v.z));
+    }
+
+    std::vector<DirectX::XMFLOAT4> uncapped;
+    hull.GetPlanes(uncapped);
+
+    for (uint32_t maxPlanes : { 4u, 8u, 16u, 64u })
+    {
+        HullPlaneParams params;
+        params.maxPlanes = maxPlanes;
+        std::vector<DirectX::XMFLOAT4> planes;
+        hull.GetPlanes(planes, params);
+
+        MN_CHECK(planes.size() <= std::max(maxPlanes, 6u));
+        MN_CHECK(planes.size() < uncapped.size());
+
+        // Nothing of the hull is cut off
+        bool keepsVertices = true;
+        for (const DirectX::XMFLOAT3& v : hull.vertices)
+            keepsVertices &= IsInside(planes, v.x, v.y, v.z, 1e-4f);
+        MN_CHECK(keepsVertices);
+
+        // And nothing outside the vertex box is let in, so the box can stand in for the planes
+        std::mt19937 rng(maxPlanes);
+        std::uniform_real_distribution<float> unit(-1.0f, 2.0f);
+        uint32_t leaks = 0;
+        for (uint32_t i = 0; i < 20000; ++i)
+        {
+            float x = boxMin.x + unit(rng) * (boxMax.x - boxMin.x);
+            float y = boxMin.y + unit(rng) * (boxMax.y - boxMin.y);
+            float z = boxMin.z + unit(rng) * (boxMax.z - boxMin.z);
+            bool inBox = x >= boxMin.x && x <= boxMax.x && y >= boxMin.y && y <= boxMax.y && z >= boxMin.z && z <= boxMax.z;
+            leaks += !inBox && IsInside(planes, x, y, z, -1e-4f) ? 1 : 0;
+        }
+        MN_CHECK(leaks == 0);
+    }
+}
+
+MN_TEST(BoxHullPlanesAreItsSides)
+{
+    // A box's twelve triangles merge into its six sides, well under any cap
+    std::vector<aiVector3D> corners;
+    for (int i = 0; i < 8; ++i)
+        corners.emplace_back(i & 1 ? 2.0f : -1.0f, i & 2 ? 3.0f : 0.0f, i & 4 ? 0.5f : -0.5f);
+    Hull box(corners.data(), (int)corners.size());
+
+    HullPlaneParams params;
+    params.maxPlanes = 6;
+    std::vector<DirectX::XMFLOAT4> planes;
+    box.GetPlanes(planes, params);
+    MN_CHECK(planes.size() == 6);
+    MN_CHECK(IsInside(planes, 1.99f, 2.99f, 0.49f, 0.0f));
+    MN_CHECK(!IsInside(planes, 2.01f, 1.0f, 0.0f, 0.0f));
+}
+
+// Grids put many points exactly on each face and edge of the hull, and rows of them along one line.
+// Expanding a face used to hand each of its outside points to the first new face they were above rather than the one
+// they were furthest above, which could leave them off every conflict list that mattered, outside the finished hull.
+MN_TEST(HullContainsDegenerateGrids)
+{
+    // A lattice, off the origin so float rounding is larger than at unit scale
+    std::vector<aiVector3D> lattice;
+    for (int z = 0; z < 8; ++z)
+        for (int y = 0; y < 8; ++y)
+            for (int x = 0; x < 8; ++x)
+                lattice.emplace_back(10.0f + 0.5f * x, -4.0f + 0.5f * y, 3.0f + 0.5f * z);
+
+    Hull latticeHull(lattice.data(), (int)lattice.size());
+    MN_CHECK(GetMaxOutside(latticeHull, lattice) < 1e-4f);
+    MN_CHECK(IsClosedSurface(latticeHull));
+    MN_CHECK_NEAR(latticeHull.volume, 3.5f * 3.5f * 3.5f, 1e-3f);
+
+    // Every corner is kept. Points on the sides and edges are mostly dropped, but which ones rounding leaves a hair
+    // outside depends on whether the compiler fuses the plane tests' multiply-adds, so only check they're on the surface.
+    uint32_t corners = 0, offSurface = 0;
+    for (const DirectX::XMFLOAT3& v : latticeHull.vertices)
+    {
+        const float c[3] = { v.x - 10.0f, v.y + 4.0f, v.z - 3.0f };
+        uint32_t onSides = 0;
+        for (float coord : c)
+            onSides += fabsf(coord) < 1e-4f || fabsf(coord - 3.5f) < 1e-4f ? 1 : 0;
+        corners += onSides == 3 ? 1 : 0;
+        offSurface += onSides == 0 ? 1 : 0;
+    }
+    MN_CHECK(corners == 8);
+    MN_CHECK(offSurface == 0);
+    MN_CHECK(latticeHull.vertices.size() < 16);
+
+    // The same lattice with every point in it twice
+    std::vector<aiVector3D> doubled = lattice;
+    doubled.insert(doubled.end(), lattice.rbegin(), lattice.rend());
+    Hull doubledHull(doubled.data(), (int)doubled.size());
+    MN_CHECK(GetMaxOutside(doubledHull, doubled) < 1e-4f);
+    MN_CHECK(IsClosedSurface(doubledHull));
+    MN_CHECK_NEAR(doubledHull.volume, latticeHull.volume, 1e-3f);
+
+    // Random picks from a small lattice, so points repeat and most of them share planes with many others.
+    // These are what the first-new-face handoff lost points on, leaving some several units outside.
+    std::mt19937 pickRng(0);
+    std::uniform_int_distribution<int> cell(0, 5);
+    float pickedOutside = -FLT_MAX;
+    uint32_t openSurfaces = 0;
+    for (uint32_t cloud = 0; cloud < 200; ++cloud)
+    {
+        std::vector<aiVector3D> picked;
+        for (uint32_t i = 0; i < 100; ++i)
+            picked.emplace_back(5.0f + 3.0f * cell(pickRng), -1.0f + 2.0f * cell(pickRng), 7.0f + cell(pickRng));
+
+        Hull pickedHull(picked.data(), (int)picked.size());
+        if (pickedHull.faces.empty())
+            continue;
+        pickedOutside = std::max(pickedOutside, GetMaxOutside(pickedHull, picked));
+        openSurfaces += IsClosedSurface(pickedHull) ? 0 : 1;
+    }
+    MN_CHECK(pickedOutside < 1e-4f);
+    MN_CHECK(openSurfaces == 0);
+
+    // A grid on the surface of a box only, with a few interior points
+    std::vector<aiVector3D> shell;
+    std::mt19937 rng(21);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    for (int i = 0; i < 16; ++i)
+    {
+        for (int j = 0; j < 16; ++j)
+        {
+            float u = i / 15.0f, v = j / 15.0f;
+            shell.emplace_back(u * 4.0f, v * 2.0f, 0.0f);
+            shell.emplace_back(u * 4.0f, v * 2.0f, 1.0f);
+            shell.emplace_back(u * 4.0f, 0.0f, v);
+            shell.emplace_back(u * 4.0f, 2.0f, v);
+            shell.emplace_back(0.0f, u * 2.0f, v);
+            shell.emplace_back(4.0f, u * 2.0f, v);
+        }
+    }
+    for (int i = 0; i < 50; ++i)
+        shell.emplace_back(4.0f * unit(rng), 2.0f * unit(rng), unit(rng));
+    std::shuffle(shell.begin(), shell.end(), rng);
+
+    Hull shellHull(shell.data(), (int)shell.size());
+    MN_CHECK(GetMaxOutside(shellHull, shell) < 1e-4f);
+    MN_CHECK(IsClosedSurface(shellHull));
+    MN_CHECK_NEAR(shellHull.volume, 8.0f, 1e-3f);
+}
+
+MN_TEST(HullContainsCoplanarRings)
+{
+    // Stacked rings, each one's points coplanar and cocircular
+    std::vector<aiVector3D> cylinder;
+    for (int ring = 0; ring < 10; ++ring)
+    {
+        for (int i = 0; i < 24; ++i)
+        {
+            float angle = 6.2831853f * i / 24.0f;
+            cylinder.emplace_back(2.0f * cosf(angle), 0.3f * ring, 2.0f * sinf(angle));
+        }
+    }
+
+    Hull cylinderHull(cylinder.data(), (int)cylinder.size());
+    MN_CHECK(GetMaxOutside(cylinderHull, cylinder) < 1e-4f);
+    MN_CHECK(IsClosedSurface(cylinderHull));
+
+    // A 24-gon's area times the height
+    const float area = 0.5f * 24.0f * 2.0f * 2.0f * sinf(6.2831853f / 24.0f);
+    MN_CHECK_NEAR(cylinderHull.volume, area * 2.7f, 1e-3f);
+
+    // A flat grid with one point above it, and a slab only a hundredth thick
+    std::vector<aiVector3D> pyramid;
+    std::vector<aiVector3D> slab;
+    for (int y = 0; y < 16; ++y)
+    {
+        for (int x = 0; x < 16; ++x)
+        {
+            pyramid.emplace_back(0.2f * x, 0.2f * y, 0.0f);
+            slab.emplace_back(0.2f * x, 0.2f * y, 0.0f);
+            slab.emplace_back(0.2f * x, 0.2f * y, 0.01f);
+        }
+    }
+    pyramid.emplace_back(1.0f, 2.0f, 1.5f);
+
+    Hull pyramidHull(pyramid.data(), (int)pyramid.size());
+    MN_CHECK(GetMaxOutside(pyramidHull, pyramid) < 1e-4f);
+    MN_CHECK(IsClosedSurface(pyramidHull));
+    MN_CHECK(pyramidHull.vertices.size() == 5);
+    MN_CHECK_NEAR(pyramidHull.volume, 3.0f * 3.0f * 1.5f / 3.0f, 1e-3f);
+
+    Hull slabHull(slab.data(), (int)slab.size());
+    MN_CHECK(GetMaxOutside(slabHull, slab) < 1e-4f);
+    MN_CHECK(IsClosedSurface(slabHull));
+    MN_CHECK_NEAR(slabHull.volume, 3.0f * 3.0f * 0.01f, 1e-4f);
+
+    // Every point on one plane has no hull
+    std::vector<aiVector3D> flat(pyramid.begin(), pyramid.end() - 1);
+    Hull flatHull(flat.data(), (int)flat.size());
+    MN_CHECK(flatHull.faces.empty() && flatHull.volume == 0.0f);
+}
@@ -0,0 +1,203 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the hull and cloud voxel overlap in HullVoxelUtils.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Utils/HullVoxelUtils.h>
+
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    const uint32_t GRID_WIDTH = 64;
+    const uint32_t GRID_HEIGHT = 48;
+    const uint32_t GRID_DEPTH = 36;
+
+    Hull MakeEllipsoidHull()
+    {
+        std::mt19937 rng(5);
+        std::normal_distribution<float> normal(0.0f, 1.0f);
+
+        std::vector<aiVector3D> points;
+        for (uint32_t i = 0; i < 300; ++i)
+        {
+            float x = normal(rng), y = normal(rng), z = normal(rng);
+            float length = sqrtf(x * x + y * y + z * z);
+            points.emplace_back(3.0f * x / length, 1.0f * y / length, 2.0f * z / length);
+        }
+        return Hull(points.data(), (int)points.size());
+    }
+
+    // Rotated, sheared and scaled up to a few hundred meters, away from the volume's center
+    DirectX::XMFLOAT4X4 MakeWorld()
+    {
+        const float c = cosf(0.7f), s = sinf(0.7f);
+        const float rotation[3][3] = { { c, 0.0f, -s }, { 0.0f, 1.0f, 0.0f }, { s, 0.0f, c } };
+        const float shear[3][3] = { { 1.0f, 0.3f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.2f, 1.0f } };
+
+        DirectX::XMFLOAT4X4 world = {};
+        for (int r = 0; r < 3; ++r)
+            for (int col = 0; col < 3; ++col)
+                for (int k = 0; k < 3; ++k)
+                    world.m[r][col] += 120.0f * shear[r][k] * rotation[k][col];
+        world._41 = 310.0f;
+        world._42 = 240.0f;
+        world._43 = -170.0f;
+        world._44 = 1.0f;
+        return world;
+    }
+
+    // The hull's faces in world space, n.p + w > 0 outside, by moving the point back into hull space
+    bool IsInsideHull(const Hull& hull, const DirectX::XMFLOAT4X4& world, const DirectX::XMFLOAT3& p, float slack)
+    {
+        const float (&m)[4][4] = world.m;
+        const float det = m[0][0] * (m[1][1] * m[2][2] - m[1][2] * m[2][1]) - m[0][1] * (m[1][0] * m[2][2] - m[1][2] * m[2][0]) + m[0][2] * (m[1][0] * m[2][1] - m[1][1] * m[2][0]);
+        const float inv[3][3] = {
+            { (m[1][1] * m[2][2] - m[1][2] * m[2][1]) / det, (m[0][2] * m[2][1] - m[0][1] * m[2][2]) / det, (m[0][1] * m[1][2] - m[0][2] * m[1][1]) / det },
+            { (m[1][2] * m[2][0] - m[1][0] * m[2][2]) / det, (m[0][0] * m[2][2] - m[0][2] * m[2][0]) / det, (m[0][2] * m[1][0] - m[0][0] * m[1][2]) / det },
+            { (m[1][0] * m[2][1] - m[1][1] * m[2][0]) / det, (m[0][1] * m[2][0] - m[0][0] * m[2][1]) / det, (m[0][0] * m[1][1] - m[0][1] * m[1][0]) / det } };
+
+        const float d[3] = { p.x - m[3][0], p.y - m[3][1], p.z - m[3][2] };
+        const DirectX::XMFLOAT3 local(
+            d[0] * inv[0][0] + d[1] * inv[1][0] + d[2] * inv[2][0],
+            d[0] * inv[0][1] + d[1] * inv[1][1] + d[2] * inv[2][1],
+            d[0] * inv[0][2] + d[1] * inv[1][2] + d[2] * inv[2][2]);
+
+        for (const HullFace& face : hull.faces)
+            if (face.normal.x * local.x + face.normal.y * local.y + face.normal.z * local.z + face.distance > slack)
+                return false;
+        return true;
+    }
+
+    // World space center of a voxel, the grid's axes are x, world z, world y
+    DirectX::XMFLOAT3 GetVoxelCenter(uint32_t x, uint32_t y, uint32_t z)
+    {
+        return DirectX::XMFLOAT3(
+            -0.5f * CLOUD_VOLUME_SIDE_LENGTH + ((float)x + 0.5f) * CLOUD_VOLUME_SIDE_LENGTH / GRID_WIDTH,
+            ((float)z + 0.5f) * CLOUD_VOLUME_HEIGHT / GRID_DEPTH,
+            -0.5f * CLOUD_VOLUME_SIDE_LENGTH + ((float)y + 0.5f) * CLOUD_VOLUME_SIDE_LENGTH / GRID_HEIGHT);
+    }
+
+    // Every voxel's coverage in the full grid, -1 for voxels in no block
+    std::vector<float> ExpandCoverage(const HullVoxelOverlap& overlap)
+    {
+        std::vector<float> coverage((size_t)GRID_WIDTH * GRID_HEIGHT * GRID_DEPTH, -1.0f);
+        for (size_t b = 0; b < overlap.blocks.size(); ++b)
+        {
+            const HullVoxelBlock& block = overlap.blocks[b];
+            for (uint32_t i = 0; i < HULL_VOXEL_BLOCK_VOXELS; ++i)
+            {
+                uint32_t x = block.x * HULL_VOXEL_BLOCK_SIZE + i % HULL_VOXEL_BLOCK_SIZE;
+                uint32_t y = block.y * HULL_VOXEL_BLOCK_SIZE + (i / HULL_VOXEL_BLOCK_SIZE) % HULL_VOXEL_BLOCK_SIZE;
+                uint32_t z = block.z * HULL_VOXEL_BLOCK_SIZE + i / (HULL_VOXEL_BLOCK_SIZE * HULL_VOXEL_BLOCK_SIZE);
+                if (x < GRID_WIDTH && y < GRID_HEIGHT && z < GRID_DEPTH)
+                    coverage[((size_t)z * GRID_HEIGHT + y) * GRID_WIDTH + x] = overlap.voxelCoverage[b * HULL_VOXEL_BLOCK_VOXELS + i];
+            }
+        }
+        return coverage;
+    }
+}
+
+MN_TEST(HullVoxelOverlapIsConservative)
+{
+    const Hull hull = MakeEllipsoidHull();
+    const DirectX::XMFLOAT4X4 world = MakeWorld();
+    std::vector<DirectX::XMFLOAT4> planes;
+    hull.GetPlanes(planes);
+
+    HullVoxelOverlap overlap;
+    MN_CHECK(QueryHullVoxelOverlap(hull, planes, world, GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH, nullptr, overlap, 1));
+    MN_CHECK(!overlap.blocks.empty());
+    MN_CHECK(overlap.voxelCoverage.size() == overlap.blocks.size() * HULL_VOXEL_BLOCK_VOXELS);
+
+    // Voxel centers against the hull itself, any center inside must be in a block with some coverage,
+    // and voxels with every corner inside are fully covered
+    const std::vector<float> coverage = ExpandCoverage(overlap);
+    const DirectX::XMFLOAT3 half(0.5f * CLOUD_VOLUME_SIDE_LENGTH / GRID_WIDTH, 0.5f * CLOUD_VOLUME_HEIGHT / GRID_DEPTH, 0.5f * CLOUD_VOLUME_SIDE_LENGTH / GRID_HEIGHT);
+    uint32_t insideCount = 0, dropped = 0, partial = 0;
+    for (uint32_t z = 0; z < GRID_DEPTH; ++z)
+    {
+        for (uint32_t y = 0; y < GRID_HEIGHT; ++y)
+        {
+            for (uint32_t x = 0; x < GRID_WIDTH; ++x)
+            {
+                const DirectX::XMFLOAT3 center = GetVoxelCenter(x, y, z);
+                if (!IsInsideHull(hull, world, center, 0.0f))
+                    continue;
+
+                const float voxelCoverage = coverage[((size_t)z * GRID_HEIGHT + y) * GRID_WIDTH + x];
+                ++insideCount;
+                dropped += voxelCoverage <= 0.0f ? 1 : 0;
+
+                bool cornersInside = true;
+                for (uint32_t corner = 0; corner < 8; ++corner)
+                {
+                    const DirectX::XMFLOAT3 p(center.x + (corner & 1 ? half.x : -half.x), center.y + (corner & 2 ? half.y : -half.y), center.z + (corner & 4 ? half.z : -half.z));
+                    cornersInside = cornersInside && IsInsideHull(hull, world, p, -1e-4f);
+                }
+                partial += cornersInside && voxelCoverage != 1.0f ? 1 : 0;
+            }
+        }
+    }
+
+    MN_CHECK(insideCount > 100);
+    MN_CHECK(dropped == 0);
+    MN_CHECK(partial == 0);
+
+    // Voxels whose whole box is outside one of the planes are never reported
+    uint32_t stray = 0;
+    for (uint32_t z = 0; z < GRID_DEPTH; ++z)
+        for (uint32_t y = 0; y < GRID_HEIGHT; ++y)
+            for (uint32_t x = 0; x < GRID_WIDTH; ++x)
+            {
+                if (coverage[((size_t)z * GRID_HEIGHT + y) * GRID_WIDTH + x] <= 0.0f)
+                    continue;
+
+                const DirectX::XMFLOAT3 center = GetVoxelCenter(x, y, z);
+                bool anyCornerNear = false;
+                for (uint32_t corner = 0; corner < 8; ++corner)
+                {
+                    const DirectX::XMFLOAT3 p(center.x + (corner & 1 ? half.x : -half.x), center.y + (corner & 2 ? half.y : -half.y), center.z + (corner & 4 ? half.z : -half.z));
+                    anyCornerNear = anyCornerNear || IsInsideHull(hull, world, p, 0.05f);
+                }
+                stray += anyCornerNear ? 0 : 1;
+            }
+    MN_CHECK(stray == 0);
+
+    // More threads only change who does the work
+    HullVoxelOverlap threaded;
+    MN_CHECK(QueryHullVoxelOverlap(hull, planes, world, GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH, nullptr, threaded, 4));
+    MN_CHECK(threaded.blocks.size() == overlap.blocks.size() && threaded.voxelCoverage == overlap.voxelCoverage);
+}
+
+MN_TEST(HullVoxelOverlapSkipsEmptyCells)
+{
+    const Hull hull = MakeEllipsoidHull();
+    const DirectX::XMFLOAT4X4 world = MakeWorld();
+    std::vector<DirectX::XMFLOAT4> planes;
+    hull.GetPlanes(planes);
+
+    // No cell of the occupancy grid holds cloud, so there is nothing to edit
+    CloudDensityGrid occupancy;
+    occupancy.width = 16;
+    occupancy.height = 16;
+    occupancy.depth = 8;
+    occupancy.extinction.assign((size_t)occupancy.width * occupancy.height * occupancy.depth, 0.0f);
+    occupancy.emptyDistance.assign(occupancy.extinction.size(), 50.0f);
+
+    HullVoxelOverlap overlap;
+    MN_CHECK(QueryHullVoxelOverlap(hull, planes, world, GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH, &occupancy, overlap));
+    MN_CHECK(overlap.blocks.empty());
+
+    // Far outside the volume nothing is touched either
+    DirectX::XMFLOAT4X4 away = world;
+    away._41 = 1e5f;
+    MN_CHECK(QueryHullVoxelOverlap(hull, planes, away, GRID_WIDTH, GRID_HEIGHT, GRID_DEPTH, nullptr, overlap));
+    MN_CHECK(overlap.blocks.empty());
+}
@@ -0,0 +1,123 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for packing mesh SDFs into the atlas in MeshSdf.h,
+checked against sampling each SDF on its own
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Core/MeshSdf.h>
+
+#include <cfloat>
+#include <cmath>
+#include <random>
+
+using namespace Muon;
+
+namespace
+{
+    // Distance to a sphere at the origin, sampled at the voxel centers
+    MeshSdf MakeSphereSdf(uint32_t width, uint32_t height, uint32_t depth, float voxelSize, float radius)
+    {
+        MeshSdf sdf;
+        sdf.width = width;
+        sdf.height = height;
+        sdf.depth = depth;
+        sdf.voxelSize = voxelSize;
+        sdf.boundsMin = DirectX::XMFLOAT3(-0.5f * voxelSize * width, -0.5f * voxelSize * height, -0.5f * voxelSize * depth);
+
+        for (uint32_t z = 0; z < depth; ++z)
+        {
+            for (uint32_t y = 0; y < height; ++y)
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    float px = sdf.boundsMin.x + voxelSize * (x + 0.5f);
+                    float py = sdf.boundsMin.y + voxelSize * (y + 0.5f);
+                    float pz = sdf.boundsMin.z + voxelSize * (z + 0.5f);
+                    sdf.distances.push_back(sqrtf(px * px + py * py + pz * pz) - radius);
+                }
+            }
+        }
+        return sdf;
+    }
+}
+
+MN_TEST(MeshSdfAtlasLayout)
+{
+    MeshSdf wide = MakeSphereSdf(6, 5, 4, 0.5f, 1.0f);
+    MeshSdf tall = MakeSphereSdf(3, 7, 2, 0.25f, 0.5f);
+    const MeshSdf* sdfs[] = { &wide, &tall };
+
+    MeshSdfAtlas atlas;
+    MN_CHECK(BuildMeshSdfAtlas(sdfs, 2, 4.0f, atlas));
+    MN_CHECK(atlas.width == 6 && atlas.height == 7 && atlas.depth == 6);
+    MN_CHECK(atlas.distances.size() == (size_t)6 * 7 * 6);
+    MN_CHECK(atlas.slots.size() == 2);
+
+    // Stacked along z in order, each keeping its own box and falloff
+    MN_CHECK(atlas.slots[0].zOffset == 0 && atlas.slots[1].zOffset == 4);
+    MN_CHECK(atlas.slots[1].dimensions.x == 3 && atlas.slots[1].dimensions.y == 7 && atlas.slots[1].dimensions.z == 2);
+    MN_CHECK_NEAR(atlas.slots[0].falloff, 2.0f, 1e-6f);
+    MN_CHECK_NEAR(atlas.slots[1].falloff, 1.0f, 1e-6f);
+    MN_CHECK_NEAR(atlas.slots[1].boundsSize.x, 0.75f, 1e-6f);
+    MN_CHECK_NEAR(atlas.slots[1].boundsMin.y, tall.boundsMin.y, 1e-6f);
+
+    // Texels past a slot's own size repeat its edge
+    auto At = [&](uint32_t x, uint32_t y, uint32_t z) { return atlas.distances[((size_t)z * atlas.height + y) * atlas.width + x]; };
+    MN_CHECK(At(5, 2, 5) == tall.distances[((size_t)1 * 7 + 2) * 3 + 2]);
+    MN_CHECK(At(1, 6, 3) == wide.distances[((size_t)3 * 5 + 4) * 6 + 1]);
+    MN_CHECK(At(0, 0, 4) == tall.distances[0]);
+
+    MN_CHECK(SampleMeshSdfAtlas(atlas, 2, DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f)) == FLT_MAX);
+}
+
+MN_TEST(MeshSdfAtlasMatchesEachSdf)
+{
+    MeshSdf wide = MakeSphereSdf(6, 5, 4, 0.5f, 1.0f);
+    MeshSdf tall = MakeSphereSdf(3, 7, 2, 0.25f, 0.5f);
+    MeshSdf cube = MakeSphereSdf(8, 8, 8, 0.2f, 0.6f);
+    const MeshSdf* sdfs[] = { &wide, &tall, &cube };
+
+    MeshSdfAtlas atlas;
+    MN_CHECK(BuildMeshSdfAtlas(sdfs, 3, 4.0f, atlas));
+
+    // Inside each box, on its edges where filtering could reach the next slot, and well outside it
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(-1.0f, 1.0f);
+    float maxError = 0.0f;
+    for (uint32_t slot = 0; slot < 3; ++slot)
+    {
+        const MeshSdf& sdf = *sdfs[slot];
+        const float halfSize[3] = { 0.5f * sdf.voxelSize * sdf.width, 0.5f * sdf.voxelSize * sdf.height, 0.5f * sdf.voxelSize * sdf.depth };
+        for (uint32_t i = 0; i < 2000; ++i)
+        {
+            const float reach = (i % 3 == 0) ? 1.0f : (i % 3 == 1 ? 1.05f : 2.0f);
+            DirectX::XMFLOAT3 p(reach * halfSize[0] * unit(rng), reach * halfSize[1] * unit(rng), reach * halfSize[2] * unit(rng));
+            if (i % 5 == 0)
+                p.z = (i % 2 ? 1.0f : -1.0f) * halfSize[2];
+            maxError = std::max(maxError, fabsf(SampleMeshSdfAtlas(atlas, slot, p) - SampleMeshSdf(sdf, p)));
+        }
+    }
+    MN_CHECK(maxError < 1e-4f);
+}
+
+MN_TEST(MeshSdfAtlasRejectsBadInput)
+{
+    MeshSdf valid = MakeSphereSdf(4, 4, 4, 0.5f, 1.0f);
+    MeshSdf empty;
+    const MeshSdf* withEmpty[] = { &valid, &empty };
+
+    MeshSdfAtlas atlas;
+    MN_CHECK(!BuildMeshSdfAtlas(withEmpty, 2, 4.0f, atlas));
+    MN_CHECK(atlas.slots.empty() && atlas.distances.empty());
+
+    // More slices than a 3d texture can have
+    MeshSdf deep = MakeSphereSdf(2, 2, MESH_SDF_ATLAS_MAX_DEPTH / 2 + 1, 0.5f, 1.0f);
+    const MeshSdf* tooDeep[] = { &deep, &deep };
+    MN_CHECK(!BuildMeshSdfAtlas(tooDeep, 2, 4.0f, atlas));
+    MN_CHECK(atlas.depth == 0 && atlas.distances.empty());
+
+    const MeshSdf* fits[] = { &deep };
+    MN_CHECK(BuildMeshSdfAtlas(fits, 1, 4.0f, atlas));
+}
@@ -0,0 +1,130 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the wrapped 3D mip chain in TextureUtils.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Utils/TextureUtils.h>
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    uint32_t GetMipSize(uint32_t size, uint32_t mip)
+    {
+        return std::max(1u, size >> mip);
+    }
+
+    // Random values per texel and channel, so every tap the filter takes shows up in the result
+    std::vector<float> MakeNoiseVolume(uint32_t width, uint32_t height, uint32_t depth, uint32_t channels, uint32_t seed)
+    {
+        std::mt19937 rng(seed);
+        std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+        std::vector<float> texels((size_t)width * height * depth * channels);
+        for (float& texel : texels)
+            texel = unit(rng);
+        return texels;
+    }
+}
+
+MN_TEST(MipChainWrappedKeepsConstants)
+{
+    const uint32_t width = 8, height = 16, depth = 2, channels = 2;
+    const float values[channels] = { 0.25f, 3.0f };
+
+    std::vector<float> texels((size_t)width * height * depth * channels);
+    for (size_t i = 0; i < texels.size(); ++i)
+        texels[i] = values[i % channels];
+
+    std::vector<std::vector<float>> mips;
+    Build3DMipChainWrapped(texels.data(), width, height, depth, channels, mips);
+    MN_CHECK(mips.size() == GetMipCount(width, height, depth));
+    MN_CHECK(mips.size() == 5);
+
+    // The tent's weights sum to one, so there's nothing for it to blur on any level, down to the last 1x1x1
+    float maxError = 0.0f;
+    bool sizesMatch = true;
+    for (uint32_t mip = 0; mip < mips.size(); ++mip)
+    {
+        sizesMatch &= mips[mip].size() == (size_t)GetMipSize(width, mip) * GetMipSize(height, mip) * GetMipSize(depth, mip) * channels;
+        for (size_t i = 0; i < mips[mip].size(); ++i)
+            maxError = std::max(maxError, fabsf(mips[mip][i] - values[i % channels]));
+    }
+    MN_CHECK(sizesMatch);
+    MN_CHECK(maxError < 1e-6f);
+    MN_CHECK(mips.back().size() == channels);
+}
+
+MN_TEST(MipChainWrappedTiles)
+{
+    // Not a cube, so the axes run out of texels on different levels
+    const uint32_t width = 16, height = 8, depth = 4, channels = 2;
+    std::vector<float> tile = MakeNoiseVolume(width, height, depth, channels, 3);
+
+    // The same volume tiled twice along each axis. If the filter wraps, every level of it is the tile's level tiled twice,
+    // including the texels either side of the seams. Clamping at the edges would make the seams differ.
+    std::vector<float> tiled((size_t)8 * tile.size());
+    for (uint32_t z = 0; z < 2 * depth; ++z)
+        for (uint32_t y = 0; y < 2 * height; ++y)
+            for (uint32_t x = 0; x < 2 * width; ++x)
+                for (uint32_t c = 0; c < channels; ++c)
+                    tiled[(((size_t)z * 2 * height + y) * 2 * width + x) * channels + c] = tile[(((size_t)(z % depth) * height + y % height) * width + x % width) * channels + c];
+
+    std::vector<std::vector<float>> tileMips, tiledMips;
+    Build3DMipChainWrapped(tile.data(), width, height, depth, channels, tileMips);
+    Build3DMipChainWrapped(tiled.data(), 2 * width, 2 * height, 2 * depth, channels, tiledMips);
+    MN_CHECK(tileMips.size() == 5);
+    MN_CHECK(tiledMips.size() == 6);
+
+    float maxError = 0.0f;
+    for (uint32_t mip = 0; mip < tileMips.size(); ++mip)
+    {
+        const uint32_t tileW = GetMipSize(width, mip), tileH = GetMipSize(height, mip), tileD = GetMipSize(depth, mip);
+        const uint32_t tiledW = GetMipSize(2 * width, mip), tiledH = GetMipSize(2 * height, mip), tiledD = GetMipSize(2 * depth, mip);
+        for (uint32_t z = 0; z < tiledD; ++z)
+            for (uint32_t y = 0; y < tiledH; ++y)
+                for (uint32_t x = 0; x < tiledW; ++x)
+                    for (uint32_t c = 0; c < channels; ++c)
+                    {
+                        float expected = tileMips[mip][(((size_t)(z % tileD) * tileH + y % tileH) * tileW + x % tileW) * channels + c];
+                        float actual = tiledMips[mip][(((size_t)z * tiledH + y) * tiledW + x) * channels + c];
+                        maxError = std::max(maxError, fabsf(actual - expected));
+                    }
+    }
+    MN_CHECK(maxError < 1e-5f);
+
+    // Still not constant, the tiling test would pass trivially if the filter flattened everything
+    const std::vector<float>& mip1 = tileMips[1];
+    MN_CHECK(*std::max_element(mip1.begin(), mip1.end()) - *std::min_element(mip1.begin(), mip1.end()) > 0.1f);
+
+    // Wrapping weighs every texel the same, so each level keeps the tile's mean and the last level is exactly it
+    for (uint32_t c = 0; c < channels; ++c)
+    {
+        double mean = 0.0;
+        for (size_t i = c; i < tile.size(); i += channels)
+            mean += tile[i];
+        mean /= (double)(tile.size() / channels);
+        MN_CHECK_NEAR(tileMips.back()[c], (float)mean, 1e-5f);
+        MN_CHECK_NEAR(tiledMips.back()[c], (float)mean, 1e-5f);
+    }
+}
+
+MN_TEST(MipChainWrappedRejectsEmpty)
+{
+    std::vector<std::vector<float>> mips(3);
+    Build3DMipChainWrapped(nullptr, 4, 4, 4, 4, mips);
+    MN_CHECK(mips.empty());
+
+    const float texel[4] = {};
+    Build3DMipChainWrapped(texel, 0, 1, 1, 4, mips);
+    MN_CHECK(mips.empty());
+
+    Build3DMipChainWrapped(texel, 1, 1, 1, 4, mips);
+    MN_CHECK(mips.size() == 1 && mips[0].size() == 4);
+}
@@ -0,0 +1,136 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the cloud ray intervals in RayIntervalUtils.h
+----------------------------------------------*/
+#include "Test.h"
+#include "TestCamera.h"
+
+#include <Utils/RayIntervalUtils.h>
+#include <Utils/RaymarchUtils.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    // A few blobs of cloud, so some bricks are dropped and the rest are shrunk to their occupied cells
+    CloudDensityGrid MakeBlobGrid()
+    {
+        CloudDensityGrid grid;
+        grid.width = 64;
+        grid.height = 64;
+        grid.depth = 16;
+        grid.extinction.assign((size_t)grid.width * grid.height * grid.depth, 0.0f);
+        grid.emptyDistance.assign(grid.extinction.size(), 100.0f);
+
+        const int blobs[3][4] = { { 10, 12, 4, 5 }, { 40, 30, 9, 7 }, { 52, 55, 2, 3 } };
+        for (uint32_t z = 0; z < grid.depth; ++z)
+            for (uint32_t y = 0; y < grid.height; ++y)
+                for (uint32_t x = 0; x < grid.width; ++x)
+                    for (const int* blob : blobs)
+                    {
+                        int dx = (int)x - blob[0], dy = (int)y - blob[1], dz = (int)z - blob[2];
+                        if (dx * dx + dy * dy + dz * dz <= blob[3] * blob[3])
+                            grid.emptyDistance[((size_t)z * grid.height + y) * grid.width + x] = 0.0f;
+                    }
+        return grid;
+    }
+
+    // Every march texel's ray against every brick, without the screen rectangles
+    void BruteForceIntervals(const std::vector<CloudBrick>& bricks, const TestCamera& camera, uint32_t fullWidth, uint32_t fullHeight,
+                             uint32_t divisor, DirectX::XMINT2 marchOffset, uint32_t marchWidth, uint32_t marchHeight, std::vector<DirectX::XMFLOAT2>& out_intervals)
+    {
+        out_intervals.assign((size_t)marchWidth * marchHeight, DirectX::XMFLOAT2(CLOUD_RAY_NO_ENTER, CLOUD_RAY_NO_EXIT));
+        const DirectX::XMFLOAT3 eye(camera.invView._41, camera.invView._42, camera.invView._43);
+
+        for (uint32_t marchY = 0; marchY < marchHeight; ++marchY)
+        {
+            for (uint32_t marchX = 0; marchX < marchWidth; ++marchX)
+            {
+                DirectX::XMUINT2 pixel = GetMarchPixelCoord(marchX, marchY, fullWidth, fullHeight, divisor, marchOffset);
+                DirectX::XMFLOAT3 dir = GetWorldRayDirection(camera, pixel, fullWidth, fullHeight);
+
+                for (const CloudBrick& brick : bricks)
+                {
+                    float tEnter, tExit;
+                    if (!RayBoxIntersect(eye, dir, brick.minBounds, brick.maxBounds, tEnter, tExit))
+                        continue;
+
+                    DirectX::XMFLOAT2& interval = out_intervals[(size_t)marchY * marchWidth + marchX];
+                    interval.x = std::min(interval.x, std::max(tEnter, 0.0f));
+                    interval.y = std::max(interval.y, tExit);
+                }
+            }
+        }
+    }
+}
+
+MN_TEST(CloudBricksCoverOccupiedCells)
+{
+    CloudDensityGrid grid = MakeBlobGrid();
+    std::vector<CloudBrick> bricks;
+    BuildCloudBricks(grid, bricks);
+
+    MN_CHECK(!bricks.empty());
+    MN_CHECK(bricks.size() < MAX_CLOUD_BRICKS);
+
+    // Every cell that may hold cloud has its center inside some brick
+    for (uint32_t z = 0; z < grid.depth; ++z)
+        for (uint32_t y = 0; y < grid.height; ++y)
+            for (uint32_t x = 0; x < grid.width; ++x)
+            {
+                if (grid.emptyDistance[((size_t)z * grid.height + y) * grid.width + x] > 0.0f)
+                    continue;
+
+                DirectX::XMFLOAT3 center = GetCloudVolumeTexelCenter(x, y, z, grid.width, grid.height, grid.depth);
+                bool covered = false;
+                for (const CloudBrick& brick : bricks)
+                    covered |= center.x >= brick.minBounds.x && center.x <= brick.maxBounds.x &&
+                               center.y >= brick.minBounds.y && center.y <= brick.maxBounds.y &&
+                               center.z >= brick.minBounds.z && center.z <= brick.maxBounds.z;
+                MN_CHECK(covered);
+            }
+}
+
+MN_TEST(CloudRayIntervalsMatchBruteForce)
+{
+    CloudDensityGrid grid = MakeBlobGrid();
+    std::vector<CloudBrick> bricks;
+    BuildCloudBricks(grid, bricks);
+
+    const uint32_t fullWidth = 160;
+    const uint32_t fullHeight = 90;
+
+    // From outside the volume looking in, from inside it, and from right up against a brick
+    const TestCamera cameras[] = {
+        MakeCamera(DirectX::XMFLOAT3(-2600.0f, 400.0f, -2600.0f), DirectX::XMFLOAT3(1.0f, -0.15f, 1.0f), (float)fullWidth / fullHeight),
+        MakeCamera(DirectX::XMFLOAT3(0.0f, 200.0f, 0.0f), DirectX::XMFLOAT3(-0.7f, 0.1f, -0.6f), (float)fullWidth / fullHeight),
+        MakeCamera(DirectX::XMFLOAT3(bricks[0].minBounds.x - 0.05f, bricks[0].minBounds.y + 1.0f, bricks[0].minBounds.z + 1.0f), DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f), (float)fullWidth / fullHeight)
+    };
+
+    for (const TestCamera& camera : cameras)
+    {
+        for (uint32_t divisor : { 1u, 2u, 4u })
+        {
+            DirectX::XMUINT2 march = GetMarchResolution(fullWidth, fullHeight, divisor);
+            DirectX::XMINT2 offset = divisor == CLOUD_TEMPORAL_BLOCK_SIZE ? GetTemporalMarchOffset(5) : GetCenteredMarchOffset(divisor);
+
+            std::vector<DirectX::XMFLOAT2> intervals, expected;
+            BuildCloudRayIntervals(bricks, camera.view, camera.proj, camera.invView, fullWidth, fullHeight, divisor, offset, march.x, march.y, intervals);
+            BruteForceIntervals(bricks, camera, fullWidth, fullHeight, divisor, offset, march.x, march.y, expected);
+
+            // The screen rectangles only skip work, so every texel matches exactly
+            uint32_t mismatches = 0, hits = 0;
+            for (size_t i = 0; i < expected.size(); ++i)
+            {
+                mismatches += intervals[i].x != expected[i].x || intervals[i].y != expected[i].y ? 1 : 0;
+                hits += expected[i].y > CLOUD_RAY_NO_EXIT ? 1 : 0;
+            }
+            MN_CHECK(mismatches == 0);
+            MN_CHECK(hits > 0);
+        }
+    }
+}
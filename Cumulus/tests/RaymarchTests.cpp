@@ -0,0 +1,295 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the raymarch CPU mirrors in RaymarchUtils.h
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Utils/RaymarchUtils.h>
+
+#include <algorithm>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    const float NEAR_Z = 0.1f;
+    const float FAR_Z = 1000.0f;
+
+    // Row-vector XMMatrixPerspectiveFovLH, written out so the test doesn't lean on DirectXMath
+    DirectX::XMFLOAT4X4 MakeProjection(float fovY, float aspect, float nearZ, float farZ)
+    {
+        float yScale = 1.0f / tanf(fovY * 0.5f);
+        float range = farZ / (farZ - nearZ);
+
+        DirectX::XMFLOAT4X4 proj = {};
+        proj._11 = yScale / aspect;
+        proj._22 = yScale;
+        proj._33 = range;
+        proj._34 = 1.0f;
+        proj._43 = -range * nearZ;
+        return proj;
+    }
+
+    // Device depth written for a view space Z
+    float ToDeviceDepth(float viewZ, const DirectX::XMFLOAT4X4& proj)
+    {
+        return proj._33 + proj._43 / viewZ;
+    }
+}
+
+MN_TEST(LinearizeDepthKnownDepths)
+{
+    DirectX::XMFLOAT4X4 proj = MakeProjection(1.0f, 16.0f / 9.0f, NEAR_Z, FAR_Z);
+
+    MN_CHECK_NEAR(LinearizeDepth(0.0f, proj), NEAR_Z, 1e-5f);
+    MN_CHECK_NEAR(LinearizeDepth(ToDeviceDepth(50.0f, proj), proj), 50.0f, 50.0f * 1e-4f);
+    MN_CHECK_NEAR(LinearizeDepth(ToDeviceDepth(900.0f, proj), proj), 900.0f, 900.0f * 1e-2f);
+
+    // Cleared depth is the sky, not the far plane
+    MN_CHECK(LinearizeDepth(1.0f, proj) == RAYMARCH_SKY_DISTANCE);
+
+    // The near/far overload agrees with the matrix one
+    for (float depth : { 0.0f, 0.5f, 0.9f, 0.999f, 1.0f })
+        MN_CHECK_NEAR(LinearizeDepth(depth, NEAR_Z, FAR_Z), LinearizeDepth(depth, proj), LinearizeDepth(depth, proj) * 1e-5f);
+}
+
+MN_TEST(DepthToRayDistanceAlongRay)
+{
+    const float width = 1280.0f;
+    const float height = 720.0f;
+    DirectX::XMFLOAT4X4 proj = MakeProjection(1.0f, width / height, NEAR_Z, FAR_Z);
+    float device = ToDeviceDepth(20.0f, proj);
+
+    // Straight ahead the ray distance is the view depth
+    MN_CHECK_NEAR(DepthToRayDistance(device, proj, DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f)), 20.0f, 20.0f * 1e-4f);
+
+    // Off axis, the distance along the ray projects back onto the same view depth
+    for (DirectX::XMFLOAT2 pixel : { DirectX::XMFLOAT2(0.0f, 0.0f), DirectX::XMFLOAT2(width - 1.0f, 0.0f), DirectX::XMFLOAT2(300.0f, 700.0f) })
+    {
+        DirectX::XMFLOAT3 dir = GetViewRayDirection(pixel.x, pixel.y, width, height, proj);
+        float distance = DepthToRayDistance(device, proj, dir);
+        MN_CHECK(distance > 20.0f);
+        MN_CHECK_NEAR(distance * dir.z, 20.0f, 20.0f * 1e-4f);
+    }
+
+    MN_CHECK(DepthToRayDistance(1.0f, proj, DirectX::XMFLOAT3(0.0f, 0.0f, 1.0f)) == RAYMARCH_SKY_DISTANCE);
+    MN_CHECK(DepthToRayDistance(device, proj, DirectX::XMFLOAT3(1.0f, 0.0f, 0.0f)) == RAYMARCH_SKY_DISTANCE);
+}
+
+MN_TEST(BilateralUpsampleFlatDepth)
+{
+    const uint32_t divisor = 2;
+    const uint32_t fullWidth = 17;
+    const uint32_t fullHeight = 9;
+    DirectX::XMUINT2 march = GetMarchResolution(fullWidth, fullHeight, divisor);
+    DirectX::XMINT2 offset = GetCenteredMarchOffset(divisor);
+
+    std::vector<DirectX::XMFLOAT4> lowResCloud(march.x * march.y);
+    std::vector<DirectX::XMFLOAT2> lowResDepth(march.x * march.y, DirectX::XMFLOAT2(30.0f, 100.0f));
+    for (uint32_t i = 0; i < lowResCloud.size(); ++i)
+        lowResCloud[i] = DirectX::XMFLOAT4((float)i, 0.5f, 0.25f, 0.75f);
+
+    std::vector<float> fullResDepth(fullWidth * fullHeight, 30.0f);
+    std::vector<DirectX::XMFLOAT4> upsampled(fullWidth * fullHeight);
+    BilateralUpsampleClouds(lowResCloud.data(), lowResDepth.data(), march.x, march.y, fullResDepth.data(), fullWidth, fullHeight, divisor, offset, upsampled.data());
+
+    // Pixels that were marched get their own sample back
+    for (uint32_t y = 0; y < march.y; ++y)
+    {
+        for (uint32_t x = 0; x < march.x; ++x)
+        {
+            DirectX::XMUINT2 pixel = GetMarchPixelCoord(x, y, fullWidth, fullHeight, divisor, offset);
+            if (pixel.x != x * divisor + offset.x || pixel.y != y * divisor + offset.y)
+                continue;   // Clamped onto the edge, shared with another texel
+            MN_CHECK_NEAR(upsampled[pixel.y * fullWidth + pixel.x].x, lowResCloud[y * march.x + x].x, 1e-4f);
+        }
+    }
+
+    // At one depth the filter is plain bilinear, so channels that don't vary stay put and the rest stay in range
+    for (const DirectX::XMFLOAT4& cloud : upsampled)
+    {
+        MN_CHECK_NEAR(cloud.y, 0.5f, 1e-5f);
+        MN_CHECK_NEAR(cloud.w, 0.75f, 1e-5f);
+        MN_CHECK(cloud.x >= 0.0f && cloud.x <= (float)(lowResCloud.size() - 1));
+    }
+
+    // Full resolution marching passes straight through
+    std::vector<DirectX::XMFLOAT4> passthrough(fullWidth * fullHeight);
+    std::vector<DirectX::XMFLOAT4> fullCloud(fullWidth * fullHeight, DirectX::XMFLOAT4(1.0f, 2.0f, 3.0f, 0.5f));
+    std::vector<DirectX::XMFLOAT2> fullDepth(fullWidth * fullHeight, DirectX::XMFLOAT2(30.0f, 100.0f));
+    BilateralUpsampleClouds(fullCloud.data(), fullDepth.data(), fullWidth, fullHeight, fullResDepth.data(), fullWidth, fullHeight, 1, DirectX::XMINT2(0, 0), passthrough.data());
+    MN_CHECK(passthrough[5 * fullWidth + 7].z == 3.0f);
+}
+
+MN_TEST(BilateralUpsampleKeepsSilhouettes)
+{
+    // Left half of the screen is a near wall with no cloud in front of it, the right half is open sky with thick cloud
+    const uint32_t divisor = 4;
+    const uint32_t fullWidth = 32;
+    const uint32_t fullHeight = 8;
+    const float nearDepth = 10.0f;
+    const float skyDepth = RAYMARCH_SKY_DISTANCE;
+    DirectX::XMUINT2 march = GetMarchResolution(fullWidth, fullHeight, divisor);
+    DirectX::XMINT2 offset = GetCenteredMarchOffset(divisor);
+
+    std::vector<DirectX::XMFLOAT4> lowResCloud(march.x * march.y);
+    std::vector<DirectX::XMFLOAT2> lowResDepth(march.x * march.y);
+    for (uint32_t y = 0; y < march.y; ++y)
+    {
+        for (uint32_t x = 0; x < march.x; ++x)
+        {
+            bool wall = x < march.x / 2;
+            lowResCloud[y * march.x + x] = wall ? DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f) : DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 0.1f);
+            lowResDepth[y * march.x + x] = DirectX::XMFLOAT2(wall ? nearDepth : skyDepth, 500.0f);
+        }
+    }
+
+    std::vector<float> fullResDepth(fullWidth * fullHeight);
+    for (uint32_t y = 0; y < fullHeight; ++y)
+        for (uint32_t x = 0; x < fullWidth; ++x)
+            fullResDepth[y * fullWidth + x] = x < fullWidth / 2 ? nearDepth : skyDepth;
+
+    std::vector<DirectX::XMFLOAT4> upsampled(fullWidth * fullHeight);
+    BilateralUpsampleClouds(lowResCloud.data(), lowResDepth.data(), march.x, march.y, fullResDepth.data(), fullWidth, fullHeight, divisor, offset, upsampled.data());
+
+    // Pixels either side of the edge only take from their own side, a plain bilinear filter would blend them
+    for (uint32_t y = 0; y < fullHeight; ++y)
+    {
+        for (uint32_t x = fullWidth / 2 - 3; x < fullWidth / 2 + 3; ++x)
+        {
+            const DirectX::XMFLOAT4& cloud = upsampled[y * fullWidth + x];
+            bool wall = x < fullWidth / 2;
+            MN_CHECK_NEAR(cloud.w, wall ? 1.0f : 0.1f, 1e-3f);
+            MN_CHECK_NEAR(cloud.x, wall ? 0.0f : 1.0f, 1e-3f);
+        }
+    }
+}
+
+namespace
+{
+    // A 16x16 screen marched one pixel per 4x4 block, from a camera that sat still at the origin looking down +Z
+    struct TemporalScene
+    {
+        static const uint32_t SIZE = 16;
+        static const uint32_t MARCH_SIZE = SIZE / CLOUD_TEMPORAL_BLOCK_SIZE;
+
+        std::vector<DirectX::XMFLOAT4> cloud = std::vector<DirectX::XMFLOAT4>(MARCH_SIZE * MARCH_SIZE);
+        std::vector<DirectX::XMFLOAT2> cloudDepth = std::vector<DirectX::XMFLOAT2>(MARCH_SIZE * MARCH_SIZE, DirectX::XMFLOAT2(RAYMARCH_SKY_DISTANCE, 500.0f));
+        std::vector<DirectX::XMFLOAT4> history = std::vector<DirectX::XMFLOAT4>(SIZE * SIZE);
+        std::vector<DirectX::XMFLOAT2> historyDepth = std::vector<DirectX::XMFLOAT2>(SIZE * SIZE, DirectX::XMFLOAT2(RAYMARCH_SKY_DISTANCE, 500.0f));
+        std::vector<float> sceneDepth = std::vector<float>(SIZE * SIZE, RAYMARCH_SKY_DISTANCE);
+        TemporalCloudInputs inputs;
+
+        TemporalScene()
+        {
+            // Each march texel holds its own index, so the neighborhood clamp has a known range
+            for (uint32_t i = 0; i < cloud.size(); ++i)
+                cloud[i] = DirectX::XMFLOAT4((float)i, (float)i, (float)i, 0.5f);
+
+            DirectX::XMFLOAT4X4 identity = {};
+            identity._11 = identity._22 = identity._33 = identity._44 = 1.0f;
+
+            inputs.fullWidth = inputs.fullHeight = SIZE;
+            inputs.marchWidth = inputs.marchHeight = MARCH_SIZE;
+            inputs.marchOffset = GetTemporalMarchOffset(0);
+            inputs.historyValid = true;
+            inputs.proj = MakeProjection(1.0f, 1.0f, NEAR_Z, FAR_Z);
+            inputs.invView = identity;
+            inputs.prevViewProj = inputs.proj;
+        }
+
+        void Resolve(uint32_t x, uint32_t y, DirectX::XMFLOAT4& out_cloud, DirectX::XMFLOAT2& out_depth)
+        {
+            inputs.cloud = cloud.data();
+            inputs.cloudDepth = cloudDepth.data();
+            inputs.history = history.data();
+            inputs.historyDepth = historyDepth.data();
+            inputs.sceneDepth = sceneDepth.data();
+            ResolveTemporalCloudPixel(inputs, x, y, out_cloud, out_depth);
+        }
+
+        DirectX::XMFLOAT4 Spatial(uint32_t x, uint32_t y) const
+        {
+            return BilateralUpsampleCloud(cloud.data(), cloudDepth.data(), MARCH_SIZE, MARCH_SIZE, x, y, sceneDepth[y * SIZE + x], CLOUD_TEMPORAL_BLOCK_SIZE, inputs.marchOffset);
+        }
+    };
+}
+
+MN_TEST(ReprojectToPreviousFrameStaticCamera)
+{
+    DirectX::XMFLOAT4X4 viewProj = MakeProjection(1.0f, 1.0f, NEAR_Z, FAR_Z);
+    DirectX::XMFLOAT2 uv;
+    float viewZ;
+
+    MN_CHECK(ReprojectToPreviousFrame(DirectX::XMFLOAT3(0.0f, 0.0f, 40.0f), viewProj, uv, viewZ));
+    MN_CHECK_NEAR(uv.x, 0.5f, 1e-6f);
+    MN_CHECK_NEAR(uv.y, 0.5f, 1e-6f);
+    MN_CHECK_NEAR(viewZ, 40.0f, 1e-4f);
+
+    // A point along a pixel's ray lands back on that pixel's center
+    DirectX::XMFLOAT3 dir = GetViewRayDirection(3.0f, 12.0f, 16.0f, 16.0f, viewProj);
+    MN_CHECK(ReprojectToPreviousFrame(DirectX::XMFLOAT3(dir.x * 70.0f, dir.y * 70.0f, dir.z * 70.0f), viewProj, uv, viewZ));
+    MN_CHECK_NEAR(uv.x * 16.0f, 3.5f, 1e-3f);
+    MN_CHECK_NEAR(uv.y * 16.0f, 12.5f, 1e-3f);
+
+    MN_CHECK(!ReprojectToPreviousFrame(DirectX::XMFLOAT3(0.0f, 0.0f, -5.0f), viewProj, uv, viewZ));
+    MN_CHECK(!ReprojectToPreviousFrame(DirectX::XMFLOAT3(100.0f, 0.0f, 1.0f), viewProj, uv, viewZ));
+
+    MN_CHECK(!IsHistoryDisoccluded(RAYMARCH_SKY_DISTANCE, RAYMARCH_SKY_DISTANCE));
+    MN_CHECK(!IsHistoryDisoccluded(10.0f, 10.2f));
+    MN_CHECK(IsHistoryDisoccluded(10.0f, 50.0f));
+}
+
+MN_TEST(TemporalResolveHistoryAndClamp)
+{
+    TemporalScene scene;
+    DirectX::XMFLOAT4 resolved;
+    DirectX::XMFLOAT2 depth;
+
+    // Marched pixels take this frame's sample no matter what the history says
+    std::fill(scene.history.begin(), scene.history.end(), DirectX::XMFLOAT4(100.0f, 100.0f, 100.0f, 1.0f));
+    scene.Resolve(4, 4, resolved, depth);
+    MN_CHECK(resolved.x == scene.cloud[1 * TemporalScene::MARCH_SIZE + 1].x);
+    MN_CHECK(depth.y == 500.0f);
+
+    // Pixel (6, 5) sits in march texel (1, 1), whose 3x3 neighborhood holds 0 to 10
+    std::fill(scene.history.begin(), scene.history.end(), DirectX::XMFLOAT4(5.5f, 5.5f, 5.5f, 0.5f));
+    scene.Resolve(6, 5, resolved, depth);
+    MN_CHECK_NEAR(resolved.x, 5.5f, 1e-4f);
+    MN_CHECK_NEAR(resolved.w, 0.5f, 1e-6f);
+
+    // History outside the neighborhood is clamped onto it rather than trusted
+    std::fill(scene.history.begin(), scene.history.end(), DirectX::XMFLOAT4(100.0f, 100.0f, 100.0f, 0.5f));
+    scene.Resolve(6, 5, resolved, depth);
+    MN_CHECK_NEAR(resolved.x, 10.0f, 1e-4f);
+
+    // Without a history the pixel is a spatial upsample of this frame
+    scene.inputs.historyValid = false;
+    scene.Resolve(6, 5, resolved, depth);
+    MN_CHECK_NEAR(resolved.x, scene.Spatial(6, 5).x, 1e-5f);
+}
+
+MN_TEST(TemporalResolveRejectsDisocclusion)
+{
+    // An opaque wall 10 units away this frame
+    TemporalScene scene;
+    std::fill(scene.sceneDepth.begin(), scene.sceneDepth.end(), 10.0f);
+    std::fill(scene.cloudDepth.begin(), scene.cloudDepth.end(), DirectX::XMFLOAT2(10.0f, 5.0f));
+    std::fill(scene.history.begin(), scene.history.end(), DirectX::XMFLOAT4(5.5f, 5.5f, 5.5f, 0.5f));
+    DirectX::XMFLOAT4 resolved;
+    DirectX::XMFLOAT2 depth;
+
+    // Last frame saw the same wall, so the history is used
+    std::fill(scene.historyDepth.begin(), scene.historyDepth.end(), DirectX::XMFLOAT2(10.0f, 5.0f));
+    scene.Resolve(6, 5, resolved, depth);
+    MN_CHECK_NEAR(resolved.x, 5.5f, 1e-4f);
+    MN_CHECK_NEAR(depth.x, 10.0f, 1e-6f);
+
+    // Last frame saw something much further away there, so the history belongs to another surface
+    std::fill(scene.historyDepth.begin(), scene.historyDepth.end(), DirectX::XMFLOAT2(50.0f, 5.0f));
+    scene.Resolve(6, 5, resolved, depth);
+    MN_CHECK_NEAR(resolved.x, scene.Spatial(6, 5).x, 1e-5f);
+    MN_CHECK(fabsf(resolved.x - 5.5f) > 1e-2f);
+}
@@ -0,0 +1,219 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Tests for the incremental broadphase in SweepAndPrune.h,
+checked against testing every pair of live boxes
+----------------------------------------------*/
+#include "Test.h"
+
+#include <Core/SweepAndPrune.h>
+
+#include <algorithm>
+#include <random>
+#include <vector>
+
+using namespace Muon;
+
+namespace
+{
+    struct TestObject
+    {
+        AABB bounds;
+        uint32_t layer;
+        uint32_t mask;
+        bool alive;
+    };
+
+    // Snapped to quarters so plenty of boxes share endpoint values and only touch
+    AABB MakeBox(std::mt19937& rng)
+    {
+        std::uniform_int_distribution<int> position(0, 80);
+        std::uniform_int_distribution<int> size(1, 12);
+
+        AABB box;
+        box.min = DirectX::XMFLOAT3A(0.25f * position(rng), 0.25f * position(rng), 0.25f * position(rng));
+        box.max = DirectX::XMFLOAT3A(box.min.x + 0.25f * size(rng), box.min.y + 0.25f * size(rng), box.min.z + 0.25f * size(rng));
+        return box;
+    }
+
+    uint32_t MakeLayer(std::mt19937& rng)
+    {
+        return 1u << (rng() % 3);
+    }
+
+    // Either everything or everything but one of the layers
+    uint32_t MakeMask(std::mt19937& rng)
+    {
+        return rng() % 2 ? UINT32_MAX : ~(1u << (rng() % 3));
+    }
+
+    // Touching boxes count as overlapping, like the endpoint sort
+    bool Overlaps(const AABB& a, const AABB& b)
+    {
+        return a.min.x <= b.max.x && b.min.x <= a.max.x
+            && a.min.y <= b.max.y && b.min.y <= a.max.y
+            && a.min.z <= b.max.z && b.min.z <= a.max.z;
+    }
+
+    // Pairs of the broadphase and of every pair of live objects, both sorted, plus whether any pair came back twice or out of order
+    bool MatchesBruteForce(const SweepAndPrune& broadphase, const std::vector<TestObject>& objects)
+    {
+        std::vector<std::pair<uint32_t, uint32_t>> expected;
+        for (uint32_t a = 0; a < objects.size(); ++a)
+        {
+            for (uint32_t b = a + 1; b < objects.size(); ++b)
+            {
+                const TestObject& objectA = objects[a];
+                const TestObject& objectB = objects[b];
+                if (objectA.alive && objectB.alive && (objectA.layer & objectB.mask) && (objectB.layer & objectA.mask) && Overlaps(objectA.bounds, objectB.bounds))
+                    expected.emplace_back(a, b);
+            }
+        }
+
+        std::vector<std::pair<uint32_t, uint32_t>> actual;
+        for (const ConvexQueryPair& pair : broadphase.GetPairs())
+        {
+            if (pair.objectA >= pair.objectB)
+                return false;
+            actual.emplace_back(pair.objectA, pair.objectB);
+        }
+        std::sort(actual.begin(), actual.end());
+        return actual == expected;
+    }
+
+    uint32_t CountAlive(const std::vector<TestObject>& objects)
+    {
+        return (uint32_t)std::count_if(objects.begin(), objects.end(), [](const TestObject& object) { return object.alive; });
+    }
+}
+
+MN_TEST(SweepAndPruneMatchesBruteForce)
+{
+    std::mt19937 rng(9);
+    SweepAndPrune broadphase;
+    std::vector<TestObject> objects;
+
+    // Objects added one by one, handles are dense from 0
+    for (uint32_t i = 0; i < 40; ++i)
+    {
+        TestObject object = { MakeBox(rng), MakeLayer(rng), MakeMask(rng), true };
+        uint32_t handle = broadphase.AddObject(object.bounds, object.layer, object.mask);
+        MN_CHECK(handle == objects.size());
+        objects.push_back(object);
+    }
+    MN_CHECK(MatchesBruteForce(broadphase, objects));
+
+    // Moves of every size, from nudges that swap with a neighbor or two to jumps across the whole range.
+    // Some boxes grow or shrink in place, which moves only one endpoint per axis.
+    uint32_t mismatches = 0;
+    for (uint32_t step = 0; step < 400; ++step)
+    {
+        uint32_t handle = rng() % objects.size();
+        TestObject& object = objects[handle];
+        if (!object.alive)
+            continue;
+
+        AABB bounds = object.bounds;
+        switch (rng() % 3)
+        {
+        case 0:
+        {
+            float dx = 0.25f * (float)((int)(rng() % 5) - 2), dy = 0.25f * (float)((int)(rng() % 5) - 2), dz = 0.25f * (float)((int)(rng() % 5) - 2);
+            bounds.min = DirectX::XMFLOAT3A(bounds.min.x + dx, bounds.min.y + dy, bounds.min.z + dz);
+            bounds.max = DirectX::XMFLOAT3A(bounds.max.x + dx, bounds.max.y + dy, bounds.max.z + dz);
+            break;
+        }
+        case 1:
+        {
+            float grow = 0.25f * (float)((int)(rng() % 5) - 2);
+            bounds.max = DirectX::XMFLOAT3A(std::max(bounds.max.x + grow, bounds.min.x), std::max(bounds.max.y + grow, bounds.min.y), std::max(bounds.max.z + grow, bounds.min.z));
+            break;
+        }
+        default:
+            bounds = MakeBox(rng);
+            break;
+        }
+
+        object.bounds = bounds;
+        broadphase.UpdateObject(handle, bounds);
+        mismatches += MatchesBruteForce(broadphase, objects) ? 0 : 1;
+    }
+    MN_CHECK(mismatches == 0);
+
+    // Removed handles come back for the next objects added
+    std::vector<uint32_t> removed;
+    for (uint32_t handle = 0; handle < objects.size(); handle += 3)
+    {
+        broadphase.RemoveObject(handle);
+        objects[handle].alive = false;
+        removed.push_back(handle);
+        MN_CHECK(MatchesBruteForce(broadphase, objects));
+    }
+    MN_CHECK(broadphase.GetObjectCount() == CountAlive(objects));
+
+    for (size_t i = 0; i < removed.size(); ++i)
+    {
+        TestObject object = { MakeBox(rng), MakeLayer(rng), MakeMask(rng), true };
+        uint32_t handle = broadphase.AddObject(object.bounds, object.layer, object.mask);
+        MN_CHECK(handle < objects.size() && !objects[handle].alive);
+        if (handle < objects.size())
+            objects[handle] = object;
+    }
+    MN_CHECK(broadphase.GetObjectCount() == (uint32_t)objects.size());
+    MN_CHECK(MatchesBruteForce(broadphase, objects));
+
+    // Updates after the endpoint arrays were compacted by the removals
+    mismatches = 0;
+    for (uint32_t step = 0; step < 100; ++step)
+    {
+        uint32_t handle = rng() % objects.size();
+        objects[handle].bounds = MakeBox(rng);
+        broadphase.UpdateObject(handle, objects[handle].bounds);
+        mismatches += MatchesBruteForce(broadphase, objects) ? 0 : 1;
+    }
+    MN_CHECK(mismatches == 0);
+}
+
+MN_TEST(SweepAndPruneBulkAdd)
+{
+    std::mt19937 rng(4);
+    SweepAndPrune broadphase;
+    std::vector<TestObject> objects;
+
+    // A few added one by one first, so the bulk sort has to merge with endpoints already there
+    for (uint32_t i = 0; i < 10; ++i)
+    {
+        TestObject object = { MakeBox(rng), 1, UINT32_MAX, true };
+        broadphase.AddObject(object.bounds, object.layer, object.mask);
+        objects.push_back(object);
+    }
+
+    // One bulk add per layer, each leaving out its own layer from the mask
+    for (uint32_t layer = 0; layer < 3; ++layer)
+    {
+        std::vector<AABB> bounds;
+        for (uint32_t i = 0; i < 50; ++i)
+            bounds.push_back(MakeBox(rng));
+
+        std::vector<uint32_t> handles(bounds.size());
+        broadphase.AddObjects(bounds.data(), (uint32_t)bounds.size(), handles.data(), 2u << layer, ~(2u << layer));
+        for (uint32_t i = 0; i < bounds.size(); ++i)
+        {
+            MN_CHECK(handles[i] == objects.size());
+            objects.push_back({ bounds[i], 2u << layer, ~(2u << layer), true });
+        }
+        MN_CHECK(MatchesBruteForce(broadphase, objects));
+    }
+    MN_CHECK(broadphase.GetObjectCount() == (uint32_t)objects.size());
+
+    // Incremental updates keep working from the bulk sorted endpoints
+    uint32_t mismatches = 0;
+    for (uint32_t step = 0; step < 200; ++step)
+    {
+        uint32_t handle = rng() % objects.size();
+        objects[handle].bounds = MakeBox(rng);
+        broadphase.UpdateObject(handle, objects[handle].bounds);
+        mismatches += MatchesBruteForce(broadphase, objects) ? 0 : 1;
+    }
+    MN_CHECK(mismatches == 0);
+}
@@ -0,0 +1,60 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Minimal test registry for the CPU mirrors in Utils. Each
+MN_TEST registers itself before main runs, checks report the failing line
+and keep going, so one run lists every broken check.
+----------------------------------------------*/
+#ifndef MUON_TEST_H
+#define MUON_TEST_H
+
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+namespace Muon::Test
+{
+    typedef void (*TestFunction)(bool& failed);
+
+    struct TestCase
+    {
+        const char* name;
+        TestFunction function;
+    };
+
+    inline std::vector<TestCase>& GetTests()
+    {
+        static std::vector<TestCase> tests;
+        return tests;
+    }
+
+    struct Registrar
+    {
+        Registrar(const char* name, TestFunction function) { GetTests().push_back({ name, function }); }
+    };
+}
+
+#define MN_TEST(name) \
+    static void name(bool& mn_failed); \
+    static Muon::Test::Registrar name##_registrar(#name, name); \
+    static void name(bool& mn_failed)
+
+#define MN_CHECK(expr) \
+    do { \
+        if (!(expr)) { \
+            printf("  %s(%d): %s\n", __FILE__, __LINE__, #expr); \
+            mn_failed = true; \
+        } \
+    } while (0)
+
+#define MN_CHECK_NEAR(actual, expected, tolerance) \
+    do { \
+        double mn_actual = (double)(actual); \
+        double mn_expected = (double)(expected); \
+        if (!(fabs(mn_actual - mn_expected) <= (double)(tolerance))) { \
+            printf("  %s(%d): %s = %g, expected %g\n", __FILE__, __LINE__, #actual, mn_actual, mn_expected); \
+            mn_failed = true; \
+        } \
+    } while (0)
+
+#endif
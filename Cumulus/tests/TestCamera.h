@@ -0,0 +1,70 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Hand built camera matrices for the tests, since they run without the DirectXMath functions
+----------------------------------------------*/
+#ifndef MUON_TESTCAMERA_H
+#define MUON_TESTCAMERA_H
+
+#include <Utils/RaymarchUtils.h>
+
+#include <DirectXMath.h>
+
+#include <cmath>
+#include <cstdint>
+
+namespace Muon
+{
+    struct TestCamera
+    {
+        DirectX::XMFLOAT4X4 view;
+        DirectX::XMFLOAT4X4 invView;
+        DirectX::XMFLOAT4X4 proj;
+    };
+
+    inline DirectX::XMFLOAT3 Normalize(const DirectX::XMFLOAT3& v)
+    {
+        float length = sqrtf(v.x * v.x + v.y * v.y + v.z * v.z);
+        return DirectX::XMFLOAT3(v.x / length, v.y / length, v.z / length);
+    }
+
+    // Row-vector LH look-to camera, like XMMatrixLookToLH and XMMatrixPerspectiveFovLH
+    inline TestCamera MakeCamera(const DirectX::XMFLOAT3& eye, const DirectX::XMFLOAT3& forward, float aspect)
+    {
+        DirectX::XMFLOAT3 f = Normalize(forward);
+        DirectX::XMFLOAT3 r = Normalize(DirectX::XMFLOAT3(f.z, 0.0f, -f.x));
+        DirectX::XMFLOAT3 u(f.y * r.z - f.z * r.y, f.z * r.x - f.x * r.z, f.x * r.y - f.y * r.x);
+
+        TestCamera camera = {};
+        camera.invView._11 = r.x; camera.invView._12 = r.y; camera.invView._13 = r.z;
+        camera.invView._21 = u.x; camera.invView._22 = u.y; camera.invView._23 = u.z;
+        camera.invView._31 = f.x; camera.invView._32 = f.y; camera.invView._33 = f.z;
+        camera.invView._41 = eye.x; camera.invView._42 = eye.y; camera.invView._43 = eye.z; camera.invView._44 = 1.0f;
+
+        camera.view._11 = r.x; camera.view._12 = u.x; camera.view._13 = f.x;
+        camera.view._21 = r.y; camera.view._22 = u.y; camera.view._23 = f.y;
+        camera.view._31 = r.z; camera.view._32 = u.z; camera.view._33 = f.z;
+        camera.view._41 = -(r.x * eye.x + r.y * eye.y + r.z * eye.z);
+        camera.view._42 = -(u.x * eye.x + u.y * eye.y + u.z * eye.z);
+        camera.view._43 = -(f.x * eye.x + f.y * eye.y + f.z * eye.z);
+        camera.view._44 = 1.0f;
+
+        const float nearZ = 0.1f, farZ = 10000.0f, yScale = 1.0f / tanf(0.5f);
+        camera.proj._11 = yScale / aspect;
+        camera.proj._22 = yScale;
+        camera.proj._33 = farZ / (farZ - nearZ);
+        camera.proj._34 = 1.0f;
+        camera.proj._43 = -nearZ * farZ / (farZ - nearZ);
+        return camera;
+    }
+
+    // World space direction of a full resolution pixel's ray
+    inline DirectX::XMFLOAT3 GetWorldRayDirection(const TestCamera& camera, DirectX::XMUINT2 pixel, uint32_t fullWidth, uint32_t fullHeight)
+    {
+        DirectX::XMFLOAT3 d = GetViewRayDirection((float)pixel.x, (float)pixel.y, (float)fullWidth, (float)fullHeight, camera.proj);
+        const DirectX::XMFLOAT4X4& iv = camera.invView;
+        return DirectX::XMFLOAT3(d.x * iv._11 + d.y * iv._21 + d.z * iv._31, d.x * iv._12 + d.y * iv._22 + d.z * iv._32, d.x * iv._13 + d.y * iv._23 + d.z * iv._33);
+    }
+}
+
+#endif
@@ -0,0 +1,21 @@
+/*----------------------------------------------
+Ruben Young (rubenaryo@gmail.com)
+Date : 2025/12
+Description : Runs every registered test, returns the number that failed
+----------------------------------------------*/
+#include "Test.h"
+
+int main()
+{
+    int failures = 0;
+    for (const Muon::Test::TestCase& test : Muon::Test::GetTests())
+    {
+        bool failed = false;
+        test.function(failed);
+        printf("[%s] %s\n", failed ? "FAIL" : " OK ", test.name);
+        failures += failed ? 1 : 0;
+    }
+
+    printf("%d of %d tests failed\n", failures, (int)Muon::Test::GetTests().size());
+    return failures;
+}
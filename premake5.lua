@@ -70,6 +70,7 @@ project (APP_NAME)
         cppdialect "C++17"
         staticruntime "On"
         systemversion "latest"
+        vectorextensions "AVX2"
 
         defines
         {
@@ -86,6 +87,57 @@ project (APP_NAME)
         optimize "On"
         staticruntime "Off"
 
+project "CumulusTests"
+    location "Cumulus/tests"
+    kind "ConsoleApp"
+    language "C++"
+
+    targetdir ("_bin/" .. outputdir .. "/%{prj.name}")
+    objdir ("_int/" .. outputdir .. "/%{prj.name}")
+
+    -- The CPU mirrors of the shaders, the blue noise and mesh SDF atlas they sample, plus the hull builder some of them take and the collision queries over hulls
+    files
+    {
+        "Cumulus/tests/**.h",
+        "Cumulus/tests/**.cpp",
+        "Cumulus/src/Utils/**.h",
+        "Cumulus/src/Utils/**.cpp",
+        "Cumulus/src/Core/BlueNoise.h",
+        "Cumulus/src/Core/BlueNoise.cpp",
+        "Cumulus/src/Core/Hull.h",
+        "Cumulus/src/Core/Hull.cpp",
+        "Cumulus/src/Core/ConvexQuery.h",
+        "Cumulus/src/Core/ConvexQuery.cpp",
+        "Cumulus/src/Core/SweepAndPrune.h",
+        "Cumulus/src/Core/SweepAndPrune.cpp",
+        "Cumulus/src/Core/MeshSdf.h",
+        "Cumulus/src/Core/MeshSdf.cpp"
+    }
+
+    includedirs
+    {
+		"external/**/include/",
+        "Cumulus/src"
+    }
+
+    filter "system:windows"
+        cppdialect "C++17"
+        systemversion "latest"
+        vectorextensions "AVX2"
+
+        defines
+        {
+            "MN_PLATFORM_WINDOWS"
+        }
+
+    filter "configurations:Debug"
+        defines "MN_DEBUG"
+        symbols "On"
+
+    filter "configurations:Release"
+        defines "MN_RELEASE"
+        optimize "On"
+
 project "Shaders"
     location "Assets/Shaders"
     kind "ConsoleApp"